@@ -2,9 +2,30 @@ export 'src/flutter_ble_peripheral.dart';
 export 'src/models/advertise_data.dart';
 export 'src/models/advertise_set_parameters.dart';
 export 'src/models/advertise_settings.dart';
+export 'src/models/advertise_update_result.dart';
+export 'src/models/advertising_set_stats.dart';
 export 'src/models/constants.dart';
 export 'src/models/enums/advertise_mode.dart';
 export 'src/models/enums/advertise_tx_power.dart';
 export 'src/models/enums/bluetooth_peripheral_state.dart';
+export 'src/models/enums/radio_state.dart';
+export 'src/models/enums/scan_mode.dart';
+export 'src/models/enums/scan_result_format.dart';
+export 'src/models/event_queue_stats.dart';
+export 'src/models/gatt_characteristic.dart';
+export 'src/models/gatt_server_stats.dart';
+export 'src/models/gatt_service.dart';
 export 'src/models/peripheral_state.dart';
 export 'src/models/permission_state.dart';
+export 'src/models/plugin_metrics.dart';
+export 'src/models/rssi_stats.dart';
+export 'src/models/scan_cache_stats.dart';
+export 'src/models/scan_capture_stats.dart';
+export 'src/models/scan_filter.dart';
+export 'src/models/scan_record.dart';
+export 'src/models/scan_result.dart';
+export 'src/models/scan_session_stats.dart';
+export 'src/models/send_data_result.dart';
+export 'src/models/send_progress.dart';
+export 'src/models/startup_timings.dart';
+export 'src/models/state_snapshot.dart';
@@ -13,9 +13,28 @@ import 'package:flutter/services.dart';
 import 'package:flutter_ble_peripheral/src/models/advertise_data.dart';
 import 'package:flutter_ble_peripheral/src/models/advertise_set_parameters.dart';
 import 'package:flutter_ble_peripheral/src/models/advertise_settings.dart';
+import 'package:flutter_ble_peripheral/src/models/advertise_update_result.dart';
+import 'package:flutter_ble_peripheral/src/models/advertising_set_stats.dart';
 import 'package:flutter_ble_peripheral/src/models/enums/bluetooth_peripheral_state.dart';
+import 'package:flutter_ble_peripheral/src/models/enums/scan_mode.dart';
+import 'package:flutter_ble_peripheral/src/models/enums/scan_result_format.dart';
+import 'package:flutter_ble_peripheral/src/models/event_queue_stats.dart';
+import 'package:flutter_ble_peripheral/src/models/gatt_server_stats.dart';
+import 'package:flutter_ble_peripheral/src/models/gatt_service.dart';
 import 'package:flutter_ble_peripheral/src/models/periodic_advertise_settings.dart';
 import 'package:flutter_ble_peripheral/src/models/peripheral_state.dart';
+import 'package:flutter_ble_peripheral/src/models/plugin_metrics.dart';
+import 'package:flutter_ble_peripheral/src/models/rssi_stats.dart';
+import 'package:flutter_ble_peripheral/src/models/scan_cache_stats.dart';
+import 'package:flutter_ble_peripheral/src/models/scan_capture_stats.dart';
+import 'package:flutter_ble_peripheral/src/models/scan_filter.dart';
+import 'package:flutter_ble_peripheral/src/models/scan_record.dart';
+import 'package:flutter_ble_peripheral/src/models/scan_result.dart';
+import 'package:flutter_ble_peripheral/src/models/scan_session_stats.dart';
+import 'package:flutter_ble_peripheral/src/models/send_data_result.dart';
+import 'package:flutter_ble_peripheral/src/models/send_progress.dart';
+import 'package:flutter_ble_peripheral/src/models/startup_timings.dart';
+import 'package:flutter_ble_peripheral/src/models/state_snapshot.dart';
 
 class FlutterBlePeripheral {
   /// Singleton instance
@@ -44,14 +63,67 @@ class FlutterBlePeripheral {
     'dev.steenbakker.flutter_ble_peripheral/ble_state_changed',
   );
 
+  /// Event Channel for scan results as maps
+  final EventChannel _scanResultEventChannel = const EventChannel(
+    'dev.steenbakker.flutter_ble_peripheral/scan_result',
+  );
+
+  /// Event Channel for sendData progress
+  final EventChannel _sendProgressEventChannel = const EventChannel(
+    'dev.steenbakker.flutter_ble_peripheral/ble_send_progress',
+  );
+
+  /// Event Channel for periodic metrics
+  final EventChannel _metricsEventChannel = const EventChannel(
+    'dev.steenbakker.flutter_ble_peripheral/ble_metrics',
+  );
+
+  /// Message channel carrying packed [ScanRecord]s
+  static const BasicMessageChannel<ByteData?> _scanRecordChannel =
+      BasicMessageChannel<ByteData?>(
+    'dev.steenbakker.flutter_ble_peripheral/scan_result_binary',
+    BinaryCodec(),
+  );
+
+  /// Message channel carrying reassembled writes to the data service
+  static const BasicMessageChannel<ByteData?> _dataReceivedChannel =
+      BasicMessageChannel<ByteData?>(
+    'dev.steenbakker.flutter_ble_peripheral/ble_data_received',
+    BinaryCodec(),
+  );
+
   Stream<int>? _mtuState;
   Stream<PeripheralState>? _peripheralState;
+  Stream<SendProgress>? _sendProgress;
+  Stream<ScanResult>? _scanResults;
+  StreamController<ScanRecord>? _scanRecords;
+  StreamController<Uint8List>? _dataReceived;
+
+  /// Windows only
+  ///
+  /// Completes once the native side has found the Bluetooth adapter and
+  /// radio. Calls made earlier are held and run after that, so awaiting this
+  /// is optional. Throws a [PlatformException] with code
+  /// `bluetooth_unavailable` if there is no usable adapter.
+  Future<void> initialize() async {
+    await _methodChannel.invokeMethod('initialize');
+  }
 
-  //TODO Event Channel used to received data
-  // final EventChannel _dataReceivedEventChannel = const EventChannel(
-  //     'dev.steenbakker.flutter_ble_peripheral/ble_data_received');
+  /// Windows only
+  ///
+  /// Returns how long native startup took, see [StartupTimings].
+  Future<StartupTimings?> getStartupTimings() async {
+    final response = await _methodChannel
+        .invokeMapMethod<dynamic, dynamic>('getStartupTimings');
+    return response == null ? null : StartupTimings.fromMap(response);
+  }
 
   /// Start advertising. Takes [AdvertiseData] as an input.
+  ///
+  /// On Windows, throws a [PlatformException] with code
+  /// `advertise_data_too_large` when the manufacturer data does not fit in a
+  /// 31-byte legacy advertisement. The Windows publisher broadcasts only the
+  /// manufacturer data, and only when a manufacturerId is set.
   Future<BluetoothPeripheralState> start({
     required AdvertiseData advertiseData,
     AdvertiseSettings? advertiseSettings,
@@ -62,6 +134,9 @@ class FlutterBlePeripheral {
   }) async {
     final parameters = advertiseData.toJson();
     parameters["manufacturerDataBytes"] = advertiseData.manufacturerData;
+    parameters["serviceDataBytes"] = advertiseData.serviceData == null
+        ? null
+        : Uint8List.fromList(advertiseData.serviceData!);
     final settings = advertiseSettings ?? AdvertiseSettings();
     final jsonSettings = settings.toJson();
     for (final key in jsonSettings.keys) {
@@ -103,6 +178,79 @@ class FlutterBlePeripheral {
         : BluetoothPeripheralState.values[response];
   }
 
+  /// Windows only
+  ///
+  /// Replaces the advertised data. Starts advertising if it was not running.
+  ///
+  /// A started Windows publisher keeps the advertisement it started with, so
+  /// a change to the manufacturer id or data, the only fields Windows
+  /// broadcasts, stops the advertisement and starts it again with the new
+  /// data. Changes to other fields go nowhere on air and need no restart.
+  /// [AdvertiseUpdateResult.restarted] tells which happened.
+  Future<AdvertiseUpdateResult> updateAdvertiseData(
+    AdvertiseData advertiseData,
+  ) async {
+    final parameters = advertiseData.toJson();
+    parameters["manufacturerDataBytes"] = advertiseData.manufacturerData;
+    parameters["serviceDataBytes"] = advertiseData.serviceData == null
+        ? null
+        : Uint8List.fromList(advertiseData.serviceData!);
+    final response = await _methodChannel.invokeMapMethod<dynamic, dynamic>(
+      'updateAdvertiseData',
+      parameters,
+    );
+    return AdvertiseUpdateResult.fromMap(response!);
+  }
+
+  /// Windows only
+  ///
+  /// Registers an advertising set. The plugin time-slices all registered sets
+  /// over the single publisher, honouring each set's
+  /// [AdvertiseSetParameters.interval], [AdvertiseSetParameters.duration] and
+  /// [AdvertiseSetParameters.maxExtendedAdvertisingEvents].
+  ///
+  /// Returns the id of the set.
+  Future<int> addAdvertisingSet({
+    required AdvertiseData advertiseData,
+    required AdvertiseSetParameters advertiseSetParameters,
+  }) async {
+    final parameters = advertiseData.toJson();
+    parameters["manufacturerDataBytes"] = advertiseData.manufacturerData;
+    parameters["serviceDataBytes"] = advertiseData.serviceData == null
+        ? null
+        : Uint8List.fromList(advertiseData.serviceData!);
+    final json = advertiseSetParameters.toJson();
+    for (final key in json.keys) {
+      parameters['set$key'] = json[key];
+    }
+    final response =
+        await _methodChannel.invokeMethod<int>('addAdvertisingSet', parameters);
+    return response!;
+  }
+
+  /// Windows only
+  ///
+  /// Unregisters a set added with [addAdvertisingSet]. Returns `false` if the
+  /// id is unknown.
+  Future<bool> removeAdvertisingSet(int id) async {
+    return await _methodChannel.invokeMethod<bool>(
+          'removeAdvertisingSet',
+          id,
+        ) ??
+        false;
+  }
+
+  /// Windows only
+  ///
+  /// Returns the airtime accounting of every registered advertising set.
+  Future<List<AdvertisingSetStats>> getAdvertisingSetStats() async {
+    final response = await _methodChannel
+        .invokeListMethod<Map<dynamic, dynamic>>('getAdvertisingSetStats');
+    return (response ?? const [])
+        .map((stats) => AdvertisingSetStats.fromMap(stats))
+        .toList();
+  }
+
   /// Stop advertising
   Future<BluetoothPeripheralState> stop() async {
     final response = await _methodChannel.invokeMethod<int>('stop');
@@ -124,9 +272,75 @@ class FlutterBlePeripheral {
   Future<bool> get isConnected async =>
       await _methodChannel.invokeMethod<bool>('isConnected') ?? false;
 
-  /// Start advertising. Takes [AdvertiseData] as an input.
-  Future<void> sendData(Uint8List data) async {
-    await _methodChannel.invokeMethod('sendData', data);
+  /// Windows only
+  ///
+  /// Returns the cached radio and publisher state that [isSupported],
+  /// [isAdvertising] and [isConnected] answer from, and how long ago it last
+  /// changed.
+  Future<StateSnapshot?> getStateSnapshot() async {
+    final response = await _methodChannel
+        .invokeMapMethod<dynamic, dynamic>('getStateSnapshot');
+    return response == null ? null : StateSnapshot.fromMap(response);
+  }
+
+  /// Windows only
+  ///
+  /// Adds [service] to the local GATT server and starts offering it to
+  /// clients. Reads are answered with each characteristic's current value and
+  /// writes replace it.
+  Future<GattServiceHandles?> addGattService(GattService service) async {
+    final response = await _methodChannel.invokeMapMethod<dynamic, dynamic>(
+      'addGattService',
+      service.toMap(),
+    );
+    return response == null ? null : GattServiceHandles.fromMap(response);
+  }
+
+  /// Windows only
+  ///
+  /// Removes a service added with [addGattService].
+  Future<bool> removeGattService(int handle) async =>
+      await _methodChannel.invokeMethod<bool>('removeGattService', handle) ??
+      false;
+
+  /// Windows only
+  ///
+  /// Replaces the value of a characteristic and, unless [notify] is false,
+  /// sends it to every subscribed client. Returns how many clients it was
+  /// queued for.
+  Future<int> setCharacteristicValue(
+    int handle,
+    Uint8List value, {
+    bool notify = true,
+  }) async =>
+      await _methodChannel.invokeMethod<int>('setCharacteristicValue', {
+        'handle': handle,
+        'value': value,
+        'notify': notify,
+      }) ??
+      0;
+
+  /// Windows only
+  ///
+  /// Returns the request and notification counters of the GATT server.
+  Future<GattServerStats?> getGattServerStats() async {
+    final response = await _methodChannel
+        .invokeMapMethod<dynamic, dynamic>('getGattServerStats');
+    return response == null ? null : GattServerStats.fromMap(response);
+  }
+
+  /// Sends [data] to connected clients.
+  ///
+  /// On Windows this streams [data] to every client subscribed to the data
+  /// service's tx characteristic, adding the service on first use. [data] is
+  /// split into notifications that fit the connection, so it may be larger
+  /// than one attribute value. Completes once every client has received it or
+  /// failed, see [onSendProgress] for progress until then. Returns null on
+  /// other platforms.
+  Future<SendDataResult?> sendData(Uint8List data) async {
+    final response =
+        await _methodChannel.invokeMethod<dynamic>('sendData', data);
+    return response is Map ? SendDataResult.fromMap(response) : null;
   }
 
   /// Stop advertising
@@ -167,7 +381,286 @@ class FlutterBlePeripheral {
     await _methodChannel.invokeMethod('openAppSettings');
   }
 
+  /// Windows only
+  ///
+  /// Selects how scan results are delivered. With [ScanResultFormat.binary]
+  /// results arrive on [onScanRecord] instead of as maps.
+  Future<void> setScanResultFormat(ScanResultFormat format) async {
+    await _methodChannel.invokeMethod('setScanResultFormat', format.name);
+  }
+
+  /// Windows only
+  ///
+  /// Batches scan results natively and delivers them every [flushInterval],
+  /// or as soon as [maxBatchSize] results are waiting, instead of one message
+  /// per advertisement. Map results then arrive as a list per batch.
+  ///
+  /// With [coalesce], repeated advertisements from one address within a batch
+  /// become one entry carrying the latest RSSI plus `rssiMin`, `rssiMax` and
+  /// `count`.
+  Future<void> setScanBatching({
+    required bool enabled,
+    Duration flushInterval = const Duration(milliseconds: 100),
+    int maxBatchSize = 64,
+    bool coalesce = false,
+  }) async {
+    await _methodChannel.invokeMethod('setScanBatching', {
+      'enabled': enabled,
+      'flushIntervalMs': flushInterval.inMilliseconds,
+      'maxBatchSize': maxBatchSize,
+      'coalesce': coalesce,
+    });
+  }
+
+  /// Windows only
+  ///
+  /// Remembers the last advertisement of up to [capacity] devices and only
+  /// delivers scan results from new devices or with a changed payload or
+  /// local name. Devices not heard for [maxAge] are forgotten.
+  Future<void> setScanCache({
+    required bool enabled,
+    int capacity = 1024,
+    Duration maxAge = const Duration(seconds: 30),
+  }) async {
+    await _methodChannel.invokeMethod('setScanCache', {
+      'enabled': enabled,
+      'capacity': capacity,
+      'maxAgeMs': maxAge.inMilliseconds,
+    });
+  }
+
+  /// Windows only
+  ///
+  /// Drops advertisements that do not match [filter] in native code, before
+  /// they are turned into scan results. Null delivers everything again.
+  /// Single-entry criteria are also handed to the Bluetooth stack, so
+  /// advertisements they rule out never reach the process. Throws a
+  /// [PlatformException] with code `invalid_arguments` for an unparsable
+  /// UUID or a mask that is not as long as its prefix.
+  Future<void> setScanFilter(ScanFilter? filter) async {
+    await _methodChannel.invokeMethod('setScanFilter', filter?.toMap());
+  }
+
+  /// Windows only
+  ///
+  /// Returns the counters of the scan cache, see [setScanCache].
+  Future<ScanCacheStats?> getScanCacheStats() async {
+    final response = await _methodChannel
+        .invokeMapMethod<dynamic, dynamic>('getScanCacheStats');
+    return response == null ? null : ScanCacheStats.fromMap(response);
+  }
+
+  /// Windows only
+  ///
+  /// Keeps the RSSI and TX power of the last [samplesPerDevice] scan
+  /// results of up to [maxDevices] advertisers in native memory, for
+  /// [getRssiStats]. Results dropped by [setScanCache] are still recorded.
+  /// Disabling it frees the history.
+  Future<void> setRssiHistory({
+    required bool enabled,
+    int maxDevices = 256,
+    int samplesPerDevice = 256,
+  }) async {
+    await _methodChannel.invokeMethod('setRssiHistory', {
+      'enabled': enabled,
+      'maxDevices': maxDevices,
+      'samplesPerDevice': samplesPerDevice,
+    });
+  }
+
+  /// Windows only
+  ///
+  /// Returns signal statistics over the recent scan results of the device
+  /// with [address], as reported by [ScanResult.address], or null if none
+  /// were recorded, see [setRssiHistory]. The window is the newest
+  /// [windowSamples] results no older than [window] before the newest one;
+  /// leave either out for no limit.
+  Future<RssiStats?> getRssiStats(
+    String address, {
+    int? windowSamples,
+    Duration? window,
+  }) async {
+    final response =
+        await _methodChannel.invokeMapMethod<dynamic, dynamic>('getRssiStats', {
+      'address': address,
+      if (windowSamples != null) 'windowSamples': windowSamples,
+      if (window != null) 'windowMs': window.inMilliseconds,
+    });
+    return response == null ? null : RssiStats.fromMap(response);
+  }
+
+  /// Windows only
+  ///
+  /// Starts scanning for advertisements, delivered on [onScanResult]. The
+  /// radio listens for [window] out of every [interval], both between
+  /// 2.5 ms and 10.24 s; leave [window] out to scan continuously. Windows
+  /// does not support a scan window itself, so a shorter one is emulated by
+  /// starting and stopping the scanner. [interval] also sets how often a
+  /// device that keeps advertising is reported. Restarts a running scan.
+  Future<void> startScan({
+    ScanMode mode = ScanMode.passive,
+    Duration interval = const Duration(milliseconds: 100),
+    Duration? window,
+  }) async {
+    await _methodChannel.invokeMethod('startScan', {
+      'scanMode': mode.index,
+      'intervalMicros': interval.inMicroseconds,
+      if (window != null) 'windowMicros': window.inMicroseconds,
+    });
+  }
+
+  /// Windows only
+  ///
+  /// Stops the scan started by [startScan] and returns what it achieved.
+  Future<ScanSessionStats?> stopScan() async {
+    final response =
+        await _methodChannel.invokeMapMethod<dynamic, dynamic>('stopScan');
+    return response == null ? null : ScanSessionStats.fromMap(response);
+  }
+
+  /// Windows only
+  ///
+  /// Returns the settings and achieved duty cycle of the current or last
+  /// scan.
+  Future<ScanSessionStats?> getScanSessionStats() async {
+    final response = await _methodChannel
+        .invokeMapMethod<dynamic, dynamic>('getScanSessionStats');
+    return response == null ? null : ScanSessionStats.fromMap(response);
+  }
+
+  /// Windows only
+  ///
+  /// Records every advertisement the scanner receives, before any
+  /// [setScanFilter] filter, to the file at [path]: timestamp, address,
+  /// RSSI and raw AD structures. [deltaCompressed] stores repeats of a
+  /// device's last payload in a few bytes. Recording never holds up the
+  /// scan; advertisements arriving faster than the file is written are
+  /// counted as dropped. Replaces a capture already running.
+  Future<void> startScanCapture(
+    String path, {
+    bool deltaCompressed = true,
+  }) async {
+    await _methodChannel.invokeMethod('startScanCapture', {
+      'path': path,
+      'deltaCompressed': deltaCompressed,
+    });
+  }
+
+  /// Windows only
+  ///
+  /// Finishes the capture started by [startScanCapture] and returns what it
+  /// recorded.
+  Future<ScanCaptureStats?> stopScanCapture() async {
+    final response = await _methodChannel
+        .invokeMapMethod<dynamic, dynamic>('stopScanCapture');
+    return response == null ? null : ScanCaptureStats.fromMap(response);
+  }
+
+  /// Windows only
+  ///
+  /// Feeds the capture at [path] back through the scan pipeline, filter,
+  /// cache and batching included, as if the radio were receiving it. With
+  /// [realTime] advertisements arrive at their recorded pace, otherwise as
+  /// fast as the pipeline takes them. Fails while a scan is running, and
+  /// [startScan] fails until the replay has finished or been stopped.
+  Future<void> startScanReplay(String path, {bool realTime = true}) async {
+    await _methodChannel.invokeMethod('startScanReplay', {
+      'path': path,
+      'realTime': realTime,
+    });
+  }
+
+  /// Windows only
+  ///
+  /// Stops the replay started by [startScanReplay] and returns how far it
+  /// got.
+  Future<ScanReplayStats?> stopScanReplay() async {
+    final response = await _methodChannel
+        .invokeMapMethod<dynamic, dynamic>('stopScanReplay');
+    return response == null ? null : ScanReplayStats.fromMap(response);
+  }
+
+  /// Windows only
+  ///
+  /// Returns the plugin's counters and latency histograms: scan results
+  /// received, filtered and dropped, publisher status transitions and start
+  /// latency, callback-to-Dart latency and the time spent in each method
+  /// call.
+  Future<PluginMetrics?> getMetrics() async {
+    final response =
+        await _methodChannel.invokeMapMethod<dynamic, dynamic>('getMetrics');
+    return response == null ? null : PluginMetrics.fromMap(response);
+  }
+
+  /// Windows only
+  ///
+  /// Returns Stream of [getMetrics] snapshots taken every [interval], from
+  /// 10 ms up. The native side serves one listener at a time, so listening
+  /// with a new interval replaces the previous stream.
+  Stream<PluginMetrics> onMetrics({
+    Duration interval = const Duration(seconds: 1),
+  }) {
+    return _metricsEventChannel
+        .receiveBroadcastStream(interval.inMilliseconds)
+        .map((dynamic event) => PluginMetrics.fromMap(event as Map));
+  }
+
+  /// Windows only
+  ///
+  /// Returns the counters of the native queue that hands Bluetooth callbacks
+  /// to the platform thread. A growing `dropped` count means scan results
+  /// arrive faster than the app consumes them.
+  Future<EventQueueStats?> getEventQueueStats() async {
+    final response = await _methodChannel
+        .invokeMapMethod<dynamic, dynamic>('getEventQueueStats');
+    return response == null ? null : EventQueueStats.fromMap(response);
+  }
+
+  /// Windows only
+  ///
+  /// Returns Stream of scan results delivered as maps, the default
+  /// [ScanResultFormat]. Batches from [setScanBatching] are flattened.
+  Stream<ScanResult> get onScanResult {
+    _scanResults ??= _scanResultEventChannel
+        .receiveBroadcastStream()
+        .expand((dynamic event) => event is List ? event : [event])
+        .map((dynamic event) => ScanResult.fromMap(event as Map));
+    return _scanResults!;
+  }
+
+  /// Windows only
+  ///
+  /// Returns Stream of scan results delivered in the binary format, see
+  /// [setScanResultFormat].
+  Stream<ScanRecord> get onScanRecord {
+    _scanRecords ??= StreamController<ScanRecord>.broadcast(
+      onListen: () => _scanRecordChannel.setMessageHandler((message) async {
+        if (message != null) {
+          ScanRecord.decode(message).forEach(_scanRecords!.add);
+        }
+        return null;
+      }),
+      onCancel: () => _scanRecordChannel.setMessageHandler(null),
+    );
+    return _scanRecords!.stream;
+  }
+
+  /// Windows only
+  ///
+  /// Returns Stream of progress reports for payloads passed to [sendData]:
+  /// one per client stream at regular byte intervals, and a last one when
+  /// the stream is done.
+  Stream<SendProgress> get onSendProgress {
+    _sendProgress ??= _sendProgressEventChannel
+        .receiveBroadcastStream()
+        .map((dynamic event) => SendProgress.fromMap(event as Map));
+    return _sendProgress!;
+  }
+
   /// Returns Stream of MTU updates.
+  ///
+  /// On Windows this is each GATT client's ATT MTU as soon as it connects
+  /// and whenever it renegotiates. [sendData] fills packets up to it.
   Stream<int> get onMtuChanged {
     _mtuState ??= _mtuChangedEventChannel
         .receiveBroadcastStream()
@@ -180,18 +673,39 @@ class FlutterBlePeripheral {
   /// Returns Stream of state.
   ///
   /// After listening to this Stream, you'll be notified about changes in peripheral state.
+  ///
+  /// On Windows the current state is sent on listen, and transitions are
+  /// debounced so only the settled, changed state is delivered.
   Stream<PeripheralState>? get onPeripheralStateChanged {
-    if (Platform.isWindows) return null;
     _peripheralState ??= _stateChangedEventChannel
         .receiveBroadcastStream()
         .map((dynamic event) => PeripheralState.values[event as int]);
     return _peripheralState!;
   }
 
-  // /// Returns Stream of data.
-  // ///
-  // ///
-  // Stream<Uint8List> getDataReceived() {
-  //   return _dataReceivedEventChannel.receiveBroadcastStream().cast<Uint8List>();
-  // }
+  /// Windows only
+  ///
+  /// Returns Stream of data clients write to the data service's rx
+  /// characteristic, adding the service on listen. Every write is a message
+  /// of its own. Windows does not say whether a write was part of a long
+  /// (prepared) write, so a write it delivers at a nonzero offset is refused
+  /// with Invalid Offset; keep each message within one write.
+  Stream<Uint8List> get onDataReceived {
+    _dataReceived ??= StreamController<Uint8List>.broadcast(
+      onListen: () {
+        _dataReceivedChannel.setMessageHandler((message) async {
+          if (message != null) {
+            _dataReceived!.add(
+              message.buffer
+                  .asUint8List(message.offsetInBytes, message.lengthInBytes),
+            );
+          }
+          return null;
+        });
+        _methodChannel.invokeMethod<bool>('addDataService');
+      },
+      onCancel: () => _dataReceivedChannel.setMessageHandler(null),
+    );
+    return _dataReceived!.stream;
+  }
 }
@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2024. Julian Steenbakker.
+ * All rights reserved. Use of this source code is governed by a
+ * BSD-style license that can be found in the LICENSE file.
+ */
+
+import 'package:flutter_ble_peripheral/src/models/enums/bluetooth_peripheral_state.dart';
+
+/// Outcome of `FlutterBlePeripheral.updateAdvertiseData`.
+class AdvertiseUpdateResult {
+  /// State of the peripheral after the update.
+  final BluetoothPeripheralState state;
+
+  /// Bit mask of the advertise data fields that differed from the previous
+  /// payload. Zero if nothing changed.
+  final int changedFields;
+
+  /// True if the advertisement was stopped and started again with the new
+  /// data. On Windows this is the case for every manufacturer data change.
+  final bool restarted;
+
+  /// Time the native side spent applying the update.
+  final Duration duration;
+
+  const AdvertiseUpdateResult({
+    required this.state,
+    required this.changedFields,
+    required this.restarted,
+    required this.duration,
+  });
+
+  factory AdvertiseUpdateResult.fromMap(Map<dynamic, dynamic> map) =>
+      AdvertiseUpdateResult(
+        state: BluetoothPeripheralState.values[map['state'] as int],
+        changedFields: map['changedFields'] as int,
+        restarted: map['restarted'] as bool,
+        duration: Duration(microseconds: map['durationMicros'] as int),
+      );
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2024. Julian Steenbakker.
+ * All rights reserved. Use of this source code is governed by a
+ * BSD-style license that can be found in the LICENSE file.
+ */
+
+/// Airtime accounting for one advertising set registered with
+/// `FlutterBlePeripheral.addAdvertisingSet`.
+class AdvertisingSetStats {
+  /// Id returned when the set was added.
+  final int id;
+
+  /// Number of times the set has been put on air.
+  final int events;
+
+  /// Total time the set has been on air.
+  final Duration airtime;
+
+  /// True if the set is being broadcast right now.
+  final bool onAir;
+
+  /// True if the set reached its duration or maximum number of events.
+  final bool expired;
+
+  const AdvertisingSetStats({
+    required this.id,
+    required this.events,
+    required this.airtime,
+    required this.onAir,
+    required this.expired,
+  });
+
+  factory AdvertisingSetStats.fromMap(Map<dynamic, dynamic> map) =>
+      AdvertisingSetStats(
+        id: map['id'] as int,
+        events: map['events'] as int,
+        airtime: Duration(microseconds: map['airtimeMicros'] as int),
+        onAir: map['onAir'] as bool,
+        expired: map['expired'] as bool,
+      );
+}
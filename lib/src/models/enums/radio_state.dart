@@ -0,0 +1,20 @@
+/*
+ * Copyright (c) 2024. Julian Steenbakker.
+ * All rights reserved. Use of this source code is governed by a
+ * BSD-style license that can be found in the LICENSE file.
+ */
+
+/// State of the Bluetooth radio.
+enum RadioState {
+  /// Not known yet, or the adapter has no radio.
+  unknown,
+
+  /// Powered on.
+  on,
+
+  /// Powered off by the user.
+  off,
+
+  /// Disabled by policy or hardware.
+  disabled,
+}
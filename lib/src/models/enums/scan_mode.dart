@@ -0,0 +1,15 @@
+/*
+ * Copyright (c) 2024. Julian Steenbakker.
+ * All rights reserved. Use of this source code is governed by a
+ * BSD-style license that can be found in the LICENSE file.
+ */
+
+/// How the scanner treats the advertisers it hears.
+enum ScanMode {
+  /// Only listens; advertisers never learn they were heard.
+  passive,
+
+  /// Sends scan requests and reports scan responses as well, at the cost of
+  /// transmitting.
+  active,
+}
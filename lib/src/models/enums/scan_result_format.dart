@@ -0,0 +1,14 @@
+/*
+ * Copyright (c) 2024. Julian Steenbakker.
+ * All rights reserved. Use of this source code is governed by a
+ * BSD-style license that can be found in the LICENSE file.
+ */
+
+/// How the native side delivers scan results.
+enum ScanResultFormat {
+  /// One map per advertisement on the scan_result event channel.
+  map,
+
+  /// Packed [ScanRecord] messages on the scan_result_binary channel.
+  binary,
+}
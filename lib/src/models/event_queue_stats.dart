@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2024. Julian Steenbakker.
+ * All rights reserved. Use of this source code is governed by a
+ * BSD-style license that can be found in the LICENSE file.
+ */
+
+/// Counters of the native queue that carries Bluetooth callbacks to the
+/// platform thread, see `FlutterBlePeripheral.getEventQueueStats`.
+class EventQueueStats {
+  /// Events accepted into the queue.
+  final int posted;
+
+  /// Events dropped because the queue was full.
+  final int dropped;
+
+  /// Events handled on the platform thread.
+  final int drained;
+
+  /// Drain messages posted to the platform thread.
+  final int wakeups;
+
+  /// Drain messages that could not be posted. Their events are handled on
+  /// the next method call or drain message instead.
+  final int failedWakeups;
+
+  /// Largest backlog seen at the start of a drain.
+  final int highWater;
+
+  /// Maximum number of queued events.
+  final int capacity;
+
+  /// Scan results dropped by the batcher because it was full, see
+  /// `FlutterBlePeripheral.setScanBatching`.
+  final int scanResultsDropped;
+
+  /// Advertisements turned away by the scan filter, see
+  /// `FlutterBlePeripheral.setScanFilter`.
+  final int scanResultsFiltered;
+
+  const EventQueueStats({
+    required this.posted,
+    required this.dropped,
+    required this.drained,
+    required this.wakeups,
+    required this.failedWakeups,
+    required this.highWater,
+    required this.capacity,
+    required this.scanResultsDropped,
+    required this.scanResultsFiltered,
+  });
+
+  factory EventQueueStats.fromMap(Map<dynamic, dynamic> map) =>
+      EventQueueStats(
+        posted: map['posted'] as int,
+        dropped: map['dropped'] as int,
+        drained: map['drained'] as int,
+        wakeups: map['wakeups'] as int,
+        failedWakeups: map['failedWakeups'] as int,
+        highWater: map['highWater'] as int,
+        capacity: map['capacity'] as int,
+        scanResultsDropped: map['scanResultsDropped'] as int,
+        scanResultsFiltered: map['scanResultsFiltered'] as int,
+      );
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2024. Julian Steenbakker.
+ * All rights reserved. Use of this source code is governed by a
+ * BSD-style license that can be found in the LICENSE file.
+ */
+
+import 'dart:typed_data';
+
+/// A characteristic of a [GattService] hosted by the local GATT server.
+class GattCharacteristic {
+  /// Property bits, numbered as in the Bluetooth Core specification.
+  static const int propertyRead = 0x02;
+  static const int propertyWriteWithoutResponse = 0x04;
+  static const int propertyWrite = 0x08;
+  static const int propertyNotify = 0x10;
+  static const int propertyIndicate = 0x20;
+
+  /// 16-bit, 32-bit or full 128-bit UUID, e.g. `2A19`.
+  final String uuid;
+
+  /// A combination of the `property` bits.
+  final int properties;
+
+  /// Value returned to reads until it is written or replaced, at most 512
+  /// bytes.
+  final Uint8List? value;
+
+  const GattCharacteristic({
+    required this.uuid,
+    required this.properties,
+    this.value,
+  });
+
+  Map<String, dynamic> toMap() => {
+        'uuid': uuid,
+        'properties': properties,
+        'value': value,
+      };
+}
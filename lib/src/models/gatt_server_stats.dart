@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2024. Julian Steenbakker.
+ * All rights reserved. Use of this source code is governed by a
+ * BSD-style license that can be found in the LICENSE file.
+ */
+
+/// Counters of the local GATT server, see
+/// `FlutterBlePeripheral.getGattServerStats`.
+class GattServerStats {
+  /// Reads answered with a value.
+  final int reads;
+
+  /// Writes accepted.
+  final int writes;
+
+  /// Requests answered with an error.
+  final int rejected;
+
+  /// Notifications queued to clients.
+  final int notifications;
+
+  /// Indications queued to clients.
+  final int indications;
+
+  /// Values not sent because a client's queue was full.
+  final int dropped;
+
+  /// Bytes queued as notifications and indications.
+  final int bytesSent;
+
+  /// Connected clients.
+  final int clients;
+
+  /// Client subscriptions across all characteristics.
+  final int subscriptions;
+
+  /// Writes to the data service's rx characteristic, fragments included.
+  final int fragmentsReceived;
+
+  /// Messages reassembled from those writes.
+  final int messagesReceived;
+
+  /// Bytes in those messages.
+  final int bytesReceived;
+
+  /// Writes refused for a bad offset, an oversized message or a full
+  /// reassembly table.
+  final int writesRejected;
+
+  /// Long writes dropped by a cancel, a restart or a disconnect.
+  final int writesExpired;
+
+  const GattServerStats({
+    required this.reads,
+    required this.writes,
+    required this.rejected,
+    required this.notifications,
+    required this.indications,
+    required this.dropped,
+    required this.bytesSent,
+    required this.clients,
+    required this.subscriptions,
+    required this.fragmentsReceived,
+    required this.messagesReceived,
+    required this.bytesReceived,
+    required this.writesRejected,
+    required this.writesExpired,
+  });
+
+  factory GattServerStats.fromMap(Map<dynamic, dynamic> map) =>
+      GattServerStats(
+        reads: map['reads'] as int,
+        writes: map['writes'] as int,
+        rejected: map['rejected'] as int,
+        notifications: map['notifications'] as int,
+        indications: map['indications'] as int,
+        dropped: map['dropped'] as int,
+        bytesSent: map['bytesSent'] as int,
+        clients: map['clients'] as int,
+        subscriptions: map['subscriptions'] as int,
+        fragmentsReceived: map['fragmentsReceived'] as int,
+        messagesReceived: map['messagesReceived'] as int,
+        bytesReceived: map['bytesReceived'] as int,
+        writesRejected: map['writesRejected'] as int,
+        writesExpired: map['writesExpired'] as int,
+      );
+}
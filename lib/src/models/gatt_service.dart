@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2024. Julian Steenbakker.
+ * All rights reserved. Use of this source code is governed by a
+ * BSD-style license that can be found in the LICENSE file.
+ */
+
+import 'package:flutter_ble_peripheral/src/models/gatt_characteristic.dart';
+
+/// A primary service for the local GATT server, see
+/// `FlutterBlePeripheral.addGattService`.
+class GattService {
+  /// 16-bit, 32-bit or full 128-bit UUID, e.g. `180F`.
+  final String uuid;
+
+  final List<GattCharacteristic> characteristics;
+
+  const GattService({
+    required this.uuid,
+    this.characteristics = const [],
+  });
+
+  Map<String, dynamic> toMap() => {
+        'uuid': uuid,
+        'characteristics': [
+          for (final characteristic in characteristics) characteristic.toMap(),
+        ],
+      };
+}
+
+/// Handles the GATT server assigned to an added [GattService].
+class GattServiceHandles {
+  /// Pass to `FlutterBlePeripheral.removeGattService`.
+  final int handle;
+
+  /// One per characteristic, in the order they were given. Pass to
+  /// `FlutterBlePeripheral.setCharacteristicValue`.
+  final List<int> characteristicHandles;
+
+  const GattServiceHandles({
+    required this.handle,
+    required this.characteristicHandles,
+  });
+
+  factory GattServiceHandles.fromMap(Map<dynamic, dynamic> map) =>
+      GattServiceHandles(
+        handle: map['handle'] as int,
+        characteristicHandles:
+            (map['characteristicHandles'] as List<dynamic>).cast<int>(),
+      );
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2024. Julian Steenbakker.
+ * All rights reserved. Use of this source code is governed by a
+ * BSD-style license that can be found in the LICENSE file.
+ */
+
+/// A latency distribution recorded by the native side. Percentiles are
+/// accurate to within 1/16 of their value.
+class LatencyStats {
+  final int count;
+  final Duration min;
+  final Duration max;
+  final Duration mean;
+  final Duration p50;
+  final Duration p90;
+  final Duration p99;
+  final Duration p999;
+
+  const LatencyStats({
+    required this.count,
+    required this.min,
+    required this.max,
+    required this.mean,
+    required this.p50,
+    required this.p90,
+    required this.p99,
+    required this.p999,
+  });
+
+  static Duration _nanos(dynamic value) =>
+      Duration(microseconds: (value as num) ~/ 1000);
+
+  factory LatencyStats.fromMap(Map<dynamic, dynamic> map) => LatencyStats(
+        count: map['count'] as int,
+        min: _nanos(map['minNanos']),
+        max: _nanos(map['maxNanos']),
+        mean: _nanos(map['meanNanos']),
+        p50: _nanos(map['p50Nanos']),
+        p90: _nanos(map['p90Nanos']),
+        p99: _nanos(map['p99Nanos']),
+        p999: _nanos(map['p999Nanos']),
+      );
+}
+
+/// Counters and latencies the native side has recorded since the plugin
+/// was loaded, see `FlutterBlePeripheral.getMetrics`. Counters only grow;
+/// diff two snapshots for rates.
+class PluginMetrics {
+  /// False when the plugin was built without metrics, in which case
+  /// everything else is zero.
+  final bool enabled;
+
+  /// Event counts by name, e.g. `scanReceived`, `scanFiltered`,
+  /// `scanDropped` or `publisherAborted`.
+  final Map<String, int> counters;
+
+  /// Stage latencies by name: `callbackToSink`, from the Bluetooth
+  /// callback to the result being sent to Dart, and `publisherStart`, from
+  /// starting the advertisement to it being on air.
+  final Map<String, LatencyStats> latencies;
+
+  /// Time spent handling each method channel call, by method name, for the
+  /// methods that were called.
+  final Map<String, LatencyStats> methods;
+
+  const PluginMetrics({
+    required this.enabled,
+    required this.counters,
+    required this.latencies,
+    required this.methods,
+  });
+
+  static Map<String, LatencyStats> _latencies(dynamic map) =>
+      (map as Map<dynamic, dynamic>).map(
+        (dynamic key, dynamic value) => MapEntry(
+          key as String,
+          LatencyStats.fromMap(value as Map<dynamic, dynamic>),
+        ),
+      );
+
+  factory PluginMetrics.fromMap(Map<dynamic, dynamic> map) => PluginMetrics(
+        enabled: map['enabled'] as bool,
+        counters: (map['counters'] as Map<dynamic, dynamic>).map(
+          (dynamic key, dynamic value) => MapEntry(key as String, value as int),
+        ),
+        latencies: _latencies(map['latencies']),
+        methods: _latencies(map['methods']),
+      );
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2024. Julian Steenbakker.
+ * All rights reserved. Use of this source code is governed by a
+ * BSD-style license that can be found in the LICENSE file.
+ */
+
+/// Signal statistics of one advertiser over a window of its recent scan
+/// results, see `FlutterBlePeripheral.getRssiStats`. RSSI values are in
+/// dBm.
+class RssiStats {
+  /// Samples in the window.
+  final int samples;
+
+  /// Samples recorded since the device was first heard from.
+  final int totalSamples;
+
+  /// Reception time of the oldest sample in the window.
+  final DateTime first;
+
+  /// Reception time of the newest sample.
+  final DateTime last;
+
+  /// The newest RSSI.
+  final int latest;
+
+  final int min;
+  final int max;
+
+  /// Moving average over the window.
+  final double mean;
+
+  final double standardDeviation;
+
+  /// 10th percentile, median and 90th percentile over the window.
+  final int p10;
+  final int median;
+  final int p90;
+
+  /// Kalman-smoothed RSSI after the newest sample, filtered over every
+  /// sample rather than just the window.
+  final double kalman;
+
+  /// Advertisements per second across the window.
+  final double advertisementsPerSecond;
+
+  /// The newest advertised TX power level in the window, in dBm.
+  final int? txPower;
+
+  const RssiStats({
+    required this.samples,
+    required this.totalSamples,
+    required this.first,
+    required this.last,
+    required this.latest,
+    required this.min,
+    required this.max,
+    required this.mean,
+    required this.standardDeviation,
+    required this.p10,
+    required this.median,
+    required this.p90,
+    required this.kalman,
+    required this.advertisementsPerSecond,
+    this.txPower,
+  });
+
+  /// Path loss in dB between the advertised TX power and the smoothed
+  /// RSSI, the usual input for a distance estimate.
+  double? get pathLoss => txPower == null ? null : txPower! - kalman;
+
+  factory RssiStats.fromMap(Map<dynamic, dynamic> map) => RssiStats(
+        samples: map['samples'] as int,
+        totalSamples: map['totalSamples'] as int,
+        first: DateTime.fromMicrosecondsSinceEpoch(map['firstMicros'] as int),
+        last: DateTime.fromMicrosecondsSinceEpoch(map['lastMicros'] as int),
+        latest: map['latest'] as int,
+        min: map['min'] as int,
+        max: map['max'] as int,
+        mean: map['mean'] as double,
+        standardDeviation: map['standardDeviation'] as double,
+        p10: map['p10'] as int,
+        median: map['median'] as int,
+        p90: map['p90'] as int,
+        kalman: map['kalman'] as double,
+        advertisementsPerSecond: map['advertisementsPerSecond'] as double,
+        txPower: map['txPower'] as int?,
+      );
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2024. Julian Steenbakker.
+ * All rights reserved. Use of this source code is governed by a
+ * BSD-style license that can be found in the LICENSE file.
+ */
+
+/// Counters of the native per-device scan cache, see
+/// `FlutterBlePeripheral.setScanCache`.
+class ScanCacheStats {
+  /// Advertisements identical to the previous one from the same device.
+  /// These were not delivered.
+  final int hits;
+
+  /// Advertisements from devices the cache did not know.
+  final int misses;
+
+  /// Advertisements whose payload or local name changed.
+  final int changes;
+
+  /// Devices dropped because the cache was full or they went quiet.
+  final int evictions;
+
+  /// Devices currently cached.
+  final int size;
+
+  /// Maximum number of devices the cache holds.
+  final int capacity;
+
+  const ScanCacheStats({
+    required this.hits,
+    required this.misses,
+    required this.changes,
+    required this.evictions,
+    required this.size,
+    required this.capacity,
+  });
+
+  factory ScanCacheStats.fromMap(Map<dynamic, dynamic> map) => ScanCacheStats(
+        hits: map['hits'] as int,
+        misses: map['misses'] as int,
+        changes: map['changes'] as int,
+        evictions: map['evictions'] as int,
+        size: map['size'] as int,
+        capacity: map['capacity'] as int,
+      );
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2024. Julian Steenbakker.
+ * All rights reserved. Use of this source code is governed by a
+ * BSD-style license that can be found in the LICENSE file.
+ */
+
+/// What a capture started with `FlutterBlePeripheral.startScanCapture`
+/// recorded.
+class ScanCaptureStats {
+  /// Advertisements written to the capture.
+  final int records;
+
+  /// Advertisements that arrived while the writer was behind and were left
+  /// out rather than holding up the scan.
+  final int dropped;
+
+  /// Size of the capture file.
+  final int bytes;
+
+  /// Whether writing the file failed; the capture ends at the failure.
+  final bool failed;
+
+  const ScanCaptureStats({
+    required this.records,
+    required this.dropped,
+    required this.bytes,
+    required this.failed,
+  });
+
+  factory ScanCaptureStats.fromMap(Map<dynamic, dynamic> map) =>
+      ScanCaptureStats(
+        records: map['records'] as int,
+        dropped: map['dropped'] as int,
+        bytes: map['bytes'] as int,
+        failed: map['failed'] as bool,
+      );
+}
+
+/// How far a replay started with `FlutterBlePeripheral.startScanReplay` got.
+class ScanReplayStats {
+  /// Advertisements fed back through the scan pipeline.
+  final int delivered;
+
+  /// Whether the whole capture was replayed.
+  final bool finished;
+
+  const ScanReplayStats({
+    required this.delivered,
+    required this.finished,
+  });
+
+  factory ScanReplayStats.fromMap(Map<dynamic, dynamic> map) =>
+      ScanReplayStats(
+        delivered: map['delivered'] as int,
+        finished: map['finished'] as bool,
+      );
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2024. Julian Steenbakker.
+ * All rights reserved. Use of this source code is governed by a
+ * BSD-style license that can be found in the LICENSE file.
+ */
+
+import 'dart:typed_data';
+
+/// Matches manufacturer specific data of one company, see [ScanFilter].
+class ManufacturerDataFilter {
+  /// 16-bit Bluetooth SIG company identifier.
+  final int companyId;
+
+  /// Compared with the start of the manufacturer data, after the company id.
+  final Uint8List? prefix;
+
+  /// Which bits of [prefix] have to match. Null compares every bit; otherwise
+  /// it is as long as [prefix].
+  final Uint8List? mask;
+
+  const ManufacturerDataFilter({
+    required this.companyId,
+    this.prefix,
+    this.mask,
+  });
+
+  Map<String, dynamic> toMap() => {
+        'companyId': companyId,
+        'prefix': prefix,
+        'mask': mask,
+      };
+}
+
+/// Which advertisements a scan delivers, see
+/// `FlutterBlePeripheral.setScanFilter`.
+///
+/// Every criterion that is set must hold; within a list, one matching entry
+/// is enough.
+class ScanFilter {
+  /// Company identifiers of the manufacturer specific data.
+  final List<int> companyIds;
+
+  /// 16-bit, 32-bit or 128-bit service UUIDs, complete or incomplete lists.
+  final List<String> serviceUuids;
+
+  /// Manufacturer data patterns.
+  final List<ManufacturerDataFilter> manufacturerData;
+
+  /// Prefixes of the complete or shortened local name.
+  final List<String> namePrefixes;
+
+  /// Weakest signal, in dBm, that is still delivered.
+  final int? minRssi;
+
+  const ScanFilter({
+    this.companyIds = const [],
+    this.serviceUuids = const [],
+    this.manufacturerData = const [],
+    this.namePrefixes = const [],
+    this.minRssi,
+  });
+
+  Map<String, dynamic> toMap() => {
+        'companyIds': companyIds,
+        'serviceUuids': serviceUuids,
+        'manufacturerData': [for (final m in manufacturerData) m.toMap()],
+        'namePrefixes': namePrefixes,
+        'minRssi': minRssi,
+      };
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2024. Julian Steenbakker.
+ * All rights reserved. Use of this source code is governed by a
+ * BSD-style license that can be found in the LICENSE file.
+ */
+
+import 'dart:typed_data';
+
+/// A scan result received over the compact binary scan channel.
+///
+/// See `windows/core/scan_record_codec.h` for the wire format.
+class ScanRecord {
+  /// Version of the wire format this decoder understands.
+  static const int formatVersion = 1;
+
+  static const int _messageHeaderSize = 4;
+  static const int _recordHeaderSize = 18;
+
+  /// 48-bit Bluetooth address of the advertiser.
+  final int address;
+
+  /// Received signal strength in dBm.
+  final int rssi;
+
+  /// Advertisement type bits: 1 connectable, 2 scannable, 4 directed,
+  /// 8 scan response.
+  final int flags;
+
+  /// Time the advertisement was received.
+  final DateTime timestamp;
+
+  /// The raw AD structures of the advertisement.
+  final Uint8List advertisementData;
+
+  const ScanRecord({
+    required this.address,
+    required this.rssi,
+    required this.flags,
+    required this.timestamp,
+    required this.advertisementData,
+  });
+
+  bool get isConnectable => flags & 1 != 0;
+
+  bool get isScanResponse => flags & 8 != 0;
+
+  /// Decodes every record of a binary scan message. Returns an empty list for
+  /// messages of an unknown version; stops at the first truncated record.
+  static List<ScanRecord> decode(ByteData message) {
+    if (message.lengthInBytes < _messageHeaderSize ||
+        message.getUint8(0) != formatVersion) {
+      return const [];
+    }
+    final count = message.getUint16(2, Endian.little);
+    final records = <ScanRecord>[];
+    var offset = _messageHeaderSize;
+    while (records.length < count &&
+        offset + _recordHeaderSize <= message.lengthInBytes) {
+      final recordSize = 2 + message.getUint16(offset, Endian.little);
+      if (recordSize < _recordHeaderSize ||
+          offset + recordSize > message.lengthInBytes) {
+        break;
+      }
+      final address = message.getUint32(offset + 2, Endian.little) |
+          (message.getUint16(offset + 6, Endian.little) << 32);
+      records.add(
+        ScanRecord(
+          address: address,
+          rssi: message.getInt8(offset + 8),
+          flags: message.getUint8(offset + 9),
+          timestamp: DateTime.fromMicrosecondsSinceEpoch(
+            message.getUint64(offset + 10, Endian.little),
+          ),
+          advertisementData: message.buffer.asUint8List(
+            message.offsetInBytes + offset + _recordHeaderSize,
+            recordSize - _recordHeaderSize,
+          ),
+        ),
+      );
+      offset += recordSize;
+    }
+    return records;
+  }
+}
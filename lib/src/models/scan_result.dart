@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2024. Julian Steenbakker.
+ * All rights reserved. Use of this source code is governed by a
+ * BSD-style license that can be found in the LICENSE file.
+ */
+
+import 'dart:typed_data';
+
+/// A scan result delivered as a map, see
+/// `FlutterBlePeripheral.onScanResult`.
+class ScanResult {
+  /// The advertised local name, or the address in hex without one.
+  final String deviceName;
+
+  /// 48-bit Bluetooth address of the advertiser, in decimal.
+  final String address;
+
+  /// Received signal strength in dBm.
+  final int rssi;
+
+  /// Service UUIDs from the complete and incomplete lists of every width,
+  /// in the full 128-bit form.
+  final List<String> serviceUuids;
+
+  /// Service data keyed by the full 128-bit service UUID.
+  final Map<String, Uint8List> serviceData;
+
+  /// Manufacturer specific data keyed by company id.
+  final Map<int, Uint8List> manufacturerData;
+
+  /// The first manufacturer record with its little-endian company id in
+  /// front, as on Android.
+  final Uint8List manufacturerSpecificData;
+
+  /// Advertised TX power level in dBm.
+  final int? txPowerLevel;
+
+  /// GAP appearance value.
+  final int? appearance;
+
+  /// The advertisement's flags AD structure.
+  final int? advertiseFlags;
+
+  const ScanResult({
+    required this.deviceName,
+    required this.address,
+    required this.rssi,
+    required this.serviceUuids,
+    required this.serviceData,
+    required this.manufacturerData,
+    required this.manufacturerSpecificData,
+    this.txPowerLevel,
+    this.appearance,
+    this.advertiseFlags,
+  });
+
+  factory ScanResult.fromMap(Map<dynamic, dynamic> map) => ScanResult(
+        deviceName: map['deviceName'] as String,
+        address: map['address'] as String,
+        rssi: map['rssi'] as int,
+        serviceUuids:
+            (map['serviceUuids'] as List<dynamic>? ?? const []).cast<String>(),
+        serviceData: (map['serviceData'] as Map<dynamic, dynamic>? ?? const {})
+            .map((key, value) => MapEntry(key as String, value as Uint8List)),
+        manufacturerData:
+            (map['manufacturerData'] as Map<dynamic, dynamic>? ?? const {})
+                .map((key, value) => MapEntry(key as int, value as Uint8List)),
+        manufacturerSpecificData: map['manufacturerSpecificData'] as Uint8List,
+        txPowerLevel: map['txPowerLevel'] as int?,
+        appearance: map['appearance'] as int?,
+        advertiseFlags: map['advertiseFlags'] as int?,
+      );
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2024. Julian Steenbakker.
+ * All rights reserved. Use of this source code is governed by a
+ * BSD-style license that can be found in the LICENSE file.
+ */
+
+import 'package:flutter_ble_peripheral/src/models/enums/scan_mode.dart';
+
+/// What a scan started with `FlutterBlePeripheral.startScan` achieved.
+class ScanSessionStats {
+  final ScanMode mode;
+  final Duration interval;
+  final Duration window;
+
+  /// Whether the scan is still running.
+  final bool active;
+
+  /// Time since the scan started, up to when it stopped.
+  final Duration elapsed;
+
+  /// Time the radio was actually scanning.
+  final Duration scanning;
+
+  /// Scan windows opened, and windows the system refused to start.
+  final int windows;
+  final int refusedWindows;
+
+  final int advertisements;
+
+  /// [scanning] over [elapsed], the duty cycle actually achieved.
+  final double dutyCycle;
+
+  final double advertisementsPerSecond;
+
+  const ScanSessionStats({
+    required this.mode,
+    required this.interval,
+    required this.window,
+    required this.active,
+    required this.elapsed,
+    required this.scanning,
+    required this.windows,
+    required this.refusedWindows,
+    required this.advertisements,
+    required this.dutyCycle,
+    required this.advertisementsPerSecond,
+  });
+
+  factory ScanSessionStats.fromMap(Map<dynamic, dynamic> map) =>
+      ScanSessionStats(
+        mode: ScanMode.values[map['scanMode'] as int],
+        interval: Duration(microseconds: map['intervalMicros'] as int),
+        window: Duration(microseconds: map['windowMicros'] as int),
+        active: map['active'] as bool,
+        elapsed: Duration(microseconds: map['elapsedMicros'] as int),
+        scanning: Duration(microseconds: map['scanningMicros'] as int),
+        windows: map['windows'] as int,
+        refusedWindows: map['refusedWindows'] as int,
+        advertisements: map['advertisements'] as int,
+        dutyCycle: map['dutyCycle'] as double,
+        advertisementsPerSecond: map['advertisementsPerSecond'] as double,
+      );
+}
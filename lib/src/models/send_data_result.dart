@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2024. Julian Steenbakker.
+ * All rights reserved. Use of this source code is governed by a
+ * BSD-style license that can be found in the LICENSE file.
+ */
+
+/// Outcome of `FlutterBlePeripheral.sendData` on Windows.
+class SendDataResult {
+  /// Payload size in bytes.
+  final int bytes;
+
+  /// Subscribed clients the payload was streamed to.
+  final int clients;
+
+  /// Whether streaming to any of them failed.
+  final bool failed;
+
+  /// Time until the last client's stream finished, in microseconds.
+  final int durationMicros;
+
+  /// Bytes sent to all clients together over [durationMicros].
+  final double bytesPerSecond;
+
+  const SendDataResult({
+    required this.bytes,
+    required this.clients,
+    required this.failed,
+    required this.durationMicros,
+    required this.bytesPerSecond,
+  });
+
+  factory SendDataResult.fromMap(Map<dynamic, dynamic> map) => SendDataResult(
+        bytes: map['bytes'] as int,
+        clients: map['clients'] as int,
+        failed: map['failed'] as bool,
+        durationMicros: map['durationMicros'] as int,
+        bytesPerSecond: (map['bytesPerSecond'] as num).toDouble(),
+      );
+}
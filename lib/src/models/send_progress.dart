@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2024. Julian Steenbakker.
+ * All rights reserved. Use of this source code is governed by a
+ * BSD-style license that can be found in the LICENSE file.
+ */
+
+/// Progress of streaming one `sendData` payload to one client, see
+/// `FlutterBlePeripheral.onSendProgress`.
+class SendProgress {
+  /// Identifies the stream; one `sendData` call starts one per client.
+  final int stream;
+
+  /// Payload size in bytes.
+  final int totalBytes;
+
+  /// Bytes the stack reported sent so far.
+  final int sentBytes;
+
+  /// Notifications sent so far.
+  final int chunks;
+
+  /// Time since the stream started, in microseconds.
+  final int elapsedMicros;
+
+  /// [sentBytes] over the elapsed time.
+  final double bytesPerSecond;
+
+  /// Whether this is the stream's last report.
+  final bool done;
+
+  /// Whether the client unsubscribed, disconnected or a notification failed.
+  final bool failed;
+
+  const SendProgress({
+    required this.stream,
+    required this.totalBytes,
+    required this.sentBytes,
+    required this.chunks,
+    required this.elapsedMicros,
+    required this.bytesPerSecond,
+    required this.done,
+    required this.failed,
+  });
+
+  factory SendProgress.fromMap(Map<dynamic, dynamic> map) => SendProgress(
+        stream: map['stream'] as int,
+        totalBytes: map['totalBytes'] as int,
+        sentBytes: map['sentBytes'] as int,
+        chunks: map['chunks'] as int,
+        elapsedMicros: map['elapsedMicros'] as int,
+        bytesPerSecond: (map['bytesPerSecond'] as num).toDouble(),
+        done: map['done'] as bool,
+        failed: map['failed'] as bool,
+      );
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2024. Julian Steenbakker.
+ * All rights reserved. Use of this source code is governed by a
+ * BSD-style license that can be found in the LICENSE file.
+ */
+
+/// How long the native plugin took to reach each startup milestone, measured
+/// from its construction. Milestones not reached yet are null.
+class StartupTimings {
+  /// The default Bluetooth adapter was fetched.
+  final Duration? adapter;
+
+  /// The adapter's radio was fetched.
+  final Duration? radio;
+
+  /// Initialization finished and deferred method calls were replayed.
+  final Duration? initialized;
+
+  /// The publisher first reported that it started advertising.
+  final Duration? firstAdvertisement;
+
+  /// Method calls that arrived before initialization finished.
+  final int deferredCalls;
+
+  /// Why initialization failed, if it did.
+  final String? error;
+
+  const StartupTimings({
+    this.adapter,
+    this.radio,
+    this.initialized,
+    this.firstAdvertisement,
+    required this.deferredCalls,
+    this.error,
+  });
+
+  factory StartupTimings.fromMap(Map<dynamic, dynamic> map) {
+    Duration? micros(String key) {
+      final value = map[key] as int?;
+      return value == null ? null : Duration(microseconds: value);
+    }
+
+    return StartupTimings(
+      adapter: micros('adapterMicros'),
+      radio: micros('radioMicros'),
+      initialized: micros('initializedMicros'),
+      firstAdvertisement: micros('firstAdvertisementMicros'),
+      deferredCalls: map['deferredCalls'] as int,
+      error: map['error'] as String?,
+    );
+  }
+}
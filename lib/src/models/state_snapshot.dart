@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2024. Julian Steenbakker.
+ * All rights reserved. Use of this source code is governed by a
+ * BSD-style license that can be found in the LICENSE file.
+ */
+
+import 'package:flutter_ble_peripheral/src/models/enums/radio_state.dart';
+
+/// The native side's cached view of the adapter, radio and publisher, see
+/// `FlutterBlePeripheral.getStateSnapshot`.
+class StateSnapshot {
+  final RadioState radioState;
+
+  /// Raw value of the WinRT BluetoothLEAdvertisementPublisherStatus.
+  final int publisherStatus;
+
+  final bool isSupported;
+  final bool isAdvertising;
+  final bool isConnected;
+
+  /// Time since any of the fields above last changed.
+  final Duration age;
+
+  const StateSnapshot({
+    required this.radioState,
+    required this.publisherStatus,
+    required this.isSupported,
+    required this.isAdvertising,
+    required this.isConnected,
+    required this.age,
+  });
+
+  factory StateSnapshot.fromMap(Map<dynamic, dynamic> map) {
+    final radioState = map['radioState'] as int;
+    return StateSnapshot(
+      radioState: radioState < RadioState.values.length
+          ? RadioState.values[radioState]
+          : RadioState.unknown,
+      publisherStatus: map['publisherStatus'] as int,
+      isSupported: map['isSupported'] as bool,
+      isAdvertising: map['isAdvertising'] as bool,
+      isConnected: map['isConnected'] as bool,
+      age: Duration(microseconds: map['ageMicros'] as int),
+    );
+  }
+}
@@ -0,0 +1,72 @@
+import 'dart:typed_data';
+
+import 'package:flutter_ble_peripheral/src/models/scan_record.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+void main() {
+  ByteData message(List<List<int>> records) {
+    final builder = BytesBuilder()
+      ..add([ScanRecord.formatVersion, 0, records.length, 0]);
+    records.forEach(builder.add);
+    return ByteData.sublistView(builder.toBytes());
+  }
+
+  List<int> record({
+    required List<int> address,
+    required int rssi,
+    required int flags,
+    required int timestamp,
+    List<int> advertisementData = const [],
+  }) {
+    final header = ByteData(18)
+      ..setUint16(0, 16 + advertisementData.length, Endian.little)
+      ..setInt8(8, rssi)
+      ..setUint8(9, flags)
+      ..setUint64(10, timestamp, Endian.little);
+    for (var i = 0; i < 6; i++) {
+      header.setUint8(2 + i, address[i]);
+    }
+    return [...header.buffer.asUint8List(), ...advertisementData];
+  }
+
+  test('decodes packed scan records', () {
+    final records = ScanRecord.decode(
+      message([
+        record(
+          address: [0xF6, 0xE5, 0xD4, 0xC3, 0xB2, 0xA1],
+          rssi: -67,
+          flags: 1,
+          timestamp: 1700000000123456,
+          advertisementData: [0x02, 0x01, 0x06],
+        ),
+        record(address: [1, 0, 0, 0, 0, 0], rssi: -90, flags: 8, timestamp: 0),
+      ]),
+    );
+
+    expect(records, hasLength(2));
+    expect(records[0].address, 0xA1B2C3D4E5F6);
+    expect(records[0].rssi, -67);
+    expect(records[0].isConnectable, isTrue);
+    expect(
+      records[0].timestamp,
+      DateTime.fromMicrosecondsSinceEpoch(1700000000123456),
+    );
+    expect(records[0].advertisementData, [0x02, 0x01, 0x06]);
+    expect(records[1].address, 1);
+    expect(records[1].isScanResponse, isTrue);
+    expect(records[1].advertisementData, isEmpty);
+  });
+
+  test('ignores unknown versions and truncated records', () {
+    final bytes = message([
+      record(address: [1, 0, 0, 0, 0, 0], rssi: -50, flags: 0, timestamp: 0),
+    ]);
+    expect(
+      ScanRecord.decode(ByteData.sublistView(bytes, 0, bytes.lengthInBytes - 1)),
+      isEmpty,
+    );
+
+    bytes.setUint8(0, ScanRecord.formatVersion + 1);
+    expect(ScanRecord.decode(bytes), isEmpty);
+  });
+}
@@ -0,0 +1,175 @@
+#include "ad_encoder.h"
+
+namespace flutter_ble_peripheral {
+
+    namespace {
+
+        // Bytes 4..15 of the Bluetooth base UUID
+        // 00000000-0000-1000-8000-00805F9B34FB, big-endian.
+        constexpr uint8_t kBaseUuidTail[12] = {
+            0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0x80, 0x5F, 0x9B, 0x34, 0xFB,
+        };
+
+        int HexValue(char c) {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        }
+
+        // Parses |text| as big-endian hex, skipping dashes, into |out|.
+        bool ParseHex(std::string_view text, uint8_t* out, size_t size) {
+            size_t nibbles = 0;
+            for (char c : text) {
+                if (c == '-') continue;
+                const int value = HexValue(c);
+                if (value < 0 || nibbles == size * 2) return false;
+                uint8_t& byte = out[nibbles / 2];
+                byte = static_cast<uint8_t>(nibbles % 2 == 0 ? value << 4 : byte | value);
+                ++nibbles;
+            }
+            return nibbles == size * 2;
+        }
+
+        BluetoothUuid FromBigEndian(const uint8_t* bytes, uint8_t size) {
+            BluetoothUuid uuid;
+            uuid.size = size;
+            for (uint8_t i = 0; i < size; ++i) uuid.bytes[i] = bytes[size - 1 - i];
+            return uuid;
+        }
+
+        AdField UuidField(uint8_t type16, uint8_t type32, uint8_t type128, const BluetoothUuid& uuid) {
+            AdField field;
+            field.type = uuid.size == 2 ? type16 : uuid.size == 4 ? type32 : type128;
+            field.header = uuid.bytes;
+            field.headerSize = uuid.size;
+            return field;
+        }
+
+    }  // namespace
+
+    std::optional<BluetoothUuid> ParseBluetoothUuid(std::string_view text) {
+        uint8_t bytes[16] = {};
+        if (text.size() == 4 || text.size() == 8) {
+            const uint8_t size = static_cast<uint8_t>(text.size() / 2);
+            if (!ParseHex(text, bytes, size)) return std::nullopt;
+            return ShortenBluetoothUuid(FromBigEndian(bytes, size));
+        }
+        if (text.size() != 36 || text[8] != '-' || text[13] != '-' || text[18] != '-' || text[23] != '-') {
+            return std::nullopt;
+        }
+        if (!ParseHex(text, bytes, 16)) return std::nullopt;
+        return ShortenBluetoothUuid(FromBigEndian(bytes, 16));
+    }
+
+    BluetoothUuid ShortenBluetoothUuid(const BluetoothUuid& uuid) {
+        BluetoothUuid shortest = uuid;
+        if (shortest.size == 16) {
+            // Little-endian, so the base UUID's tail comes first, reversed.
+            for (size_t i = 0; i < 12; ++i) {
+                if (uuid.bytes[i] != kBaseUuidTail[11 - i]) return shortest;
+            }
+            shortest.bytes = {};
+            for (size_t i = 0; i < 4; ++i) shortest.bytes[i] = uuid.bytes[12 + i];
+            shortest.size = 4;
+        }
+        if (shortest.size == 4 && shortest.bytes[2] == 0 && shortest.bytes[3] == 0) shortest.size = 2;
+        return shortest;
+    }
+
+    std::string FormatBluetoothUuid(const BluetoothUuid& uuid) {
+        static constexpr char kHexDigits[] = "0123456789abcdef";
+        uint8_t bytes[16] = {};
+        if (uuid.size == 16) {
+            for (size_t i = 0; i < 16; ++i) bytes[i] = uuid.bytes[15 - i];
+        }
+        else {
+            for (size_t i = 0; i < uuid.size; ++i) bytes[3 - i] = uuid.bytes[i];
+            for (size_t i = 0; i < 12; ++i) bytes[4 + i] = kBaseUuidTail[i];
+        }
+        std::string text;
+        text.reserve(36);
+        for (size_t i = 0; i < 16; ++i) {
+            if (i == 4 || i == 6 || i == 8 || i == 10) text.push_back('-');
+            text.push_back(kHexDigits[bytes[i] >> 4]);
+            text.push_back(kHexDigits[bytes[i] & 0xF]);
+        }
+        return text;
+    }
+
+    bool EncodeAdvertiseData(const AdvertiseData& data, AdvertisePayload& payload, bool include_flags) {
+        if (include_flags) {
+            AdField flags;
+            flags.type = kAdFlags;
+            flags.header[0] = kAdFlagsGeneralDiscoverable;
+            flags.headerSize = 1;
+            flags.advertisementOnly = true;
+            payload.Add(flags);
+        }
+        if (data.serviceUuid) {
+            auto uuid = ParseBluetoothUuid(*data.serviceUuid);
+            if (!uuid) return false;
+            payload.Add(UuidField(kAdCompleteUuid16List, kAdCompleteUuid32List, kAdCompleteUuid128List, *uuid));
+        }
+        if (data.serviceDataUuid || !data.serviceData.empty()) {
+            auto uuid = ParseBluetoothUuid(data.serviceDataUuid.value_or(""));
+            if (!uuid) return false;
+            AdField field = UuidField(kAdServiceData16, kAdServiceData32, kAdServiceData128, *uuid);
+            field.body = data.serviceData;
+            payload.Add(field);
+        }
+        if (data.manufacturerId || !data.manufacturerData.empty()) {
+            AdField field;
+            field.type = kAdManufacturerSpecificData;
+            const uint16_t company = data.manufacturerId.value_or(0);
+            field.header[0] = static_cast<uint8_t>(company & 0xFF);
+            field.header[1] = static_cast<uint8_t>(company >> 8);
+            field.headerSize = 2;
+            field.body = data.manufacturerData;
+            payload.Add(field);
+        }
+        if (data.serviceSolicitationUuid) {
+            auto uuid = ParseBluetoothUuid(*data.serviceSolicitationUuid);
+            if (!uuid) return false;
+            payload.Add(UuidField(kAdSolicitationUuid16List, kAdSolicitationUuid32List,
+                                  kAdSolicitationUuid128List, *uuid));
+        }
+        if (data.includePowerLevel) {
+            // The controller fills in the real level; only the size matters
+            // here.
+            AdField field;
+            field.type = kAdTxPowerLevel;
+            field.headerSize = 1;
+            payload.Add(field);
+        }
+        if (data.localName && !data.localName->empty()) {
+            AdField field;
+            field.type = kAdCompleteLocalName;
+            field.body = ByteView(reinterpret_cast<const uint8_t*>(data.localName->data()), data.localName->size());
+            field.shortenable = true;
+            payload.Add(field);
+        }
+        return payload.Layout();
+    }
+
+    const char* AdTypeName(uint8_t type) {
+        switch (type) {
+        case kAdFlags: return "flags";
+        case kAdCompleteUuid16List:
+        case kAdCompleteUuid32List:
+        case kAdCompleteUuid128List: return "serviceUuid";
+        case kAdShortenedLocalName:
+        case kAdCompleteLocalName: return "localName";
+        case kAdTxPowerLevel: return "includePowerLevel";
+        case kAdSolicitationUuid16List:
+        case kAdSolicitationUuid32List:
+        case kAdSolicitationUuid128List: return "serviceSolicitationUuid";
+        case kAdServiceData16:
+        case kAdServiceData32:
+        case kAdServiceData128: return "serviceData";
+        case kAdManufacturerSpecificData: return "manufacturerData";
+        default: return "unknown";
+        }
+    }
+
+}  // namespace flutter_ble_peripheral
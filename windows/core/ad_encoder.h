@@ -0,0 +1,219 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_AD_ENCODER_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_AD_ENCODER_H_
+
+#include "advertise_data.h"
+#include "byte_buffer.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace flutter_ble_peripheral {
+
+    // AD types from the Bluetooth Assigned Numbers, "Common Data Types".
+    enum AdType : uint8_t {
+        kAdFlags = 0x01,
+        kAdIncompleteUuid16List = 0x02,
+        kAdCompleteUuid16List = 0x03,
+        kAdIncompleteUuid32List = 0x04,
+        kAdCompleteUuid32List = 0x05,
+        kAdIncompleteUuid128List = 0x06,
+        kAdCompleteUuid128List = 0x07,
+        kAdShortenedLocalName = 0x08,
+        kAdCompleteLocalName = 0x09,
+        kAdTxPowerLevel = 0x0A,
+        kAdSolicitationUuid16List = 0x14,
+        kAdSolicitationUuid128List = 0x15,
+        kAdServiceData16 = 0x16,
+        kAdAppearance = 0x19,
+        kAdSolicitationUuid32List = 0x1F,
+        kAdServiceData32 = 0x20,
+        kAdServiceData128 = 0x21,
+        kAdManufacturerSpecificData = 0xFF,
+    };
+
+    // Payload limits of one advertisement or scan response.
+    constexpr size_t kLegacyAdvertisingDataSize = 31;
+    constexpr size_t kExtendedAdvertisingDataSize = 254;
+
+    // LE General Discoverable, BR/EDR not supported.
+    constexpr uint8_t kAdFlagsGeneralDiscoverable = 0x06;
+
+    // A service UUID in its shortest over-the-air form: 2, 4 or 16 bytes,
+    // little-endian.
+    struct BluetoothUuid {
+        std::array<uint8_t, 16> bytes{};
+        uint8_t size = 0;
+    };
+
+    inline bool operator==(const BluetoothUuid& lhs, const BluetoothUuid& rhs) {
+        return lhs.size == rhs.size && lhs.bytes == rhs.bytes;
+    }
+
+    inline bool operator!=(const BluetoothUuid& lhs, const BluetoothUuid& rhs) { return !(lhs == rhs); }
+
+    // Parses "180D", "0000180D" or the full 36-character form. UUIDs on the
+    // Bluetooth base UUID shrink to 16 or 32 bits, whichever form they were
+    // written in.
+    std::optional<BluetoothUuid> ParseBluetoothUuid(std::string_view text);
+
+    // |uuid| in its shortest form: a 128-bit UUID on the Bluetooth base UUID
+    // becomes 32-bit, and a 32-bit one whose top half is zero 16-bit.
+    BluetoothUuid ShortenBluetoothUuid(const BluetoothUuid& uuid);
+
+    // The full 36-character lowercase form, the way Android prints UUIDs.
+    std::string FormatBluetoothUuid(const BluetoothUuid& uuid);
+
+    // One AD structure: a short inline header (company id or service UUID)
+    // followed by borrowed body bytes. The body must outlive the payload.
+    struct AdField {
+        uint8_t type = 0;
+        std::array<uint8_t, 16> header{};
+        uint8_t headerSize = 0;
+        ByteView body;
+        // A complete local name may be cut down to a shortened local name.
+        bool shortenable = false;
+        // Flags must stay in the advertisement proper.
+        bool advertisementOnly = false;
+
+        constexpr size_t EncodedSize() const { return 2 + headerSize + body.size(); }
+    };
+
+    enum class AdPlacement : uint8_t {
+        kAdvertisement,
+        kScanResponse,
+    };
+
+    // Fixed-capacity builder for an advertisement and its scan response.
+    //
+    // Add fields in priority order, then Layout places each one in the
+    // advertisement if it fits, else in the scan response, else shortens it
+    // if it is a name; it fails on the first field that fits nowhere.
+    // Nothing allocates and everything is constexpr, so a fixed payload can
+    // be sized and checked at compile time.
+    template <size_t MaxFields>
+    class AdPayload {
+    public:
+        constexpr explicit AdPayload(size_t budget = kLegacyAdvertisingDataSize,
+                                     bool allow_scan_response = true)
+            : budget_(budget), allow_scan_response_(allow_scan_response) {}
+
+        // Returns false when all MaxFields slots are taken.
+        constexpr bool Add(const AdField& field) {
+            if (count_ == MaxFields) return false;
+            fields_[count_++] = field;
+            laid_out_ = false;
+            return true;
+        }
+
+        constexpr bool Layout() {
+            advertisement_size_ = 0;
+            scan_response_size_ = 0;
+            failed_field_ = MaxFields;
+            for (size_t i = 0; i < count_;) {
+                AdField& field = fields_[i];
+                const size_t size = field.EncodedSize();
+                const bool scan_response = allow_scan_response_ && !field.advertisementOnly;
+                if (advertisement_size_ + size <= budget_) {
+                    placements_[i++] = AdPlacement::kAdvertisement;
+                    advertisement_size_ += size;
+                }
+                else if (scan_response && scan_response_size_ + size <= budget_) {
+                    placements_[i++] = AdPlacement::kScanResponse;
+                    scan_response_size_ += size;
+                }
+                else if (!field.shortenable || !Shorten(field, scan_response)) {
+                    failed_field_ = i;
+                    return false;
+                }
+                // A shortened name goes round again and now fits.
+            }
+            laid_out_ = true;
+            return true;
+        }
+
+        // Writes the laid-out advertisement or scan response to |out| and
+        // returns the number of bytes written, or 0 if Layout has not
+        // succeeded or |capacity| is too small.
+        constexpr size_t WriteAdvertisement(uint8_t* out, size_t capacity) const {
+            return Write(AdPlacement::kAdvertisement, advertisement_size_, out, capacity);
+        }
+        constexpr size_t WriteScanResponse(uint8_t* out, size_t capacity) const {
+            return Write(AdPlacement::kScanResponse, scan_response_size_, out, capacity);
+        }
+
+        constexpr size_t size() const { return count_; }
+        constexpr const AdField& field(size_t index) const { return fields_[index]; }
+        constexpr AdPlacement placement(size_t index) const { return placements_[index]; }
+        constexpr size_t advertisement_size() const { return advertisement_size_; }
+        constexpr size_t scan_response_size() const { return scan_response_size_; }
+        constexpr size_t budget() const { return budget_; }
+        // Index of the field that made Layout fail.
+        constexpr std::optional<size_t> failed_field() const {
+            return failed_field_ < count_ ? std::optional<size_t>(failed_field_) : std::nullopt;
+        }
+
+    private:
+        // Cuts a name to the larger of the free spaces, without splitting a
+        // UTF-8 sequence, and retypes it as a shortened local name.
+        constexpr bool Shorten(AdField& field, bool scan_response) const {
+            size_t space = budget_ - advertisement_size_;
+            if (scan_response && budget_ - scan_response_size_ > space) {
+                space = budget_ - scan_response_size_;
+            }
+            if (space < 2u + field.headerSize + 1u) return false;
+            size_t length = space - 2 - field.headerSize;
+            while (length > 0 && (field.body[length] & 0xC0) == 0x80) --length;
+            if (length == 0) return false;
+            field.body = field.body.subview(0, length);
+            field.type = kAdShortenedLocalName;
+            field.shortenable = false;
+            return true;
+        }
+
+        constexpr size_t Write(AdPlacement placement, size_t total, uint8_t* out, size_t capacity) const {
+            if (!laid_out_ || total > capacity) return 0;
+            size_t offset = 0;
+            for (size_t i = 0; i < count_; ++i) {
+                if (placements_[i] != placement) continue;
+                const AdField& field = fields_[i];
+                out[offset++] = static_cast<uint8_t>(field.EncodedSize() - 1);
+                out[offset++] = field.type;
+                for (size_t j = 0; j < field.headerSize; ++j) out[offset++] = field.header[j];
+                for (size_t j = 0; j < field.body.size(); ++j) out[offset++] = field.body[j];
+            }
+            return offset;
+        }
+
+        std::array<AdField, MaxFields> fields_{};
+        std::array<AdPlacement, MaxFields> placements_{};
+        size_t count_ = 0;
+        size_t budget_;
+        bool allow_scan_response_;
+        bool laid_out_ = false;
+        size_t advertisement_size_ = 0;
+        size_t scan_response_size_ = 0;
+        size_t failed_field_ = MaxFields;
+    };
+
+    // Flags, service UUID, service data, manufacturer data, solicitation
+    // UUID, TX power and local name.
+    constexpr size_t kMaxAdvertiseDataFields = 7;
+    using AdvertisePayload = AdPayload<kMaxAdvertiseDataFields>;
+
+    // Adds the fields of |data| to |payload| in the order above and lays it
+    // out. |data| must outlive |payload|. Returns false if a UUID does not
+    // parse or the fields do not fit; |payload|.failed_field() then names
+    // the culprit unless the UUID was at fault.
+    bool EncodeAdvertiseData(const AdvertiseData& data, AdvertisePayload& payload,
+                             bool include_flags = true);
+
+    // Human-readable name of an AD type, for error messages.
+    const char* AdTypeName(uint8_t type);
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_AD_ENCODER_H_
@@ -0,0 +1,123 @@
+#include "ad_parser.h"
+
+namespace flutter_ble_peripheral {
+
+    namespace {
+
+        uint16_t ReadUint16(const uint8_t* bytes) {
+            return static_cast<uint16_t>(bytes[0] | bytes[1] << 8);
+        }
+
+        BluetoothUuid ReadUuid(const uint8_t* bytes, uint8_t size) {
+            BluetoothUuid uuid;
+            uuid.size = size;
+            for (uint8_t i = 0; i < size; ++i) uuid.bytes[i] = bytes[i];
+            return uuid;
+        }
+
+        void ParseUuidList(ByteView body, uint8_t size, AdvertisementFields& fields) {
+            for (size_t offset = 0; offset + size <= body.size(); offset += size) {
+                if (!fields.serviceUuids.push_back(ReadUuid(body.data() + offset, size))) {
+                    fields.truncated = true;
+                    return;
+                }
+            }
+        }
+
+        void ParseServiceData(ByteView body, uint8_t size, AdvertisementFields& fields) {
+            if (body.size() < size) return;
+            if (!fields.serviceData.push_back({ ReadUuid(body.data(), size), body.subview(size) })) {
+                fields.truncated = true;
+            }
+        }
+
+    }  // namespace
+
+    void ParseAdvertisement(ByteView data, AdvertisementFields& fields) {
+        fields.flags.reset();
+        fields.txPowerLevel.reset();
+        fields.appearance.reset();
+        fields.localName = ByteView();
+        fields.completeLocalName = false;
+        fields.serviceUuids.clear();
+        fields.serviceData.clear();
+        fields.manufacturerData.clear();
+        fields.truncated = false;
+        fields.malformed = false;
+
+        size_t offset = 0;
+        const size_t size = data.size();
+        while (offset < size) {
+            const size_t length = data[offset];
+            // A zero length pads out the rest of the data.
+            if (length == 0) break;
+            if (offset + 1 + length > size) {
+                fields.malformed = true;
+                break;
+            }
+            const uint8_t type = data[offset + 1];
+            const ByteView body = data.subview(offset + 2, length - 1);
+            offset += 1 + length;
+
+            switch (type) {
+            case kAdFlags:
+                if (!body.empty() && !fields.flags) fields.flags = body[0];
+                break;
+            case kAdIncompleteUuid16List:
+            case kAdCompleteUuid16List:
+                ParseUuidList(body, 2, fields);
+                break;
+            case kAdIncompleteUuid32List:
+            case kAdCompleteUuid32List:
+                ParseUuidList(body, 4, fields);
+                break;
+            case kAdIncompleteUuid128List:
+            case kAdCompleteUuid128List:
+                ParseUuidList(body, 16, fields);
+                break;
+            case kAdShortenedLocalName:
+                if (fields.localName.empty()) fields.localName = body;
+                break;
+            case kAdCompleteLocalName:
+                if (!fields.completeLocalName) {
+                    fields.localName = body;
+                    fields.completeLocalName = true;
+                }
+                break;
+            case kAdTxPowerLevel:
+                if (!body.empty() && !fields.txPowerLevel) fields.txPowerLevel = static_cast<int8_t>(body[0]);
+                break;
+            case kAdAppearance:
+                if (body.size() >= 2 && !fields.appearance) fields.appearance = ReadUint16(body.data());
+                break;
+            case kAdServiceData16:
+                ParseServiceData(body, 2, fields);
+                break;
+            case kAdServiceData32:
+                ParseServiceData(body, 4, fields);
+                break;
+            case kAdServiceData128:
+                ParseServiceData(body, 16, fields);
+                break;
+            case kAdManufacturerSpecificData:
+                if (body.size() < 2) break;
+                if (!fields.manufacturerData.push_back({ ReadUint16(body.data()), body.subview(2) })) {
+                    fields.truncated = true;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    void AdvertisementFields::Rebase(const uint8_t* from, const uint8_t* to) {
+        const auto rebase = [from, to](ByteView& view) {
+            if (!view.empty()) view = ByteView(to + (view.data() - from), view.size());
+        };
+        rebase(localName);
+        for (auto& record : serviceData) rebase(record.data);
+        for (auto& record : manufacturerData) rebase(record.data);
+    }
+
+}  // namespace flutter_ble_peripheral
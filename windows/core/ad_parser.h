@@ -0,0 +1,104 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_AD_PARSER_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_AD_PARSER_H_
+
+#include "ad_encoder.h"
+#include "byte_buffer.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <type_traits>
+
+namespace flutter_ble_peripheral {
+
+    // Up to N values stored inline. The storage is left uninitialized until
+    // a value is pushed, so a FixedList costs nothing to construct however
+    // large N is.
+    template <typename T, size_t N>
+    class FixedList {
+        static_assert(std::is_trivially_destructible_v<T>, "FixedList never runs destructors");
+
+    public:
+        static constexpr size_t kCapacity = N;
+
+        FixedList() {}
+        // Copies only the values pushed so far.
+        FixedList(const FixedList& other) { *this = other; }
+        FixedList& operator=(const FixedList& other) {
+            for (size_t i = 0; i < other.size_; ++i) new (&items_[i]) T(other[i]);
+            size_ = other.size_;
+            return *this;
+        }
+
+        // Returns false, dropping |value|, when the list is full.
+        bool push_back(const T& value) {
+            if (size_ == N) return false;
+            new (&items_[size_++]) T(value);
+            return true;
+        }
+
+        void clear() { size_ = 0; }
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+        const T& operator[](size_t index) const { return begin()[index]; }
+        const T& back() const { return begin()[size_ - 1]; }
+        const T* begin() const { return std::launder(reinterpret_cast<const T*>(items_)); }
+        const T* end() const { return begin() + size_; }
+        T* begin() { return std::launder(reinterpret_cast<T*>(items_)); }
+        T* end() { return begin() + size_; }
+
+    private:
+        struct alignas(T) Storage {
+            unsigned char bytes[sizeof(T)];
+        };
+
+        Storage items_[N];
+        size_t size_ = 0;
+    };
+
+    struct ManufacturerRecord {
+        uint16_t companyId = 0;
+        ByteView data;
+    };
+
+    struct ServiceDataRecord {
+        BluetoothUuid uuid;
+        ByteView data;
+    };
+
+    // Every AD structure of an advertisement that the plugin reports. Byte
+    // fields borrow from the parsed data. The lists have fixed capacities
+    // well above what a 255-byte advertisement carries in practice; entries
+    // past them are dropped and |truncated| is set.
+    struct AdvertisementFields {
+        std::optional<uint8_t> flags;
+        std::optional<int8_t> txPowerLevel;
+        std::optional<uint16_t> appearance;
+        ByteView localName;
+        bool completeLocalName = false;
+        // Complete and incomplete lists of every width, in advertised order.
+        FixedList<BluetoothUuid, 16> serviceUuids;
+        FixedList<ServiceDataRecord, 8> serviceData;
+        FixedList<ManufacturerRecord, 8> manufacturerData;
+        bool truncated = false;
+        // A structure ran past the end of the data; parsing stopped there.
+        bool malformed = false;
+
+        // Points every byte field at the same offset in |to| as it had in
+        // |from|, for fields copied along with the data they were parsed
+        // from.
+        void Rebase(const uint8_t* from, const uint8_t* to);
+    };
+
+    // Parses |data|, a run of AD structures (length, type, data), in one
+    // pass, replacing everything in |fields|. Never allocates. A complete
+    // local name wins over a shortened one; for flags, TX power and
+    // appearance the first structure wins. Unknown types and structures too
+    // short for their type are skipped.
+    void ParseAdvertisement(ByteView data, AdvertisementFields& fields);
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_AD_PARSER_H_
@@ -0,0 +1,62 @@
+#include "address_table.h"
+
+#include <algorithm>
+
+namespace flutter_ble_peripheral {
+
+    AddressTable::AddressTable(size_t capacity) {
+        size_t slot_count = 1;
+        while (slot_count < std::max<size_t>(capacity, 1) * 2) slot_count <<= 1;
+        slots_.resize(slot_count);
+        slot_mask_ = slot_count - 1;
+    }
+
+    uint32_t AddressTable::Find(uint64_t address) const {
+        return slots_[FindSlot(address)].index;
+    }
+
+    void AddressTable::Insert(uint64_t address, uint32_t index) {
+        slots_[FindSlot(address)] = { address, index };
+    }
+
+    uint32_t AddressTable::Erase(uint64_t address) {
+        size_t hole = FindSlot(address);
+        const uint32_t index = slots_[hole].index;
+        if (index == kNone) return kNone;
+
+        slots_[hole] = Slot();
+        size_t slot = (hole + 1) & slot_mask_;
+        while (slots_[slot].index != kNone) {
+            const size_t home = Home(slots_[slot].address);
+            // Move the entry into the hole unless its home lies cyclically
+            // within (hole, slot].
+            const bool stays = hole <= slot ? (hole < home && home <= slot)
+                                            : (hole < home || home <= slot);
+            if (!stays) {
+                slots_[hole] = slots_[slot];
+                slots_[slot] = Slot();
+                hole = slot;
+            }
+            slot = (slot + 1) & slot_mask_;
+        }
+        return index;
+    }
+
+    void AddressTable::Clear() {
+        std::fill(slots_.begin(), slots_.end(), Slot());
+    }
+
+    size_t AddressTable::Home(uint64_t address) const {
+        // Fibonacci hashing spreads sequential addresses across the table.
+        return static_cast<size_t>((address * 0x9E3779B97F4A7C15ull) >> 32) & slot_mask_;
+    }
+
+    size_t AddressTable::FindSlot(uint64_t address) const {
+        size_t slot = Home(address);
+        while (slots_[slot].index != kNone && slots_[slot].address != address) {
+            slot = (slot + 1) & slot_mask_;
+        }
+        return slot;
+    }
+
+}  // namespace flutter_ble_peripheral
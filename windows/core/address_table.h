@@ -0,0 +1,51 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_ADDRESS_TABLE_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_ADDRESS_TABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+
+    // Maps 48-bit Bluetooth addresses to indices into a caller-owned pool.
+    //
+    // Open addressing with linear probing, kept at most half full so probe
+    // sequences stay short, and backward-shift deletion so no tombstones
+    // build up. Never allocates after construction.
+    //
+    // Not thread-safe.
+    class AddressTable {
+    public:
+        static constexpr uint32_t kNone = UINT32_MAX;
+
+        // Sized for up to |capacity| addresses.
+        explicit AddressTable(size_t capacity);
+
+        // The index stored for |address|, or kNone.
+        uint32_t Find(uint64_t address) const;
+
+        // |address| must not be in the table, and the table must hold fewer
+        // than |capacity| addresses.
+        void Insert(uint64_t address, uint32_t index);
+
+        // Removes |address|. Returns the index it mapped to, or kNone.
+        uint32_t Erase(uint64_t address);
+
+        void Clear();
+
+    private:
+        struct Slot {
+            uint64_t address = 0;
+            uint32_t index = kNone;
+        };
+
+        size_t Home(uint64_t address) const;
+        size_t FindSlot(uint64_t address) const;
+
+        std::vector<Slot> slots_;
+        size_t slot_mask_ = 0;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_ADDRESS_TABLE_H_
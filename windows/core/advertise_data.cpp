@@ -0,0 +1,35 @@
+#include "advertise_data.h"
+
+namespace flutter_ble_peripheral {
+
+    uint32_t DiffAdvertiseData(const AdvertiseData& current, const AdvertiseData& next) {
+        uint32_t changed = 0;
+        if (current.manufacturerId != next.manufacturerId) changed |= kManufacturerId;
+        // The same bytes of shared storage compare equal without touching
+        // them; a slice starts where its parent does but is shorter.
+        const auto& current_data = current.manufacturerData;
+        const auto& next_data = next.manufacturerData;
+        const bool same_bytes = current_data.data() == next_data.data() && current_data.size() == next_data.size();
+        if (!same_bytes && current_data.view() != next_data.view()) changed |= kManufacturerData;
+        if (current.serviceUuid != next.serviceUuid) changed |= kServiceUuid;
+        if (current.serviceDataUuid != next.serviceDataUuid ||
+            current.serviceData.view() != next.serviceData.view()) {
+            changed |= kServiceData;
+        }
+        if (current.serviceSolicitationUuid != next.serviceSolicitationUuid) changed |= kServiceSolicitationUuid;
+        if (current.localName != next.localName) changed |= kLocalName;
+        if (current.includeDeviceName != next.includeDeviceName) changed |= kIncludeDeviceName;
+        if (current.includePowerLevel != next.includePowerLevel) changed |= kIncludePowerLevel;
+        return changed;
+    }
+
+    AdvertiseData ManufacturerDataOnly(const AdvertiseData& data) {
+        AdvertiseData published;
+        if (data.manufacturerId) {
+            published.manufacturerId = data.manufacturerId;
+            published.manufacturerData = data.manufacturerData;
+        }
+        return published;
+    }
+
+}  // namespace flutter_ble_peripheral
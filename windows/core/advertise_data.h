@@ -0,0 +1,70 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_ADVERTISE_DATA_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_ADVERTISE_DATA_H_
+
+#include "byte_buffer.h"
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace flutter_ble_peripheral {
+
+    // Platform-neutral version of the Dart AdvertiseData model, limited to the
+    // fields the Windows publisher can express. Copies share the manufacturer
+    // data bytes.
+    struct AdvertiseData {
+        std::optional<uint16_t> manufacturerId;
+        SharedBuffer manufacturerData;
+        std::optional<std::string> serviceUuid;
+        std::optional<std::string> serviceDataUuid;
+        SharedBuffer serviceData;
+        std::optional<std::string> serviceSolicitationUuid;
+        std::optional<std::string> localName;
+        bool includeDeviceName = false;
+        bool includePowerLevel = false;
+    };
+
+    // Timing of one advertising set, from the Dart AdvertiseSetParameters.
+    // Zero durations and counts mean "no limit".
+    struct AdvertiseSetParameters {
+        std::chrono::nanoseconds interval{ std::chrono::milliseconds(1000) };
+        std::chrono::nanoseconds duration{ 0 };
+        uint32_t maxExtendedAdvertisingEvents = 0;
+    };
+
+    // AdvertiseSetParameters uses Android's units: the interval counts
+    // 0.625 ms steps and the duration 10 ms steps.
+    constexpr std::chrono::nanoseconds IntervalFromUnits(int64_t units) {
+        return std::chrono::microseconds(units * 625);
+    }
+
+    constexpr std::chrono::nanoseconds DurationFromUnits(int64_t units) {
+        return std::chrono::milliseconds(units * 10);
+    }
+
+    // Bit flags naming the AdvertiseData fields, used to describe what an
+    // update changed.
+    enum AdvertiseDataField : uint32_t {
+        kManufacturerId = 1u << 0,
+        kManufacturerData = 1u << 1,
+        kServiceUuid = 1u << 2,
+        kLocalName = 1u << 3,
+        kIncludeDeviceName = 1u << 4,
+        kIncludePowerLevel = 1u << 5,
+        kServiceData = 1u << 6,
+        kServiceSolicitationUuid = 1u << 7,
+    };
+
+    // Returns the AdvertiseDataField bits that differ between |current| and
+    // |next|. Zero means the payloads are identical.
+    uint32_t DiffAdvertiseData(const AdvertiseData& current, const AdvertiseData& next);
+
+    // The part of |data| a publisher that broadcasts only manufacturer data
+    // puts on air: the company id and its bytes, or nothing at all without a
+    // company id. Shares the bytes with |data|.
+    AdvertiseData ManufacturerDataOnly(const AdvertiseData& data);
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_ADVERTISE_DATA_H_
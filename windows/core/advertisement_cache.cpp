@@ -0,0 +1,137 @@
+#include "advertisement_cache.h"
+
+#include <algorithm>
+
+namespace flutter_ble_peripheral {
+
+    uint64_t HashBytes(ByteView bytes) {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (uint8_t byte : bytes) {
+            hash ^= byte;
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    AdvertisementCache::AdvertisementCache(size_t capacity, std::chrono::nanoseconds max_age)
+        : pool_(std::max<size_t>(capacity, 1)), table_(pool_.size()), max_age_(max_age) {
+        Clear();
+    }
+
+    AdvertisementCache::Outcome AdvertisementCache::Classify(const ScanResult& result,
+                                                             std::chrono::nanoseconds now) {
+        ExpireOlderThan(now);
+
+        const uint64_t payload_hash = HashBytes(result.advertisementData);
+        const uint64_t name_hash = HashBytes(ByteView(
+            reinterpret_cast<const uint8_t*>(result.localName.data()), result.localName.size()));
+
+        uint32_t node = table_.Find(result.address);
+        Outcome outcome;
+        if (node != kNone) {
+            Unlink(node);
+            Entry& entry = pool_[node].entry;
+            if (entry.payloadHash == payload_hash && entry.nameHash == name_hash) {
+                outcome = Outcome::kUnchanged;
+                ++hits_;
+            }
+            else {
+                outcome = Outcome::kChanged;
+                ++changes_;
+            }
+        }
+        else {
+            node = AllocateNode();
+            table_.Insert(result.address, node);
+            pool_[node].entry = Entry();
+            pool_[node].entry.address = result.address;
+            pool_[node].entry.rssiMin = result.rssi;
+            pool_[node].entry.rssiMax = result.rssi;
+            ++size_;
+            outcome = Outcome::kNew;
+            ++misses_;
+        }
+
+        Entry& entry = pool_[node].entry;
+        entry.payloadHash = payload_hash;
+        entry.nameHash = name_hash;
+        entry.lastSeen = now;
+        entry.rssiLast = result.rssi;
+        entry.rssiMin = std::min(entry.rssiMin, result.rssi);
+        entry.rssiMax = std::max(entry.rssiMax, result.rssi);
+        ++entry.rssiCount;
+        entry.rssiSum += result.rssi;
+        PushNewest(node);
+        return outcome;
+    }
+
+    const AdvertisementCache::Entry* AdvertisementCache::Find(uint64_t address) const {
+        const uint32_t node = table_.Find(address);
+        return node == kNone ? nullptr : &pool_[node].entry;
+    }
+
+    void AdvertisementCache::ExpireOlderThan(std::chrono::nanoseconds now) {
+        while (oldest_ != kNone && now - pool_[oldest_].entry.lastSeen > max_age_) {
+            Erase(pool_[oldest_].entry.address);
+            ++evictions_;
+        }
+    }
+
+    void AdvertisementCache::Clear() {
+        table_.Clear();
+        free_nodes_.clear();
+        for (size_t i = pool_.size(); i > 0; --i) {
+            free_nodes_.push_back(static_cast<uint32_t>(i - 1));
+        }
+        newest_ = kNone;
+        oldest_ = kNone;
+        size_ = 0;
+    }
+
+    AdvertisementCache::Stats AdvertisementCache::stats() const {
+        Stats stats;
+        stats.hits = hits_;
+        stats.misses = misses_;
+        stats.changes = changes_;
+        stats.evictions = evictions_;
+        stats.size = size_;
+        stats.capacity = pool_.size();
+        return stats;
+    }
+
+    void AdvertisementCache::Unlink(uint32_t node) {
+        Node& n = pool_[node];
+        if (n.newer != kNone) pool_[n.newer].older = n.older; else newest_ = n.older;
+        if (n.older != kNone) pool_[n.older].newer = n.newer; else oldest_ = n.newer;
+        n.newer = kNone;
+        n.older = kNone;
+    }
+
+    void AdvertisementCache::PushNewest(uint32_t node) {
+        Node& n = pool_[node];
+        n.newer = kNone;
+        n.older = newest_;
+        if (newest_ != kNone) pool_[newest_].newer = node;
+        newest_ = node;
+        if (oldest_ == kNone) oldest_ = node;
+    }
+
+    void AdvertisementCache::Erase(uint64_t address) {
+        const uint32_t node = table_.Erase(address);
+        if (node == kNone) return;
+        Unlink(node);
+        free_nodes_.push_back(node);
+        --size_;
+    }
+
+    uint32_t AdvertisementCache::AllocateNode() {
+        if (free_nodes_.empty()) {
+            Erase(pool_[oldest_].entry.address);
+            ++evictions_;
+        }
+        const uint32_t node = free_nodes_.back();
+        free_nodes_.pop_back();
+        return node;
+    }
+
+}  // namespace flutter_ble_peripheral
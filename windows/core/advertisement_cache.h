@@ -0,0 +1,108 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_ADVERTISEMENT_CACHE_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_ADVERTISEMENT_CACHE_H_
+
+#include "address_table.h"
+#include "byte_buffer.h"
+#include "scan_result.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+
+    // 64-bit FNV-1a.
+    uint64_t HashBytes(ByteView bytes);
+
+    // Remembers what each advertiser sent last so that only new devices and
+    // changed payloads need to cross to Dart.
+    //
+    // Devices live in a fixed pool; an AddressTable maps the 48-bit address
+    // to a pool slot. Memory is bounded by the
+    // capacity: when the pool is full the least recently seen device is
+    // evicted, and devices not seen for maxAge are dropped as well.
+    //
+    // Not thread-safe.
+    class AdvertisementCache {
+    public:
+        enum class Outcome {
+            // First advertisement from this address, or first since eviction.
+            kNew,
+            // The payload or local name differs from the last one seen.
+            kChanged,
+            // Same payload and name as last time; only the RSSI was recorded.
+            kUnchanged,
+        };
+
+        struct Entry {
+            uint64_t address = 0;
+            uint64_t payloadHash = 0;
+            uint64_t nameHash = 0;
+            std::chrono::nanoseconds lastSeen{ 0 };
+            int16_t rssiLast = 0;
+            int16_t rssiMin = 0;
+            int16_t rssiMax = 0;
+            uint32_t rssiCount = 0;
+            int64_t rssiSum = 0;
+        };
+
+        struct Stats {
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            uint64_t changes = 0;
+            uint64_t evictions = 0;
+            size_t size = 0;
+            size_t capacity = 0;
+        };
+
+        explicit AdvertisementCache(size_t capacity = 1024,
+                                    std::chrono::nanoseconds max_age = std::chrono::seconds(30));
+
+        // Records |result|, seen at |now|, and reports whether it is news.
+        Outcome Classify(const ScanResult& result, std::chrono::nanoseconds now);
+
+        // The cached state of |address|, or nullptr.
+        const Entry* Find(uint64_t address) const;
+
+        // Drops every device last seen before |now| - max_age.
+        void ExpireOlderThan(std::chrono::nanoseconds now);
+
+        void Clear();
+
+        Stats stats() const;
+        size_t size() const { return size_; }
+        size_t capacity() const { return pool_.size(); }
+
+    private:
+        static constexpr uint32_t kNone = AddressTable::kNone;
+
+        struct Node {
+            Entry entry;
+            uint32_t newer = kNone;
+            uint32_t older = kNone;
+        };
+
+        void Unlink(uint32_t node);
+        void PushNewest(uint32_t node);
+        void Erase(uint64_t address);
+        uint32_t AllocateNode();
+
+        std::vector<Node> pool_;
+        AddressTable table_;
+        std::chrono::nanoseconds max_age_;
+
+        std::vector<uint32_t> free_nodes_;
+        uint32_t newest_ = kNone;
+        uint32_t oldest_ = kNone;
+        size_t size_ = 0;
+
+        uint64_t hits_ = 0;
+        uint64_t misses_ = 0;
+        uint64_t changes_ = 0;
+        uint64_t evictions_ = 0;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_ADVERTISEMENT_CACHE_H_
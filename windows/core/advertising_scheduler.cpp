@@ -0,0 +1,178 @@
+#include "advertising_scheduler.h"
+
+#include <algorithm>
+
+namespace flutter_ble_peripheral {
+
+    AdvertisingScheduler::AdvertisingScheduler(PeripheralCore& core, const Clock& clock,
+                                               std::chrono::nanoseconds slot)
+        : core_(core), clock_(clock), slot_(slot) {}
+
+    AdvertisingScheduler::SetId AdvertisingScheduler::Add(AdvertiseData data,
+                                                          AdvertiseSetParameters parameters) {
+        auto now = clock_.Now();
+        SetId id = next_id_++;
+        Set set;
+        set.data = std::move(data);
+        set.parameters = parameters;
+        set.nextDue = now;
+        if (parameters.duration.count() > 0) {
+            set.expiresAt = now + parameters.duration;
+        }
+        set.stats.id = id;
+        sets_.emplace(id, std::move(set));
+        due_.push({ now, id });
+        return id;
+    }
+
+    bool AdvertisingScheduler::Remove(SetId id) {
+        auto it = sets_.find(id);
+        if (it == sets_.end()) return false;
+        if (on_air_ == id) {
+            AccountAirtime(clock_.Now());
+            on_air_.reset();
+            core_.Stop();
+        }
+        // Its heap entry goes stale and is skipped lazily.
+        sets_.erase(it);
+        return true;
+    }
+
+    std::optional<std::chrono::nanoseconds> AdvertisingScheduler::Tick() {
+        auto now = clock_.Now();
+        AccountAirtime(now);
+
+        bool retired = false;
+        if (on_air_) {
+            Set& current = sets_.at(*on_air_);
+            if (current.expiresAt && now >= *current.expiresAt) {
+                Retire(current);
+                retired = true;
+            }
+            else if (now < slot_end_) {
+                return NextWakeup();
+            }
+            else if (IsExhausted(current)) {
+                Retire(current);
+                retired = true;
+            }
+        }
+
+        if (auto next = PopDue(now)) {
+            SwitchTo(*next, now);
+        }
+        else if (retired) {
+            core_.Stop();
+        }
+        return NextWakeup();
+    }
+
+    std::optional<std::chrono::nanoseconds> AdvertisingScheduler::NextWakeup() {
+        auto now = clock_.Now();
+        DropStaleEntries();
+        std::optional<std::chrono::nanoseconds> wakeup;
+        if (!due_.empty()) {
+            wakeup = due_.top().due;
+        }
+        if (on_air_) {
+            const Set& current = sets_.at(*on_air_);
+            if (IsExhausted(current)) {
+                // Retires as soon as its last slot ends.
+                wakeup = slot_end_;
+            }
+            else if (slot_end_ > now) {
+                // Nothing can take over before the current slot ends.
+                wakeup = wakeup ? std::max(*wakeup, slot_end_) : slot_end_;
+            }
+            if (current.expiresAt) {
+                wakeup = wakeup ? std::min(*wakeup, *current.expiresAt) : *current.expiresAt;
+            }
+        }
+        return wakeup;
+    }
+
+    std::optional<AdvertisingScheduler::SetStats> AdvertisingScheduler::Stats(SetId id) const {
+        auto it = sets_.find(id);
+        if (it == sets_.end()) return std::nullopt;
+        return it->second.stats;
+    }
+
+    std::vector<AdvertisingScheduler::SetStats> AdvertisingScheduler::Stats() const {
+        std::vector<SetStats> stats;
+        stats.reserve(sets_.size());
+        for (const auto& entry : sets_) {
+            stats.push_back(entry.second.stats);
+        }
+        std::sort(stats.begin(), stats.end(),
+                  [](const SetStats& a, const SetStats& b) { return a.id < b.id; });
+        return stats;
+    }
+
+    void AdvertisingScheduler::AccountAirtime(std::chrono::nanoseconds now) {
+        if (on_air_ && now > accounted_at_) {
+            sets_.at(*on_air_).stats.airtime += now - accounted_at_;
+        }
+        accounted_at_ = now;
+    }
+
+    bool AdvertisingScheduler::IsExhausted(const Set& set) {
+        const auto max_events = set.parameters.maxExtendedAdvertisingEvents;
+        return max_events != 0 && set.stats.events >= max_events;
+    }
+
+    void AdvertisingScheduler::Retire(Set& set) {
+        set.stats.expired = true;
+        set.stats.onAir = false;
+        if (on_air_ == set.stats.id) {
+            on_air_.reset();
+        }
+    }
+
+    bool AdvertisingScheduler::IsLive(const HeapEntry& entry) const {
+        auto it = sets_.find(entry.id);
+        return it != sets_.end() && !it->second.stats.expired && it->second.nextDue == entry.due;
+    }
+
+    void AdvertisingScheduler::DropStaleEntries() {
+        while (!due_.empty() && !IsLive(due_.top())) {
+            due_.pop();
+        }
+    }
+
+    std::optional<AdvertisingScheduler::SetId> AdvertisingScheduler::PopDue(std::chrono::nanoseconds now) {
+        while (true) {
+            DropStaleEntries();
+            if (due_.empty() || due_.top().due > now) {
+                return std::nullopt;
+            }
+            HeapEntry entry = due_.top();
+            due_.pop();
+            Set& set = sets_.at(entry.id);
+            if (set.expiresAt && now >= *set.expiresAt) {
+                Retire(set);
+                continue;
+            }
+            return entry.id;
+        }
+    }
+
+    void AdvertisingScheduler::SwitchTo(SetId id, std::chrono::nanoseconds now) {
+        if (on_air_ && *on_air_ != id) {
+            sets_.at(*on_air_).stats.onAir = false;
+        }
+        Set& set = sets_.at(id);
+        core_.Update(set.data);
+        set.stats.onAir = true;
+        ++set.stats.events;
+        on_air_ = id;
+        slot_end_ = now + slot_;
+        accounted_at_ = now;
+
+        if (!IsExhausted(set)) {
+            // Falling behind does not earn a burst of catch-up slots.
+            set.nextDue = std::max(set.nextDue + set.parameters.interval, now);
+            due_.push({ set.nextDue, id });
+        }
+    }
+
+}  // namespace flutter_ble_peripheral
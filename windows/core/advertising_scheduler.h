@@ -0,0 +1,108 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_ADVERTISING_SCHEDULER_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_ADVERTISING_SCHEDULER_H_
+
+#include "advertise_data.h"
+#include "clock.h"
+#include "peripheral_core.h"
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+
+    // Time-slices many logical advertising sets over the single publisher.
+    //
+    // Each set is due once per interval. When the radio's current slot ends,
+    // the set with the earliest due time is swapped onto the air through
+    // PeripheralCore::Update. Due times live in a min-heap, so picking the next
+    // set is O(log N). Sets retire once their duration has elapsed or they
+    // have been on air maxExtendedAdvertisingEvents times.
+    //
+    // The scheduler does not own a timer: call Tick() when NextWakeup() says
+    // so.
+    class AdvertisingScheduler {
+    public:
+        using SetId = uint32_t;
+
+        struct SetStats {
+            SetId id = 0;
+            // Number of slots the set has been given.
+            uint64_t events = 0;
+            // Total time the set has been on air.
+            std::chrono::nanoseconds airtime{ 0 };
+            bool onAir = false;
+            bool expired = false;
+        };
+
+        AdvertisingScheduler(PeripheralCore& core, const Clock& clock,
+                             std::chrono::nanoseconds slot = std::chrono::milliseconds(100));
+
+        // Disallow copy and assign.
+        AdvertisingScheduler(const AdvertisingScheduler&) = delete;
+        AdvertisingScheduler& operator=(const AdvertisingScheduler&) = delete;
+
+        // Registers a set. It becomes due immediately.
+        SetId Add(AdvertiseData data, AdvertiseSetParameters parameters);
+
+        // Unregisters a set, taking it off the air if needed. Returns false for
+        // unknown ids.
+        bool Remove(SetId id);
+
+        // Rotates the radio to whichever set is due and returns NextWakeup().
+        std::optional<std::chrono::nanoseconds> Tick();
+
+        // Clock time at which Tick() next has work to do, or nullopt when no
+        // live sets remain.
+        std::optional<std::chrono::nanoseconds> NextWakeup();
+
+        std::optional<SetStats> Stats(SetId id) const;
+        std::vector<SetStats> Stats() const;
+
+        std::optional<SetId> on_air() const { return on_air_; }
+        size_t size() const { return sets_.size(); }
+
+    private:
+        struct Set {
+            AdvertiseData data;
+            AdvertiseSetParameters parameters;
+            std::chrono::nanoseconds nextDue{ 0 };
+            std::optional<std::chrono::nanoseconds> expiresAt;
+            SetStats stats;
+        };
+
+        struct HeapEntry {
+            std::chrono::nanoseconds due;
+            SetId id;
+            bool operator>(const HeapEntry& other) const {
+                return due != other.due ? due > other.due : id > other.id;
+            }
+        };
+
+        static bool IsExhausted(const Set& set);
+        void AccountAirtime(std::chrono::nanoseconds now);
+        void Retire(Set& set);
+        bool IsLive(const HeapEntry& entry) const;
+        void DropStaleEntries();
+        std::optional<SetId> PopDue(std::chrono::nanoseconds now);
+        void SwitchTo(SetId id, std::chrono::nanoseconds now);
+
+        PeripheralCore& core_;
+        const Clock& clock_;
+        std::chrono::nanoseconds slot_;
+
+        std::unordered_map<SetId, Set> sets_;
+        std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> due_;
+        SetId next_id_ = 1;
+
+        std::optional<SetId> on_air_;
+        std::chrono::nanoseconds slot_end_{ 0 };
+        std::chrono::nanoseconds accounted_at_{ 0 };
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_ADVERTISING_SCHEDULER_H_
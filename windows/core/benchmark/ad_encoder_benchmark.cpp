@@ -0,0 +1,86 @@
+#include <benchmark/benchmark.h>
+
+#include "ad_encoder.h"
+#include "allocation_counter.h"
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        AdvertiseData TypicalData() {
+            AdvertiseData data;
+            data.serviceUuid = "0000180d-0000-1000-8000-00805f9b34fb";
+            data.manufacturerId = 0x004C;
+            data.manufacturerData = SharedBuffer::CopyFrom(std::vector<uint8_t>(8, 0xAB));
+            data.localName = "heart-rate";
+            data.includePowerLevel = true;
+            return data;
+        }
+
+        // Stand-in for building the advertisement out of per-field runtime
+        // objects, as the WinRT publisher path does (which cannot run here):
+        // every section is its own heap buffer, concatenated at the end, and
+        // overflow is only discovered once everything has been built.
+        std::vector<uint8_t> NaiveEncode(const AdvertiseData& data) {
+            std::vector<std::vector<uint8_t>> sections;
+            sections.push_back({ 0x02, kAdFlags, kAdFlagsGeneralDiscoverable });
+            if (data.serviceUuid) {
+                auto uuid = ParseBluetoothUuid(*data.serviceUuid);
+                std::vector<uint8_t> section = { static_cast<uint8_t>(uuid->size + 1), kAdCompleteUuid16List };
+                section.insert(section.end(), uuid->bytes.begin(), uuid->bytes.begin() + uuid->size);
+                sections.push_back(section);
+            }
+            {
+                std::vector<uint8_t> section = { static_cast<uint8_t>(data.manufacturerData.size() + 3),
+                                                 kAdManufacturerSpecificData, 0x4C, 0x00 };
+                for (uint8_t byte : data.manufacturerData.view()) section.push_back(byte);
+                sections.push_back(section);
+            }
+            if (data.includePowerLevel) sections.push_back({ 0x02, kAdTxPowerLevel, 0x00 });
+            if (data.localName) {
+                std::vector<uint8_t> section = { static_cast<uint8_t>(data.localName->size() + 1), kAdCompleteLocalName };
+                section.insert(section.end(), data.localName->begin(), data.localName->end());
+                sections.push_back(section);
+            }
+            std::vector<uint8_t> payload;
+            for (const auto& section : sections) payload.insert(payload.end(), section.begin(), section.end());
+            if (payload.size() > kLegacyAdvertisingDataSize) payload.clear();
+            return payload;
+        }
+
+        void BM_EncodeNaive(benchmark::State& state) {
+            const AdvertiseData data = TypicalData();
+            AllocationScope allocations(state);
+            for (auto _ : state) {
+                benchmark::DoNotOptimize(NaiveEncode(data));
+            }
+        }
+        BENCHMARK(BM_EncodeNaive);
+
+        void BM_EncodeAdPayload(benchmark::State& state) {
+            const AdvertiseData data = TypicalData();
+            uint8_t out[kLegacyAdvertisingDataSize];
+            AllocationScope allocations(state);
+            for (auto _ : state) {
+                AdvertisePayload payload;
+                bool fits = EncodeAdvertiseData(data, payload);
+                size_t size = payload.WriteAdvertisement(out, sizeof(out));
+                benchmark::DoNotOptimize(fits);
+                benchmark::DoNotOptimize(size);
+                benchmark::ClobberMemory();
+            }
+        }
+        BENCHMARK(BM_EncodeAdPayload);
+
+        // Just the budget check the plugin runs before starting.
+        void BM_LayoutOnly(benchmark::State& state) {
+            const AdvertiseData data = TypicalData();
+            AllocationScope allocations(state);
+            for (auto _ : state) {
+                AdvertisePayload payload;
+                benchmark::DoNotOptimize(EncodeAdvertiseData(data, payload));
+            }
+        }
+        BENCHMARK(BM_LayoutOnly);
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
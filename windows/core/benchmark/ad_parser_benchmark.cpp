@@ -0,0 +1,89 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "ad_parser.h"
+#include "allocation_counter.h"
+#include "scan_result.h"
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        // What a scan hears most: an iBeacon, an Eddystone-UID frame, a
+        // named sensor and a phone's manufacturer beacon.
+        std::vector<std::vector<uint8_t>> Advertisements() {
+            std::vector<uint8_t> ibeacon = { 0x02, kAdFlags, 0x06, 0x1A, kAdManufacturerSpecificData, 0x4C, 0x00, 0x02, 0x15 };
+            ibeacon.resize(ibeacon.size() + 21, 0xA5);
+            std::vector<uint8_t> eddystone = { 0x02, kAdFlags, 0x06, 0x03, kAdCompleteUuid16List, 0xAA, 0xFE,
+                                               0x17, kAdServiceData16, 0xAA, 0xFE, 0x00, 0xEE };
+            eddystone.resize(eddystone.size() + 18, 0x5A);
+            const std::vector<uint8_t> sensor = {
+                0x02, kAdFlags, 0x06, 0x05, kAdCompleteUuid16List, 0x0F, 0x18, 0x1A, 0x18,
+                0x02, kAdTxPowerLevel, 0x00, 0x03, kAdAppearance, 0x40, 0x05,
+                0x09, kAdCompleteLocalName, 'T', 'h', 'e', 'r', 'm', 'o', '-', '7',
+            };
+            const std::vector<uint8_t> phone = { 0x02, kAdFlags, 0x1A, 0x0B, kAdManufacturerSpecificData, 0x06, 0x00,
+                                                 0x01, 0x09, 0x20, 0x02, 0x5C, 0x31, 0x7E, 0x10 };
+            return { ibeacon, eddystone, sensor, phone };
+        }
+
+        // The parse ScanEvent::View did before ParseAdvertisement: only the
+        // local name and the manufacturer records, into a ScanResult.
+        void BM_ParseAdvertisement_Partial(benchmark::State& state) {
+            const auto advertisements = Advertisements();
+            size_t index = 0;
+            AllocationScope allocations(state);
+            for (auto _ : state) {
+                const ByteView data = advertisements[index++ % advertisements.size()];
+                ScanResult result;
+                size_t offset = 0;
+                while (offset < data.size()) {
+                    const size_t length = data[offset];
+                    if (length == 0 || offset + 1 + length > data.size()) break;
+                    const uint8_t type = data[offset + 1];
+                    const ByteView value = data.subview(offset + 2, length - 1);
+                    if (type == kAdManufacturerSpecificData && value.size() >= 2) {
+                        result.manufacturerData.push_back(
+                            { static_cast<uint16_t>(value[0] | (value[1] << 8)), value.subview(2) });
+                    }
+                    else if (type == kAdCompleteLocalName ||
+                             (type == kAdShortenedLocalName && result.localName.empty())) {
+                        result.localName.assign(value.begin(), value.end());
+                    }
+                    offset += 1 + length;
+                }
+                benchmark::DoNotOptimize(result);
+            }
+        }
+        BENCHMARK(BM_ParseAdvertisement_Partial);
+
+        // Every reported type, into one reused AdvertisementFields.
+        void BM_ParseAdvertisement_Full(benchmark::State& state) {
+            const auto advertisements = Advertisements();
+            AdvertisementFields fields;
+            size_t index = 0;
+            AllocationScope allocations(state);
+            for (auto _ : state) {
+                ParseAdvertisement(advertisements[index++ % advertisements.size()], fields);
+                benchmark::DoNotOptimize(fields);
+            }
+        }
+        BENCHMARK(BM_ParseAdvertisement_Full);
+
+        // The same with a fresh AdvertisementFields per advertisement, as
+        // ScanEvent::View does; the lists are not initialized up front.
+        void BM_ParseAdvertisement_FullFresh(benchmark::State& state) {
+            const auto advertisements = Advertisements();
+            size_t index = 0;
+            AllocationScope allocations(state);
+            for (auto _ : state) {
+                AdvertisementFields fields;
+                ParseAdvertisement(advertisements[index++ % advertisements.size()], fields);
+                benchmark::DoNotOptimize(fields);
+            }
+        }
+        BENCHMARK(BM_ParseAdvertisement_FullFresh);
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
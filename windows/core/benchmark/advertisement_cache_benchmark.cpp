@@ -0,0 +1,54 @@
+#include <benchmark/benchmark.h>
+
+#include "advertisement_cache.h"
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        const std::vector<uint8_t> kAdvertisementData = {
+            0x02, 0x01, 0x06, 0x0B, 0xFF, 0x4C, 0x00, 1, 2, 3, 4, 5, 6, 7, 8, 9,
+        };
+
+        // Steady state of a room of N beacons that never change payload: every
+        // advertisement should be a hit and be suppressed.
+        void BM_ClassifyRoom(benchmark::State& state) {
+            const uint64_t devices = static_cast<uint64_t>(state.range(0));
+            AdvertisementCache cache(static_cast<size_t>(devices));
+            ScanResult result;
+            result.advertisementData = kAdvertisementData;
+            result.localName = "beacon";
+            uint64_t device = 0;
+            int64_t ms = 0;
+            for (auto _ : state) {
+                result.address = 0xC0FFEE000000ull + device;
+                result.rssi = static_cast<int16_t>(-40 - device % 50);
+                benchmark::DoNotOptimize(cache.Classify(result, std::chrono::milliseconds(ms)));
+                if (++device == devices) {
+                    device = 0;
+                    ++ms;
+                }
+            }
+            const auto stats = cache.stats();
+            state.counters["hit_rate"] =
+                static_cast<double>(stats.hits) / static_cast<double>(stats.hits + stats.misses + stats.changes);
+            state.SetItemsProcessed(state.iterations());
+        }
+        BENCHMARK(BM_ClassifyRoom)->Arg(16)->Arg(256)->Arg(4096);
+
+        // More advertisers than the cache holds: every lookup misses and evicts.
+        void BM_ClassifyChurn(benchmark::State& state) {
+            AdvertisementCache cache(256);
+            ScanResult result;
+            result.advertisementData = kAdvertisementData;
+            uint64_t device = 0;
+            for (auto _ : state) {
+                result.address = device++ % 1024;
+                benchmark::DoNotOptimize(cache.Classify(result, std::chrono::milliseconds(0)));
+            }
+            state.counters["evictions"] = static_cast<double>(cache.stats().evictions);
+            state.SetItemsProcessed(state.iterations());
+        }
+        BENCHMARK(BM_ClassifyChurn);
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,37 @@
+#include <benchmark/benchmark.h>
+
+#include "advertising_scheduler.h"
+#include "mock_radio_backend.h"
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        // Cost of one rotation with N registered sets, all on the same
+        // interval so every tick swaps a different set onto the radio.
+        void BM_SchedulerRotation(benchmark::State& state) {
+            const auto set_count = static_cast<size_t>(state.range(0));
+            MockRadioBackend backend;
+            PeripheralCore core(backend);
+            VirtualClock clock;
+            const auto slot = std::chrono::milliseconds(10);
+            AdvertisingScheduler scheduler(core, clock, slot);
+
+            AdvertiseSetParameters parameters;
+            parameters.interval = slot * static_cast<int64_t>(set_count);
+            for (size_t i = 0; i < set_count; ++i) {
+                AdvertiseData data;
+                data.manufacturerId = 1234;
+                data.manufacturerData = SharedBuffer::CopyFrom(std::vector<uint8_t>{
+                    static_cast<uint8_t>(i), static_cast<uint8_t>(i >> 8) });
+                scheduler.Add(data, parameters);
+            }
+
+            for (auto _ : state) {
+                clock.Advance(slot);
+                benchmark::DoNotOptimize(scheduler.Tick());
+            }
+        }
+        BENCHMARK(BM_SchedulerRotation)->RangeMultiplier(8)->Range(1, 4096);
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
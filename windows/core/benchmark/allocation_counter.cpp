@@ -0,0 +1,35 @@
+#include "allocation_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace flutter_ble_peripheral {
+
+    namespace {
+        thread_local uint64_t allocation_count = 0;
+    }  // namespace
+
+    uint64_t ThreadAllocationCount() { return allocation_count; }
+
+    void* CountedAllocate(std::size_t size) {
+        ++allocation_count;
+        if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+            return pointer;
+        }
+        throw std::bad_alloc();
+    }
+
+}  // namespace flutter_ble_peripheral
+
+void* operator new(std::size_t size) {
+    return flutter_ble_peripheral::CountedAllocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return flutter_ble_peripheral::CountedAllocate(size);
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
@@ -0,0 +1,35 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_BENCHMARK_ALLOCATION_COUNTER_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_BENCHMARK_ALLOCATION_COUNTER_H_
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+namespace flutter_ble_peripheral {
+
+    // Number of global operator new calls made so far on this thread. The
+    // benchmark executable replaces the global allocation functions to count
+    // them; see allocation_counter.cpp.
+    uint64_t ThreadAllocationCount();
+
+    // Counts the allocations made while a benchmark's timing loop runs and
+    // reports them as the "allocs/iter" counter.
+    class AllocationScope {
+    public:
+        explicit AllocationScope(benchmark::State& state)
+            : state_(state), start_(ThreadAllocationCount()) {}
+
+        ~AllocationScope() {
+            auto allocations = static_cast<double>(ThreadAllocationCount() - start_);
+            state_.counters["allocs/iter"] =
+                benchmark::Counter(allocations, benchmark::Counter::kAvgIterations);
+        }
+
+    private:
+        benchmark::State& state_;
+        uint64_t start_;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_BENCHMARK_ALLOCATION_COUNTER_H_
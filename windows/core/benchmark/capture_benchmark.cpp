@@ -0,0 +1,102 @@
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <vector>
+
+#include "allocation_counter.h"
+#include "scan_capture.h"
+#include "simulated_radio.h"
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        std::string CapturePath(const char* name) {
+            return (std::filesystem::temp_directory_path() / (std::string("flutter_ble_peripheral_") + name + ".blec"))
+                .u8string();
+        }
+
+        // A second of a busy simulated room.
+        const std::vector<ScanEvent>& Room() {
+            static const std::vector<ScanEvent> events = [] {
+                SimulatedRadioOptions options;
+                options.advertisers = 2000;
+                options.advertisementsPerSecond = 100000;
+                VirtualClock clock;
+                SimulatedRadio radio(clock, options);
+                radio.StartScan(ScanSettings());
+                std::vector<ScanEvent> events;
+                radio.RunUntil(std::chrono::seconds(1), [&](const ScanResult& result) {
+                    events.emplace_back();
+                    events.back().Assign(result);
+                });
+                return events;
+            }();
+            return events;
+        }
+
+        // What capture adds to each Received callback. dropped stays at zero
+        // as long as the writer thread keeps up with the appends.
+        void BM_CaptureAppend(benchmark::State& state) {
+            std::vector<ScanResult> results;
+            for (const auto& event : Room()) results.push_back(event.View());
+            const auto path = CapturePath("append_benchmark");
+            ScanCaptureOptions options;
+            options.deltaCompressed = state.range(0) != 0;
+            auto writer = ScanCaptureWriter::Open(path, options);
+            if (!writer) {
+                state.SkipWithError("cannot write a capture file");
+                return;
+            }
+            size_t next = 0;
+            {
+                AllocationScope allocations(state);
+                for (auto _ : state) {
+                    writer->Append(results[next]);
+                    if (++next == results.size()) next = 0;
+                }
+            }
+            writer->Close();
+            const auto stats = writer->stats();
+            state.counters["bytes/record"] =
+                static_cast<double>(stats.bytes) / static_cast<double>(std::max<uint64_t>(stats.records, 1));
+            state.counters["dropped"] = static_cast<double>(stats.dropped);
+            state.SetItemsProcessed(state.iterations());
+            writer.reset();
+            std::filesystem::remove(path);
+        }
+        BENCHMARK(BM_CaptureAppend)->ArgName("delta")->Arg(0)->Arg(1);
+
+        // Reading a mapped capture back, the ceiling of a maximum-speed
+        // replay before the pipeline it feeds.
+        void BM_CaptureRead(benchmark::State& state) {
+            const auto path = CapturePath("read_benchmark");
+            ScanCaptureOptions options;
+            options.deltaCompressed = state.range(0) != 0;
+            options.bufferSize = 16 << 20;
+            {
+                auto writer = ScanCaptureWriter::Open(path, options);
+                if (!writer) {
+                    state.SkipWithError("cannot write a capture file");
+                    return;
+                }
+                for (const auto& event : Room()) writer->Append(event.View());
+            }
+            auto reader = ScanCaptureReader::Open(path);
+            ScanEvent event;
+            AllocationScope allocations(state);
+            for (auto _ : state) {
+                if (!reader->Next(event)) {
+                    reader->Rewind();
+                    reader->Next(event);
+                }
+                benchmark::DoNotOptimize(event.advertisementDataSize);
+            }
+            state.SetItemsProcessed(state.iterations());
+            state.SetBytesProcessed(static_cast<int64_t>(reader->size() / Room().size()) * state.iterations());
+            reader.reset();
+            std::filesystem::remove(path);
+        }
+        BENCHMARK(BM_CaptureRead)->ArgName("delta")->Arg(0)->Arg(1);
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
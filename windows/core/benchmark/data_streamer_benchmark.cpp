@@ -0,0 +1,69 @@
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <vector>
+
+#include "allocation_counter.h"
+#include "clock.h"
+#include "data_streamer.h"
+#include "gatt_server.h"
+#include "simulated_gatt_link.h"
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        constexpr size_t kPayloadSize = 256 * 1024;
+
+        // Streams a 256 KB payload over a simulated 1M PHY link per
+        // iteration. Wall time is the streamer's CPU cost; "link_kB/s" is
+        // the throughput the link achieved in simulated time for the given
+        // MTU, window and completion latency.
+        void BM_StreamOverSimulatedLink(benchmark::State& state) {
+            const auto mtu = static_cast<size_t>(state.range(0));
+            const auto window = static_cast<size_t>(state.range(1));
+            const auto latency = std::chrono::microseconds(state.range(2));
+
+            VirtualClock clock;
+            SimulatedGattLink link(clock);
+            link.latency = latency;
+            GattServer server(link);
+            GattService service;
+            service.uuid = *ParseBluetoothUuid("8ebdb2f3-7817-45c9-95c5-c5e9031aaa47");
+            service.characteristics.push_back(
+                { *ParseBluetoothUuid("08590F7E-DB05-467E-8757-72F6FAEB13D4"), kGattNotify, {} });
+            server.AddService(service);
+            const GattHandle tx = service.characteristics[0].handle;
+            server.OnClientConnected(1);
+            server.OnMtuChanged(1, mtu);
+            server.OnSubscriptionChanged(1, tx, GattSubscription::kNotify);
+            DataStreamer streamer(server, clock, DataStreamOptions{ window, 64 * 1024 });
+
+            const SharedBuffer payload = SharedBuffer::CopyFrom(std::vector<uint8_t>(kPayloadSize, 0xA5));
+            double link_seconds = 0;
+            AllocationScope allocations(state);
+            for (auto _ : state) {
+                const auto start = clock.Now();
+                streamer.Send(1, tx, payload);
+                streamer.Pump();
+                while (link.DeliverNext([&](GattClientId client, const SharedBuffer& value) {
+                    streamer.OnSent(client, value, true);
+                    streamer.Pump();
+                })) {}
+                benchmark::DoNotOptimize(streamer.TakeProgress());
+                link_seconds += std::chrono::duration<double>(clock.Now() - start).count();
+            }
+            state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(kPayloadSize));
+            state.counters["link_kB/s"] =
+                static_cast<double>(state.iterations()) * kPayloadSize / 1024.0 / link_seconds;
+        }
+        BENCHMARK(BM_StreamOverSimulatedLink)
+            ->ArgNames({"mtu", "window", "latency_us"})
+            ->Args({23, 1, 7500})
+            ->Args({23, 8, 7500})
+            ->Args({185, 8, 7500})
+            ->Args({247, 1, 15000})
+            ->Args({247, 8, 15000})
+            ->Args({247, 16, 15000});
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,320 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "ad_parser.h"
+#include "advertisement_cache.h"
+#include "allocation_counter.h"
+#include "peripheral_core.h"
+#include "rssi_history.h"
+#include "scan_batcher.h"
+#include "scan_filter.h"
+#include "scan_record_codec.h"
+#include "simulated_radio.h"
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        using std::chrono::milliseconds;
+
+        constexpr milliseconds kFlushInterval{ 100 };
+
+        SimulatedRadioOptions Room(int64_t advertisements_per_second) {
+            SimulatedRadioOptions options;
+            options.advertisementsPerSecond = static_cast<double>(advertisements_per_second);
+            // Busy rooms have more devices rather than chattier ones.
+            options.advertisers = static_cast<size_t>(std::max<int64_t>(advertisements_per_second / 50, 1));
+            return options;
+        }
+
+        // Apple beacons no weaker than -80 dBm.
+        ScanFilter BeaconFilter() {
+            ScanFilterSpec spec;
+            spec.companyIds = { 0x004C };
+            spec.minRssi = -80;
+            return *ScanFilter::Compile(spec);
+        }
+
+        // The path a scan result takes through the plugin with binary results
+        // and batching on: the watcher thread filters, dedups and pushes; the
+        // platform thread flushes each batch into one message.
+        class ScanPipeline {
+        public:
+            ScanPipeline(bool filter, bool dedup) : dedup_(dedup) {
+                if (filter) filter_ = BeaconFilter();
+                ScanBatchOptions options;
+                options.flushInterval = kFlushInterval;
+                options.maxBatchSize = 1024;
+                batcher_.SetOptions(options);
+            }
+
+            void OnScanResult(const ScanResult& result, std::chrono::nanoseconds now) {
+                if (!filter_.Matches(result)) {
+                    ++filtered;
+                    return;
+                }
+                if (dedup_ && cache_.Classify(result, now) == AdvertisementCache::Outcome::kUnchanged) {
+                    ++deduplicated;
+                    return;
+                }
+                if (batcher_.Push(result)) Flush(now);
+            }
+
+            void Flush(std::chrono::nanoseconds now) {
+                const auto& batch = batcher_.Flush(now);
+                if (batch.empty()) return;
+                writer_.Reset();
+                for (const auto& entry : batch) writer_.Append(entry.latest.View());
+                benchmark::DoNotOptimize(writer_.data().data());
+                ++messages;
+                records += writer_.count();
+                bytes += writer_.data().size();
+            }
+
+            uint64_t dropped() const { return batcher_.dropped(); }
+
+            uint64_t filtered = 0;
+            uint64_t deduplicated = 0;
+            uint64_t messages = 0;
+            uint64_t records = 0;
+            uint64_t bytes = 0;
+
+        private:
+            ScanFilter filter_;
+            bool dedup_;
+            AdvertisementCache cache_{ 4096 };
+            ScanBatcher batcher_{ ScanBatchOptions(), 4096 };
+            ScanRecordWriter writer_;
+        };
+
+        // The simulator on its own, the floor under the numbers below.
+        void BM_SimulatedRadio(benchmark::State& state) {
+            VirtualClock clock;
+            SimulatedRadio radio(clock, Room(state.range(0)));
+            radio.StartScan(ScanSettings());
+            uint64_t delivered = 0;
+            for (auto _ : state) {
+                delivered += radio.RunUntil(clock.Now() + std::chrono::seconds(1), [](const ScanResult& result) {
+                    benchmark::DoNotOptimize(result.rssi);
+                });
+            }
+            state.SetItemsProcessed(static_cast<int64_t>(delivered));
+        }
+        BENCHMARK(BM_SimulatedRadio)->ArgName("adv_per_s")->Arg(10000)->Arg(100000);
+
+        // One simulated second of a scan per iteration, end to end from the
+        // radio to encoded messages. items_per_second is the ingest rate the
+        // pipeline sustains; it has to stay well above adv_per_s to keep up.
+        void BM_EndToEndScanIngest(benchmark::State& state) {
+            VirtualClock clock;
+            SimulatedRadio radio(clock, Room(state.range(0)));
+            ScanPipeline pipeline(state.range(1) != 0, state.range(2) != 0);
+            radio.StartScan(ScanSettings());
+            uint64_t delivered = 0;
+            AllocationScope allocations(state);
+            for (auto _ : state) {
+                const auto end = clock.Now() + std::chrono::seconds(1);
+                while (clock.Now() < end) {
+                    delivered += radio.RunUntil(clock.Now() + kFlushInterval, [&](const ScanResult& result) {
+                        pipeline.OnScanResult(result, clock.Now());
+                    });
+                    pipeline.Flush(clock.Now());
+                }
+            }
+            const auto per_second = [&](uint64_t count) {
+                return benchmark::Counter(static_cast<double>(count), benchmark::Counter::kAvgIterations);
+            };
+            state.counters["filtered/sim_s"] = per_second(pipeline.filtered);
+            state.counters["deduplicated/sim_s"] = per_second(pipeline.deduplicated);
+            state.counters["records/sim_s"] = per_second(pipeline.records);
+            state.counters["messages/sim_s"] = per_second(pipeline.messages);
+            state.counters["bytes/sim_s"] = per_second(pipeline.bytes);
+            state.counters["dropped"] = static_cast<double>(pipeline.dropped());
+            state.SetItemsProcessed(static_cast<int64_t>(delivered));
+        }
+        BENCHMARK(BM_EndToEndScanIngest)
+            ->ArgNames({ "adv_per_s", "filter", "dedup" })
+            ->Args({ 10000, 0, 0 })
+            ->Args({ 100000, 0, 0 })
+            ->Args({ 100000, 1, 0 })
+            ->Args({ 100000, 0, 1 })
+            ->Args({ 100000, 1, 1 });
+
+        // What the plugin does with one advertisement from the watcher to the
+        // map sent to Dart, with RSSI history and batching on: the watcher
+        // thread parses it into a ScanResult, records its RSSI and pushes it;
+        // the platform thread flushes the batch and reads every field a map
+        // needs. With parse_once the parsed fields travel with the result;
+        // without, every stage parses for itself as it used to.
+        void BM_OnScanResultPath(benchmark::State& state) {
+            const bool parse_once = state.range(0) != 0;
+            VirtualClock clock;
+            SimulatedRadio radio(clock, Room(100000));
+            radio.StartScan(ScanSettings());
+            ScanBatchOptions options;
+            options.maxBatchSize = 1024;
+            ScanBatcher batcher(options, 4096);
+            RssiHistory history(RssiHistoryOptions{ 1, 1 });
+            AdvertisementFields watcher_fields;
+            uint64_t delivered = 0;
+            uint64_t parses = 0;
+            size_t read = 0;
+
+            const auto parse = [&parses](ByteView data, AdvertisementFields& fields) {
+                ParseAdvertisement(data, fields);
+                ++parses;
+            };
+            const auto flush = [&] {
+                for (const auto& entry : batcher.Flush(clock.Now())) {
+                    const auto result = entry.latest.View();
+                    AdvertisementFields map_fields;
+                    if (!parse_once) parse(result.advertisementData, map_fields);
+                    const auto& fields = parse_once ? *result.fields : map_fields;
+                    read += DeviceName(result).size() + ManufacturerSpecificData(result).size();
+                    read += fields.serviceUuids.size() + fields.serviceData.size() + fields.manufacturerData.size();
+                    read += fields.txPowerLevel.has_value() + fields.appearance.has_value();
+                }
+            };
+
+            AllocationScope allocations(state);
+            for (auto _ : state) {
+                delivered += radio.RunUntil(clock.Now() + kFlushInterval, [&](const ScanResult& raw) {
+                    // WinRtRadioBackend's ToScanResult.
+                    ScanResult result = raw;
+                    parse(result.advertisementData, watcher_fields);
+                    result.localName.assign(watcher_fields.localName.begin(), watcher_fields.localName.end());
+                    result.manufacturerData.assign(watcher_fields.manufacturerData.begin(),
+                                                   watcher_fields.manufacturerData.end());
+                    result.fields = parse_once ? &watcher_fields : nullptr;
+
+                    AdvertisementFields history_fields;
+                    if (!parse_once) parse(result.advertisementData, history_fields);
+                    const auto& fields = parse_once ? watcher_fields : history_fields;
+                    history.Record(result.address, result.timestamp, result.rssi, fields.txPowerLevel);
+
+                    // Without carried fields the batched event parses its
+                    // own, where ScanEvent::View used to.
+                    if (!parse_once) ++parses;
+                    if (batcher.Push(result)) flush();
+                });
+                flush();
+            }
+            benchmark::DoNotOptimize(read);
+            state.counters["parses_per_result"] =
+                static_cast<double>(parses) / static_cast<double>(std::max<uint64_t>(delivered, 1));
+            state.SetItemsProcessed(static_cast<int64_t>(delivered));
+        }
+        BENCHMARK(BM_OnScanResultPath)->ArgName("parse_once")->Arg(0)->Arg(1);
+
+        // A recorded stretch of the simulated room, replayed through one stage
+        // at a time.
+        std::vector<ScanEvent> Recording(size_t count) {
+            VirtualClock clock;
+            SimulatedRadio radio(clock, Room(100000));
+            radio.StartScan(ScanSettings());
+            std::vector<ScanEvent> events;
+            events.reserve(count);
+            while (events.size() < count) {
+                radio.RunUntil(clock.Now() + milliseconds(10), [&](const ScanResult& result) {
+                    if (events.size() < count) {
+                        events.emplace_back();
+                        events.back().Assign(result);
+                    }
+                });
+            }
+            return events;
+        }
+
+        void BM_ScanFilterStage(benchmark::State& state) {
+            const auto events = Recording(8192);
+            std::vector<ScanResult> results;
+            for (const auto& event : events) results.push_back(event.View());
+            const auto filter = BeaconFilter();
+            size_t next = 0;
+            uint64_t matched = 0;
+            for (auto _ : state) {
+                matched += filter.Matches(results[next]);
+                if (++next == results.size()) next = 0;
+            }
+            state.counters["match_rate"] =
+                static_cast<double>(matched) / static_cast<double>(std::max<int64_t>(state.iterations(), 1));
+            state.SetItemsProcessed(state.iterations());
+        }
+        BENCHMARK(BM_ScanFilterStage);
+
+        // Encoding batches of |range(0)| results into binary messages,
+        // viewing each batched event as the flush does.
+        void BM_ScanEncodeStage(benchmark::State& state) {
+            const auto events = Recording(8192);
+            const auto batch = static_cast<size_t>(state.range(0));
+            ScanRecordWriter writer;
+            size_t next = 0;
+            AllocationScope allocations(state);
+            for (auto _ : state) {
+                writer.Reset();
+                for (size_t i = 0; i < batch; ++i) {
+                    writer.Append(events[next].View());
+                    if (++next == events.size()) next = 0;
+                }
+                benchmark::DoNotOptimize(writer.data().data());
+            }
+            state.SetItemsProcessed(state.iterations() * state.range(0));
+        }
+        BENCHMARK(BM_ScanEncodeStage)->ArgName("batch")->Arg(1)->Arg(64);
+
+        // A rotating payload pushed through PeripheralCore::Update at
+        // simulated random times. The time column is the core's own cost;
+        // on_air_ms is how long the new payload took to reach the air, in
+        // place at the next advertising event or through a stop/start.
+        void BM_AdvertisingUpdateLatency(benchmark::State& state) {
+            const bool in_place = state.range(0) != 0;
+            VirtualClock clock;
+            SimulatedRadioOptions options;
+            options.advertisers = 1;
+            SimulatedRadio radio(clock, options);
+            radio.accept_update = in_place;
+            PeripheralCore core(radio);
+            radio.on_status = [&core](PublisherStatus status, uint64_t publisher) {
+                core.OnPublisherStatusChanged(status, publisher);
+            };
+
+            std::vector<AdvertiseData> payloads(2);
+            for (size_t i = 0; i < payloads.size(); ++i) {
+                payloads[i].manufacturerId = 0x0059;
+                payloads[i].manufacturerData =
+                    SharedBuffer::CopyFrom(std::vector<uint8_t>(20, static_cast<uint8_t>(i)));
+            }
+            core.Start(payloads[0]);
+            radio.RunUntil(milliseconds(100), [](const ScanResult&) {});
+            radio.ClearCommands();
+
+            SimulationRandom random(options.seed);
+            size_t next = 1;
+            for (auto _ : state) {
+                benchmark::DoNotOptimize(core.Update(payloads[next]));
+                next ^= 1;
+                state.PauseTiming();
+                // Catch the status changes up and wait up to half a second.
+                radio.RunUntil(clock.Now() + milliseconds(random.Between(1, 500)), [](const ScanResult&) {});
+                state.ResumeTiming();
+            }
+
+            std::vector<double> on_air;
+            for (const auto& command : radio.commands()) {
+                if (command.kind == SimulatedRadio::CommandKind::kStopAdvertising) continue;
+                if (!command.accepted) continue;
+                on_air.push_back(std::chrono::duration<double, std::milli>(command.onAir - command.at).count());
+            }
+            if (!on_air.empty()) {
+                std::sort(on_air.begin(), on_air.end());
+                double sum = 0;
+                for (double value : on_air) sum += value;
+                state.counters["on_air_ms"] = sum / static_cast<double>(on_air.size());
+                state.counters["on_air_p99_ms"] = on_air[on_air.size() * 99 / 100];
+            }
+        }
+        BENCHMARK(BM_AdvertisingUpdateLatency)->ArgName("in_place")->Arg(0)->Arg(1);
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,71 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "allocation_counter.h"
+#include "gatt_server.h"
+#include "loopback_gatt_transport.h"
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        // Notification fan-out over the loopback transport: one value to
+        // range(0) subscribers per iteration, range(1) bytes each. Inboxes are
+        // drained every iteration, so the numbers are the server's and the
+        // transport's queueing cost.
+        void BM_NotifyFanOut(benchmark::State& state) {
+            const auto clients = static_cast<GattClientId>(state.range(0));
+            const auto size = static_cast<size_t>(state.range(1));
+
+            LoopbackGattTransport transport;
+            GattServer server(transport);
+            GattService service;
+            service.uuid = *ParseBluetoothUuid("8ebdb2f3-7817-45c9-95c5-c5e9031aaa47");
+            service.characteristics.push_back(
+                { *ParseBluetoothUuid("08590F7E-DB05-467E-8757-72F6FAEB13D4"), kGattRead | kGattNotify, {} });
+            server.AddService(service);
+            const GattHandle tx = service.characteristics[0].handle;
+            for (GattClientId client = 1; client <= clients; ++client) {
+                server.OnClientConnected(client);
+                server.OnSubscriptionChanged(client, tx, GattSubscription::kNotify);
+                transport.inboxes[client].reserve(1);
+            }
+
+            const SharedBuffer payload = SharedBuffer::CopyFrom(std::vector<uint8_t>(size, 0x5A));
+            AllocationScope allocations(state);
+            for (auto _ : state) {
+                benchmark::DoNotOptimize(server.Notify(tx, payload));
+                for (auto& inbox : transport.inboxes) inbox.second.clear();
+            }
+            state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(clients));
+            state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(clients * size));
+        }
+        BENCHMARK(BM_NotifyFanOut)
+            ->ArgNames({"clients", "bytes"})
+            ->Args({1, 20})
+            ->Args({1, 244})
+            ->Args({8, 244})
+            ->Args({64, 244});
+
+        // The same fan-out copying the value for every client, as a stack
+        // that takes ownership of a byte array per call would.
+        void BM_NotifyFanOut_Copying(benchmark::State& state) {
+            const auto clients = static_cast<size_t>(state.range(0));
+            const std::vector<uint8_t> payload(static_cast<size_t>(state.range(1)), 0x5A);
+            std::vector<std::vector<uint8_t>> inboxes(clients);
+            AllocationScope allocations(state);
+            for (auto _ : state) {
+                for (auto& inbox : inboxes) inbox = payload;
+                benchmark::DoNotOptimize(inboxes.data());
+                for (auto& inbox : inboxes) inbox = std::vector<uint8_t>();
+            }
+            state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(clients));
+            state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(clients * payload.size()));
+        }
+        BENCHMARK(BM_NotifyFanOut_Copying)
+            ->ArgNames({"clients", "bytes"})
+            ->Args({8, 244})
+            ->Args({64, 244});
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
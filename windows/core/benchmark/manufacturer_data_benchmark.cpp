@@ -0,0 +1,82 @@
+#include <benchmark/benchmark.h>
+
+#include <variant>
+
+#include "allocation_counter.h"
+#include "method_arguments.h"
+#include "scan_result.h"
+#include "test_value.h"
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        TestMap StartArguments(size_t payload_size) {
+            return TestMap{
+                {std::string("manufacturerId"), int32_t{1234}},
+                {std::string("manufacturerDataBytes"), std::vector<uint8_t>(payload_size, 0xAB)},
+            };
+        }
+
+        // The start path before SharedBuffer: decode into a vector, keep a
+        // copy in the core, then stream the bytes through a growing writer
+        // (DataWriter) and detach its buffer for the publisher.
+        void BM_StartPath_Copying(benchmark::State& state) {
+            TestMap arguments = StartArguments(static_cast<size_t>(state.range(0)));
+            const TestValue* value = FindArgument(arguments, "manufacturerDataBytes");
+            AllocationScope allocations(state);
+            for (auto _ : state) {
+                std::vector<uint8_t> decoded = std::get<std::vector<uint8_t>>(*value);
+                std::vector<uint8_t> stored = decoded;
+                std::vector<uint8_t> writer;
+                for (uint8_t byte : stored) writer.push_back(byte);
+                std::vector<uint8_t> detached = std::move(writer);
+                benchmark::DoNotOptimize(detached.data());
+            }
+        }
+        BENCHMARK(BM_StartPath_Copying)->Arg(8)->Arg(24)->Arg(200);
+
+        // The same hops with SharedBuffer: one copy out of the method call,
+        // after which the core and the publisher share the storage.
+        void BM_StartPath_Shared(benchmark::State& state) {
+            TestMap arguments = StartArguments(static_cast<size_t>(state.range(0)));
+            const TestValue* value = FindArgument(arguments, "manufacturerDataBytes");
+            AllocationScope allocations(state);
+            for (auto _ : state) {
+                SharedBuffer decoded = SharedBuffer::CopyFrom(*GetBytes(value));
+                SharedBuffer stored = decoded;
+                SharedBuffer published = stored;
+                benchmark::DoNotOptimize(published.data());
+            }
+        }
+        BENCHMARK(BM_StartPath_Shared)->Arg(8)->Arg(24)->Arg(200);
+
+        // The receive path before WriteManufacturerSpecificData: read the
+        // IBuffer into a vector, build the prefix vector, then append.
+        void BM_ReceivePath_Copying(benchmark::State& state) {
+            const std::vector<uint8_t> payload(static_cast<size_t>(state.range(0)), 0x42);
+            const uint16_t company_id = 0x004C;
+            AllocationScope allocations(state);
+            for (auto _ : state) {
+                std::vector<uint8_t> data(payload.begin(), payload.end());
+                const auto* prefix = reinterpret_cast<const uint8_t*>(&company_id);
+                std::vector<uint8_t> result{ prefix, prefix + sizeof(company_id) };
+                result.insert(result.end(), data.begin(), data.end());
+                benchmark::DoNotOptimize(result.data());
+            }
+        }
+        BENCHMARK(BM_ReceivePath_Copying)->Arg(8)->Arg(24)->Arg(200);
+
+        void BM_ReceivePath_Presized(benchmark::State& state) {
+            const std::vector<uint8_t> payload(static_cast<size_t>(state.range(0)), 0x42);
+            ScanResult result;
+            result.manufacturerData.push_back({0x004C, payload});
+            AllocationScope allocations(state);
+            for (auto _ : state) {
+                auto bytes = ManufacturerSpecificData(result);
+                benchmark::DoNotOptimize(bytes.data());
+            }
+        }
+        BENCHMARK(BM_ReceivePath_Presized)->Arg(8)->Arg(24)->Arg(200);
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,102 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include "allocation_counter.h"
+#include "manufacturer_pattern_set.h"
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        constexpr size_t kRecords = 1024;
+
+        // |count| iBeacon identities: four UUIDs, each with a run of majors
+        // and minors. Prefixes stop before the TX power byte.
+        std::vector<ManufacturerDataPattern> BeaconPatterns(size_t count) {
+            std::mt19937 random(11);
+            std::vector<ManufacturerDataPattern> patterns;
+            for (size_t i = 0; i < count; ++i) {
+                std::vector<uint8_t> prefix = { 0x02, 0x15 };
+                for (uint8_t b = 0; b < 16; ++b) prefix.push_back(static_cast<uint8_t>(0xA0 + b + (i % 4)));
+                const auto major = static_cast<uint16_t>(random());
+                const auto minor = static_cast<uint16_t>(random());
+                prefix.insert(prefix.end(), { static_cast<uint8_t>(major >> 8), static_cast<uint8_t>(major),
+                                              static_cast<uint8_t>(minor >> 8), static_cast<uint8_t>(minor) });
+                patterns.push_back({ 0x004C, prefix, {} });
+            }
+            return patterns;
+        }
+
+        // What a kiosk hears: one in eight records is a tracked identity,
+        // the rest are other beacons of the same UUIDs.
+        std::vector<std::vector<uint8_t>> BeaconRecords(const std::vector<ManufacturerDataPattern>& patterns) {
+            std::mt19937 random(5);
+            std::vector<std::vector<uint8_t>> records;
+            for (size_t i = 0; i < kRecords; ++i) {
+                std::vector<uint8_t> record = { 0x4C, 0x00 };
+                const auto& pattern = patterns[random() % patterns.size()];
+                record.insert(record.end(), pattern.prefix.begin(), pattern.prefix.end());
+                if (random() % 8 != 0) record[record.size() - 1] ^= static_cast<uint8_t>(1 + random() % 255);
+                record.push_back(0xC5);
+                records.push_back(std::move(record));
+            }
+            return records;
+        }
+
+        // The matcher before the pattern set: a byte loop over every
+        // pattern of the record's company.
+        bool MatchLinear(const std::vector<ManufacturerDataPattern>& patterns, const std::vector<uint8_t>& record) {
+            const uint16_t company = static_cast<uint16_t>(record[0] | record[1] << 8);
+            for (const auto& pattern : patterns) {
+                if (pattern.companyId != company || record.size() < 2 + pattern.prefix.size()) continue;
+                size_t i = 0;
+                while (i < pattern.prefix.size() && record[2 + i] == pattern.prefix[i]) ++i;
+                if (i == pattern.prefix.size()) return true;
+            }
+            return false;
+        }
+
+        void BM_PatternMatch_Linear(benchmark::State& state) {
+            const auto patterns = BeaconPatterns(static_cast<size_t>(state.range(0)));
+            const auto records = BeaconRecords(patterns);
+            size_t index = 0;
+            size_t matched = 0;
+            AllocationScope allocations(state);
+            for (auto _ : state) {
+                matched += MatchLinear(patterns, records[index++ % kRecords]);
+            }
+            benchmark::DoNotOptimize(matched);
+        }
+        BENCHMARK(BM_PatternMatch_Linear)->ArgName("patterns")->Arg(16)->Arg(1000)->Arg(10000);
+
+        // One record per iteration against the set, at SIMD level
+        // range(1) (clamped to the CPU) with the bucket index on or off.
+        void BM_PatternMatch_Set(benchmark::State& state) {
+            const auto patterns = BeaconPatterns(static_cast<size_t>(state.range(0)));
+            const auto records = BeaconRecords(patterns);
+            ManufacturerPatternSetOptions options;
+            options.simdLevel = static_cast<SimdLevel>(state.range(1));
+            options.bucketIndex = state.range(2) != 0;
+            const auto set = *ManufacturerPatternSet::Compile(patterns, options);
+            state.SetLabel(SimdLevelName(set.simd_level()));
+            size_t index = 0;
+            size_t matched = 0;
+            {
+                // Closed before the counters below, whose map insert would
+                // count as an allocation.
+                AllocationScope allocations(state);
+                for (auto _ : state) {
+                    matched += set.MatchesAny(records[index++ % kRecords]);
+                }
+            }
+            benchmark::DoNotOptimize(matched);
+            state.counters["match_rate"] =
+                benchmark::Counter(static_cast<double>(matched) / static_cast<double>(state.iterations()));
+        }
+        BENCHMARK(BM_PatternMatch_Set)
+            ->ArgNames({ "patterns", "simd", "index" })
+            ->ArgsProduct({ { 16, 1000, 10000 }, { 0, 1, 2 }, { 0, 1 } });
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
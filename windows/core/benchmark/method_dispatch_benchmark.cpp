@@ -0,0 +1,86 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "allocation_counter.h"
+#include "method_arguments.h"
+#include "method_dispatch.h"
+#include "test_value.h"
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        // The names a session typically sends, copied into std::strings the
+        // way MethodCall::method_name() hands them over.
+        std::vector<std::string> CallNames() {
+            std::vector<std::string> names;
+            for (auto name : kMethodNames) names.emplace_back(name);
+            names.emplace_back("enableBluetooth");
+            return names;
+        }
+
+        // The dispatch before the table: compare() against each name in turn.
+        int CompareChain(const std::string& name) {
+            int index = 0;
+            for (auto candidate : kMethodNames) {
+                if (name.compare(0, std::string::npos, candidate.data(), candidate.size()) == 0) return index;
+                ++index;
+            }
+            return -1;
+        }
+
+        void BM_Dispatch_CompareChain(benchmark::State& state) {
+            auto names = CallNames();
+            size_t next = 0;
+            for (auto _ : state) {
+                benchmark::DoNotOptimize(CompareChain(names[next]));
+                if (++next == names.size()) next = 0;
+            }
+        }
+        BENCHMARK(BM_Dispatch_CompareChain);
+
+        void BM_Dispatch_PerfectHash(benchmark::State& state) {
+            auto names = CallNames();
+            size_t next = 0;
+            for (auto _ : state) {
+                benchmark::DoNotOptimize(FindMethod(names[next]));
+                if (++next == names.size()) next = 0;
+            }
+        }
+        BENCHMARK(BM_Dispatch_PerfectHash);
+
+        TestMap StartArguments() {
+            TestMap arguments;
+            for (auto name : kArgumentNames) arguments.emplace(std::string(name), std::monostate());
+            arguments[std::string("manufacturerDataBytes")] = std::vector<uint8_t>{1, 2, 3, 4};
+            arguments[std::string("localName")] = std::string("peripheral");
+            return arguments;
+        }
+
+        // A full "start" decode, looking keys up by name.
+        void BM_DecodeStart_TemporaryKeys(benchmark::State& state) {
+            TestMap arguments = StartArguments();
+            AllocationScope allocations(state);
+            for (auto _ : state) {
+                // The names view whole literals, so data() is null-terminated.
+                for (auto name : kArgumentNames) {
+                    benchmark::DoNotOptimize(FindArgument(arguments, name.data()));
+                }
+            }
+        }
+        BENCHMARK(BM_DecodeStart_TemporaryKeys);
+
+        void BM_DecodeStart_InternedKeys(benchmark::State& state) {
+            TestMap arguments = StartArguments();
+            AllocationScope allocations(state);
+            for (auto _ : state) {
+                for (size_t i = 0; i < kArgumentCount; ++i) {
+                    benchmark::DoNotOptimize(FindArgument(arguments, static_cast<Argument>(i)));
+                }
+            }
+        }
+        BENCHMARK(BM_DecodeStart_InternedKeys);
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
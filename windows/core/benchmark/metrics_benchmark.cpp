@@ -0,0 +1,65 @@
+#include <benchmark/benchmark.h>
+
+#include "allocation_counter.h"
+#include "clock.h"
+#include "metrics.h"
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        // What instrumenting a hot path costs, from as many threads as the
+        // plugin has callback threads. Threads beyond Metrics::kStripes would
+        // start sharing cache lines.
+        Metrics& SharedMetrics() {
+            static SteadyClock clock;
+            static Metrics metrics(clock);
+            return metrics;
+        }
+
+        void BM_CounterAdd(benchmark::State& state) {
+            auto& metrics = SharedMetrics();
+            AllocationScope allocations(state);
+            for (auto _ : state) {
+                metrics.Add(MetricCounter::kScanReceived);
+            }
+            state.SetItemsProcessed(state.iterations());
+        }
+        BENCHMARK(BM_CounterAdd)->Threads(1)->Threads(4);
+
+        void BM_RecordLatency(benchmark::State& state) {
+            auto& metrics = SharedMetrics();
+            int64_t nanos = 0;
+            metrics.Record(MetricLatency::kCallbackToSink, std::chrono::nanoseconds(0));
+            AllocationScope allocations(state);
+            for (auto _ : state) {
+                metrics.Record(MetricLatency::kCallbackToSink, std::chrono::nanoseconds(nanos));
+                nanos = (nanos + 7919) & 0xFFFFF;
+            }
+            state.SetItemsProcessed(state.iterations());
+        }
+        BENCHMARK(BM_RecordLatency)->Threads(1)->Threads(4);
+
+        // A MethodTimer around nothing: two steady clock reads and a record.
+        void BM_MethodTimer(benchmark::State& state) {
+            auto& metrics = SharedMetrics();
+            for (auto _ : state) {
+                MethodTimer timer(metrics, Method::kIsAdvertising);
+            }
+            state.SetItemsProcessed(state.iterations());
+        }
+        BENCHMARK(BM_MethodTimer);
+
+        // One getMetrics call, or one tick of the metrics stream.
+        void BM_Collect(benchmark::State& state) {
+            auto& metrics = SharedMetrics();
+            for (size_t method = 0; method < kMethodCount; ++method) {
+                metrics.RecordMethod(static_cast<Method>(method), std::chrono::microseconds(20));
+            }
+            for (auto _ : state) {
+                benchmark::DoNotOptimize(metrics.Collect());
+            }
+        }
+        BENCHMARK(BM_Collect);
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,138 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "allocation_counter.h"
+#include "rssi_history.h"
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        constexpr uint64_t kFirstAddress = 0xC0FFEE000000ull;
+
+        // A busy room: |devices| advertisers at 10 Hz with noisy RSSI.
+        RssiHistory FilledHistory(size_t devices, size_t samples_per_device, SimdLevel level) {
+            RssiHistoryOptions options;
+            options.maxDevices = devices;
+            options.samplesPerDevice = samples_per_device;
+            options.simdLevel = level;
+            RssiHistory history(options);
+            std::mt19937 random(4);
+            for (size_t i = 0; i < samples_per_device; ++i) {
+                for (uint64_t device = 0; device < devices; ++device) {
+                    history.Record(kFirstAddress + device, std::chrono::milliseconds(i * 100 + device % 100),
+                                   static_cast<int16_t>(-50 - static_cast<int>(device % 40) - static_cast<int>(random() % 12)),
+                                   static_cast<int8_t>(-8));
+                }
+            }
+            return history;
+        }
+
+        void BM_RssiRecord(benchmark::State& state) {
+            const auto devices = static_cast<uint64_t>(state.range(0));
+            RssiHistoryOptions options;
+            options.maxDevices = static_cast<size_t>(devices);
+            options.samplesPerDevice = 1024;
+            RssiHistory history(options);
+            uint64_t device = 0;
+            int64_t ms = 0;
+            AllocationScope allocations(state);
+            for (auto _ : state) {
+                history.Record(kFirstAddress + device, std::chrono::milliseconds(ms),
+                               static_cast<int16_t>(-40 - static_cast<int64_t>(device % 50)));
+                if (++device == devices) {
+                    device = 0;
+                    ++ms;
+                }
+            }
+            state.SetItemsProcessed(state.iterations());
+        }
+        BENCHMARK(BM_RssiRecord)->ArgName("devices")->Arg(16)->Arg(1024);
+
+        // Statistics for every device of a room holding range(0) x range(1)
+        // samples, about a million to four million, at SIMD level range(2)
+        // (clamped to the CPU).
+        void BM_RssiQueryRoom(benchmark::State& state) {
+            const auto devices = static_cast<size_t>(state.range(0));
+            const auto samples = static_cast<size_t>(state.range(1));
+            const auto history = FilledHistory(devices, samples, static_cast<SimdLevel>(state.range(2)));
+            state.SetLabel(SimdLevelName(history.simd_level()));
+            AllocationScope allocations(state);
+            for (auto _ : state) {
+                for (uint64_t device = 0; device < devices; ++device) {
+                    benchmark::DoNotOptimize(history.Query(kFirstAddress + device));
+                }
+            }
+            state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(devices * samples));
+        }
+        BENCHMARK(BM_RssiQueryRoom)
+            ->ArgNames({ "devices", "samples", "simd" })
+            ->ArgsProduct({ { 256 }, { 4096, 16384 }, { 0, 1, 2 } })
+            ->Unit(benchmark::kMillisecond);
+
+        // A short window of one device, as a proximity UI polls it.
+        void BM_RssiQueryWindow(benchmark::State& state) {
+            const auto history = FilledHistory(64, 4096, DetectSimdLevel());
+            const RssiWindow window{ static_cast<size_t>(state.range(0)), std::chrono::microseconds(0) };
+            AllocationScope allocations(state);
+            for (auto _ : state) {
+                benchmark::DoNotOptimize(history.Query(kFirstAddress + 17, window));
+            }
+        }
+        BENCHMARK(BM_RssiQueryWindow)->ArgName("window")->Arg(16)->Arg(256)->Arg(4096);
+
+        // What Dart does without the history: every raw event kept as an
+        // object, and each query copying the window to sort it.
+        struct Sample {
+            int64_t timestamp;
+            int16_t rssi;
+            int8_t txPower;
+        };
+
+        void BM_RssiQueryRoom_ArrayOfStructs(benchmark::State& state) {
+            const auto devices = static_cast<size_t>(state.range(0));
+            const auto samples = static_cast<size_t>(state.range(1));
+            std::vector<std::vector<Sample>> history(devices);
+            std::mt19937 random(4);
+            for (size_t i = 0; i < samples; ++i) {
+                for (size_t device = 0; device < devices; ++device) {
+                    history[device].push_back({ static_cast<int64_t>(i * 100000 + device % 100),
+                                                static_cast<int16_t>(-50 - static_cast<int>(device % 40) -
+                                                                     static_cast<int>(random() % 12)),
+                                                -8 });
+                }
+            }
+            std::vector<int16_t> sorted;
+            for (auto _ : state) {
+                for (const auto& device : history) {
+                    int64_t sum = 0;
+                    int64_t squares = 0;
+                    sorted.clear();
+                    for (const Sample& sample : device) {
+                        sum += sample.rssi;
+                        squares += sample.rssi * sample.rssi;
+                        sorted.push_back(sample.rssi);
+                    }
+                    std::sort(sorted.begin(), sorted.end());
+                    const double mean = static_cast<double>(sum) / static_cast<double>(device.size());
+                    benchmark::DoNotOptimize(mean);
+                    benchmark::DoNotOptimize(
+                        std::sqrt(static_cast<double>(squares) / static_cast<double>(device.size()) - mean * mean));
+                    benchmark::DoNotOptimize(sorted[sorted.size() / 10]);
+                    benchmark::DoNotOptimize(sorted[sorted.size() / 2]);
+                    benchmark::DoNotOptimize(sorted[sorted.size() * 9 / 10]);
+                }
+            }
+            state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(devices * samples));
+        }
+        BENCHMARK(BM_RssiQueryRoom_ArrayOfStructs)
+            ->ArgNames({ "devices", "samples" })
+            ->Args({ 256, 4096 })
+            ->Args({ 256, 16384 })
+            ->Unit(benchmark::kMillisecond);
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,63 @@
+#include <benchmark/benchmark.h>
+
+#include "scan_batcher.h"
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        const std::vector<uint8_t> kAdvertisementData = {
+            0x02, 0x01, 0x06, 0x0B, 0xFF, 0x4C, 0x00, 1, 2, 3, 4, 5, 6, 7, 8, 9,
+        };
+
+        // A dense room: 200 advertisers, each heard every 10 ms, for one
+        // simulated second per iteration. Reports how many sink calls (platform
+        // thread hops) that second costs.
+        void BM_DenseRoom(benchmark::State& state) {
+            const bool batching = state.range(0) != 0;
+            ScanBatchOptions options;
+            options.flushInterval = std::chrono::milliseconds(100);
+            options.maxBatchSize = 1024;
+            options.coalesce = state.range(1) != 0;
+            ScanBatcher batcher(options, 4096);
+
+            ScanResult result;
+            result.advertisementData = kAdvertisementData;
+            int64_t sink_calls = 0;
+            int64_t entries = 0;
+            for (auto _ : state) {
+                for (int64_t ms = 0; ms < 1000; ms += 10) {
+                    const auto now = std::chrono::milliseconds(ms);
+                    for (uint64_t device = 0; device < 200; ++device) {
+                        result.address = device;
+                        result.rssi = static_cast<int16_t>(-40 - (device + static_cast<uint64_t>(ms)) % 50);
+                        if (!batching) {
+                            ScanEvent event;
+                            event.Assign(result);
+                            benchmark::DoNotOptimize(event);
+                            ++sink_calls;
+                            ++entries;
+                            continue;
+                        }
+                        batcher.Push(result);
+                    }
+                    if (batching && batcher.FlushDue(now)) {
+                        entries += static_cast<int64_t>(batcher.Flush(now).size());
+                        ++sink_calls;
+                    }
+                }
+            }
+            state.counters["sink_calls/s"] =
+                benchmark::Counter(static_cast<double>(sink_calls), benchmark::Counter::kAvgIterations);
+            state.counters["entries/s"] =
+                benchmark::Counter(static_cast<double>(entries), benchmark::Counter::kAvgIterations);
+            state.counters["dropped"] = static_cast<double>(batcher.dropped());
+            state.SetItemsProcessed(state.iterations() * 200 * 100);
+        }
+        BENCHMARK(BM_DenseRoom)
+            ->ArgNames({"batching", "coalesce"})
+            ->Args({0, 0})
+            ->Args({1, 0})
+            ->Args({1, 1});
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,73 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include "allocation_counter.h"
+#include "scan_filter.h"
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        constexpr size_t kAdvertisements = 1024;
+
+        // A mix like a busy scan: mostly phones and trackers from a handful
+        // of companies, a few named devices and the occasional match.
+        std::vector<std::vector<uint8_t>> MakeAdvertisements() {
+            std::mt19937 random(7);
+            const uint16_t companies[] = { 0x004C, 0x0006, 0x0075, 0x00E0, 0x0059 };
+            std::vector<std::vector<uint8_t>> advertisements;
+            for (size_t i = 0; i < kAdvertisements; ++i) {
+                std::vector<uint8_t> data = { 0x02, kAdFlags, 0x06 };
+                if (random() % 3 == 0) {
+                    data.insert(data.end(), { 0x05, kAdCompleteUuid16List, 0x6F, 0xFD, 0x0F, 0x18 });
+                }
+                const uint16_t company = companies[random() % 5];
+                data.insert(data.end(), { 0x0B, kAdManufacturerSpecificData, static_cast<uint8_t>(company),
+                                          static_cast<uint8_t>(company >> 8) });
+                for (int b = 0; b < 8; ++b) data.push_back(static_cast<uint8_t>(random()));
+                if (random() % 4 == 0) {
+                    data.insert(data.end(), { 0x06, kAdCompleteLocalName, 'S', 'e', 'n', 's', static_cast<uint8_t>('0' + random() % 10) });
+                }
+                advertisements.push_back(std::move(data));
+            }
+            return advertisements;
+        }
+
+        ScanFilterSpec Spec(int complexity) {
+            ScanFilterSpec spec;
+            spec.minRssi = -90;
+            if (complexity >= 1) spec.companyIds = { 0x0059, 0x00E0 };
+            if (complexity >= 2) spec.manufacturerData = { { 0x0059, { 0x10, 0x00 }, { 0xF0, 0x00 } },
+                                                           { 0x00E0, { 0x01 }, {} } };
+            if (complexity >= 3) spec.serviceUuids = { *ParseBluetoothUuid("FD6F"), *ParseBluetoothUuid("180F") };
+            if (complexity >= 4) spec.namePrefixes = { "Sens", "Lamp", "Tag" };
+            return spec;
+        }
+
+        // Filters a fixed mix of advertisements; ns per advertisement is the
+        // time per iteration. Complexity 0 is the RSSI threshold alone, each
+        // step adds a criterion.
+        void BM_ScanFilter(benchmark::State& state) {
+            const auto advertisements = MakeAdvertisements();
+            const ScanFilter filter = *ScanFilter::Compile(Spec(static_cast<int>(state.range(0))));
+            size_t index = 0;
+            size_t passed = 0;
+
+            {
+                // Closed before the counters below, whose map insert would
+                // count as an allocation.
+                AllocationScope allocations(state);
+                for (auto _ : state) {
+                    const auto& data = advertisements[index++ % kAdvertisements];
+                    passed += filter.Matches(-60, data);
+                }
+            }
+            benchmark::DoNotOptimize(passed);
+            state.counters["pass_rate"] =
+                benchmark::Counter(static_cast<double>(passed) / static_cast<double>(state.iterations()));
+        }
+        BENCHMARK(BM_ScanFilter)->ArgName("criteria")->DenseRange(0, 4);
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,66 @@
+#include <benchmark/benchmark.h>
+
+#include "scan_record_codec.h"
+#include "scan_result.h"
+#include "test_value.h"
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        // A typical iBeacon-sized advertisement.
+        const std::vector<uint8_t> kAdvertisementData = [] {
+            std::vector<uint8_t> ad = {0x02, 0x01, 0x06, 0x1A, 0xFF, 0x4C, 0x00};
+            ad.resize(ad.size() + 24, 0x42);
+            return ad;
+        }();
+
+        ScanResult MakeResult(uint64_t address) {
+            ScanResult result;
+            result.address = address;
+            result.rssi = -67;
+            result.flags = kConnectable;
+            result.timestamp = std::chrono::microseconds(1700000000000000);
+            result.manufacturerData.push_back(
+                {0x004C, ByteView(kAdvertisementData).subview(7)});
+            result.advertisementData = kAdvertisementData;
+            return result;
+        }
+
+        // The existing path: one string-keyed map per advertisement. Codec
+        // serialization is not included, which flatters this side.
+        void BM_ScanResults_Map(benchmark::State& state) {
+            std::vector<ScanResult> results;
+            for (uint64_t i = 0; i < 64; ++i) results.push_back(MakeResult(0xA1B2C3D4E500 + i));
+            for (auto _ : state) {
+                for (const auto& result : results) {
+                    TestMap map{
+                        {std::string("deviceName"), DeviceName(result)},
+                        {std::string("address"), AddressString(result.address)},
+                        {std::string("manufacturerSpecificData"), ManufacturerSpecificData(result)},
+                        {std::string("rssi"), static_cast<int32_t>(result.rssi)},
+                    };
+                    benchmark::DoNotOptimize(map);
+                }
+            }
+            state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(results.size()));
+        }
+        BENCHMARK(BM_ScanResults_Map);
+
+        void BM_ScanResults_Binary(benchmark::State& state) {
+            std::vector<ScanResult> results;
+            for (uint64_t i = 0; i < 64; ++i) results.push_back(MakeResult(0xA1B2C3D4E500 + i));
+            ScanRecordWriter writer;
+            for (auto _ : state) {
+                writer.Reset();
+                for (const auto& result : results) {
+                    writer.Append(result);
+                }
+                benchmark::DoNotOptimize(writer.data().data());
+            }
+            state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(results.size()));
+            state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(writer.data().size()));
+        }
+        BENCHMARK(BM_ScanResults_Binary);
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,30 @@
+#include <benchmark/benchmark.h>
+
+#include "scan_result.h"
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        const std::vector<uint8_t> kPayload(23, 0x42);
+
+        ScanResult MakeResult(bool with_name) {
+            ScanResult result;
+            result.address = 0xA1B2C3D4E5F6;
+            result.rssi = -67;
+            if (with_name) result.localName = "beacon";
+            result.manufacturerData.push_back({0x004C, kPayload});
+            return result;
+        }
+
+        void BM_ShapeScanResult(benchmark::State& state) {
+            ScanResult result = MakeResult(state.range(0) != 0);
+            for (auto _ : state) {
+                benchmark::DoNotOptimize(DeviceName(result));
+                benchmark::DoNotOptimize(AddressString(result.address));
+                benchmark::DoNotOptimize(ManufacturerSpecificData(result));
+            }
+        }
+        BENCHMARK(BM_ShapeScanResult)->Arg(0)->Arg(1);
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,65 @@
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <vector>
+
+#include "allocation_counter.h"
+#include "buffer_pool.h"
+#include "write_assembler.h"
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        constexpr size_t kMtu = 247;
+        constexpr size_t kFragment = kMtu - kAttPrepareWriteHeaderSize;
+
+        std::vector<uint8_t> Message(size_t size) {
+            std::vector<uint8_t> bytes(size);
+            for (size_t i = 0; i < size; ++i) bytes[i] = static_cast<uint8_t>(i);
+            return bytes;
+        }
+
+        // One message per iteration, written as a long write of full
+        // fragments, executed and delivered as a pooled SharedBuffer.
+        void BM_ReassembleLongWrite(benchmark::State& state) {
+            const auto message = Message(static_cast<size_t>(state.range(0)));
+            const ByteView view(message);
+            BufferPool pool;
+            WriteAssembler assembler(pool, WriteAssemblerOptions{ 1 << 20, std::chrono::seconds(5), 16 });
+            std::chrono::nanoseconds now{ 0 };
+
+            AllocationScope allocations(state);
+            for (auto _ : state) {
+                for (size_t offset = 0; offset < view.size(); offset += kFragment) {
+                    assembler.Append(1, 2, GattWriteKind::kPrepare, offset, view.subview(offset, kFragment), now);
+                }
+                auto result = assembler.Append(1, 2, GattWriteKind::kExecute, 0, ByteView(), now);
+                benchmark::DoNotOptimize(result.message.data());
+                now += std::chrono::milliseconds(1);
+            }
+            state.SetBytesProcessed(state.iterations() * state.range(0));
+        }
+        BENCHMARK(BM_ReassembleLongWrite)->Arg(512)->Arg(4096)->Arg(65536);
+
+        // The straightforward version: a fresh vector per message, copied
+        // into a SharedBuffer for delivery.
+        void BM_ReassembleLongWrite_Vector(benchmark::State& state) {
+            const auto message = Message(static_cast<size_t>(state.range(0)));
+            const ByteView view(message);
+
+            AllocationScope allocations(state);
+            for (auto _ : state) {
+                std::vector<uint8_t> assembly;
+                for (size_t offset = 0; offset < view.size(); offset += kFragment) {
+                    auto fragment = view.subview(offset, kFragment);
+                    assembly.insert(assembly.end(), fragment.begin(), fragment.end());
+                }
+                auto delivered = SharedBuffer::CopyFrom(assembly);
+                benchmark::DoNotOptimize(delivered.data());
+            }
+            state.SetBytesProcessed(state.iterations() * state.range(0));
+        }
+        BENCHMARK(BM_ReassembleLongWrite_Vector)->Arg(512)->Arg(4096)->Arg(65536);
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,76 @@
+#include "buffer_pool.h"
+
+#include <utility>
+
+namespace flutter_ble_peripheral {
+
+    namespace {
+
+        // Smallest class whose capacity holds |size|.
+        size_t ClassFor(size_t size) {
+            size_t bits = BufferPool::kMinClass;
+            while (bits < BufferPool::kMaxClass && (size_t{ 1 } << bits) < size) ++bits;
+            return bits;
+        }
+
+    }  // namespace
+
+    BufferPool::BufferPool(size_t max_cached_per_class) : free_lists_(std::make_shared<FreeLists>()) {
+        free_lists_->max_cached_per_class = max_cached_per_class;
+    }
+
+    PooledBytes BufferPool::Acquire(size_t capacity) {
+        if (capacity > (size_t{ 1 } << kMaxClass)) return nullptr;
+        const size_t bits = ClassFor(capacity);
+        {
+            std::lock_guard<std::mutex> lock(free_lists_->mutex);
+            auto& cached = free_lists_->classes[bits - kMinClass];
+            if (!cached.empty()) {
+                PooledBytes bytes = std::move(cached.back());
+                cached.pop_back();
+                ++free_lists_->stats.reuses;
+                return bytes;
+            }
+            ++free_lists_->stats.allocations;
+        }
+        auto bytes = std::make_unique<std::vector<uint8_t>>();
+        bytes->reserve(size_t{ 1 } << bits);
+        return bytes;
+    }
+
+    void BufferPool::Release(PooledBytes bytes) { free_lists_->Release(std::move(bytes)); }
+
+    SharedBuffer BufferPool::Share(PooledBytes bytes) {
+        if (!bytes) return SharedBuffer();
+        auto* raw = bytes.release();
+        return SharedBuffer::Adopt(std::shared_ptr<const std::vector<uint8_t>>(
+            raw, [free_lists = free_lists_](const std::vector<uint8_t>* shared) {
+                // The pool handed out a mutable vector; it is only const
+                // while shared.
+                free_lists->Release(PooledBytes(const_cast<std::vector<uint8_t>*>(shared)));
+            }));
+    }
+
+    BufferPool::Stats BufferPool::stats() const {
+        std::lock_guard<std::mutex> lock(free_lists_->mutex);
+        Stats stats = free_lists_->stats;
+        stats.cached = 0;
+        for (const auto& cached : free_lists_->classes) stats.cached += cached.size();
+        return stats;
+    }
+
+    void BufferPool::FreeLists::Release(PooledBytes bytes) {
+        if (!bytes) return;
+        const size_t capacity = bytes->capacity();
+        if (capacity < (size_t{ 1 } << kMinClass)) return;
+        // The largest class the capacity fully covers.
+        size_t bits = kMinClass;
+        while (bits < kMaxClass && (size_t{ 1 } << (bits + 1)) <= capacity) ++bits;
+        bytes->clear();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& cached = classes[bits - kMinClass];
+        if (cached.size() < max_cached_per_class) cached.push_back(std::move(bytes));
+    }
+
+}  // namespace flutter_ble_peripheral
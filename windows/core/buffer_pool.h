@@ -0,0 +1,72 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_BUFFER_POOL_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_BUFFER_POOL_H_
+
+#include "byte_buffer.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+
+    using PooledBytes = std::unique_ptr<std::vector<uint8_t>>;
+
+    // Recycles byte vectors in power-of-two capacity classes, so assembling
+    // a message of a size seen before allocates nothing.
+    //
+    // Thread-safe: buffers are typically filled on one thread and, once
+    // shared, released on another. A SharedBuffer from Share keeps the pool's
+    // free lists alive, so it may outlive the pool.
+    class BufferPool {
+    public:
+        // Capacities run from 1 << kMinClass to 1 << kMaxClass bytes.
+        static constexpr size_t kMinClass = 8;
+        static constexpr size_t kMaxClass = 24;
+
+        struct Stats {
+            // Vectors created because no cached one was large enough.
+            uint64_t allocations = 0;
+            uint64_t reuses = 0;
+            // Vectors waiting in the free lists.
+            size_t cached = 0;
+        };
+
+        // Keeps up to |max_cached_per_class| free vectors of each class.
+        explicit BufferPool(size_t max_cached_per_class = 8);
+
+        // Disallow copy and assign.
+        BufferPool(const BufferPool&) = delete;
+        BufferPool& operator=(const BufferPool&) = delete;
+
+        // An empty vector with room for at least |capacity| bytes, or null
+        // if that is above the largest class.
+        PooledBytes Acquire(size_t capacity);
+
+        // Returns |bytes| to its class; beyond the class's cache it is freed.
+        void Release(PooledBytes bytes);
+
+        // Hands |bytes| out as an immutable SharedBuffer that goes back to
+        // the pool when its last copy goes away.
+        SharedBuffer Share(PooledBytes bytes);
+
+        Stats stats() const;
+
+    private:
+        struct FreeLists {
+            void Release(PooledBytes bytes);
+
+            std::mutex mutex;
+            std::array<std::vector<PooledBytes>, kMaxClass - kMinClass + 1> classes;
+            size_t max_cached_per_class = 0;
+            Stats stats;
+        };
+
+        std::shared_ptr<FreeLists> free_lists_;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_BUFFER_POOL_H_
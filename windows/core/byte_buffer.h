@@ -0,0 +1,103 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_BYTE_BUFFER_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_BYTE_BUFFER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+
+    // Non-owning view over contiguous bytes, the C++17 stand-in for
+    // std::span<const uint8_t>. The viewed memory must outlive the view.
+    class ByteView {
+    public:
+        constexpr ByteView() = default;
+        constexpr ByteView(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+        ByteView(const std::vector<uint8_t>& bytes) : data_(bytes.data()), size_(bytes.size()) {}
+
+        constexpr const uint8_t* data() const { return data_; }
+        constexpr size_t size() const { return size_; }
+        constexpr bool empty() const { return size_ == 0; }
+        constexpr const uint8_t* begin() const { return data_; }
+        constexpr const uint8_t* end() const { return data_ + size_; }
+        constexpr uint8_t operator[](size_t index) const { return data_[index]; }
+
+        // Bytes [offset, offset + count), clamped to the end of the view.
+        constexpr ByteView subview(size_t offset, size_t count = static_cast<size_t>(-1)) const {
+            if (offset > size_) offset = size_;
+            size_t remaining = size_ - offset;
+            return ByteView(data_ + offset, count < remaining ? count : remaining);
+        }
+
+        std::vector<uint8_t> ToVector() const { return std::vector<uint8_t>(begin(), end()); }
+
+    private:
+        const uint8_t* data_ = nullptr;
+        size_t size_ = 0;
+    };
+
+    inline bool operator==(ByteView lhs, ByteView rhs) {
+        return lhs.size() == rhs.size() &&
+            (lhs.size() == 0 || std::memcmp(lhs.data(), rhs.data(), lhs.size()) == 0);
+    }
+
+    inline bool operator!=(ByteView lhs, ByteView rhs) { return !(lhs == rhs); }
+
+    // Immutable, reference-counted bytes. Copying a SharedBuffer shares the
+    // storage, so a payload decoded once can be held by the core and by the
+    // radio at the same time without further copies. Slices share it too.
+    class SharedBuffer {
+    public:
+        SharedBuffer() = default;
+
+        static SharedBuffer CopyFrom(ByteView bytes) {
+            SharedBuffer buffer;
+            if (!bytes.empty()) {
+                buffer.bytes_ = std::make_shared<const std::vector<uint8_t>>(bytes.begin(), bytes.end());
+                buffer.size_ = bytes.size();
+            }
+            return buffer;
+        }
+
+        // Shares |bytes| as they are. The deleter of |bytes| runs when the
+        // last copy or slice goes away, which lets pooled storage go back to
+        // its pool.
+        static SharedBuffer Adopt(std::shared_ptr<const std::vector<uint8_t>> bytes) {
+            SharedBuffer buffer;
+            if (bytes && !bytes->empty()) {
+                buffer.size_ = bytes->size();
+                buffer.bytes_ = std::move(bytes);
+            }
+            return buffer;
+        }
+
+        const uint8_t* data() const { return bytes_ ? bytes_->data() + offset_ : nullptr; }
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+        ByteView view() const { return ByteView(data(), size()); }
+        operator ByteView() const { return view(); }
+
+        // Bytes [offset, offset + count), clamped to the end, sharing this
+        // buffer's storage.
+        SharedBuffer Slice(size_t offset, size_t count = static_cast<size_t>(-1)) const {
+            if (offset > size_) offset = size_;
+            SharedBuffer slice;
+            slice.size_ = count < size_ - offset ? count : size_ - offset;
+            if (slice.size_ != 0) {
+                slice.bytes_ = bytes_;
+                slice.offset_ = offset_ + offset;
+            }
+            return slice;
+        }
+
+    private:
+        std::shared_ptr<const std::vector<uint8_t>> bytes_;
+        size_t offset_ = 0;
+        size_t size_ = 0;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_BYTE_BUFFER_H_
@@ -0,0 +1,33 @@
+#include "callback_guard.h"
+
+namespace flutter_ble_peripheral {
+
+    CallbackGuard::Scope CallbackGuard::Enter() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (shut_down_) return Scope(nullptr);
+        ++running_;
+        return Scope(this);
+    }
+
+    void CallbackGuard::Shutdown() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        shut_down_ = true;
+        idle_.wait(lock, [this] { return running_ == 0; });
+    }
+
+    bool CallbackGuard::shut_down() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return shut_down_;
+    }
+
+    size_t CallbackGuard::running() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return running_;
+    }
+
+    void CallbackGuard::Exit() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--running_ == 0 && shut_down_) idle_.notify_all();
+    }
+
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,72 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_CALLBACK_GUARD_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_CALLBACK_GUARD_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+namespace flutter_ble_peripheral {
+
+    // Lets callbacks on other threads run against an object until it shuts
+    // down, and lets the shutdown wait for the ones already running.
+    //
+    // Cancelling a thread-pool timer does not wait for a callback that has
+    // already started, so every callback that touches its owner enters the
+    // guard first and returns at once if that fails. The owner calls
+    // Shutdown before its members go away. Callbacks hold the guard through
+    // a shared_ptr, so one that only starts after the owner is gone still
+    // finds it.
+    class CallbackGuard {
+    public:
+        // Counts a callback as running for as long as it exists, if it
+        // entered.
+        class Scope {
+        public:
+            Scope(Scope&& other) noexcept : guard_(other.guard_) { other.guard_ = nullptr; }
+            ~Scope() {
+                if (guard_) guard_->Exit();
+            }
+
+            // Disallow copy and assign.
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+            Scope& operator=(Scope&&) = delete;
+
+            // False once Shutdown has begun; the callback must return.
+            explicit operator bool() const { return guard_ != nullptr; }
+
+        private:
+            friend class CallbackGuard;
+            explicit Scope(CallbackGuard* guard) : guard_(guard) {}
+
+            CallbackGuard* guard_;
+        };
+
+        CallbackGuard() = default;
+
+        // Disallow copy and assign.
+        CallbackGuard(const CallbackGuard&) = delete;
+        CallbackGuard& operator=(const CallbackGuard&) = delete;
+
+        // Any thread.
+        Scope Enter();
+
+        // Refuses new scopes and blocks until every open one has closed.
+        // Must not be called from inside a scope.
+        void Shutdown();
+
+        bool shut_down() const;
+        size_t running() const;
+
+    private:
+        void Exit();
+
+        mutable std::mutex mutex_;
+        std::condition_variable idle_;
+        size_t running_ = 0;
+        bool shut_down_ = false;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_CALLBACK_GUARD_H_
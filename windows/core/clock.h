@@ -0,0 +1,39 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_CLOCK_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_CLOCK_H_
+
+#include <chrono>
+
+namespace flutter_ble_peripheral {
+
+    // Monotonic time source. Time-driven parts of the core take a Clock so
+    // tests can run them against a VirtualClock.
+    class Clock {
+    public:
+        virtual ~Clock() = default;
+
+        // Time since an arbitrary, fixed epoch.
+        virtual std::chrono::nanoseconds Now() const = 0;
+    };
+
+    class SteadyClock : public Clock {
+    public:
+        std::chrono::nanoseconds Now() const override {
+            return std::chrono::steady_clock::now().time_since_epoch();
+        }
+    };
+
+    // A clock that only moves when told to.
+    class VirtualClock : public Clock {
+    public:
+        std::chrono::nanoseconds Now() const override { return now_; }
+
+        void Advance(std::chrono::nanoseconds delta) { now_ += delta; }
+        void Set(std::chrono::nanoseconds now) { now_ = now; }
+
+    private:
+        std::chrono::nanoseconds now_{ 0 };
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_CLOCK_H_
@@ -0,0 +1,56 @@
+#include "cpu_features.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace flutter_ble_peripheral {
+
+    namespace {
+
+        SimdLevel Detect() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+            int info[4] = {};
+            __cpuid(info, 0);
+            const int max_leaf = info[0];
+            __cpuid(info, 1);
+            const bool sse2 = (info[3] & (1 << 26)) != 0;
+            // AVX2 also needs AVX and an OS that saves the YMM registers.
+            const bool avx = (info[2] & (1 << 28)) != 0;
+            const bool os_saves_ymm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+            if (max_leaf >= 7 && avx && os_saves_ymm) {
+                __cpuidex(info, 7, 0);
+                if (info[1] & (1 << 5)) return SimdLevel::kAvx2;
+            }
+            return sse2 ? SimdLevel::kSse2 : SimdLevel::kScalar;
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2")) return SimdLevel::kAvx2;
+            if (__builtin_cpu_supports("sse2")) return SimdLevel::kSse2;
+            return SimdLevel::kScalar;
+#else
+            return SimdLevel::kScalar;
+#endif
+        }
+
+    }  // namespace
+
+    SimdLevel DetectSimdLevel() {
+        static const SimdLevel level = Detect();
+        return level;
+    }
+
+    const char* SimdLevelName(SimdLevel level) {
+        switch (level) {
+        case SimdLevel::kScalar:
+            return "scalar";
+        case SimdLevel::kSse2:
+            return "sse2";
+        case SimdLevel::kAvx2:
+            return "avx2";
+        }
+        return "unknown";
+    }
+
+}  // namespace flutter_ble_peripheral
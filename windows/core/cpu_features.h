@@ -0,0 +1,37 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_CPU_FEATURES_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_CPU_FEATURES_H_
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define FLUTTER_BLE_PERIPHERAL_X86 1
+#else
+#define FLUTTER_BLE_PERIPHERAL_X86 0
+#endif
+
+// Marks a kernel that uses instructions beyond the build's baseline. GCC and
+// Clang only emit those inside functions that ask for them; MSVC always does.
+#if defined(__GNUC__) || defined(__clang__)
+#define FLUTTER_BLE_PERIPHERAL_TARGET(isa) __attribute__((target(isa)))
+#else
+#define FLUTTER_BLE_PERIPHERAL_TARGET(isa)
+#endif
+
+namespace flutter_ble_peripheral {
+
+    // Vector instruction sets the core has kernels for, weakest first.
+    enum class SimdLevel : uint8_t {
+        kScalar,
+        kSse2,
+        kAvx2,
+    };
+
+    // The strongest level this CPU and OS support. Non-x86 builds are always
+    // kScalar. Detected once and cached.
+    SimdLevel DetectSimdLevel();
+
+    const char* SimdLevelName(SimdLevel level);
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_CPU_FEATURES_H_
@@ -0,0 +1,149 @@
+#include "data_streamer.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace flutter_ble_peripheral {
+
+    DataStreamer::DataStreamer(GattServer& server, const Clock& clock, DataStreamOptions options)
+        : server_(server), clock_(clock), options_(options) {
+        if (options_.window == 0) options_.window = 1;
+        if (options_.progressInterval == 0) options_.progressInterval = 1;
+    }
+
+    StreamId DataStreamer::Send(GattClientId client, GattHandle characteristic, SharedBuffer payload) {
+        Stream stream;
+        stream.progress.id = next_id_++;
+        stream.progress.client = client;
+        stream.progress.totalBytes = payload.size();
+        stream.characteristic = characteristic;
+        stream.payload = std::move(payload);
+        stream.nextReport = options_.progressInterval;
+        stream.started = clock_.Now();
+        // An empty payload is done as soon as it is reported.
+        stream.reportDue = stream.progress.totalBytes == 0;
+        stream.progress.done = stream.reportDue;
+        streams_.push_back(std::move(stream));
+        return streams_.back().progress.id;
+    }
+
+    size_t DataStreamer::Pump() {
+        size_t queued = 0;
+        // Clients that still have chunks left after their turn: their window
+        // is full or the transport pushed back. Their later streams wait, so
+        // each client's notifications go out in Send order.
+        auto& blocked = blocked_;
+        blocked.clear();
+        for (auto& stream : streams_) {
+            const GattClientId client = stream.progress.client;
+            if (stream.progress.failed || stream.queuedBytes == stream.progress.totalBytes) continue;
+            if (std::find(blocked.begin(), blocked.end(), client) != blocked.end()) continue;
+
+            if (!server_.subscribed(client, stream.characteristic)) {
+                Fail(stream);
+                continue;
+            }
+            const size_t chunk_size = server_.mtu(client) - kAttNotificationHeaderSize;
+            size_t& in_flight = InFlight(client);
+            while (in_flight < options_.window && stream.queuedBytes < stream.progress.totalBytes) {
+                auto chunk = stream.payload.Slice(stream.queuedBytes, chunk_size);
+                if (!server_.SendTo(client, stream.characteristic, chunk)) break;
+                stream.queuedBytes += chunk.size();
+                ++stream.inFlight;
+                ++in_flight;
+                ++queued;
+            }
+            if (stream.queuedBytes < stream.progress.totalBytes) blocked.push_back(client);
+        }
+        return queued;
+    }
+
+    void DataStreamer::OnSent(GattClientId client, const SharedBuffer& value, bool delivered) {
+        for (auto& stream : streams_) {
+            if (stream.progress.client != client || stream.inFlight == 0) continue;
+            const uint8_t* begin = stream.payload.data();
+            std::less<const uint8_t*> before;
+            if (before(value.data(), begin) || !before(value.data(), begin + stream.progress.totalBytes)) continue;
+
+            --stream.inFlight;
+            size_t& in_flight = InFlight(client);
+            if (in_flight > 0) --in_flight;
+            if (stream.progress.failed) {
+                if (stream.inFlight == 0) {
+                    stream.progress.done = true;
+                    stream.reportDue = true;
+                }
+                return;
+            }
+            if (!delivered) {
+                Fail(stream);
+                return;
+            }
+
+            stream.progress.sentBytes += value.size();
+            ++stream.progress.chunks;
+            stream.progress.elapsed = clock_.Now() - stream.started;
+            if (stream.progress.sentBytes >= stream.nextReport) {
+                stream.reportDue = true;
+                stream.nextReport = stream.progress.sentBytes + options_.progressInterval;
+            }
+            if (stream.Finished()) {
+                stream.progress.done = true;
+                stream.reportDue = true;
+            }
+            return;
+        }
+    }
+
+    void DataStreamer::OnClientDisconnected(GattClientId client) {
+        for (auto& stream : streams_) {
+            if (stream.progress.client != client) continue;
+            // Nothing in flight will be reported sent any more.
+            stream.inFlight = 0;
+            Fail(stream);
+        }
+        in_flight_.erase(std::remove_if(in_flight_.begin(), in_flight_.end(),
+                                        [client](const auto& entry) { return entry.first == client; }),
+                         in_flight_.end());
+    }
+
+    std::vector<StreamProgress> DataStreamer::TakeProgress() {
+        std::vector<StreamProgress> reports;
+        for (auto& stream : streams_) {
+            if (!stream.reportDue) continue;
+            stream.reportDue = false;
+            reports.push_back(stream.progress);
+        }
+        streams_.erase(std::remove_if(streams_.begin(), streams_.end(),
+                                      [](const Stream& stream) { return stream.progress.done && !stream.reportDue; }),
+                       streams_.end());
+        return reports;
+    }
+
+    std::optional<StreamProgress> DataStreamer::Progress(StreamId id) const {
+        for (const auto& stream : streams_) {
+            if (stream.progress.id == id) return stream.progress;
+        }
+        return std::nullopt;
+    }
+
+    size_t& DataStreamer::InFlight(GattClientId client) {
+        for (auto& entry : in_flight_) {
+            if (entry.first == client) return entry.second;
+        }
+        in_flight_.emplace_back(client, 0);
+        return in_flight_.back().second;
+    }
+
+    void DataStreamer::Fail(Stream& stream) {
+        stream.progress.failed = true;
+        stream.progress.elapsed = clock_.Now() - stream.started;
+        // Stop queuing; chunks already in flight still return their credit.
+        stream.queuedBytes = stream.progress.totalBytes;
+        if (stream.inFlight == 0) {
+            stream.progress.done = true;
+            stream.reportDue = true;
+        }
+    }
+
+}  // namespace flutter_ble_peripheral
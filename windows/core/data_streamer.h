@@ -0,0 +1,122 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_DATA_STREAMER_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_DATA_STREAMER_H_
+
+#include "byte_buffer.h"
+#include "clock.h"
+#include "gatt_server.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+
+    struct DataStreamOptions {
+        // Notifications a client may have in flight before the streamer waits
+        // for the transport to report one sent.
+        size_t window = 8;
+        // A progress report is due each time this many more bytes are
+        // confirmed. Finished streams are always reported.
+        size_t progressInterval = 16 * 1024;
+    };
+
+    using StreamId = uint32_t;
+
+    struct StreamProgress {
+        StreamId id = 0;
+        GattClientId client = 0;
+        size_t totalBytes = 0;
+        // Bytes the transport reported sent.
+        size_t sentBytes = 0;
+        size_t chunks = 0;
+        // Since Send.
+        std::chrono::nanoseconds elapsed{ 0 };
+        bool done = false;
+        bool failed = false;
+
+        double bytesPerSecond() const {
+            return elapsed.count() > 0 ? static_cast<double>(sentBytes) * 1e9 / static_cast<double>(elapsed.count())
+                                       : 0.0;
+        }
+    };
+
+    // Streams large payloads to GATT clients as a run of notifications.
+    //
+    // Chunks are slices of the payload's SharedBuffer, so a payload is never
+    // copied after Send. Each chunk fills the client's current ATT_MTU, as
+    // GattServer tracks it, so a larger MTU negotiated mid-stream applies to
+    // the rest of the stream. Each client has a window of notifications in flight;
+    // the transport returns a credit through OnSent for every one it finishes,
+    // and Pump refills the window. Streams to the same client go out one
+    // after the other. Not thread-safe; the owner serializes calls with the
+    // GattServer's.
+    class DataStreamer {
+    public:
+        DataStreamer(GattServer& server, const Clock& clock, DataStreamOptions options = {});
+
+        // Disallow copy and assign.
+        DataStreamer(const DataStreamer&) = delete;
+        DataStreamer& operator=(const DataStreamer&) = delete;
+
+        // Queues |payload| for |client| as notifications of |characteristic|.
+        // Nothing goes out before the next Pump.
+        StreamId Send(GattClientId client, GattHandle characteristic, SharedBuffer payload);
+
+        // Hands chunks to the server until every client's window is full or
+        // the transport pushes back. Returns the number of chunks queued.
+        size_t Pump();
+
+        // The transport finished sending |value| to |client|. Values that are
+        // not chunks of a stream are ignored. A failed chunk fails its stream.
+        void OnSent(GattClientId client, const SharedBuffer& value, bool delivered);
+
+        // Fails every stream to |client|.
+        void OnClientDisconnected(GattClientId client);
+
+        // Progress reports due since the last call, in stream order. A
+        // finished stream is reported once and then forgotten.
+        std::vector<StreamProgress> TakeProgress();
+
+        std::optional<StreamProgress> Progress(StreamId id) const;
+        size_t active() const { return streams_.size(); }
+        const DataStreamOptions& options() const { return options_; }
+
+    private:
+        struct Stream {
+            StreamProgress progress;
+            GattHandle characteristic = 0;
+            SharedBuffer payload;
+            // Bytes handed to the server so far.
+            size_t queuedBytes = 0;
+            size_t inFlight = 0;
+            size_t nextReport = 0;
+            std::chrono::nanoseconds started{ 0 };
+            bool reportDue = false;
+
+            bool Finished() const {
+                return inFlight == 0 && (progress.failed || progress.sentBytes == progress.totalBytes);
+            }
+        };
+
+        size_t& InFlight(GattClientId client);
+        void Fail(Stream& stream);
+
+        GattServer& server_;
+        const Clock& clock_;
+        DataStreamOptions options_;
+        // In Send order.
+        std::deque<Stream> streams_;
+        // Notifications in flight per client, across its streams.
+        std::vector<std::pair<GattClientId, size_t>> in_flight_;
+        // Pump's scratch list, kept to reuse its storage.
+        std::vector<GattClientId> blocked_;
+        StreamId next_id_ = 1;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_DATA_STREAMER_H_
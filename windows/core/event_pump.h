@@ -0,0 +1,134 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_EVENT_PUMP_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_EVENT_PUMP_H_
+
+#include "mpsc_queue.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+namespace flutter_ble_peripheral {
+
+    // Hands events from any number of callback threads to one consumer thread,
+    // in the plugin the Flutter platform thread.
+    //
+    // Producers Post into an MpscQueue and call |wake| only when no drain is
+    // pending, so a burst of events costs one wakeup (one posted window
+    // message). The consumer calls Drain from that wakeup. Drain handles a
+    // bounded number of events and wakes itself again for the rest, so a flood
+    // never starves the consumer's own message loop.
+    //
+    // |wake| returns false when it could not reach the consumer, say before
+    // there is a window to post to. No drain is pending then, so the next
+    // Post tries again, and the consumer can Drain on its own at any time.
+    //
+    // When the queue is full, Post drops the event and counts it. Producers
+    // can keep headroom for important events by posting less important ones
+    // with a |reserve|.
+    template <typename T>
+    class EventPump {
+    public:
+        struct Stats {
+            uint64_t posted = 0;
+            uint64_t dropped = 0;
+            uint64_t drained = 0;
+            uint64_t wakeups = 0;
+            // Wakeups |wake| could not deliver.
+            uint64_t failedWakeups = 0;
+            size_t highWater = 0;
+            size_t capacity = 0;
+        };
+
+        EventPump(size_t capacity, std::function<bool()> wake)
+            : queue_(capacity), wake_(std::move(wake)) {}
+
+        // Disallow copy and assign.
+        EventPump(const EventPump&) = delete;
+        EventPump& operator=(const EventPump&) = delete;
+
+        // Any thread. Fails, and counts a drop, if fewer than |reserve| + 1
+        // slots are free.
+        template <typename Fill>
+        bool PostWith(Fill&& fill, size_t reserve = 0) {
+            if (reserve > 0 && queue_.size() + reserve >= queue_.capacity()) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            if (!queue_.TryPushWith(std::forward<Fill>(fill))) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            posted_.fetch_add(1, std::memory_order_relaxed);
+            Wake();
+            return true;
+        }
+
+        bool Post(T value, size_t reserve = 0) {
+            return PostWith([&value](T& slot) { slot = std::move(value); }, reserve);
+        }
+
+        // Consumer thread. Calls |handle| for up to |max_events| events and
+        // returns how many were handled.
+        template <typename Handle>
+        size_t Drain(Handle&& handle, size_t max_events = SIZE_MAX) {
+            // Clear first: a Post racing with this drain either lands in the
+            // loop below or wakes us again.
+            wake_pending_.store(false, std::memory_order_seq_cst);
+
+            const size_t backlog = queue_.size();
+            if (backlog > high_water_.load(std::memory_order_relaxed)) {
+                high_water_.store(backlog, std::memory_order_relaxed);
+            }
+
+            size_t handled = 0;
+            while (handled < max_events && queue_.TryPopWith(handle)) {
+                ++handled;
+            }
+            drained_.fetch_add(handled, std::memory_order_relaxed);
+            if (queue_.size() > 0) Wake();
+            return handled;
+        }
+
+        Stats stats() const {
+            Stats stats;
+            stats.posted = posted_.load(std::memory_order_relaxed);
+            stats.dropped = dropped_.load(std::memory_order_relaxed);
+            stats.drained = drained_.load(std::memory_order_relaxed);
+            stats.wakeups = wakeups_.load(std::memory_order_relaxed);
+            stats.failedWakeups = failed_wakeups_.load(std::memory_order_relaxed);
+            stats.highWater = high_water_.load(std::memory_order_relaxed);
+            stats.capacity = queue_.capacity();
+            return stats;
+        }
+
+        size_t pending() const { return queue_.size(); }
+
+    private:
+        void Wake() {
+            if (wake_pending_.exchange(true, std::memory_order_seq_cst)) return;
+            if (wake_()) {
+                wakeups_.fetch_add(1, std::memory_order_relaxed);
+            }
+            else {
+                failed_wakeups_.fetch_add(1, std::memory_order_relaxed);
+                wake_pending_.store(false, std::memory_order_seq_cst);
+            }
+        }
+
+        MpscQueue<T> queue_;
+        std::function<bool()> wake_;
+        std::atomic<bool> wake_pending_{ false };
+
+        std::atomic<uint64_t> posted_{ 0 };
+        std::atomic<uint64_t> dropped_{ 0 };
+        std::atomic<uint64_t> drained_{ 0 };
+        std::atomic<uint64_t> wakeups_{ 0 };
+        std::atomic<uint64_t> failed_wakeups_{ 0 };
+        std::atomic<size_t> high_water_{ 0 };
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_EVENT_PUMP_H_
@@ -0,0 +1,282 @@
+#include "gatt_server.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace flutter_ble_peripheral {
+
+    GattServer::GattServer(GattTransport& transport) : transport_(transport) {}
+
+    bool GattServer::AddService(GattService& service) {
+        const size_t needed = 1 + service.characteristics.size();
+        if (next_handle_ + needed - 1 > std::numeric_limits<GattHandle>::max()) return false;
+        for (const auto& characteristic : service.characteristics) {
+            if (characteristic.value.size() > kGattMaxAttributeSize) return false;
+        }
+
+        auto handle = static_cast<GattHandle>(next_handle_);
+        service.handle = handle++;
+        for (auto& characteristic : service.characteristics) characteristic.handle = handle++;
+        if (!transport_.PublishService(service)) {
+            service.handle = 0;
+            for (auto& characteristic : service.characteristics) characteristic.handle = 0;
+            return false;
+        }
+
+        next_handle_ += needed;
+        services_.push_back(service.handle);
+        for (const auto& characteristic : service.characteristics) {
+            Attribute attribute;
+            attribute.handle = characteristic.handle;
+            attribute.service = service.handle;
+            attribute.uuid = characteristic.uuid;
+            attribute.properties = characteristic.properties;
+            attribute.value = characteristic.value;
+            attributes_.push_back(std::move(attribute));
+        }
+        return true;
+    }
+
+    bool GattServer::RemoveService(GattHandle service) {
+        auto it = std::find(services_.begin(), services_.end(), service);
+        if (it == services_.end()) return false;
+        services_.erase(it);
+        attributes_.erase(
+            std::remove_if(attributes_.begin(), attributes_.end(),
+                           [service](const Attribute& attribute) { return attribute.service == service; }),
+            attributes_.end());
+        transport_.RemoveService(service);
+        return true;
+    }
+
+    GattHandle GattServer::FindCharacteristic(const BluetoothUuid& uuid) const {
+        for (const auto& attribute : attributes_) {
+            if (attribute.uuid == uuid) return attribute.handle;
+        }
+        return 0;
+    }
+
+    bool GattServer::SetValue(GattHandle characteristic, SharedBuffer value) {
+        auto* attribute = Find(characteristic);
+        if (!attribute || value.size() > kGattMaxAttributeSize) return false;
+        attribute->value = std::move(value);
+        return true;
+    }
+
+    const SharedBuffer* GattServer::GetValue(GattHandle characteristic) const {
+        const auto* attribute = Find(characteristic);
+        return attribute ? &attribute->value : nullptr;
+    }
+
+    size_t GattServer::Notify(GattHandle characteristic, SharedBuffer value) {
+        auto* attribute = Find(characteristic);
+        if (!attribute || value.size() > kGattMaxAttributeSize) return 0;
+        attribute->value = std::move(value);
+
+        size_t sent = 0;
+        for (const auto& subscriber : attribute->subscribers) {
+            if (Send(subscriber, characteristic, attribute->value)) ++sent;
+        }
+        return sent;
+    }
+
+    bool GattServer::SendTo(GattClientId client, GattHandle characteristic, const SharedBuffer& value) {
+        auto* attribute = Find(characteristic);
+        if (!attribute) return false;
+        for (const auto& subscriber : attribute->subscribers) {
+            if (subscriber.client == client) return Send(subscriber, characteristic, value);
+        }
+        return false;
+    }
+
+    bool GattServer::OnClientConnected(GattClientId client) {
+        if (FindClient(client)) return false;
+        clients_.push_back({ client });
+        return clients_.size() == 1;
+    }
+
+    bool GattServer::OnClientDisconnected(GattClientId client) {
+        auto it = std::find_if(clients_.begin(), clients_.end(),
+                               [client](const Client& entry) { return entry.id == client; });
+        if (it == clients_.end()) return false;
+        clients_.erase(it);
+        for (auto& attribute : attributes_) Unsubscribe(attribute, client);
+        return clients_.empty();
+    }
+
+    GattStatus GattServer::OnSubscriptionChanged(GattClientId client, GattHandle characteristic,
+                                                 GattSubscription subscription) {
+        auto* attribute = Find(characteristic);
+        if (!attribute) return GattStatus::kInvalidHandle;
+        Unsubscribe(*attribute, client);
+        if (subscription == GattSubscription::kNone) return GattStatus::kSuccess;
+
+        const uint8_t required = subscription == GattSubscription::kIndicate ? kGattIndicate : kGattNotify;
+        if ((attribute->properties & required) == 0) {
+            ++stats_.rejected;
+            return GattStatus::kWriteNotPermitted;
+        }
+        attribute->subscribers.push_back({ client, subscription == GattSubscription::kIndicate });
+        return GattStatus::kSuccess;
+    }
+
+    bool GattServer::OnMtuChanged(GattClientId client, size_t mtu) {
+        auto* entry = FindClient(client);
+        if (!entry) return false;
+        mtu = std::clamp(mtu, kDefaultAttMtu, kMaxAttMtu);
+        if (entry->mtu == mtu) return false;
+        entry->mtu = mtu;
+        return true;
+    }
+
+    GattReadResult GattServer::OnRead(GattClientId client, GattHandle characteristic, size_t offset) {
+        GattReadResult result;
+        auto* attribute = Find(characteristic);
+        if (!attribute) {
+            result.status = GattStatus::kInvalidHandle;
+        }
+        else if ((attribute->properties & kGattRead) == 0) {
+            result.status = GattStatus::kReadNotPermitted;
+        }
+        else {
+            // Long reads come back with the offset of the next part; only the
+            // first part goes through the handler, so every part reads from
+            // the same value.
+            SharedBuffer value = attribute->value;
+            if (offset == 0 && read_handler_) {
+                result.status = read_handler_(client, characteristic, value);
+                if (result.status == GattStatus::kSuccess && value.size() > kGattMaxAttributeSize) {
+                    result.status = GattStatus::kUnlikelyError;
+                }
+                if (result.status == GattStatus::kSuccess) attribute->value = value;
+            }
+            if (result.status == GattStatus::kSuccess && offset > value.size()) {
+                result.status = GattStatus::kInvalidOffset;
+            }
+            if (result.status == GattStatus::kSuccess) {
+                result.value = std::move(value);
+                result.offset = offset;
+            }
+        }
+
+        if (result.status == GattStatus::kSuccess) {
+            ++stats_.reads;
+        }
+        else {
+            ++stats_.rejected;
+        }
+        return result;
+    }
+
+    GattStatus GattServer::OnWrite(GattClientId client, GattHandle characteristic, size_t offset,
+                                   ByteView value, bool with_response) {
+        GattStatus status = GattStatus::kSuccess;
+        auto* attribute = Find(characteristic);
+        if (!attribute) {
+            status = GattStatus::kInvalidHandle;
+        }
+        else if ((attribute->properties & (with_response ? kGattWrite : kGattWriteWithoutResponse)) == 0) {
+            status = GattStatus::kWriteNotPermitted;
+        }
+        else if (offset > attribute->value.size()) {
+            status = GattStatus::kInvalidOffset;
+        }
+        else if (offset + value.size() > kGattMaxAttributeSize) {
+            status = GattStatus::kInvalidAttributeValueLength;
+        }
+        else if (write_handler_) {
+            status = write_handler_(client, characteristic, offset, value);
+        }
+
+        if (status != GattStatus::kSuccess) {
+            ++stats_.rejected;
+            return status;
+        }
+
+        if (offset == 0) {
+            attribute->value = SharedBuffer::CopyFrom(value);
+        }
+        else {
+            // The old value up to |offset|, then the new bytes.
+            std::vector<uint8_t> merged(attribute->value.data(), attribute->value.data() + offset);
+            merged.insert(merged.end(), value.begin(), value.end());
+            attribute->value = SharedBuffer::CopyFrom(merged);
+        }
+        ++stats_.writes;
+        return status;
+    }
+
+    size_t GattServer::subscriber_count(GattHandle characteristic) const {
+        const auto* attribute = Find(characteristic);
+        return attribute ? attribute->subscribers.size() : 0;
+    }
+
+    bool GattServer::subscribed(GattClientId client, GattHandle characteristic) const {
+        const auto* attribute = Find(characteristic);
+        if (!attribute) return false;
+        return std::any_of(attribute->subscribers.begin(), attribute->subscribers.end(),
+                           [client](const Subscriber& subscriber) { return subscriber.client == client; });
+    }
+
+    std::vector<GattClientId> GattServer::subscribers(GattHandle characteristic) const {
+        std::vector<GattClientId> clients;
+        if (const auto* attribute = Find(characteristic)) {
+            for (const auto& subscriber : attribute->subscribers) clients.push_back(subscriber.client);
+        }
+        return clients;
+    }
+
+    size_t GattServer::mtu(GattClientId client) const {
+        const auto* entry = FindClient(client);
+        return entry ? entry->mtu : kDefaultAttMtu;
+    }
+
+    GattServer::Stats GattServer::stats() const {
+        Stats stats = stats_;
+        stats.clients = clients_.size();
+        stats.subscriptions = 0;
+        for (const auto& attribute : attributes_) stats.subscriptions += attribute.subscribers.size();
+        return stats;
+    }
+
+    GattServer::Attribute* GattServer::Find(GattHandle characteristic) {
+        return const_cast<Attribute*>(static_cast<const GattServer*>(this)->Find(characteristic));
+    }
+
+    const GattServer::Attribute* GattServer::Find(GattHandle characteristic) const {
+        auto it = std::lower_bound(
+            attributes_.begin(), attributes_.end(), characteristic,
+            [](const Attribute& attribute, GattHandle handle) { return attribute.handle < handle; });
+        return it != attributes_.end() && it->handle == characteristic ? &*it : nullptr;
+    }
+
+    GattServer::Client* GattServer::FindClient(GattClientId client) {
+        return const_cast<Client*>(static_cast<const GattServer*>(this)->FindClient(client));
+    }
+
+    const GattServer::Client* GattServer::FindClient(GattClientId client) const {
+        for (const auto& entry : clients_) {
+            if (entry.id == client) return &entry;
+        }
+        return nullptr;
+    }
+
+    void GattServer::Unsubscribe(Attribute& attribute, GattClientId client) {
+        auto& subscribers = attribute.subscribers;
+        subscribers.erase(
+            std::remove_if(subscribers.begin(), subscribers.end(),
+                           [client](const Subscriber& subscriber) { return subscriber.client == client; }),
+            subscribers.end());
+    }
+
+    bool GattServer::Send(const Subscriber& subscriber, GattHandle characteristic, const SharedBuffer& value) {
+        if (!transport_.SendValue(subscriber.client, characteristic, value, subscriber.indicate)) {
+            ++stats_.dropped;
+            return false;
+        }
+        ++(subscriber.indicate ? stats_.indications : stats_.notifications);
+        stats_.bytesSent += value.size();
+        return true;
+    }
+
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,148 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_GATT_SERVER_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_GATT_SERVER_H_
+
+#include "byte_buffer.h"
+#include "gatt_transport.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+
+    // Outcome of GattServer::OnRead. On success the client gets bytes().
+    struct GattReadResult {
+        GattStatus status = GattStatus::kSuccess;
+        SharedBuffer value;
+        size_t offset = 0;
+
+        ByteView bytes() const { return value.view().subview(offset); }
+    };
+
+    // Services, characteristics and subscriptions of the local GATT server.
+    //
+    // The server owns the attribute table and checks every client request
+    // against it; the transport only moves requests and values between the
+    // stack and the server. Not thread-safe: the owner serializes calls from
+    // the stack's threads with its own calls.
+    class GattServer {
+    public:
+        // Sees each request after it passed the property and bounds checks.
+        // A read handler may replace |value| before it is returned and
+        // stored; anything but kSuccess is sent back as an ATT error.
+        using ReadHandler = std::function<GattStatus(GattClientId client, GattHandle characteristic,
+                                                     SharedBuffer& value)>;
+        using WriteHandler = std::function<GattStatus(GattClientId client, GattHandle characteristic,
+                                                      size_t offset, ByteView value)>;
+
+        struct Stats {
+            uint64_t reads = 0;
+            uint64_t writes = 0;
+            uint64_t rejected = 0;
+            uint64_t notifications = 0;
+            uint64_t indications = 0;
+            // Values the transport refused to queue.
+            uint64_t dropped = 0;
+            uint64_t bytesSent = 0;
+            size_t clients = 0;
+            size_t subscriptions = 0;
+        };
+
+        explicit GattServer(GattTransport& transport);
+
+        // Disallow copy and assign.
+        GattServer(const GattServer&) = delete;
+        GattServer& operator=(const GattServer&) = delete;
+
+        // Assigns handles to |service| and its characteristics, then
+        // publishes it. Returns false, leaving the table unchanged, if the
+        // handles ran out, a value is over kGattMaxAttributeSize or the
+        // transport refused the service.
+        bool AddService(GattService& service);
+        bool RemoveService(GattHandle service);
+
+        // Handle of the first characteristic with |uuid|, or 0.
+        GattHandle FindCharacteristic(const BluetoothUuid& uuid) const;
+
+        // Replaces the value reads return, without telling subscribers.
+        bool SetValue(GattHandle characteristic, SharedBuffer value);
+        const SharedBuffer* GetValue(GattHandle characteristic) const;
+
+        // Replaces the value and sends it to every subscribed client. All
+        // clients share |value|'s storage. Returns how many the transport
+        // accepted it for.
+        size_t Notify(GattHandle characteristic, SharedBuffer value);
+
+        // Sends |value| to one subscribed client without touching the stored
+        // value. Returns false if |client| is not subscribed or the transport
+        // refused it.
+        bool SendTo(GattClientId client, GattHandle characteristic, const SharedBuffer& value);
+
+        void SetReadHandler(ReadHandler handler) { read_handler_ = std::move(handler); }
+        void SetWriteHandler(WriteHandler handler) { write_handler_ = std::move(handler); }
+
+        // Transport callbacks. Connection changes return whether connected()
+        // changed.
+        bool OnClientConnected(GattClientId client);
+        bool OnClientDisconnected(GattClientId client);
+        GattStatus OnSubscriptionChanged(GattClientId client, GattHandle characteristic,
+                                         GattSubscription subscription);
+        // Records the ATT_MTU |client| negotiated, clamped to what ATT allows.
+        // Returns whether it changed.
+        bool OnMtuChanged(GattClientId client, size_t mtu);
+        GattReadResult OnRead(GattClientId client, GattHandle characteristic, size_t offset);
+        GattStatus OnWrite(GattClientId client, GattHandle characteristic, size_t offset,
+                           ByteView value, bool with_response);
+
+        bool connected() const { return !clients_.empty(); }
+        // |client|'s ATT_MTU; kDefaultAttMtu until it negotiates one.
+        size_t mtu(GattClientId client) const;
+        size_t subscriber_count(GattHandle characteristic) const;
+        bool subscribed(GattClientId client, GattHandle characteristic) const;
+        std::vector<GattClientId> subscribers(GattHandle characteristic) const;
+        Stats stats() const;
+
+    private:
+        struct Client {
+            GattClientId id = 0;
+            size_t mtu = kDefaultAttMtu;
+        };
+
+        struct Subscriber {
+            GattClientId client = 0;
+            bool indicate = false;
+        };
+
+        struct Attribute {
+            GattHandle handle = 0;
+            GattHandle service = 0;
+            BluetoothUuid uuid;
+            uint8_t properties = 0;
+            SharedBuffer value;
+            std::vector<Subscriber> subscribers;
+        };
+
+        // attributes_ is sorted by handle, since handles only grow.
+        Attribute* Find(GattHandle characteristic);
+        const Attribute* Find(GattHandle characteristic) const;
+        Client* FindClient(GattClientId client);
+        const Client* FindClient(GattClientId client) const;
+        void Unsubscribe(Attribute& attribute, GattClientId client);
+        bool Send(const Subscriber& subscriber, GattHandle characteristic, const SharedBuffer& value);
+
+        GattTransport& transport_;
+        std::vector<GattHandle> services_;
+        std::vector<Attribute> attributes_;
+        std::vector<Client> clients_;
+        ReadHandler read_handler_;
+        WriteHandler write_handler_;
+        // Wider than GattHandle so running out does not wrap to 0.
+        size_t next_handle_ = 1;
+        Stats stats_;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_GATT_SERVER_H_
@@ -0,0 +1,119 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_GATT_TRANSPORT_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_GATT_TRANSPORT_H_
+
+#include "ad_encoder.h"
+#include "byte_buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+
+    // Names a service or characteristic. GattServer assigns them; they are
+    // its own ids rather than the stack's ATT handles. Zero is never valid.
+    using GattHandle = uint16_t;
+
+    // Identifies one connected client for as long as it stays connected. The
+    // transport picks the values.
+    using GattClientId = uint64_t;
+
+    // The longest attribute value ATT allows.
+    inline constexpr size_t kGattMaxAttributeSize = 512;
+
+    // ATT_MTU of every connection until the client negotiates a larger one,
+    // and the largest one worth negotiating: a 512-byte value behind the
+    // longest request header.
+    inline constexpr size_t kDefaultAttMtu = 23;
+    inline constexpr size_t kMaxAttMtu = 517;
+
+    // Opcode and attribute handle in front of every notification's value.
+    inline constexpr size_t kAttNotificationHeaderSize = 3;
+
+    // Characteristic property bits, numbered as in the Core specification
+    // (and WinRT's GattCharacteristicProperties).
+    enum GattProperties : uint8_t {
+        kGattRead = 1u << 1,
+        kGattWriteWithoutResponse = 1u << 2,
+        kGattWrite = 1u << 3,
+        kGattNotify = 1u << 4,
+        kGattIndicate = 1u << 5,
+    };
+
+    // ATT error codes a request can be answered with.
+    enum class GattStatus : uint8_t {
+        kSuccess = 0x00,
+        kInvalidHandle = 0x01,
+        kReadNotPermitted = 0x02,
+        kWriteNotPermitted = 0x03,
+        kInvalidOffset = 0x07,
+        kInvalidAttributeValueLength = 0x0D,
+        kUnlikelyError = 0x0E,
+        kInsufficientResources = 0x11,
+    };
+
+    // Which ATT request a write to a characteristic came from.
+    enum class GattWriteKind : uint8_t {
+        // A write request or command. Always the whole value, at offset 0;
+        // also how a stack that queues a long write itself hands over the
+        // executed value.
+        kWrite,
+        // One prepare write request of a long write, at its value offset.
+        kPrepare,
+        // An execute write request: the prepared fragments are the value.
+        kExecute,
+        // An execute write request with the cancel flag.
+        kCancel,
+    };
+
+    // What a client asked to receive through a characteristic's client
+    // configuration descriptor.
+    enum class GattSubscription : uint8_t {
+        kNone,
+        kNotify,
+        kIndicate,
+    };
+
+    struct GattCharacteristic {
+        BluetoothUuid uuid;
+        // GattProperties bits.
+        uint8_t properties = 0;
+        // Answered to reads and replaced by writes and notifications.
+        SharedBuffer value;
+        // Assigned by GattServer::AddService.
+        GattHandle handle = 0;
+    };
+
+    struct GattService {
+        BluetoothUuid uuid;
+        std::vector<GattCharacteristic> characteristics;
+        // Assigned by GattServer::AddService.
+        GattHandle handle = 0;
+    };
+
+    // The part of the Bluetooth stack GattServer drives. The Windows plugin
+    // implements it on top of GattServiceProvider; tests and benchmarks use a
+    // loopback mock. Client requests flow back through GattServer's On*
+    // methods.
+    class GattTransport {
+    public:
+        virtual ~GattTransport() = default;
+
+        // Makes |service|, with every handle assigned, visible to clients.
+        // Returns false if the stack refused it.
+        virtual bool PublishService(const GattService& service) = 0;
+
+        // Withdraws a service published earlier.
+        virtual void RemoveService(GattHandle service) = 0;
+
+        // Queues |value| for |client| as a notification, or an indication if
+        // |indicate| is set, of |characteristic|. The transport shares |value|
+        // rather than copying it. Returns false if the client is gone or its
+        // queue is full.
+        virtual bool SendValue(GattClientId client, GattHandle characteristic,
+                               const SharedBuffer& value, bool indicate) = 0;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_GATT_TRANSPORT_H_
@@ -0,0 +1,62 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_INITIALIZATION_GATE_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_INITIALIZATION_GATE_H_
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+
+    // Holds calls that arrive before asynchronous initialization has finished
+    // and hands them back, in arrival order, once it has.
+    //
+    // Not thread-safe; the plugin defers and replays on the platform thread.
+    template <typename Call>
+    class InitializationGate {
+    public:
+        enum class Admission {
+            // Initialization is done; run the call now.
+            kRun,
+            // Queued for replay.
+            kDeferred,
+            // The queue is full; fail the call.
+            kRejected,
+        };
+
+        explicit InitializationGate(size_t max_deferred = 64) : max_deferred_(max_deferred) {}
+
+        Admission Admit(Call&& call) {
+            if (open_) return Admission::kRun;
+            if (deferred_.size() == max_deferred_) return Admission::kRejected;
+            deferred_.push_back(std::move(call));
+            ++total_deferred_;
+            return Admission::kDeferred;
+        }
+
+        // Finishes initialization, successfully if |error| is empty, and
+        // returns the calls to replay. Later calls are admitted directly.
+        std::vector<Call> Open(std::string error = std::string()) {
+            open_ = true;
+            error_ = std::move(error);
+            return std::exchange(deferred_, std::vector<Call>());
+        }
+
+        bool open() const { return open_; }
+        bool failed() const { return open_ && !error_.empty(); }
+        const std::string& error() const { return error_; }
+        size_t pending() const { return deferred_.size(); }
+        // Calls deferred since construction, replayed or not.
+        size_t total_deferred() const { return total_deferred_; }
+
+    private:
+        size_t max_deferred_;
+        bool open_ = false;
+        std::string error_;
+        std::vector<Call> deferred_;
+        size_t total_deferred_ = 0;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_INITIALIZATION_GATE_H_
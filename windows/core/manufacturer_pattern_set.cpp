@@ -0,0 +1,307 @@
+#include "manufacturer_pattern_set.h"
+
+#include "ad_encoder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#if FLUTTER_BLE_PERIPHERAL_X86
+#include <immintrin.h>
+#endif
+
+namespace flutter_ble_peripheral {
+
+    using internal::PatternSlot;
+
+    namespace {
+
+        // The longest record an AD structure carries: the company id and the
+        // data behind the length and type bytes.
+        constexpr size_t kMaxRecordSize = kExtendedAdvertisingDataSize - 2;
+
+        // Fewer patterns than this are cheaper to scan than to hash.
+        constexpr size_t kMinIndexedPatterns = 16;
+
+        uint8_t CompanyBit(uint8_t low, uint8_t high) {
+            return static_cast<uint8_t>(low ^ high);
+        }
+
+        uint32_t ReadKey(const uint8_t* bytes) {
+            uint32_t key;
+            std::memcpy(&key, bytes, sizeof(key));
+            return key;
+        }
+
+        uint32_t ScanScalar(const PatternSlot* slots, const uint8_t* lengths, uint32_t begin, uint32_t end,
+                            const uint8_t* record, size_t record_size) {
+            uint64_t words[4];
+            std::memcpy(words, record, sizeof(words));
+            for (uint32_t i = begin; i < end; ++i) {
+                uint64_t expected[4];
+                uint64_t mask[4];
+                std::memcpy(expected, slots[i].expected, sizeof(expected));
+                std::memcpy(mask, slots[i].mask, sizeof(mask));
+                const uint64_t diff = ((words[0] & mask[0]) ^ expected[0]) | ((words[1] & mask[1]) ^ expected[1]) |
+                    ((words[2] & mask[2]) ^ expected[2]) | ((words[3] & mask[3]) ^ expected[3]);
+                if (diff == 0 && lengths[i] <= record_size) return i;
+            }
+            return end;
+        }
+
+#if FLUTTER_BLE_PERIPHERAL_X86
+        FLUTTER_BLE_PERIPHERAL_TARGET("sse2")
+        uint32_t ScanSse2(const PatternSlot* slots, const uint8_t* lengths, uint32_t begin, uint32_t end,
+                          const uint8_t* record, size_t record_size) {
+            const __m128i low = _mm_load_si128(reinterpret_cast<const __m128i*>(record));
+            const __m128i high = _mm_load_si128(reinterpret_cast<const __m128i*>(record + 16));
+            for (uint32_t i = begin; i < end; ++i) {
+                const auto* expected = reinterpret_cast<const __m128i*>(slots[i].expected);
+                const auto* mask = reinterpret_cast<const __m128i*>(slots[i].mask);
+                const __m128i equal_low = _mm_cmpeq_epi8(_mm_and_si128(low, _mm_load_si128(mask)),
+                                                         _mm_load_si128(expected));
+                const __m128i equal_high = _mm_cmpeq_epi8(_mm_and_si128(high, _mm_load_si128(mask + 1)),
+                                                          _mm_load_si128(expected + 1));
+                if (_mm_movemask_epi8(_mm_and_si128(equal_low, equal_high)) == 0xFFFF && lengths[i] <= record_size) {
+                    return i;
+                }
+            }
+            return end;
+        }
+
+        FLUTTER_BLE_PERIPHERAL_TARGET("avx2")
+        uint32_t ScanAvx2(const PatternSlot* slots, const uint8_t* lengths, uint32_t begin, uint32_t end,
+                          const uint8_t* record, size_t record_size) {
+            const __m256i bytes = _mm256_load_si256(reinterpret_cast<const __m256i*>(record));
+            uint32_t i = begin;
+            // Two slots per round keeps both load ports busy.
+            for (; i + 1 < end; i += 2) {
+                const __m256i equal_first = _mm256_cmpeq_epi8(
+                    _mm256_and_si256(bytes, _mm256_load_si256(reinterpret_cast<const __m256i*>(slots[i].mask))),
+                    _mm256_load_si256(reinterpret_cast<const __m256i*>(slots[i].expected)));
+                const __m256i equal_second = _mm256_cmpeq_epi8(
+                    _mm256_and_si256(bytes, _mm256_load_si256(reinterpret_cast<const __m256i*>(slots[i + 1].mask))),
+                    _mm256_load_si256(reinterpret_cast<const __m256i*>(slots[i + 1].expected)));
+                if (_mm256_movemask_epi8(equal_first) == -1 && lengths[i] <= record_size) return i;
+                if (_mm256_movemask_epi8(equal_second) == -1 && lengths[i + 1] <= record_size) return i + 1;
+            }
+            if (i < end) {
+                const __m256i equal = _mm256_cmpeq_epi8(
+                    _mm256_and_si256(bytes, _mm256_load_si256(reinterpret_cast<const __m256i*>(slots[i].mask))),
+                    _mm256_load_si256(reinterpret_cast<const __m256i*>(slots[i].expected)));
+                if (_mm256_movemask_epi8(equal) == -1 && lengths[i] <= record_size) return i;
+            }
+            return end;
+        }
+#endif
+
+        internal::PatternKernel KernelFor(SimdLevel level) {
+#if FLUTTER_BLE_PERIPHERAL_X86
+            switch (level) {
+            case SimdLevel::kAvx2:
+                return ScanAvx2;
+            case SimdLevel::kSse2:
+                return ScanSse2;
+            case SimdLevel::kScalar:
+                break;
+            }
+#else
+            (void)level;
+#endif
+            return ScanScalar;
+        }
+
+        // A pattern spelled out over the whole record.
+        struct Expanded {
+            std::vector<uint8_t> expected;
+            std::vector<uint8_t> mask;
+
+            bool FixesKey(size_t offset) const {
+                if (mask.size() < offset + ManufacturerPatternSet::kKeySize) return false;
+                for (size_t i = 0; i < ManufacturerPatternSet::kKeySize; ++i) {
+                    if (mask[offset + i] != 0xFF) return false;
+                }
+                return true;
+            }
+        };
+
+        // The key window that leaves the fewest slots to scan per match:
+        // the patterns outside the index plus an average bucket. Returns
+        // nullopt if no window beats scanning everything.
+        std::optional<size_t> ChooseKeyOffset(const std::vector<Expanded>& patterns) {
+            const double total = static_cast<double>(patterns.size());
+            double best_cost = total;
+            std::optional<size_t> best;
+            std::vector<uint32_t> keys;
+            for (size_t offset = 0; offset + ManufacturerPatternSet::kKeySize <= ManufacturerPatternSet::kSlotSize;
+                 ++offset) {
+                keys.clear();
+                for (const auto& pattern : patterns) {
+                    if (pattern.FixesKey(offset)) keys.push_back(ReadKey(pattern.expected.data() + offset));
+                }
+                if (keys.empty()) continue;
+                const double indexed = static_cast<double>(keys.size());
+                std::sort(keys.begin(), keys.end());
+                const double distinct =
+                    static_cast<double>(std::unique(keys.begin(), keys.end()) - keys.begin());
+                const double cost = (total - indexed) + indexed / distinct;
+                if (cost < best_cost) {
+                    best_cost = cost;
+                    best = offset;
+                }
+            }
+            return best;
+        }
+
+    }  // namespace
+
+    std::optional<ManufacturerPatternSet> ManufacturerPatternSet::Compile(
+        const std::vector<ManufacturerDataPattern>& patterns, ManufacturerPatternSetOptions options) {
+        if (patterns.size() >= std::numeric_limits<uint32_t>::max()) return std::nullopt;
+
+        std::vector<Expanded> expanded;
+        expanded.reserve(patterns.size());
+        for (const auto& pattern : patterns) {
+            const size_t size = 2 + pattern.prefix.size();
+            if (size > kMaxRecordSize) return std::nullopt;
+            if (!pattern.mask.empty() && pattern.mask.size() != pattern.prefix.size()) return std::nullopt;
+            Expanded record;
+            record.mask.assign(size, 0xFF);
+            if (!pattern.mask.empty()) std::copy(pattern.mask.begin(), pattern.mask.end(), record.mask.begin() + 2);
+            record.expected = { static_cast<uint8_t>(pattern.companyId & 0xFF),
+                                static_cast<uint8_t>(pattern.companyId >> 8) };
+            record.expected.insert(record.expected.end(), pattern.prefix.begin(), pattern.prefix.end());
+            for (size_t i = 0; i < size; ++i) record.expected[i] &= record.mask[i];
+            expanded.push_back(std::move(record));
+        }
+
+        ManufacturerPatternSet set;
+        set.level_ = std::min(options.simdLevel, DetectSimdLevel());
+        set.kernel_ = KernelFor(set.level_);
+
+        // Every pattern's place: a bucket, or the residual group past the
+        // last bucket.
+        std::optional<size_t> key_offset;
+        if (options.bucketIndex && expanded.size() >= kMinIndexedPatterns) key_offset = ChooseKeyOffset(expanded);
+        size_t bucket_count = 0;
+        std::vector<uint32_t> places(expanded.size());
+        if (key_offset) {
+            set.key_offset_ = static_cast<uint32_t>(*key_offset);
+            size_t indexed = 0;
+            for (const auto& pattern : expanded) indexed += pattern.FixesKey(*key_offset);
+            uint32_t bits = 1;
+            while ((size_t{ 1 } << bits) < indexed) ++bits;
+            bucket_count = size_t{ 1 } << bits;
+            set.bucket_shift_ = 64 - bits;
+        }
+        for (size_t i = 0; i < expanded.size(); ++i) {
+            const auto& pattern = expanded[i];
+            places[i] = key_offset && pattern.FixesKey(*key_offset)
+                ? set.Bucket(ReadKey(pattern.expected.data() + *key_offset))
+                : static_cast<uint32_t>(bucket_count);
+        }
+
+        // Counting sort by place keeps each group in Compile order.
+        std::vector<uint32_t> offsets(bucket_count + 2, 0);
+        for (uint32_t place : places) ++offsets[place + 1];
+        for (size_t b = 1; b < offsets.size(); ++b) offsets[b] += offsets[b - 1];
+        set.residual_begin_ = offsets[bucket_count];
+        if (bucket_count > 0) set.bucket_offsets_.assign(offsets.begin(), offsets.begin() + bucket_count + 1);
+
+        set.slots_.resize(expanded.size());
+        set.lengths_.resize(expanded.size());
+        set.indices_.resize(expanded.size());
+        set.tail_offsets_.resize(expanded.size());
+        for (size_t i = 0; i < expanded.size(); ++i) {
+            const auto& pattern = expanded[i];
+            const uint32_t slot = offsets[places[i]]++;
+            const size_t head = std::min(pattern.expected.size(), kSlotSize);
+            PatternSlot& compiled = set.slots_[slot];
+            std::memset(&compiled, 0, sizeof(compiled));
+            std::memcpy(compiled.expected, pattern.expected.data(), head);
+            std::memcpy(compiled.mask, pattern.mask.data(), head);
+            set.lengths_[slot] = static_cast<uint8_t>(pattern.expected.size());
+            set.indices_[slot] = static_cast<uint32_t>(i);
+            const uint8_t bit = CompanyBit(pattern.expected[0], pattern.expected[1]);
+            set.companies_[bit >> 6] |= uint64_t{ 1 } << (bit & 63);
+            set.tail_offsets_[slot] = static_cast<uint32_t>(set.tails_.size());
+            if (pattern.expected.size() > kSlotSize) {
+                set.tails_.insert(set.tails_.end(), pattern.expected.begin() + kSlotSize, pattern.expected.end());
+                set.tails_.insert(set.tails_.end(), pattern.mask.begin() + kSlotSize, pattern.mask.end());
+            }
+        }
+        return set;
+    }
+
+    bool ManufacturerPatternSet::Prepare(ByteView record, uint8_t* padded) const {
+        if (record.size() < 2) return false;
+        const uint8_t bit = CompanyBit(record[0], record[1]);
+        if ((companies_[bit >> 6] >> (bit & 63) & 1) == 0) return false;
+        if (record.size() >= kSlotSize) {
+            std::memcpy(padded, record.data(), kSlotSize);
+        }
+        else {
+            std::memset(padded, 0, kSlotSize);
+            std::memcpy(padded, record.data(), record.size());
+        }
+        return true;
+    }
+
+    std::optional<uint32_t> ManufacturerPatternSet::Match(ByteView record) const {
+        alignas(kSlotSize) uint8_t padded[kSlotSize];
+        if (!Prepare(record, padded)) return std::nullopt;
+
+        std::optional<uint32_t> first;
+        if (!bucket_offsets_.empty() && record.size() >= key_offset_ + kKeySize) {
+            const uint32_t bucket = Bucket(ReadKey(record.data() + key_offset_));
+            const uint32_t end = bucket_offsets_[bucket + 1];
+            const uint32_t slot = Scan(bucket_offsets_[bucket], end, padded, record);
+            if (slot != end) first = indices_[slot];
+        }
+        const uint32_t end = static_cast<uint32_t>(indices_.size());
+        const uint32_t slot = Scan(residual_begin_, end, padded, record);
+        if (slot != end && (!first || indices_[slot] < *first)) first = indices_[slot];
+        return first;
+    }
+
+    bool ManufacturerPatternSet::MatchesAny(ByteView record) const {
+        alignas(kSlotSize) uint8_t padded[kSlotSize];
+        if (!Prepare(record, padded)) return false;
+
+        if (!bucket_offsets_.empty() && record.size() >= key_offset_ + kKeySize) {
+            const uint32_t bucket = Bucket(ReadKey(record.data() + key_offset_));
+            const uint32_t end = bucket_offsets_[bucket + 1];
+            if (Scan(bucket_offsets_[bucket], end, padded, record) != end) return true;
+        }
+        const uint32_t end = static_cast<uint32_t>(indices_.size());
+        return Scan(residual_begin_, end, padded, record) != end;
+    }
+
+    uint32_t ManufacturerPatternSet::Scan(uint32_t begin, uint32_t end, const uint8_t* padded, ByteView record) const {
+        while (begin < end) {
+            const uint32_t slot = kernel_(slots_.data(), lengths_.data(), begin, end, padded, record.size());
+            if (slot == end || TailMatches(slot, record)) return slot;
+            begin = slot + 1;
+        }
+        return end;
+    }
+
+    bool ManufacturerPatternSet::TailMatches(uint32_t slot, ByteView record) const {
+        const size_t length = lengths_[slot];
+        if (length <= kSlotSize) return true;
+        const size_t tail = length - kSlotSize;
+        const uint8_t* expected = tails_.data() + tail_offsets_[slot];
+        const uint8_t* mask = expected + tail;
+        for (size_t i = 0; i < tail; ++i) {
+            if ((record[kSlotSize + i] & mask[i]) != expected[i]) return false;
+        }
+        return true;
+    }
+
+    uint32_t ManufacturerPatternSet::Bucket(uint32_t key) const {
+        // Fibonacci hashing: the top bits of the product spread keys that
+        // differ only in their low bytes, like consecutive minors.
+        return static_cast<uint32_t>((uint64_t{ key } * 0x9E3779B97F4A7C15ull) >> bucket_shift_);
+    }
+
+}  // namespace flutter_ble_peripheral
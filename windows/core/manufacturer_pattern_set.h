@@ -0,0 +1,125 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_MANUFACTURER_PATTERN_SET_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_MANUFACTURER_PATTERN_SET_H_
+
+#include "byte_buffer.h"
+#include "cpu_features.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+
+    struct ManufacturerDataPattern {
+        uint16_t companyId = 0;
+        // Compared with the start of the record's data, bit by bit where
+        // |mask| is set. An empty mask compares every bit; otherwise it is as
+        // long as |prefix|.
+        std::vector<uint8_t> prefix;
+        std::vector<uint8_t> mask;
+    };
+
+    namespace internal {
+
+        // One compiled pattern: its first 32 bytes, already masked,
+        // and the mask, zero past the pattern's end.
+        struct alignas(32) PatternSlot {
+            uint8_t expected[32];
+            uint8_t mask[32];
+        };
+
+        // Returns the position of the first slot in [begin, end) that
+        // |record|, zero-padded to 32 bytes, matches, or |end|. Slots longer
+        // than |record_size| never match.
+        using PatternKernel = uint32_t (*)(const PatternSlot* slots, const uint8_t* lengths, uint32_t begin,
+                                           uint32_t end, const uint8_t* record, size_t record_size);
+
+    }  // namespace internal
+
+    struct ManufacturerPatternSetOptions {
+        // Clamped to what the CPU supports.
+        SimdLevel simdLevel = DetectSimdLevel();
+        // Buckets patterns by a 4-byte key window. Off, every match scans
+        // every pattern.
+        bool bucketIndex = true;
+    };
+
+    // Matches a manufacturer specific data record against thousands of
+    // prefix/mask patterns at once.
+    //
+    // Each pattern is compiled to a 32-byte slot of expected bytes and a
+    // 32-byte mask over the record, company id included, so a comparison
+    // is one AND and one compare per slot: a single AVX2 instruction pair,
+    // two with SSE2 or four 64-bit words in the scalar kernel. Bytes past 32
+    // are checked afterwards for the rare longer pattern. The kernel is
+    // picked at Compile from the CPU's capabilities.
+    //
+    // To avoid scanning every slot, Compile picks the 4-byte window of the
+    // record that tells the patterns apart best and hashes it into buckets;
+    // patterns that do not fix all four bytes of it are scanned on every
+    // match. For beacon identities that differ in major and minor this
+    // leaves about one slot per lookup. A 256-bit filter over the company
+    // ids turns away records no pattern can match before either. Matching
+    // never allocates.
+    class ManufacturerPatternSet {
+    public:
+        static constexpr size_t kSlotSize = sizeof(internal::PatternSlot::expected);
+        static constexpr size_t kKeySize = 4;
+
+        // Matches nothing.
+        ManufacturerPatternSet() = default;
+
+        // Returns nullopt if a pattern's mask and prefix differ in length or
+        // a pattern does not fit in an AD structure.
+        static std::optional<ManufacturerPatternSet> Compile(const std::vector<ManufacturerDataPattern>& patterns,
+                                                             ManufacturerPatternSetOptions options = {});
+
+        // |record| is the body of a manufacturer specific data structure:
+        // the little-endian company id followed by the data. Returns the
+        // index, in Compile order, of the first pattern it matches.
+        std::optional<uint32_t> Match(ByteView record) const;
+
+        // Whether |record| matches any pattern; stops at the first it finds.
+        bool MatchesAny(ByteView record) const;
+
+        size_t size() const { return indices_.size(); }
+        bool empty() const { return indices_.empty(); }
+        SimdLevel simd_level() const { return level_; }
+        // Patterns reached through the bucket index rather than scanned on
+        // every match.
+        size_t indexed() const { return residual_begin_; }
+
+    private:
+        // Zero-pads |record|'s head into |padded|. False if no pattern can
+        // match it.
+        bool Prepare(ByteView record, uint8_t* padded) const;
+        uint32_t Scan(uint32_t begin, uint32_t end, const uint8_t* padded, ByteView record) const;
+        bool TailMatches(uint32_t slot, ByteView record) const;
+        uint32_t Bucket(uint32_t key) const;
+
+        internal::PatternKernel kernel_ = nullptr;
+        // Bit (low ^ high byte) of every pattern's company id.
+        std::array<uint64_t, 4> companies_{};
+        SimdLevel level_ = SimdLevel::kScalar;
+        // Slots of indexed patterns grouped by bucket, then the rest; each
+        // group in Compile order.
+        std::vector<internal::PatternSlot> slots_;
+        // Per slot: the pattern's length, its index in Compile order and
+        // where its bytes past kSlotSize start in tails_.
+        std::vector<uint8_t> lengths_;
+        std::vector<uint32_t> indices_;
+        std::vector<uint32_t> tail_offsets_;
+        // Expected bytes then mask of each tail, back to back.
+        std::vector<uint8_t> tails_;
+        // Bucket b holds slots [bucket_offsets_[b], bucket_offsets_[b + 1]).
+        std::vector<uint32_t> bucket_offsets_;
+        uint32_t bucket_shift_ = 0;
+        uint32_t key_offset_ = 0;
+        uint32_t residual_begin_ = 0;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_MANUFACTURER_PATTERN_SET_H_
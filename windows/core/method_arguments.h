@@ -0,0 +1,252 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_METHOD_ARGUMENTS_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_METHOD_ARGUMENTS_H_
+
+#include "advertise_data.h"
+#include "scan_settings.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+
+    // Argument decoding for the method channel.
+    //
+    // The helpers are templated on the map type so the same code decodes a
+    // flutter::EncodableMap in the plugin and a plain std::map of std::variant
+    // values in the tests. The only requirement is that keys can be built from
+    // a std::string and that values work with std::get_if.
+
+    // Map keys the plugin reads. Looking one up by name builds a temporary
+    // key (a std::string inside a variant) on every call; the interned keys
+    // below are built once per map type instead.
+    enum class Argument : uint8_t {
+        kManufacturerId,
+        kManufacturerDataBytes,
+        kServiceUuid,
+        kServiceDataUuid,
+        kServiceDataBytes,
+        kServiceSolicitationUuid,
+        kLocalName,
+        kIncludeDeviceName,
+        kIncludePowerLevel,
+        kSetInterval,
+        kSetDuration,
+        kSetMaxExtendedAdvertisingEvents,
+        kEnabled,
+        kFlushIntervalMs,
+        kMaxBatchSize,
+        kCoalesce,
+        kCapacity,
+        kMaxAgeMs,
+        kUuid,
+        kCharacteristics,
+        kProperties,
+        kValue,
+        kHandle,
+        kNotify,
+        kCompanyIds,
+        kServiceUuids,
+        kManufacturerData,
+        kNamePrefixes,
+        kMinRssi,
+        kCompanyId,
+        kPrefix,
+        kMask,
+        kAddress,
+        kMaxDevices,
+        kSamplesPerDevice,
+        kWindowSamples,
+        kWindowMs,
+        kScanMode,
+        kIntervalMicros,
+        kWindowMicros,
+        kPath,
+        kDeltaCompressed,
+        kRealTime,
+        kCount,
+    };
+
+    inline constexpr size_t kArgumentCount = static_cast<size_t>(Argument::kCount);
+
+    inline constexpr std::array<std::string_view, kArgumentCount> kArgumentNames = {
+        "manufacturerId",
+        "manufacturerDataBytes",
+        "serviceUuid",
+        "serviceDataUuid",
+        "serviceDataBytes",
+        "serviceSolicitationUuid",
+        "localName",
+        "includeDeviceName",
+        "includePowerLevel",
+        "setinterval",
+        "setduration",
+        "setmaxExtendedAdvertisingEvents",
+        "enabled",
+        "flushIntervalMs",
+        "maxBatchSize",
+        "coalesce",
+        "capacity",
+        "maxAgeMs",
+        "uuid",
+        "characteristics",
+        "properties",
+        "value",
+        "handle",
+        "notify",
+        "companyIds",
+        "serviceUuids",
+        "manufacturerData",
+        "namePrefixes",
+        "minRssi",
+        "companyId",
+        "prefix",
+        "mask",
+        "address",
+        "maxDevices",
+        "samplesPerDevice",
+        "windowSamples",
+        "windowMs",
+        "scanMode",
+        "intervalMicros",
+        "windowMicros",
+        "path",
+        "deltaCompressed",
+        "realTime",
+    };
+
+    namespace internal {
+
+        template <typename Key, size_t... I>
+        std::array<Key, sizeof...(I)> MakeArgumentKeys(std::index_sequence<I...>) {
+            return { Key(std::string(kArgumentNames[I]))... };
+        }
+
+    }  // namespace internal
+
+    // The key for |argument| as a Key (e.g. flutter::EncodableValue), built
+    // on first use and shared afterwards.
+    template <typename Key>
+    const Key& InternedKey(Argument argument) {
+        static const std::array<Key, kArgumentCount> keys =
+            internal::MakeArgumentKeys<Key>(std::make_index_sequence<kArgumentCount>());
+        return keys[static_cast<size_t>(argument)];
+    }
+
+    template <typename Map>
+    const typename Map::mapped_type* FindArgument(const Map& arguments, Argument key) {
+        auto it = arguments.find(InternedKey<typename Map::key_type>(key));
+        return it == arguments.end() ? nullptr : &it->second;
+    }
+
+    // Looks up a key that has no Argument entry. Allocates a temporary key.
+    template <typename Map>
+    const typename Map::mapped_type* FindArgument(const Map& arguments, const char* key) {
+        auto it = arguments.find(typename Map::key_type(std::string(key)));
+        return it == arguments.end() ? nullptr : &it->second;
+    }
+
+    // Dart ints arrive as int32 or int64 depending on their magnitude.
+    template <typename Value>
+    std::optional<int64_t> GetInt(const Value* value) {
+        if (!value) return std::nullopt;
+        if (const auto* v32 = std::get_if<int32_t>(value)) return *v32;
+        if (const auto* v64 = std::get_if<int64_t>(value)) return *v64;
+        return std::nullopt;
+    }
+
+    template <typename Value>
+    std::optional<bool> GetBool(const Value* value) {
+        if (!value) return std::nullopt;
+        if (const auto* b = std::get_if<bool>(value)) return *b;
+        return std::nullopt;
+    }
+
+    template <typename Value>
+    const std::string* GetString(const Value* value) {
+        return value ? std::get_if<std::string>(value) : nullptr;
+    }
+
+    template <typename Value>
+    const std::vector<uint8_t>* GetBytes(const Value* value) {
+        return value ? std::get_if<std::vector<uint8_t>>(value) : nullptr;
+    }
+
+    // Decodes the arguments of the "start" call. Absent and null entries keep
+    // their defaults; entries of an unexpected type are ignored.
+    template <typename Map>
+    AdvertiseData DecodeAdvertiseData(const Map& arguments) {
+        AdvertiseData data;
+        if (auto id = GetInt(FindArgument(arguments, Argument::kManufacturerId))) {
+            data.manufacturerId = static_cast<uint16_t>(*id & 0xFFFF);
+        }
+        if (const auto* bytes = GetBytes(FindArgument(arguments, Argument::kManufacturerDataBytes))) {
+            // The one copy on the start path: everything downstream, up to the
+            // WinRT publisher, shares this buffer.
+            data.manufacturerData = SharedBuffer::CopyFrom(*bytes);
+        }
+        if (const auto* uuid = GetString(FindArgument(arguments, Argument::kServiceUuid))) {
+            data.serviceUuid = *uuid;
+        }
+        if (const auto* uuid = GetString(FindArgument(arguments, Argument::kServiceDataUuid))) {
+            data.serviceDataUuid = *uuid;
+        }
+        if (const auto* bytes = GetBytes(FindArgument(arguments, Argument::kServiceDataBytes))) {
+            data.serviceData = SharedBuffer::CopyFrom(*bytes);
+        }
+        if (const auto* uuid = GetString(FindArgument(arguments, Argument::kServiceSolicitationUuid))) {
+            data.serviceSolicitationUuid = *uuid;
+        }
+        if (const auto* name = GetString(FindArgument(arguments, Argument::kLocalName))) {
+            data.localName = *name;
+        }
+        data.includeDeviceName = GetBool(FindArgument(arguments, Argument::kIncludeDeviceName)).value_or(false);
+        data.includePowerLevel = GetBool(FindArgument(arguments, Argument::kIncludePowerLevel)).value_or(false);
+        return data;
+    }
+
+    // Decodes the AdvertiseSetParameters that FlutterBlePeripheral.start and
+    // addAdvertisingSet send as "set"-prefixed keys.
+    template <typename Map>
+    AdvertiseSetParameters DecodeAdvertiseSetParameters(const Map& arguments) {
+        AdvertiseSetParameters parameters;
+        if (auto interval = GetInt(FindArgument(arguments, Argument::kSetInterval))) {
+            if (*interval > 0) parameters.interval = IntervalFromUnits(*interval);
+        }
+        if (auto duration = GetInt(FindArgument(arguments, Argument::kSetDuration))) {
+            if (*duration > 0) parameters.duration = DurationFromUnits(*duration);
+        }
+        if (auto events = GetInt(FindArgument(arguments, Argument::kSetMaxExtendedAdvertisingEvents))) {
+            if (*events > 0) parameters.maxExtendedAdvertisingEvents = static_cast<uint32_t>(*events);
+        }
+        return parameters;
+    }
+
+    // Decodes the arguments of startScan. A missing window equals the
+    // interval, scanning continuously. Unknown modes are passive. The
+    // result still needs IsValidScanSettings.
+    template <typename Map>
+    ScanSettings DecodeScanSettings(const Map& arguments) {
+        ScanSettings settings;
+        if (auto mode = GetInt(FindArgument(arguments, Argument::kScanMode))) {
+            if (*mode == static_cast<int64_t>(ScanMode::kActive)) settings.mode = ScanMode::kActive;
+        }
+        if (auto interval = GetInt(FindArgument(arguments, Argument::kIntervalMicros))) {
+            settings.interval = std::chrono::microseconds(*interval);
+            settings.window = settings.interval;
+        }
+        if (auto window = GetInt(FindArgument(arguments, Argument::kWindowMicros))) {
+            settings.window = std::chrono::microseconds(*window);
+        }
+        return settings;
+    }
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_METHOD_ARGUMENTS_H_
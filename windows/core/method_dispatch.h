@@ -0,0 +1,111 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_METHOD_DISPATCH_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_METHOD_DISPATCH_H_
+
+#include "perfect_hash_table.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace flutter_ble_peripheral {
+
+    // Every method the Windows plugin answers on flutter_ble_peripheral/methods.
+    // To add one, add it here and to kMethodNames in the same position, then
+    // handle it in the plugin's dispatch switch.
+    enum class Method : uint8_t {
+        kInitialize,
+        kGetStartupTimings,
+        kStart,
+        kUpdateAdvertiseData,
+        kAddAdvertisingSet,
+        kRemoveAdvertisingSet,
+        kGetAdvertisingSetStats,
+        kSetScanResultFormat,
+        kSetScanBatching,
+        kSetScanCache,
+        kGetScanCacheStats,
+        kStop,
+        kIsAdvertising,
+        kIsSupported,
+        kIsConnected,
+        kGetStateSnapshot,
+        kGetEventQueueStats,
+        kAddGattService,
+        kRemoveGattService,
+        kSetCharacteristicValue,
+        kSendData,
+        kGetGattServerStats,
+        kAddDataService,
+        kSetScanFilter,
+        kSetRssiHistory,
+        kGetRssiStats,
+        kStartScan,
+        kStopScan,
+        kGetScanSessionStats,
+        kGetMetrics,
+        kStartScanCapture,
+        kStopScanCapture,
+        kStartScanReplay,
+        kStopScanReplay,
+        kCount,
+    };
+
+    inline constexpr size_t kMethodCount = static_cast<size_t>(Method::kCount);
+
+    inline constexpr std::array<std::string_view, kMethodCount> kMethodNames = {
+        "initialize",
+        "getStartupTimings",
+        "start",
+        "updateAdvertiseData",
+        "addAdvertisingSet",
+        "removeAdvertisingSet",
+        "getAdvertisingSetStats",
+        "setScanResultFormat",
+        "setScanBatching",
+        "setScanCache",
+        "getScanCacheStats",
+        "stop",
+        "isAdvertising",
+        "isSupported",
+        "isConnected",
+        "getStateSnapshot",
+        "getEventQueueStats",
+        "addGattService",
+        "removeGattService",
+        "setCharacteristicValue",
+        "sendData",
+        "getGattServerStats",
+        "addDataService",
+        "setScanFilter",
+        "setRssiHistory",
+        "getRssiStats",
+        "startScan",
+        "stopScan",
+        "getScanSessionStats",
+        "getMetrics",
+        "startScanCapture",
+        "stopScanCapture",
+        "startScanReplay",
+        "stopScanReplay",
+    };
+
+    inline constexpr PerfectHashTable<kMethodCount> kMethodTable{ kMethodNames };
+    static_assert(kMethodTable.valid(), "method names must be unique");
+
+    constexpr std::string_view MethodName(Method method) {
+        return kMethodNames[static_cast<size_t>(method)];
+    }
+
+    // Maps a method channel method name to its Method, or nullopt for names
+    // the plugin does not implement.
+    constexpr std::optional<Method> FindMethod(std::string_view name) {
+        auto index = kMethodTable.Find(name);
+        if (!index) return std::nullopt;
+        return static_cast<Method>(*index);
+    }
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_METHOD_DISPATCH_H_
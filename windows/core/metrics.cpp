@@ -0,0 +1,194 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace flutter_ble_peripheral {
+
+    namespace {
+
+        // Index of the highest set bit of a non-zero |value|.
+        unsigned HighestBit(uint64_t value) {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanReverse64(&index, value);
+            return static_cast<unsigned>(index);
+#else
+            return 63u - static_cast<unsigned>(__builtin_clzll(value));
+#endif
+        }
+
+    }  // namespace
+
+    size_t LatencyHistogram::BucketIndex(uint64_t nanos) {
+        // Values below two octaves of sub-buckets get a bucket each.
+        if (nanos < 2 * kSubBuckets) return static_cast<size_t>(nanos);
+        const unsigned bit = HighestBit(nanos);
+        if (bit >= kMaxValueBits) return kBucketCount - 1;
+        const unsigned shift = bit - kSubBucketBits;
+        // nanos >> shift keeps the top kSubBucketBits + 1 bits, in
+        // [kSubBuckets, 2 * kSubBuckets).
+        return static_cast<size_t>(shift) * kSubBuckets + static_cast<size_t>(nanos >> shift);
+    }
+
+    uint64_t LatencyHistogram::BucketLowerBound(size_t index) {
+        if (index < 2 * kSubBuckets) return index;
+        const size_t shift = index / kSubBuckets - 1;
+        return static_cast<uint64_t>(index % kSubBuckets + kSubBuckets) << shift;
+    }
+
+    void LatencyHistogram::Record(uint64_t nanos) {
+        ++buckets_[BucketIndex(nanos)];
+        ++count_;
+        sum_ += nanos;
+        min_ = std::min(min_, nanos);
+        max_ = std::max(max_, nanos);
+    }
+
+    void LatencyHistogram::Merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < kBucketCount; ++i) buckets_[i] += other.buckets_[i];
+        count_ += other.count_;
+        sum_ += other.sum_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+
+    uint64_t LatencyHistogram::ValueAtPercentile(double percentile) const {
+        if (count_ == 0) return 0;
+        const double rank = std::ceil(std::clamp(percentile, 0.0, 100.0) / 100.0 * static_cast<double>(count_));
+        const uint64_t target = std::max<uint64_t>(static_cast<uint64_t>(rank), 1);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            seen += buckets_[i];
+            if (seen < target) continue;
+            const uint64_t upper = i + 1 < kBucketCount ? BucketLowerBound(i + 1) - 1 : max_;
+            // Not std::clamp: a snapshot taken during a stripe's first
+            // sample can have its bucket without its min.
+            return std::min(std::max(upper, min_), max_);
+        }
+        return max_;
+    }
+
+    Metrics::StripeHistogram::StripeHistogram() {
+        for (auto& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+        sum.store(0, std::memory_order_relaxed);
+        min.store(UINT64_MAX, std::memory_order_relaxed);
+        max.store(0, std::memory_order_relaxed);
+    }
+
+    Metrics::Stripe::Stripe() {
+        for (auto& counter : counters) counter.store(0, std::memory_order_relaxed);
+        for (auto& histogram : histograms) histogram.store(nullptr, std::memory_order_relaxed);
+    }
+
+    Metrics::Metrics(const Clock& clock) : clock_(clock) {
+        if constexpr (kMetricsEnabled) stripes_ = std::make_unique<Stripe[]>(kStripes);
+    }
+
+    Metrics::~Metrics() {
+        if (!stripes_) return;
+        for (size_t s = 0; s < kStripes; ++s) {
+            for (auto& histogram : stripes_[s].histograms) delete histogram.load(std::memory_order_acquire);
+        }
+    }
+
+    Metrics::Stripe& Metrics::LocalStripe() const {
+        static std::atomic<size_t> next_stripe{ 0 };
+        thread_local const size_t stripe = next_stripe.fetch_add(1, std::memory_order_relaxed) % kStripes;
+        return stripes_[stripe];
+    }
+
+    void Metrics::RecordHistogram(size_t histogram, std::chrono::nanoseconds elapsed) {
+        const uint64_t nanos = elapsed.count() > 0 ? static_cast<uint64_t>(elapsed.count()) : 0;
+        auto& slot = LocalStripe().histograms[histogram];
+        auto* samples = slot.load(std::memory_order_acquire);
+        if (!samples) {
+            // Another thread sharing the stripe may install one first.
+            auto fresh = std::make_unique<StripeHistogram>();
+            if (slot.compare_exchange_strong(samples, fresh.get(), std::memory_order_acq_rel,
+                                             std::memory_order_acquire)) {
+                samples = fresh.release();
+            }
+        }
+
+        samples->buckets[LatencyHistogram::BucketIndex(nanos)].fetch_add(1, std::memory_order_relaxed);
+        samples->sum.fetch_add(nanos, std::memory_order_relaxed);
+        uint64_t min = samples->min.load(std::memory_order_relaxed);
+        while (nanos < min && !samples->min.compare_exchange_weak(min, nanos, std::memory_order_relaxed)) {
+        }
+        uint64_t max = samples->max.load(std::memory_order_relaxed);
+        while (nanos > max && !samples->max.compare_exchange_weak(max, nanos, std::memory_order_relaxed)) {
+        }
+    }
+
+    void Metrics::OnPublisherStartRequested() {
+        if constexpr (kMetricsEnabled) {
+            Add(MetricCounter::kPublisherStartRequests);
+            publisher_start_requested_.store(clock_.Now().count(), std::memory_order_relaxed);
+        }
+    }
+
+    void Metrics::OnPublisherStatus(PublisherStatus status) {
+        if constexpr (kMetricsEnabled) {
+            switch (status) {
+            case PublisherStatus::created:
+                return;
+            case PublisherStatus::waiting:
+                Add(MetricCounter::kPublisherWaiting);
+                return;
+            case PublisherStatus::started: {
+                Add(MetricCounter::kPublisherStarted);
+                const int64_t requested =
+                    publisher_start_requested_.exchange(kNoStartRequest, std::memory_order_relaxed);
+                if (requested != kNoStartRequest) {
+                    RecordSince(MetricLatency::kPublisherStart, std::chrono::nanoseconds(requested));
+                }
+                return;
+            }
+            case PublisherStatus::stopping:
+                Add(MetricCounter::kPublisherStopping);
+                return;
+            case PublisherStatus::stopped:
+                Add(MetricCounter::kPublisherStopped);
+                break;
+            case PublisherStatus::aborted:
+                Add(MetricCounter::kPublisherAborted);
+                break;
+            }
+            // The start this was timing, if any, never completed.
+            publisher_start_requested_.store(kNoStartRequest, std::memory_order_relaxed);
+        }
+    }
+
+    Metrics::Snapshot Metrics::Collect() const {
+        Snapshot snapshot;
+        snapshot.histograms.resize(kHistogramCount);
+        if (!stripes_) return snapshot;
+
+        for (size_t s = 0; s < kStripes; ++s) {
+            const auto& stripe = stripes_[s];
+            for (size_t c = 0; c < kMetricCounterCount; ++c) {
+                snapshot.counters[c] += stripe.counters[c].load(std::memory_order_relaxed);
+            }
+            for (size_t h = 0; h < kHistogramCount; ++h) {
+                const auto* samples = stripe.histograms[h].load(std::memory_order_acquire);
+                if (!samples) continue;
+                auto& histogram = snapshot.histograms[h];
+                for (size_t b = 0; b < LatencyHistogram::kBucketCount; ++b) {
+                    const uint64_t count = samples->buckets[b].load(std::memory_order_relaxed);
+                    histogram.buckets_[b] += count;
+                    histogram.count_ += count;
+                }
+                histogram.sum_ += samples->sum.load(std::memory_order_relaxed);
+                histogram.min_ = std::min(histogram.min_, samples->min.load(std::memory_order_relaxed));
+                histogram.max_ = std::max(histogram.max_, samples->max.load(std::memory_order_relaxed));
+            }
+        }
+        return snapshot;
+    }
+
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,249 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_METRICS_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_METRICS_H_
+
+#include "clock.h"
+#include "method_dispatch.h"
+#include "peripheral_state.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Set to 0, or configure with -DFLUTTER_BLE_PERIPHERAL_METRICS=OFF, to compile
+// every recording call below down to nothing. getMetrics then reports the
+// metrics as disabled.
+#ifndef FLUTTER_BLE_PERIPHERAL_METRICS
+#define FLUTTER_BLE_PERIPHERAL_METRICS 1
+#endif
+
+namespace flutter_ble_peripheral {
+
+    inline constexpr bool kMetricsEnabled = FLUTTER_BLE_PERIPHERAL_METRICS != 0;
+
+    enum class MetricCounter : size_t {
+        // Advertisements the watcher raised, before any filtering.
+        kScanReceived,
+        // Turned away by the scan filter.
+        kScanFiltered,
+        // Dropped by dedup as unchanged since the device's last result.
+        kScanDeduplicated,
+        // Lost to a full platform event queue.
+        kScanDropped,
+        // Handed to Dart, one per result even when batched.
+        kScanDelivered,
+        kPublisherStartRequests,
+        // Publisher status transitions, by the status entered.
+        kPublisherWaiting,
+        kPublisherStarted,
+        kPublisherStopping,
+        kPublisherStopped,
+        kPublisherAborted,
+        kCount,
+    };
+
+    inline constexpr size_t kMetricCounterCount = static_cast<size_t>(MetricCounter::kCount);
+
+    inline constexpr std::array<std::string_view, kMetricCounterCount> kMetricCounterNames = {
+        "scanReceived",
+        "scanFiltered",
+        "scanDeduplicated",
+        "scanDropped",
+        "scanDelivered",
+        "publisherStartRequests",
+        "publisherWaiting",
+        "publisherStarted",
+        "publisherStopping",
+        "publisherStopped",
+        "publisherAborted",
+    };
+
+    enum class MetricLatency : size_t {
+        // From the watcher's Received callback to EventSink::Success.
+        kCallbackToSink,
+        // From StartAdvertising to the publisher reporting Started.
+        kPublisherStart,
+        kCount,
+    };
+
+    inline constexpr size_t kMetricLatencyCount = static_cast<size_t>(MetricLatency::kCount);
+
+    inline constexpr std::array<std::string_view, kMetricLatencyCount> kMetricLatencyNames = {
+        "callbackToSink",
+        "publisherStart",
+    };
+
+    // A latency distribution in nanoseconds with HDR-style log-linear
+    // buckets: 16 linear sub-buckets per power of two, so any recorded value
+    // is known to within 1/16 of itself. Values from 2^36 ns, about 69 s,
+    // share the last bucket; min and max stay exact.
+    class LatencyHistogram {
+    public:
+        static constexpr unsigned kSubBucketBits = 4;
+        static constexpr unsigned kMaxValueBits = 36;
+        static constexpr size_t kSubBuckets = size_t{ 1 } << kSubBucketBits;
+        static constexpr size_t kBucketCount = (kMaxValueBits - kSubBucketBits + 1) * kSubBuckets;
+
+        static size_t BucketIndex(uint64_t nanos);
+        // The smallest value that lands in bucket |index|.
+        static uint64_t BucketLowerBound(size_t index);
+
+        void Record(uint64_t nanos);
+        void Merge(const LatencyHistogram& other);
+
+        // The value below which |percentile| percent of the recorded values
+        // fall, as the upper edge of its bucket clamped to [min, max]. 0 when
+        // empty.
+        uint64_t ValueAtPercentile(double percentile) const;
+
+        bool empty() const { return count_ == 0; }
+        uint64_t count() const { return count_; }
+        uint64_t min() const { return count_ ? min_ : 0; }
+        uint64_t max() const { return max_; }
+        uint64_t sum() const { return sum_; }
+        double mean() const { return count_ ? static_cast<double>(sum_) / static_cast<double>(count_) : 0.0; }
+        uint64_t bucket(size_t index) const { return buckets_[index]; }
+
+    private:
+        friend class Metrics;
+
+        std::array<uint64_t, kBucketCount> buckets_{};
+        uint64_t count_ = 0;
+        uint64_t sum_ = 0;
+        uint64_t min_ = UINT64_MAX;
+        uint64_t max_ = 0;
+    };
+
+    // Low-overhead telemetry for the plugin's hot paths: event counters and
+    // latency histograms for a few named stages and for every method call.
+    //
+    // Recording never locks. Each thread writes to one of kStripes
+    // cache-line-aligned stripes with relaxed atomic adds, so threads only
+    // contend once there are more of them than stripes; Collect sums the
+    // stripes without stopping the writers, and so sees each counter at some
+    // recent value rather than all of them at one instant. A stripe's
+    // histogram buckets are allocated on its first sample.
+    //
+    // With FLUTTER_BLE_PERIPHERAL_METRICS 0 nothing is allocated, recording
+    // compiles to nothing and Collect returns an empty snapshot.
+    class Metrics {
+    public:
+        static constexpr size_t kStripes = 16;
+        static constexpr size_t kHistogramCount = kMetricLatencyCount + kMethodCount;
+
+        struct Snapshot {
+            bool enabled = kMetricsEnabled;
+            std::array<uint64_t, kMetricCounterCount> counters{};
+            // kMetricLatencyCount stage histograms, then one per Method.
+            std::vector<LatencyHistogram> histograms;
+
+            uint64_t counter(MetricCounter counter) const { return counters[static_cast<size_t>(counter)]; }
+            const LatencyHistogram& latency(MetricLatency latency) const {
+                return histograms[static_cast<size_t>(latency)];
+            }
+            const LatencyHistogram& method(Method method) const {
+                return histograms[kMetricLatencyCount + static_cast<size_t>(method)];
+            }
+        };
+
+        explicit Metrics(const Clock& clock);
+        ~Metrics();
+
+        // Disallow copy and assign.
+        Metrics(const Metrics&) = delete;
+        Metrics& operator=(const Metrics&) = delete;
+
+        // The clock's time, or 0 without metrics so that timing a stage
+        // costs nothing either.
+        std::chrono::nanoseconds Now() const {
+            if constexpr (kMetricsEnabled) return clock_.Now();
+            return std::chrono::nanoseconds(0);
+        }
+
+        void Add(MetricCounter counter, uint64_t count = 1) {
+            if constexpr (kMetricsEnabled) {
+                LocalStripe().counters[static_cast<size_t>(counter)].fetch_add(count, std::memory_order_relaxed);
+            }
+        }
+
+        void Record(MetricLatency latency, std::chrono::nanoseconds elapsed) {
+            if constexpr (kMetricsEnabled) RecordHistogram(static_cast<size_t>(latency), elapsed);
+        }
+
+        // Records |latency| since |since|, a Now() time.
+        void RecordSince(MetricLatency latency, std::chrono::nanoseconds since) {
+            if constexpr (kMetricsEnabled) RecordHistogram(static_cast<size_t>(latency), clock_.Now() - since);
+        }
+
+        void RecordMethod(Method method, std::chrono::nanoseconds elapsed) {
+            if constexpr (kMetricsEnabled) {
+                RecordHistogram(kMetricLatencyCount + static_cast<size_t>(method), elapsed);
+            }
+        }
+
+        // Counts a StartAdvertising call and starts timing kPublisherStart.
+        // A second request before the publisher starts restarts the timing.
+        void OnPublisherStartRequested();
+
+        // Counts a transition into |status| and, on started, records
+        // kPublisherStart if a start was requested.
+        void OnPublisherStatus(PublisherStatus status);
+
+        Snapshot Collect() const;
+
+    private:
+        // One histogram's samples in one stripe.
+        struct StripeHistogram {
+            StripeHistogram();
+
+            std::array<std::atomic<uint64_t>, LatencyHistogram::kBucketCount> buckets;
+            std::atomic<uint64_t> sum;
+            std::atomic<uint64_t> min;
+            std::atomic<uint64_t> max;
+        };
+
+        struct alignas(64) Stripe {
+            Stripe();
+
+            std::array<std::atomic<uint64_t>, kMetricCounterCount> counters;
+            std::array<std::atomic<StripeHistogram*>, kHistogramCount> histograms;
+        };
+
+        // The calling thread's stripe, assigned round-robin on the thread's
+        // first use of any Metrics.
+        Stripe& LocalStripe() const;
+
+        void RecordHistogram(size_t histogram, std::chrono::nanoseconds elapsed);
+
+        static constexpr int64_t kNoStartRequest = -1;
+
+        const Clock& clock_;
+        std::unique_ptr<Stripe[]> stripes_;
+        std::atomic<int64_t> publisher_start_requested_{ kNoStartRequest };
+    };
+
+    // Records the time from construction to destruction as |method|'s
+    // latency.
+    class MethodTimer {
+    public:
+        MethodTimer(Metrics& metrics, Method method)
+            : metrics_(metrics), method_(method), started_(metrics.Now()) {}
+        ~MethodTimer() { metrics_.RecordMethod(method_, metrics_.Now() - started_); }
+
+        // Disallow copy and assign.
+        MethodTimer(const MethodTimer&) = delete;
+        MethodTimer& operator=(const MethodTimer&) = delete;
+
+    private:
+        Metrics& metrics_;
+        Method method_;
+        std::chrono::nanoseconds started_;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_METRICS_H_
@@ -0,0 +1,120 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_MPSC_QUEUE_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_MPSC_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#ifdef _MSC_VER
+#pragma warning( push )
+// The padding added by alignas is the point: it keeps the indices apart.
+#pragma warning( disable : 4324)
+#endif
+
+namespace flutter_ble_peripheral {
+
+    // Bounded, lock-free multi-producer/single-consumer queue.
+    //
+    // Any number of threads may call TryPush concurrently; exactly one thread
+    // may call TryPop. Each slot carries a sequence number that tells producers
+    // and the consumer whose turn it is (D. Vyukov's bounded queue), so a push
+    // is one CAS on the tail and a pop is uncontended. Slots are constructed
+    // up front and reused; capacity is rounded up to a power of two.
+    template <typename T>
+    class MpscQueue {
+    public:
+        explicit MpscQueue(size_t capacity)
+            : capacity_(RoundUpToPowerOfTwo(capacity)),
+              mask_(capacity_ - 1),
+              cells_(std::make_unique<Cell[]>(capacity_)) {
+            for (size_t i = 0; i < capacity_; ++i) {
+                cells_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        // Disallow copy and assign.
+        MpscQueue(const MpscQueue&) = delete;
+        MpscQueue& operator=(const MpscQueue&) = delete;
+
+        // Producer side, any thread. Returns false if the queue is full.
+        template <typename Fill>
+        bool TryPushWith(Fill&& fill) {
+            size_t tail = tail_.load(std::memory_order_relaxed);
+            Cell* cell;
+            for (;;) {
+                cell = &cells_[tail & mask_];
+                const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                const auto lag = static_cast<std::ptrdiff_t>(sequence - tail);
+                if (lag == 0) {
+                    if (tail_.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)) break;
+                }
+                else if (lag < 0) {
+                    // The consumer has not released this slot yet.
+                    return false;
+                }
+                else {
+                    tail = tail_.load(std::memory_order_relaxed);
+                }
+            }
+            fill(cell->value);
+            cell->sequence.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool TryPush(T value) {
+            return TryPushWith([&value](T& slot) { slot = std::move(value); });
+        }
+
+        // Consumer side. Returns false if the queue is empty or the next
+        // producer has claimed its slot but not finished filling it.
+        template <typename Consume>
+        bool TryPopWith(Consume&& consume) {
+            const size_t head = head_.load(std::memory_order_relaxed);
+            Cell& cell = cells_[head & mask_];
+            if (cell.sequence.load(std::memory_order_acquire) != head + 1) return false;
+            consume(cell.value);
+            cell.sequence.store(head + capacity_, std::memory_order_release);
+            head_.store(head + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        bool TryPop(T& value) {
+            return TryPopWith([&value](T& slot) { value = std::move(slot); });
+        }
+
+        // Approximate when called concurrently with pushes or pops.
+        size_t size() const {
+            const size_t head = head_.load(std::memory_order_relaxed);
+            const size_t tail = tail_.load(std::memory_order_relaxed);
+            return tail > head ? tail - head : 0;
+        }
+        size_t capacity() const { return capacity_; }
+
+    private:
+        struct Cell {
+            std::atomic<size_t> sequence{ 0 };
+            T value{};
+        };
+
+        static size_t RoundUpToPowerOfTwo(size_t value) {
+            size_t result = 1;
+            while (result < value) result <<= 1;
+            return result;
+        }
+
+        const size_t capacity_;
+        const size_t mask_;
+        std::unique_ptr<Cell[]> cells_;
+
+        alignas(64) std::atomic<size_t> tail_{ 0 };
+        alignas(64) std::atomic<size_t> head_{ 0 };
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#ifdef _MSC_VER
+#pragma warning( pop )
+#endif
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_MPSC_QUEUE_H_
@@ -0,0 +1,88 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_PERFECT_HASH_TABLE_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_PERFECT_HASH_TABLE_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace flutter_ble_peripheral {
+
+    // A perfect hash over a fixed set of names, built at compile time.
+    //
+    // The constructor searches for a seed under which every name lands in its
+    // own slot of a power-of-two table at least four times the size of the
+    // set, so a lookup is one hash, one table read and one string comparison.
+    // Names map to their index in the array the table was built from.
+    //
+    // If no seed is found (which in practice only happens with duplicate
+    // names) valid() is false; declare tables constexpr and static_assert on
+    // it so a bad set fails the build instead of a lookup.
+    template <size_t N>
+    class PerfectHashTable {
+    public:
+        static constexpr size_t kSlots = [] {
+            size_t slots = 1;
+            while (slots < 4 * N) slots <<= 1;
+            return slots;
+        }();
+
+        constexpr explicit PerfectHashTable(const std::array<std::string_view, N>& names)
+            : names_(names) {
+            for (uint32_t seed = 1; seed <= kMaxSeeds; ++seed) {
+                if (TryBuild(seed)) {
+                    seed_ = seed;
+                    valid_ = true;
+                    return;
+                }
+            }
+        }
+
+        constexpr std::optional<size_t> Find(std::string_view name) const {
+            uint8_t slot = slots_[Slot(name, seed_)];
+            if (slot == 0 || names_[slot - 1u] != name) return std::nullopt;
+            return static_cast<size_t>(slot - 1u);
+        }
+
+        constexpr bool valid() const { return valid_; }
+        constexpr uint32_t seed() const { return seed_; }
+
+    private:
+        static_assert(N > 0 && N < 255, "slots store the index plus one in a byte");
+
+        static constexpr uint32_t kMaxSeeds = 4096;
+
+        // Seeded FNV-1a with a final avalanche so the low bits used for the
+        // slot depend on every character.
+        static constexpr size_t Slot(std::string_view name, uint32_t seed) {
+            uint32_t hash = 2166136261u ^ seed;
+            for (char c : name) {
+                hash ^= static_cast<uint8_t>(c);
+                hash *= 16777619u;
+            }
+            hash ^= hash >> 16;
+            hash *= 0x7FEB352Du;
+            hash ^= hash >> 15;
+            return hash & (kSlots - 1);
+        }
+
+        constexpr bool TryBuild(uint32_t seed) {
+            for (auto& slot : slots_) slot = 0;
+            for (size_t i = 0; i < N; ++i) {
+                auto& slot = slots_[Slot(names_[i], seed)];
+                if (slot != 0) return false;
+                slot = static_cast<uint8_t>(i + 1);
+            }
+            return true;
+        }
+
+        std::array<std::string_view, N> names_{};
+        std::array<uint8_t, kSlots> slots_{};
+        uint32_t seed_ = 0;
+        bool valid_ = false;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_PERFECT_HASH_TABLE_H_
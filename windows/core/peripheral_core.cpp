@@ -0,0 +1,71 @@
+#include "peripheral_core.h"
+
+namespace flutter_ble_peripheral {
+
+    PeripheralCore::PeripheralCore(RadioBackend& backend) : backend_(backend) {}
+
+    BluetoothPeripheralState PeripheralCore::Start(const AdvertiseData& data) {
+        if (IsAdvertising()) {
+            backend_.StopAdvertising();
+        }
+        advertise_data_ = data;
+        ++publisher_;
+        if (!backend_.StartAdvertising(advertise_data_)) {
+            state_ = PeripheralState::idle;
+            return BluetoothPeripheralState::unsupported;
+        }
+        state_ = PeripheralState::advertising;
+        return BluetoothPeripheralState::ready;
+    }
+
+    BluetoothPeripheralState PeripheralCore::Stop() {
+        backend_.StopAdvertising();
+        advertise_data_ = AdvertiseData();
+        state_ = PeripheralState::idle;
+        return BluetoothPeripheralState::ready;
+    }
+
+    UpdateResult PeripheralCore::Update(const AdvertiseData& data) {
+        auto started_at = std::chrono::steady_clock::now();
+        UpdateResult result;
+        result.changedFields = DiffAdvertiseData(advertise_data_, data);
+        if (!IsAdvertising()) {
+            result.state = Start(data);
+            result.restarted = true;
+        }
+        else if (result.changedFields == 0) {
+            result.state = BluetoothPeripheralState::ready;
+        }
+        else if (backend_.UpdateAdvertisement(data, result.changedFields)) {
+            advertise_data_ = data;
+            result.state = BluetoothPeripheralState::ready;
+        }
+        else {
+            result.state = Start(data);
+            result.restarted = true;
+        }
+        result.duration = std::chrono::steady_clock::now() - started_at;
+        return result;
+    }
+
+    void PeripheralCore::OnPublisherStatusChanged(PublisherStatus status, uint64_t publisher) {
+        // The Stopped of a publisher that was stopped to make way for a new
+        // one can arrive after the new one started.
+        if (publisher != publisher_) return;
+        publisher_status_ = status;
+        switch (status) {
+        case PublisherStatus::waiting:
+        case PublisherStatus::started:
+            state_ = PeripheralState::advertising;
+            break;
+        case PublisherStatus::stopped:
+        case PublisherStatus::aborted:
+            state_ = PeripheralState::idle;
+            break;
+        case PublisherStatus::created:
+        case PublisherStatus::stopping:
+            break;
+        }
+    }
+
+}  // namespace flutter_ble_peripheral
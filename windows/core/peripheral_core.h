@@ -0,0 +1,66 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_PERIPHERAL_CORE_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_PERIPHERAL_CORE_H_
+
+#include "advertise_data.h"
+#include "peripheral_state.h"
+#include "radio_backend.h"
+
+#include <chrono>
+#include <cstdint>
+
+namespace flutter_ble_peripheral {
+
+    // Outcome of PeripheralCore::Update.
+    struct UpdateResult {
+        BluetoothPeripheralState state = BluetoothPeripheralState::unknown;
+        // AdvertiseDataField bits that differed from the previous payload.
+        uint32_t changedFields = 0;
+        // True if the backend could not swap in place and the advertisement
+        // was stopped and started again.
+        bool restarted = false;
+        std::chrono::nanoseconds duration{ 0 };
+    };
+
+    // Advertising state machine shared by every platform adapter.
+    //
+    // The core owns the current payload and the peripheral state; the backend
+    // only moves bytes to the radio.
+    class PeripheralCore {
+    public:
+        explicit PeripheralCore(RadioBackend& backend);
+
+        // Disallow copy and assign.
+        PeripheralCore(const PeripheralCore&) = delete;
+        PeripheralCore& operator=(const PeripheralCore&) = delete;
+
+        BluetoothPeripheralState Start(const AdvertiseData& data);
+        BluetoothPeripheralState Stop();
+
+        // Replaces the advertised payload with |data|, touching only the
+        // fields that changed and keeping the advertisement on air when the
+        // backend allows it. Starts advertising if it was not running.
+        UpdateResult Update(const AdvertiseData& data);
+
+        // Called by the backend whenever a publisher reports a new status.
+        // |publisher| is its number, as described in RadioBackend. Statuses
+        // of publishers a later Start replaced are ignored.
+        void OnPublisherStatusChanged(PublisherStatus status, uint64_t publisher);
+
+        bool IsAdvertising() const { return state_ == PeripheralState::advertising; }
+        PeripheralState state() const { return state_; }
+        PublisherStatus publisher_status() const { return publisher_status_; }
+        const AdvertiseData& advertise_data() const { return advertise_data_; }
+        // Number of the publisher the last Start set up; 0 before any.
+        uint64_t publisher() const { return publisher_; }
+
+    private:
+        RadioBackend& backend_;
+        AdvertiseData advertise_data_;
+        PeripheralState state_ = PeripheralState::idle;
+        PublisherStatus publisher_status_ = PublisherStatus::created;
+        uint64_t publisher_ = 0;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_PERIPHERAL_CORE_H_
@@ -0,0 +1,54 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_PERIPHERAL_STATE_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_PERIPHERAL_STATE_H_
+
+#include <cstdint>
+
+namespace flutter_ble_peripheral {
+
+    // Mirrors BluetoothPeripheralState in
+    // lib/src/models/enums/bluetooth_peripheral_state.dart. The numeric values
+    // are sent over the method channel and must stay in sync with Dart.
+    enum class BluetoothPeripheralState : int32_t {
+        granted = 0,
+        denied = 1,
+        permanentlyDenied = 2,
+        restricted = 3,
+        limited = 4,
+        turnedOff = 5,
+        unsupported = 6,
+        unknown = 7,
+        ready = 8,
+    };
+
+    // Mirrors PeripheralState in lib/src/models/peripheral_state.dart.
+    enum class PeripheralState : int32_t {
+        unknown = 0,
+        unsupported = 1,
+        unauthorized = 2,
+        poweredOff = 3,
+        idle = 4,
+        advertising = 5,
+        connected = 6,
+    };
+
+    // Mirrors winrt BluetoothLEAdvertisementPublisherStatus.
+    enum class PublisherStatus : int32_t {
+        created = 0,
+        waiting = 1,
+        started = 2,
+        stopping = 3,
+        stopped = 4,
+        aborted = 5,
+    };
+
+    // Mirrors winrt RadioState.
+    enum class RadioState : int32_t {
+        unknown = 0,
+        on = 1,
+        off = 2,
+        disabled = 3,
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_PERIPHERAL_STATE_H_
@@ -0,0 +1,47 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_RADIO_BACKEND_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_RADIO_BACKEND_H_
+
+#include "advertise_data.h"
+#include "scan_settings.h"
+
+namespace flutter_ble_peripheral {
+
+    // The part of the radio the core drives. The Windows plugin implements it
+    // on top of BluetoothLEAdvertisementPublisher and
+    // BluetoothLEAdvertisementWatcher; tests and benchmarks use a mock.
+    //
+    // Every StartAdvertising call sets up a new publisher. Publishers are
+    // numbered from 1 in call order, refused calls included. Status changes
+    // flow back through PeripheralCore::OnPublisherStatusChanged with the
+    // number of the publisher that raised them, so a status that a replaced
+    // publisher raises late cannot be mistaken for the current one's.
+    class RadioBackend {
+    public:
+        virtual ~RadioBackend() = default;
+
+        // Starts broadcasting |data| on a new publisher. Returns false if the
+        // radio refused.
+        virtual bool StartAdvertising(const AdvertiseData& data) = 0;
+
+        // Stops broadcasting and drops the current payload.
+        virtual void StopAdvertising() = 0;
+
+        // Swaps the payload of a running advertisement for |data|. |changed|
+        // holds the AdvertiseDataField bits that differ from the current
+        // payload. Returns false if the radio cannot apply the change in place,
+        // in which case the core falls back to a stop/start cycle.
+        virtual bool UpdateAdvertisement(const AdvertiseData& data, uint32_t changed) = 0;
+
+        // Starts listening for advertisements in |settings|' mode, reporting
+        // each device at most once per interval, or restarts the scanner
+        // with them. The backend scans continuously; ScanSession turns it on
+        // and off for shorter windows. Returns false if the radio refused.
+        virtual bool StartScan(const ScanSettings& settings) = 0;
+
+        // Stops listening. A no-op when the scanner is not running.
+        virtual void StopScan() = 0;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_RADIO_BACKEND_H_
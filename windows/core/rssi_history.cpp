@@ -0,0 +1,362 @@
+#include "rssi_history.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if FLUTTER_BLE_PERIPHERAL_X86
+#include <immintrin.h>
+#endif
+
+namespace flutter_ble_peripheral {
+
+    using internal::RssiSummary;
+
+    namespace {
+
+        constexpr int64_t kMicrosPerSecond = 1000000;
+
+        void SummarizeScalar(const int8_t* samples, size_t count, RssiSummary& summary) {
+            int64_t sum = 0;
+            int64_t squares = 0;
+            int8_t min = summary.min;
+            int8_t max = summary.max;
+            for (size_t i = 0; i < count; ++i) {
+                const int8_t value = samples[i];
+                sum += value;
+                squares += value * value;
+                min = std::min(min, value);
+                max = std::max(max, value);
+            }
+            summary.sum += sum;
+            summary.sumSquares += squares;
+            summary.min = min;
+            summary.max = max;
+        }
+
+        // The vector kernels work on samples biased to unsigned bytes,
+        // b = x + 128, which SSE2 can sum (psadbw) and bound (pminub) without
+        // widening, then take the bias back out:
+        //   sum(x) = sum(b) - 128n,  sum(x²) = sum(b²) - 256 sum(b) + 16384n.
+        // A 32-bit lane of sum(b²) gathers at most 4 * 255² per 16 samples,
+        // which stays below 2³¹ up to kMaxSamplesPerDevice.
+        void Unbias(size_t count, uint64_t biased_sum, uint64_t biased_squares, uint8_t biased_min,
+                    uint8_t biased_max, RssiSummary& summary) {
+            if (count == 0) return;
+            const auto n = static_cast<int64_t>(count);
+            const auto sum = static_cast<int64_t>(biased_sum);
+            summary.sum += sum - 128 * n;
+            summary.sumSquares += static_cast<int64_t>(biased_squares) - 256 * sum + 16384 * n;
+            summary.min = std::min(summary.min, static_cast<int8_t>(biased_min - 128));
+            summary.max = std::max(summary.max, static_cast<int8_t>(biased_max - 128));
+        }
+
+#if FLUTTER_BLE_PERIPHERAL_X86
+        FLUTTER_BLE_PERIPHERAL_TARGET("sse2")
+        void SummarizeSse2(const int8_t* samples, size_t count, RssiSummary& summary) {
+            const __m128i bias = _mm_set1_epi8(static_cast<char>(0x80));
+            const __m128i zero = _mm_setzero_si128();
+            __m128i sums = zero;
+            __m128i squares = zero;
+            __m128i low = _mm_set1_epi8(static_cast<char>(0xFF));
+            __m128i high = zero;
+            size_t i = 0;
+            for (; i + 16 <= count; i += 16) {
+                const __m128i biased =
+                    _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i)), bias);
+                sums = _mm_add_epi64(sums, _mm_sad_epu8(biased, zero));
+                const __m128i first = _mm_unpacklo_epi8(biased, zero);
+                const __m128i second = _mm_unpackhi_epi8(biased, zero);
+                squares = _mm_add_epi32(squares,
+                                        _mm_add_epi32(_mm_madd_epi16(first, first), _mm_madd_epi16(second, second)));
+                low = _mm_min_epu8(low, biased);
+                high = _mm_max_epu8(high, biased);
+            }
+
+            alignas(16) uint64_t sum_lanes[2];
+            alignas(16) uint32_t square_lanes[4];
+            alignas(16) uint8_t low_lanes[16];
+            alignas(16) uint8_t high_lanes[16];
+            _mm_store_si128(reinterpret_cast<__m128i*>(sum_lanes), sums);
+            _mm_store_si128(reinterpret_cast<__m128i*>(square_lanes), squares);
+            _mm_store_si128(reinterpret_cast<__m128i*>(low_lanes), low);
+            _mm_store_si128(reinterpret_cast<__m128i*>(high_lanes), high);
+            uint64_t square_sum = 0;
+            for (uint32_t lane : square_lanes) square_sum += lane;
+            Unbias(i, sum_lanes[0] + sum_lanes[1], square_sum, *std::min_element(low_lanes, low_lanes + 16),
+                   *std::max_element(high_lanes, high_lanes + 16), summary);
+            SummarizeScalar(samples + i, count - i, summary);
+        }
+
+        FLUTTER_BLE_PERIPHERAL_TARGET("avx2")
+        void SummarizeAvx2(const int8_t* samples, size_t count, RssiSummary& summary) {
+            const __m256i bias = _mm256_set1_epi8(static_cast<char>(0x80));
+            const __m256i zero = _mm256_setzero_si256();
+            __m256i sums = zero;
+            __m256i squares = zero;
+            __m256i low = _mm256_set1_epi8(static_cast<char>(0xFF));
+            __m256i high = zero;
+            size_t i = 0;
+            for (; i + 32 <= count; i += 32) {
+                const __m256i biased =
+                    _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + i)), bias);
+                sums = _mm256_add_epi64(sums, _mm256_sad_epu8(biased, zero));
+                const __m256i first = _mm256_unpacklo_epi8(biased, zero);
+                const __m256i second = _mm256_unpackhi_epi8(biased, zero);
+                squares = _mm256_add_epi32(
+                    squares, _mm256_add_epi32(_mm256_madd_epi16(first, first), _mm256_madd_epi16(second, second)));
+                low = _mm256_min_epu8(low, biased);
+                high = _mm256_max_epu8(high, biased);
+            }
+
+            alignas(32) uint64_t sum_lanes[4];
+            alignas(32) uint32_t square_lanes[8];
+            alignas(32) uint8_t low_lanes[32];
+            alignas(32) uint8_t high_lanes[32];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(sum_lanes), sums);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(square_lanes), squares);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(low_lanes), low);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(high_lanes), high);
+            uint64_t square_sum = 0;
+            for (uint32_t lane : square_lanes) square_sum += lane;
+            Unbias(i, sum_lanes[0] + sum_lanes[1] + sum_lanes[2] + sum_lanes[3], square_sum,
+                   *std::min_element(low_lanes, low_lanes + 32), *std::max_element(high_lanes, high_lanes + 32),
+                   summary);
+            SummarizeScalar(samples + i, count - i, summary);
+        }
+#endif
+
+        internal::RssiSummaryKernel KernelFor(SimdLevel level) {
+#if FLUTTER_BLE_PERIPHERAL_X86
+            switch (level) {
+            case SimdLevel::kAvx2:
+                return SummarizeAvx2;
+            case SimdLevel::kSse2:
+                return SummarizeSse2;
+            case SimdLevel::kScalar:
+                break;
+            }
+#else
+            (void)level;
+#endif
+            return SummarizeScalar;
+        }
+
+        // Counts of each sample value, restricted to the [min, max] range
+        // the summary kernel found, so zeroing and walking the bins costs
+        // the spread of the readings rather than all 256 values.
+        class Histogram {
+        public:
+            Histogram(int8_t min, int8_t max) : min_(min), bins_(static_cast<size_t>(max - min + 1)) {
+                std::fill(counts_, counts_ + kLanes * bins_, 0u);
+            }
+
+            // Consecutive samples go to different lanes so that runs of
+            // equal readings do not serialize on one counter.
+            void Add(const int8_t* samples, size_t count) {
+                uint32_t* lanes[kLanes];
+                for (size_t lane = 0; lane < kLanes; ++lane) lanes[lane] = counts_ + lane * bins_;
+                size_t i = 0;
+                for (; i + kLanes <= count; i += kLanes) {
+                    ++lanes[0][samples[i] - min_];
+                    ++lanes[1][samples[i + 1] - min_];
+                    ++lanes[2][samples[i + 2] - min_];
+                    ++lanes[3][samples[i + 3] - min_];
+                }
+                for (; i < count; ++i) ++lanes[0][samples[i] - min_];
+            }
+
+            // The values at the 1-based |ranks|, which must be ascending.
+            template <size_t N>
+            void ValuesAtRanks(const uint32_t (&ranks)[N], int8_t (&values)[N]) const {
+                uint32_t seen = 0;
+                size_t next = 0;
+                for (size_t bin = 0; bin < bins_ && next < N; ++bin) {
+                    for (size_t lane = 0; lane < kLanes; ++lane) seen += counts_[lane * bins_ + bin];
+                    while (next < N && seen >= ranks[next]) values[next++] = static_cast<int8_t>(min_ + static_cast<int>(bin));
+                }
+            }
+
+        private:
+            static constexpr size_t kLanes = 4;
+
+            int min_;
+            size_t bins_;
+            uint32_t counts_[kLanes * 256];
+        };
+
+        // Nearest-rank: the smallest sample with at least |percent| of the
+        // samples at or below it.
+        uint32_t Rank(uint32_t count, uint32_t percent) {
+            return std::max<uint32_t>(1, (count * percent + 99) / 100);
+        }
+
+    }  // namespace
+
+    RssiHistory::RssiHistory(RssiHistoryOptions options)
+        : level_(std::min(options.simdLevel, DetectSimdLevel())),
+          process_noise_(options.processNoise),
+          measurement_noise_(options.measurementNoise),
+          max_devices_(std::max<size_t>(options.maxDevices, 1)),
+          table_(max_devices_) {
+        kernel_ = KernelFor(level_);
+        const size_t wanted = std::clamp<size_t>(options.samplesPerDevice, 1, kMaxSamplesPerDevice);
+        ring_shift_ = 0;
+        while ((size_t{ 1 } << ring_shift_) < wanted) ++ring_shift_;
+        ring_mask_ = (size_t{ 1 } << ring_shift_) - 1;
+
+        addresses_.resize(max_devices_);
+        heads_.resize(max_devices_);
+        counts_.resize(max_devices_);
+        totals_.resize(max_devices_);
+        last_seen_.resize(max_devices_);
+        estimates_.resize(max_devices_);
+        variances_.resize(max_devices_);
+        const size_t samples = max_devices_ << ring_shift_;
+        timestamps_.resize(samples);
+        rssi_.resize(samples);
+        tx_power_.resize(samples);
+    }
+
+    void RssiHistory::Record(uint64_t address, std::chrono::microseconds timestamp, int16_t rssi,
+                             std::optional<int8_t> tx_power) {
+        const auto reading = static_cast<int8_t>(std::clamp<int16_t>(rssi, INT8_MIN, INT8_MAX));
+        const auto measured = static_cast<float>(reading);
+        int64_t time = timestamp.count();
+
+        uint32_t device = table_.Find(address);
+        if (device == AddressTable::kNone) {
+            device = AllocateDevice(address);
+            estimates_[device] = measured;
+            variances_[device] = measurement_noise_;
+        }
+        else {
+            time = std::max(time, last_seen_[device]);
+            const float elapsed = static_cast<float>(time - last_seen_[device]) / static_cast<float>(kMicrosPerSecond);
+            const float predicted = variances_[device] + process_noise_ * elapsed;
+            const float gain = predicted / (predicted + measurement_noise_);
+            estimates_[device] += gain * (measured - estimates_[device]);
+            variances_[device] = (1.0f - gain) * predicted;
+        }
+
+        const size_t slot = (static_cast<size_t>(device) << ring_shift_) + heads_[device];
+        timestamps_[slot] = time;
+        rssi_[slot] = reading;
+        tx_power_[slot] = tx_power.value_or(kNoTxPower);
+        heads_[device] = static_cast<uint32_t>((heads_[device] + 1) & ring_mask_);
+        counts_[device] = static_cast<uint32_t>(std::min<size_t>(counts_[device] + size_t{ 1 }, ring_mask_ + 1));
+        ++totals_[device];
+        last_seen_[device] = time;
+        ++samples_;
+    }
+
+    std::optional<RssiStats> RssiHistory::Query(uint64_t address, RssiWindow window) const {
+        const uint32_t device = table_.Find(address);
+        if (device == AddressTable::kNone || counts_[device] == 0) return std::nullopt;
+
+        const size_t count = counts_[device];
+        size_t begin = 0;
+        if (window.samples != 0 && window.samples < count) begin = count - window.samples;
+        if (window.span.count() > 0) {
+            // Timestamps are non-decreasing, so the window's oldest sample
+            // can be found by bisection.
+            const int64_t oldest = timestamps_[At(device, count - 1)] - window.span.count();
+            size_t low = begin;
+            size_t high = count - 1;
+            while (low < high) {
+                const size_t middle = low + (high - low) / 2;
+                if (timestamps_[At(device, middle)] < oldest) low = middle + 1; else high = middle;
+            }
+            begin = low;
+        }
+        const size_t size = count - begin;
+
+        RssiSummary summary;
+        const Runs runs = RunsOf(device, begin, size);
+        for (int run = 0; run < 2; ++run) kernel_(rssi_.data() + runs.first[run], runs.size[run], summary);
+        Histogram histogram(summary.min, summary.max);
+        for (int run = 0; run < 2; ++run) histogram.Add(rssi_.data() + runs.first[run], runs.size[run]);
+
+        RssiStats stats;
+        stats.samples = static_cast<uint32_t>(size);
+        stats.totalSamples = totals_[device];
+        stats.first = std::chrono::microseconds(timestamps_[At(device, begin)]);
+        stats.last = std::chrono::microseconds(timestamps_[At(device, count - 1)]);
+        stats.latest = rssi_[At(device, count - 1)];
+        stats.min = summary.min;
+        stats.max = summary.max;
+        const double mean = static_cast<double>(summary.sum) / static_cast<double>(size);
+        const double variance = static_cast<double>(summary.sumSquares) / static_cast<double>(size) - mean * mean;
+        stats.mean = static_cast<float>(mean);
+        stats.standardDeviation = static_cast<float>(std::sqrt(std::max(variance, 0.0)));
+        const uint32_t ranks[] = { Rank(stats.samples, 10), Rank(stats.samples, 50), Rank(stats.samples, 90) };
+        int8_t percentiles[3];
+        histogram.ValuesAtRanks(ranks, percentiles);
+        stats.p10 = percentiles[0];
+        stats.median = percentiles[1];
+        stats.p90 = percentiles[2];
+        stats.kalman = estimates_[device];
+        const auto elapsed = stats.last - stats.first;
+        if (size > 1 && elapsed.count() > 0) {
+            stats.advertisementsPerSecond = static_cast<float>(static_cast<double>(size - 1) *
+                static_cast<double>(kMicrosPerSecond) / static_cast<double>(elapsed.count()));
+        }
+        for (size_t i = count; i > begin; --i) {
+            const int8_t power = tx_power_[At(device, i - 1)];
+            if (power != kNoTxPower) {
+                stats.txPower = power;
+                break;
+            }
+        }
+        return stats;
+    }
+
+    void RssiHistory::Clear() {
+        table_.Clear();
+        devices_ = 0;
+    }
+
+    RssiHistory::Stats RssiHistory::stats() const {
+        Stats stats;
+        stats.samples = samples_;
+        stats.evictions = evictions_;
+        stats.devices = devices_;
+        stats.maxDevices = max_devices_;
+        stats.samplesPerDevice = samples_per_device();
+        return stats;
+    }
+
+    RssiHistory::Runs RssiHistory::RunsOf(uint32_t device, size_t begin, size_t count) const {
+        const size_t base = static_cast<size_t>(device) << ring_shift_;
+        const size_t capacity = ring_mask_ + 1;
+        const size_t start = (heads_[device] - counts_[device] + begin) & ring_mask_;
+        const size_t first_size = std::min(count, capacity - start);
+        return { { base + start, base }, { first_size, count - first_size } };
+    }
+
+    size_t RssiHistory::At(uint32_t device, size_t index) const {
+        const size_t start = heads_[device] - counts_[device];
+        return (static_cast<size_t>(device) << ring_shift_) + ((start + index) & ring_mask_);
+    }
+
+    uint32_t RssiHistory::AllocateDevice(uint64_t address) {
+        uint32_t device;
+        if (devices_ < max_devices_) {
+            device = static_cast<uint32_t>(devices_++);
+        }
+        else {
+            // A scan over one timestamp per device, and only when a new
+            // device arrives at a full history.
+            device = static_cast<uint32_t>(std::min_element(last_seen_.begin(), last_seen_.end()) -
+                                           last_seen_.begin());
+            table_.Erase(addresses_[device]);
+            ++evictions_;
+        }
+        table_.Insert(address, device);
+        addresses_[device] = address;
+        heads_[device] = 0;
+        counts_[device] = 0;
+        totals_[device] = 0;
+        return device;
+    }
+
+}  // namespace flutter_ble_peripheral
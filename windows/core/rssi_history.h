@@ -0,0 +1,172 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_RSSI_HISTORY_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_RSSI_HISTORY_H_
+
+#include "address_table.h"
+#include "cpu_features.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+
+    namespace internal {
+
+        // Sum, sum of squares and range of a run of RSSI samples.
+        struct RssiSummary {
+            int64_t sum = 0;
+            int64_t sumSquares = 0;
+            int8_t min = INT8_MAX;
+            int8_t max = INT8_MIN;
+        };
+
+        // Adds |count| samples at |samples| to |summary|. |count| is at
+        // most RssiHistory::kMaxSamplesPerDevice.
+        using RssiSummaryKernel = void (*)(const int8_t* samples, size_t count, RssiSummary& summary);
+
+    }  // namespace internal
+
+    struct RssiHistoryOptions {
+        // Devices tracked at once. A new device replaces the one heard from
+        // least recently.
+        size_t maxDevices = 256;
+        // Samples kept per device; rounded up to a power of two and capped
+        // at RssiHistory::kMaxSamplesPerDevice.
+        size_t samplesPerDevice = 256;
+        // Kalman filter tuning: how far the true RSSI drifts, as variance in
+        // dBm² per second, and the variance of a single reading in dBm².
+        float processNoise = 2.0f;
+        float measurementNoise = 16.0f;
+        // Clamped to what the CPU supports.
+        SimdLevel simdLevel = DetectSimdLevel();
+    };
+
+    // Which of a device's samples RssiHistory::Query looks at: the newest
+    // |samples| of them, of those no more than |span| older than the
+    // newest. Zero means no limit.
+    struct RssiWindow {
+        size_t samples = 0;
+        std::chrono::microseconds span{ 0 };
+    };
+
+    struct RssiStats {
+        // Samples in the window, and recorded since the device was first
+        // heard from.
+        uint32_t samples = 0;
+        uint64_t totalSamples = 0;
+        // Timestamps of the oldest and newest sample in the window.
+        std::chrono::microseconds first{ 0 };
+        std::chrono::microseconds last{ 0 };
+        int8_t latest = 0;
+        int8_t min = 0;
+        int8_t max = 0;
+        // Moving average over the window.
+        float mean = 0;
+        float standardDeviation = 0;
+        // Nearest-rank percentiles over the window.
+        int8_t p10 = 0;
+        int8_t median = 0;
+        int8_t p90 = 0;
+        // The Kalman-smoothed RSSI after the newest sample. The filter runs
+        // over every sample as it is recorded, not just the window.
+        float kalman = 0;
+        // Advertisements per second across the window; zero for fewer than
+        // two samples or a window with no time span.
+        float advertisementsPerSecond = 0;
+        // The newest advertised TX power level in the window.
+        std::optional<int8_t> txPower;
+    };
+
+    // Keeps the recent RSSI samples of each advertiser and computes
+    // proximity statistics from them on demand.
+    //
+    // Samples are stored struct-of-arrays: one ring of timestamps, one of
+    // RSSI and one of TX power per device, each laid out back to back in a
+    // single allocation shared by all devices, so the statistics kernels
+    // stream through contiguous int8 runs. The sums and range come from an
+    // SSE2 or AVX2 kernel picked at construction; percentiles from a
+    // 256-bin histogram, so no query sorts or allocates. The Kalman estimate
+    // is updated as each sample is recorded, which keeps Query independent
+    // of the filter's history.
+    //
+    // Timestamps are taken to be non-decreasing per device; one older than
+    // the device's newest is recorded at the newest.
+    //
+    // Not thread-safe.
+    class RssiHistory {
+    public:
+        static constexpr size_t kMaxSamplesPerDevice = 65536;
+        // The Bluetooth value for "TX power not available".
+        static constexpr int8_t kNoTxPower = 127;
+
+        struct Stats {
+            uint64_t samples = 0;
+            uint64_t evictions = 0;
+            size_t devices = 0;
+            size_t maxDevices = 0;
+            size_t samplesPerDevice = 0;
+        };
+
+        explicit RssiHistory(RssiHistoryOptions options = {});
+
+        // Appends a sample for |address|. |rssi| is clamped to the int8
+        // range. Never allocates.
+        void Record(uint64_t address, std::chrono::microseconds timestamp, int16_t rssi,
+                    std::optional<int8_t> tx_power = std::nullopt);
+
+        // Statistics over |window| of |address|'s samples, or nullopt for a
+        // device with none.
+        std::optional<RssiStats> Query(uint64_t address, RssiWindow window = {}) const;
+
+        void Clear();
+
+        Stats stats() const;
+        size_t size() const { return devices_; }
+        size_t samples_per_device() const { return ring_mask_ + 1; }
+        SimdLevel simd_level() const { return level_; }
+
+    private:
+        // Samples [begin, begin + count) of |device|'s ring in logical
+        // order, oldest first, as up to two contiguous runs.
+        struct Runs {
+            size_t first[2];
+            size_t size[2];
+        };
+        Runs RunsOf(uint32_t device, size_t begin, size_t count) const;
+        // The physical position of |device|'s |index|-th oldest sample.
+        size_t At(uint32_t device, size_t index) const;
+        uint32_t AllocateDevice(uint64_t address);
+
+        internal::RssiSummaryKernel kernel_;
+        SimdLevel level_;
+        float process_noise_;
+        float measurement_noise_;
+        size_t max_devices_;
+        size_t ring_mask_;
+        uint32_t ring_shift_;
+        AddressTable table_;
+
+        // Per device.
+        std::vector<uint64_t> addresses_;
+        std::vector<uint32_t> heads_;
+        std::vector<uint32_t> counts_;
+        std::vector<uint64_t> totals_;
+        std::vector<int64_t> last_seen_;
+        std::vector<float> estimates_;
+        std::vector<float> variances_;
+
+        // Per sample: device d's ring is [d << ring_shift_, (d + 1) << ring_shift_).
+        std::vector<int64_t> timestamps_;
+        std::vector<int8_t> rssi_;
+        std::vector<int8_t> tx_power_;
+
+        size_t devices_ = 0;
+        uint64_t samples_ = 0;
+        uint64_t evictions_ = 0;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_RSSI_HISTORY_H_
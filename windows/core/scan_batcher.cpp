@@ -0,0 +1,62 @@
+#include "scan_batcher.h"
+
+#include <algorithm>
+
+namespace flutter_ble_peripheral {
+
+    ScanBatcher::ScanBatcher(ScanBatchOptions options, size_t capacity)
+        : options_(options), max_batch_size_(options.maxBatchSize), ring_(capacity) {
+        batch_.reserve(ring_.capacity());
+        batch_index_.reserve(ring_.capacity());
+    }
+
+    bool ScanBatcher::Push(const ScanResult& result) {
+        if (!ring_.TryPushWith([&result](ScanEvent& slot) { slot.Assign(result); })) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        return ring_.size() >= max_batch_size_.load(std::memory_order_relaxed);
+    }
+
+    bool ScanBatcher::FlushDue(std::chrono::nanoseconds now) const {
+        const size_t waiting = ring_.size();
+        if (waiting == 0) return false;
+        return waiting >= options_.maxBatchSize || now - last_flush_ >= options_.flushInterval;
+    }
+
+    const std::vector<ScanBatchEntry>& ScanBatcher::Flush(std::chrono::nanoseconds now) {
+        batch_.clear();
+        batch_index_.clear();
+        last_flush_ = now;
+        ++flushes_;
+
+        const bool coalesce = options_.coalesce;
+        auto consume = [this, coalesce](ScanEvent& event) {
+            if (coalesce) {
+                auto inserted = batch_index_.emplace(event.address, batch_.size());
+                if (!inserted.second) {
+                    ScanBatchEntry& entry = batch_[inserted.first->second];
+                    entry.rssiMin = std::min(entry.rssiMin, event.rssi);
+                    entry.rssiMax = std::max(entry.rssiMax, event.rssi);
+                    ++entry.count;
+                    entry.latest = event;
+                    return;
+                }
+            }
+            ScanBatchEntry& entry = batch_.emplace_back();
+            entry.latest = event;
+            entry.rssiMin = event.rssi;
+            entry.rssiMax = event.rssi;
+            entry.count = 1;
+        };
+        while (ring_.TryPopWith(consume)) {
+        }
+        return batch_;
+    }
+
+    void ScanBatcher::SetOptions(const ScanBatchOptions& options) {
+        options_ = options;
+        max_batch_size_.store(options.maxBatchSize, std::memory_order_relaxed);
+    }
+
+}  // namespace flutter_ble_peripheral
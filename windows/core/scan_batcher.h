@@ -0,0 +1,81 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_SCAN_BATCHER_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_SCAN_BATCHER_H_
+
+#include "scan_result.h"
+#include "spsc_ring.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+
+    struct ScanBatchOptions {
+        // A batch is flushed at least this often while results are waiting.
+        std::chrono::milliseconds flushInterval{ 100 };
+        // ...or as soon as this many results are waiting.
+        size_t maxBatchSize = 64;
+        // Merge repeated advertisements from one address within a batch into a
+        // single entry.
+        bool coalesce = false;
+    };
+
+    // One entry of a flushed batch. Without coalescing every entry has a
+    // count of one.
+    struct ScanBatchEntry {
+        ScanEvent latest;
+        int16_t rssiMin = 0;
+        int16_t rssiMax = 0;
+        uint32_t count = 0;
+    };
+
+    // Collects scan results between the watcher and the event sink so results
+    // cross to Dart as one list per flush instead of one message each.
+    //
+    // Push() is the producer side and must only be called from the thread
+    // delivering scan results; it is lock-free and never allocates. Everything
+    // else is the consumer side and must be serialized by the caller.
+    class ScanBatcher {
+    public:
+        explicit ScanBatcher(ScanBatchOptions options = ScanBatchOptions(), size_t capacity = 1024);
+
+        // Disallow copy and assign.
+        ScanBatcher(const ScanBatcher&) = delete;
+        ScanBatcher& operator=(const ScanBatcher&) = delete;
+
+        // Queues |result|. Returns true when enough results are waiting that
+        // the consumer should flush now. Results are dropped, and counted,
+        // while the queue is full.
+        bool Push(const ScanResult& result);
+
+        // True if results are waiting and a flush is due at |now|.
+        bool FlushDue(std::chrono::nanoseconds now) const;
+
+        // Drains every queued result into a batch. The returned entries stay
+        // valid until the next call.
+        const std::vector<ScanBatchEntry>& Flush(std::chrono::nanoseconds now);
+
+        void SetOptions(const ScanBatchOptions& options);
+        const ScanBatchOptions& options() const { return options_; }
+
+        size_t pending() const { return ring_.size(); }
+        uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+        uint64_t flushes() const { return flushes_; }
+
+    private:
+        ScanBatchOptions options_;
+        std::atomic<size_t> max_batch_size_;
+        SpscRing<ScanEvent> ring_;
+        std::atomic<uint64_t> dropped_{ 0 };
+
+        std::vector<ScanBatchEntry> batch_;
+        std::unordered_map<uint64_t, size_t> batch_index_;
+        std::chrono::nanoseconds last_flush_{ 0 };
+        uint64_t flushes_ = 0;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_SCAN_BATCHER_H_
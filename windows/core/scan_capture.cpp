@@ -0,0 +1,447 @@
+#include "scan_capture.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace flutter_ble_peripheral {
+
+    namespace {
+
+        constexpr uint8_t kMagic[4] = { 'B', 'L', 'E', 'C' };
+        constexpr size_t kPlainBodyHeaderSize = 8 + 6 + 1 + 1;
+        // Small enough that a buffer never takes long to write, large enough
+        // for any single advertisement.
+        constexpr size_t kMinBufferSize = 4096;
+        constexpr uint8_t kRepeatPayload = 0;
+        constexpr uint8_t kLiteralPayload = 1;
+
+        void PutLittleEndian(std::vector<uint8_t>& out, uint64_t value, size_t size) {
+            for (size_t i = 0; i < size; ++i) {
+                out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+            }
+        }
+
+        uint64_t ReadLittleEndian(const uint8_t* in, size_t size) {
+            uint64_t value = 0;
+            for (size_t i = 0; i < size; ++i) {
+                value |= static_cast<uint64_t>(in[i]) << (8 * i);
+            }
+            return value;
+        }
+
+        void PutVarint(std::vector<uint8_t>& out, uint64_t value) {
+            while (value >= 0x80) {
+                out.push_back(static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<uint8_t>(value));
+        }
+
+        size_t VarintSize(uint64_t value) {
+            size_t size = 1;
+            while (value >= 0x80) {
+                value >>= 7;
+                ++size;
+            }
+            return size;
+        }
+
+        bool ReadVarint(ByteView in, size_t& offset, uint64_t& value) {
+            value = 0;
+            for (unsigned shift = 0; shift < 64 && offset < in.size(); shift += 7) {
+                const uint8_t byte = in[offset++];
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) return true;
+            }
+            return false;
+        }
+
+        uint64_t ZigZag(int64_t value) {
+            return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+        }
+
+        int64_t UnZigZag(uint64_t value) {
+            return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+        }
+
+        uint8_t ClampRssi(int16_t rssi) {
+            return static_cast<uint8_t>(static_cast<int8_t>(std::clamp<int16_t>(rssi, INT8_MIN, INT8_MAX)));
+        }
+
+    }  // namespace
+
+    std::unique_ptr<ScanCaptureWriter> ScanCaptureWriter::Open(const std::string& path,
+                                                               const ScanCaptureOptions& options) {
+        std::ofstream file(std::filesystem::u8path(path), std::ios::binary | std::ios::trunc);
+        if (!file) return nullptr;
+        uint8_t header[kScanCaptureHeaderSize] = {};
+        std::memcpy(header, kMagic, sizeof(kMagic));
+        header[4] = kScanCaptureVersion;
+        header[5] = options.deltaCompressed ? kScanCaptureDelta : 0;
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        if (!file.flush()) return nullptr;
+        return std::unique_ptr<ScanCaptureWriter>(new ScanCaptureWriter(std::move(file), options));
+    }
+
+    ScanCaptureWriter::ScanCaptureWriter(std::ofstream file, const ScanCaptureOptions& options)
+        : options_{ options.deltaCompressed, std::max(options.bufferSize, kMinBufferSize), options.flushInterval },
+          file_(std::move(file)) {
+        front_.reserve(options_.bufferSize);
+        back_.reserve(options_.bufferSize);
+        stats_.bytes = kScanCaptureHeaderSize;
+        thread_ = std::thread([this] { Run(); });
+    }
+
+    ScanCaptureWriter::~ScanCaptureWriter() { Close(); }
+
+    bool ScanCaptureWriter::Append(const ScanResult& result) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_ || stats_.failed) return false;
+
+        const size_t body = Encode(result);
+        const size_t size = VarintSize(body) + body;
+        if (front_.size() + size > options_.bufferSize) {
+            if (writing_ || size > options_.bufferSize) {
+                ++stats_.dropped;
+                return false;
+            }
+            std::swap(front_, back_);
+            writing_ = true;
+            wake_.notify_one();
+        }
+        PutVarint(front_, body);
+        front_.insert(front_.end(), scratch_.begin(), scratch_.end());
+        Commit(result);
+        ++stats_.records;
+        return true;
+    }
+
+    size_t ScanCaptureWriter::Encode(const ScanResult& result) {
+        const ByteView payload = result.advertisementData;
+        scratch_.clear();
+        if (!options_.deltaCompressed) {
+            PutLittleEndian(scratch_, static_cast<uint64_t>(result.timestamp.count()), 8);
+            PutLittleEndian(scratch_, result.address, 6);
+            scratch_.push_back(ClampRssi(result.rssi));
+            scratch_.push_back(result.flags);
+            scratch_.insert(scratch_.end(), payload.begin(), payload.end());
+            return scratch_.size();
+        }
+
+        PutVarint(scratch_, ZigZag(result.timestamp.count() - last_timestamp_));
+        encoded_device_ = devices_.Find(result.address & 0xFFFFFFFFFFFFull);
+        encoded_new_device_ = encoded_device_ == AddressTable::kNone;
+        bool repeat = false;
+        if (encoded_new_device_) {
+            PutVarint(scratch_, device_payloads_.size());
+            PutLittleEndian(scratch_, result.address, 6);
+        } else {
+            PutVarint(scratch_, encoded_device_);
+            repeat = ByteView(device_payloads_[encoded_device_]) == payload;
+        }
+        scratch_.push_back(ClampRssi(result.rssi));
+        scratch_.push_back(result.flags);
+        if (repeat) {
+            scratch_.push_back(kRepeatPayload);
+        } else {
+            scratch_.push_back(kLiteralPayload);
+            scratch_.insert(scratch_.end(), payload.begin(), payload.end());
+        }
+        return scratch_.size();
+    }
+
+    void ScanCaptureWriter::Commit(const ScanResult& result) {
+        if (!options_.deltaCompressed) return;
+        last_timestamp_ = result.timestamp.count();
+        const ByteView payload = result.advertisementData;
+        if (!encoded_new_device_) {
+            auto& previous = device_payloads_[encoded_device_];
+            if (ByteView(previous) != payload) previous.assign(payload.begin(), payload.end());
+        } else if (device_payloads_.size() < kScanCaptureMaxDevices) {
+            devices_.Insert(result.address & 0xFFFFFFFFFFFFull, static_cast<uint32_t>(device_payloads_.size()));
+            device_payloads_.emplace_back(payload.begin(), payload.end());
+        }
+    }
+
+    void ScanCaptureWriter::Run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait_for(lock, options_.flushInterval, [this] { return writing_ || closed_; });
+            // A quiet interval, or the final flush.
+            if (!writing_ && !front_.empty()) {
+                std::swap(front_, back_);
+                writing_ = true;
+            }
+            if (writing_) {
+                // After a failed write the rest of the capture is discarded.
+                bool ok = !stats_.failed;
+                lock.unlock();
+                if (ok) {
+                    file_.write(reinterpret_cast<const char*>(back_.data()), static_cast<std::streamsize>(back_.size()));
+                    ok = static_cast<bool>(file_.flush());
+                }
+                lock.lock();
+                if (ok) {
+                    stats_.bytes += back_.size();
+                } else {
+                    stats_.failed = true;
+                }
+                back_.clear();
+                writing_ = false;
+                continue;
+            }
+            if (closed_) break;
+        }
+    }
+
+    void ScanCaptureWriter::Close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        wake_.notify_one();
+        if (thread_.joinable()) thread_.join();
+        if (file_.is_open()) file_.close();
+    }
+
+    ScanCaptureWriter::Stats ScanCaptureWriter::stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+    // A read-only view of a whole file.
+    class ScanCaptureReader::Mapping {
+    public:
+        static std::unique_ptr<Mapping> Open(const std::string& path) {
+#ifdef _WIN32
+            HANDLE file = CreateFileW(std::filesystem::u8path(path).c_str(), GENERIC_READ,
+                                      FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                                      FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (file == INVALID_HANDLE_VALUE) return nullptr;
+            LARGE_INTEGER size;
+            const void* data = nullptr;
+            if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+                // The view keeps the file mapped after both handles close.
+                if (HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr)) {
+                    data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                    CloseHandle(mapping);
+                }
+            }
+            CloseHandle(file);
+            if (!data) return nullptr;
+            return std::unique_ptr<Mapping>(new Mapping(data, static_cast<size_t>(size.QuadPart)));
+#else
+            const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) return nullptr;
+            struct stat info;
+            void* data = MAP_FAILED;
+            if (fstat(fd, &info) == 0 && info.st_size > 0) {
+                data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            }
+            close(fd);
+            if (data == MAP_FAILED) return nullptr;
+            madvise(data, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+            return std::unique_ptr<Mapping>(new Mapping(data, static_cast<size_t>(info.st_size)));
+#endif
+        }
+
+        ~Mapping() {
+#ifdef _WIN32
+            UnmapViewOfFile(data_);
+#else
+            munmap(const_cast<void*>(data_), size_);
+#endif
+        }
+
+        // Disallow copy and assign.
+        Mapping(const Mapping&) = delete;
+        Mapping& operator=(const Mapping&) = delete;
+
+        ByteView bytes() const { return ByteView(static_cast<const uint8_t*>(data_), size_); }
+
+    private:
+        Mapping(const void* data, size_t size) : data_(data), size_(size) {}
+
+        const void* data_;
+        size_t size_;
+    };
+
+    std::unique_ptr<ScanCaptureReader> ScanCaptureReader::Open(const std::string& path) {
+        auto mapping = Mapping::Open(path);
+        if (!mapping) return nullptr;
+        auto reader = std::make_unique<ScanCaptureReader>(mapping->bytes());
+        if (!reader->valid()) return nullptr;
+        reader->mapping_ = std::move(mapping);
+        return reader;
+    }
+
+    ScanCaptureReader::ScanCaptureReader(ByteView capture) : capture_(capture) {
+        if (capture.size() >= kScanCaptureHeaderSize && std::memcmp(capture.data(), kMagic, sizeof(kMagic)) == 0 &&
+            capture[4] == kScanCaptureVersion) {
+            flags_ = capture[5];
+            valid_ = true;
+        }
+    }
+
+    ScanCaptureReader::~ScanCaptureReader() = default;
+
+    bool ScanCaptureReader::Next(ScanEvent& event) {
+        if (!valid_ || truncated_ || offset_ >= capture_.size()) return false;
+        size_t offset = offset_;
+        uint64_t length = 0;
+        if (!ReadVarint(capture_, offset, length) || length > capture_.size() - offset ||
+            !Decode(capture_.subview(offset, static_cast<size_t>(length)), event)) {
+            truncated_ = true;
+            return false;
+        }
+        offset_ = offset + static_cast<size_t>(length);
+        return true;
+    }
+
+    bool ScanCaptureReader::Decode(ByteView body, ScanEvent& event) {
+        ScanResult result;
+        if (!delta_compressed()) {
+            if (body.size() < kPlainBodyHeaderSize) return false;
+            result.timestamp = std::chrono::microseconds(static_cast<int64_t>(ReadLittleEndian(body.data(), 8)));
+            result.address = ReadLittleEndian(body.data() + 8, 6);
+            result.rssi = static_cast<int8_t>(body[14]);
+            result.flags = body[15];
+            result.advertisementData = body.subview(kPlainBodyHeaderSize);
+            event.Assign(result);
+            return true;
+        }
+
+        size_t offset = 0;
+        uint64_t timestamp_delta = 0;
+        uint64_t device = 0;
+        if (!ReadVarint(body, offset, timestamp_delta) || !ReadVarint(body, offset, device)) return false;
+        const bool new_device = device == device_addresses_.size();
+        if (new_device) {
+            if (body.size() - offset < 6) return false;
+            result.address = ReadLittleEndian(body.data() + offset, 6);
+            offset += 6;
+        } else if (device < device_addresses_.size()) {
+            result.address = device_addresses_[static_cast<size_t>(device)];
+        } else {
+            return false;
+        }
+        if (body.size() - offset < 3) return false;
+        result.rssi = static_cast<int8_t>(body[offset]);
+        result.flags = body[offset + 1];
+        const uint8_t payload = body[offset + 2];
+        offset += 3;
+        if (payload == kRepeatPayload && !new_device) {
+            result.advertisementData = device_payloads_[static_cast<size_t>(device)];
+        } else if (payload == kLiteralPayload) {
+            result.advertisementData = body.subview(offset);
+        } else {
+            return false;
+        }
+        last_timestamp_ += UnZigZag(timestamp_delta);
+        result.timestamp = std::chrono::microseconds(last_timestamp_);
+        event.Assign(result);
+
+        if (new_device) {
+            if (device_addresses_.size() < kScanCaptureMaxDevices) {
+                device_addresses_.push_back(result.address);
+                device_payloads_.emplace_back(result.advertisementData.begin(), result.advertisementData.end());
+            }
+        } else if (payload == kLiteralPayload) {
+            device_payloads_[static_cast<size_t>(device)].assign(result.advertisementData.begin(),
+                                                                 result.advertisementData.end());
+        }
+        return true;
+    }
+
+    void ScanCaptureReader::Rewind() {
+        offset_ = kScanCaptureHeaderSize;
+        truncated_ = false;
+        last_timestamp_ = 0;
+        device_addresses_.clear();
+        device_payloads_.clear();
+    }
+
+    ScanReplay::ScanReplay(ScanCaptureReader& reader, const Clock& clock, ReplaySpeed speed)
+        : reader_(reader), clock_(clock), speed_(speed) {}
+
+    std::optional<std::chrono::nanoseconds> ScanReplay::Pump(const Deliver& deliver, size_t max_records) {
+        if (done_) return std::nullopt;
+        const auto now = clock_.Now();
+        if (!started_) {
+            if (!reader_.Next(next_)) {
+                done_ = true;
+                return std::nullopt;
+            }
+            has_next_ = true;
+            started_ = true;
+            start_ = now;
+            first_timestamp_ = next_.timestamp;
+        }
+        for (size_t count = 0; count < max_records; ++count) {
+            if (!has_next_) {
+                if (!reader_.Next(next_)) {
+                    done_ = true;
+                    return std::nullopt;
+                }
+                has_next_ = true;
+            }
+            if (speed_ == ReplaySpeed::kRecorded) {
+                const auto due = start_ + (next_.timestamp - first_timestamp_);
+                if (due > now) return due;
+            }
+            has_next_ = false;
+            ++delivered_;
+            deliver(next_.View());
+        }
+        return now;
+    }
+
+    BackgroundScanReplay::BackgroundScanReplay(std::unique_ptr<ScanCaptureReader> reader, ReplaySpeed speed,
+                                               ScanReplay::Deliver deliver)
+        : reader_(std::move(reader)), replay_(*reader_, clock_, speed) {
+        thread_ = std::thread([this, deliver = std::move(deliver)] { Run(deliver); });
+    }
+
+    BackgroundScanReplay::~BackgroundScanReplay() { Stop(); }
+
+    void BackgroundScanReplay::Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        if (thread_.joinable()) thread_.join();
+    }
+
+    void BackgroundScanReplay::Run(ScanReplay::Deliver deliver) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stopping_) {
+            lock.unlock();
+            const auto next = replay_.Pump(deliver);
+            delivered_.store(replay_.delivered(), std::memory_order_relaxed);
+            lock.lock();
+            if (!next) {
+                finished_.store(true, std::memory_order_release);
+                break;
+            }
+            wake_.wait_for(lock, *next - clock_.Now(), [this] { return stopping_; });
+        }
+    }
+
+}  // namespace flutter_ble_peripheral
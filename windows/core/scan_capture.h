@@ -0,0 +1,266 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_SCAN_CAPTURE_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_SCAN_CAPTURE_H_
+
+#include "address_table.h"
+#include "byte_buffer.h"
+#include "clock.h"
+#include "scan_result.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+
+    // On-disk capture of raw advertisements, for replaying field traffic
+    // through the scan pipeline. All integers are little-endian; varints are
+    // LEB128.
+    //
+    //   file   := "BLEC" version:u8 flags:u8 reserved:u16 record*
+    //   record := length:varint body
+    //
+    // Plain records (kScanCaptureDelta clear) stand alone:
+    //
+    //   body := timestamp:u64 address:u8[6] rssi:i8 flags:u8 ad_structures
+    //
+    // Delta records are relative to the records before them:
+    //
+    //   body := timestamp_delta:zigzag-varint device:varint [address:u8[6]]
+    //           rssi:i8 flags:u8 (0:u8 | 1:u8 ad_structures)
+    //
+    // |device| indexes the addresses in order of first appearance; the index
+    // one past the last known device introduces a new one, whose address
+    // follows. Only the first kScanCaptureMaxDevices addresses get an index.
+    // A 0 in place of the AD structures repeats the device's previous ones.
+    //
+    // Files are only ever appended to, so a capture cut short by a crash is a
+    // valid capture up to its last complete record. |timestamp| is in
+    // microseconds since the Unix epoch, as in ScanResult.
+    constexpr uint8_t kScanCaptureVersion = 1;
+    constexpr size_t kScanCaptureHeaderSize = 8;
+    constexpr uint8_t kScanCaptureDelta = 1u << 0;
+    constexpr uint32_t kScanCaptureMaxDevices = 4096;
+
+    struct ScanCaptureOptions {
+        bool deltaCompressed = true;
+        // Size of each of the writer's two buffers.
+        size_t bufferSize = 256 * 1024;
+        // A partly filled buffer is written out at least this often.
+        std::chrono::milliseconds flushInterval{ 500 };
+    };
+
+    // Records advertisements to a capture file from the thread that receives
+    // them without waiting on the disk.
+    //
+    // Append encodes into the front buffer under a mutex that is otherwise
+    // only taken to swap buffers. A background thread writes the back buffer
+    // out. A record that finds the front buffer full while the back buffer
+    // is still being written is dropped and counted rather than waited for.
+    class ScanCaptureWriter {
+    public:
+        struct Stats {
+            uint64_t records = 0;
+            uint64_t dropped = 0;
+            // Bytes written to the file so far, header included.
+            uint64_t bytes = 0;
+            // Set once a write to the file failed; nothing is written after.
+            bool failed = false;
+        };
+
+        // Creates or truncates |path|, a UTF-8 path, and writes the file
+        // header. Returns null if the file cannot be written.
+        static std::unique_ptr<ScanCaptureWriter> Open(const std::string& path,
+                                                       const ScanCaptureOptions& options = ScanCaptureOptions());
+
+        // Closes the writer.
+        ~ScanCaptureWriter();
+
+        // Disallow copy and assign.
+        ScanCaptureWriter(const ScanCaptureWriter&) = delete;
+        ScanCaptureWriter& operator=(const ScanCaptureWriter&) = delete;
+
+        // Records |result|'s address, RSSI, flags, timestamp and AD data.
+        // Safe to call from any thread. Returns false if the record was
+        // dropped, or the writer is closed.
+        bool Append(const ScanResult& result);
+
+        // Writes out everything appended so far and stops the background
+        // thread. Appends after Close are refused.
+        void Close();
+
+        Stats stats() const;
+
+    private:
+        ScanCaptureWriter(std::ofstream file, const ScanCaptureOptions& options);
+
+        // Encodes |result| into scratch_ against the current delta state,
+        // without changing it. Returns the encoded size.
+        size_t Encode(const ScanResult& result);
+        // Moves the delta state past the record last encoded.
+        void Commit(const ScanResult& result);
+        void Run();
+
+        const ScanCaptureOptions options_;
+        std::ofstream file_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable wake_;
+        std::vector<uint8_t> front_;
+        std::vector<uint8_t> back_;
+        // The background thread owns back_ while this is set.
+        bool writing_ = false;
+        bool closed_ = false;
+        Stats stats_;
+
+        // Delta state, guarded by mutex_.
+        std::vector<uint8_t> scratch_;
+        int64_t last_timestamp_ = 0;
+        AddressTable devices_{ kScanCaptureMaxDevices };
+        std::vector<std::vector<uint8_t>> device_payloads_;
+        // What Encode decided about the record in scratch_.
+        uint32_t encoded_device_ = 0;
+        bool encoded_new_device_ = false;
+
+        std::thread thread_;
+    };
+
+    // Reads a capture back, from a memory-mapped file or from bytes in
+    // memory. Not thread-safe.
+    class ScanCaptureReader {
+    public:
+        // Maps |path|, a UTF-8 path. Returns null if it cannot be mapped or
+        // does not start with a capture header.
+        static std::unique_ptr<ScanCaptureReader> Open(const std::string& path);
+
+        // Borrows |capture|, which must outlive the reader.
+        explicit ScanCaptureReader(ByteView capture);
+        ~ScanCaptureReader();
+
+        // Disallow copy and assign.
+        ScanCaptureReader(const ScanCaptureReader&) = delete;
+        ScanCaptureReader& operator=(const ScanCaptureReader&) = delete;
+
+        // False if the header is malformed or of another version.
+        bool valid() const { return valid_; }
+        bool delta_compressed() const { return (flags_ & kScanCaptureDelta) != 0; }
+        size_t size() const { return capture_.size(); }
+
+        // Reads the next record into |event|. Returns false at the end of the
+        // capture or at a torn or malformed record; truncated() tells which.
+        bool Next(ScanEvent& event);
+
+        // True if reading stopped short of the end of the capture.
+        bool truncated() const { return truncated_; }
+
+        // Starts over from the first record.
+        void Rewind();
+
+    private:
+        class Mapping;
+
+        bool Decode(ByteView body, ScanEvent& event);
+
+        std::unique_ptr<Mapping> mapping_;
+        ByteView capture_;
+        size_t offset_ = kScanCaptureHeaderSize;
+        uint8_t flags_ = 0;
+        bool valid_ = false;
+        bool truncated_ = false;
+
+        // Delta state.
+        int64_t last_timestamp_ = 0;
+        std::vector<uint64_t> device_addresses_;
+        std::vector<std::vector<uint8_t>> device_payloads_;
+    };
+
+    enum class ReplaySpeed {
+        // As fast as the records can be delivered.
+        kMaximum,
+        // At the pace the records were captured.
+        kRecorded,
+    };
+
+    // Paces the records of a capture against a Clock. The caller delivers
+    // from Pump and calls it again at the time Pump returns. Not thread-safe.
+    class ScanReplay {
+    public:
+        using Deliver = std::function<void(const ScanResult&)>;
+
+        // |reader| and |clock| must outlive the replay. The first record is
+        // due at the first Pump.
+        ScanReplay(ScanCaptureReader& reader, const Clock& clock, ReplaySpeed speed);
+
+        // Delivers the records due by now, at most |max_records| of them.
+        // Returns when to call again, or nullopt once every record has been
+        // delivered.
+        std::optional<std::chrono::nanoseconds> Pump(const Deliver& deliver, size_t max_records = 1024);
+
+        uint64_t delivered() const { return delivered_; }
+        bool done() const { return done_; }
+
+    private:
+        ScanCaptureReader& reader_;
+        const Clock& clock_;
+        const ReplaySpeed speed_;
+
+        ScanEvent next_;
+        bool has_next_ = false;
+        bool started_ = false;
+        bool done_ = false;
+        // The clock at the first Pump and the first record's timestamp.
+        std::chrono::nanoseconds start_{ 0 };
+        std::chrono::microseconds first_timestamp_{ 0 };
+        uint64_t delivered_ = 0;
+    };
+
+    // Runs a ScanReplay on its own thread against the steady clock.
+    class BackgroundScanReplay {
+    public:
+        // Starts delivering from |reader| on a new thread. |deliver| is
+        // called on that thread.
+        BackgroundScanReplay(std::unique_ptr<ScanCaptureReader> reader, ReplaySpeed speed,
+                             ScanReplay::Deliver deliver);
+
+        // Stops the replay.
+        ~BackgroundScanReplay();
+
+        // Disallow copy and assign.
+        BackgroundScanReplay(const BackgroundScanReplay&) = delete;
+        BackgroundScanReplay& operator=(const BackgroundScanReplay&) = delete;
+
+        // Stops delivering and joins the thread. Must not be called from
+        // |deliver|.
+        void Stop();
+
+        uint64_t delivered() const { return delivered_.load(std::memory_order_relaxed); }
+        // True once every record has been delivered.
+        bool finished() const { return finished_.load(std::memory_order_acquire); }
+
+    private:
+        void Run(ScanReplay::Deliver deliver);
+
+        std::unique_ptr<ScanCaptureReader> reader_;
+        SteadyClock clock_;
+        ScanReplay replay_;
+
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        bool stopping_ = false;
+        std::atomic<uint64_t> delivered_{ 0 };
+        std::atomic<bool> finished_{ false };
+
+        std::thread thread_;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_SCAN_CAPTURE_H_
@@ -0,0 +1,195 @@
+#include "scan_filter.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace flutter_ble_peripheral {
+
+    namespace {
+
+        // Longest body an AD structure in an extended advertisement carries.
+        constexpr size_t kMaxAdBody = kExtendedAdvertisingDataSize - 2;
+
+        uint16_t ReadUint16(const uint8_t* bytes) {
+            return static_cast<uint16_t>(bytes[0] | bytes[1] << 8);
+        }
+
+        uint32_t ReadUint32(const uint8_t* bytes) {
+            return static_cast<uint32_t>(bytes[0]) | static_cast<uint32_t>(bytes[1]) << 8 |
+                static_cast<uint32_t>(bytes[2]) << 16 | static_cast<uint32_t>(bytes[3]) << 24;
+        }
+
+        template <typename T>
+        void SortUnique(std::vector<T>& values) {
+            std::sort(values.begin(), values.end());
+            values.erase(std::unique(values.begin(), values.end()), values.end());
+        }
+
+        template <typename T>
+        bool Contains(const std::vector<T>& sorted, const T& value) {
+            return std::binary_search(sorted.begin(), sorted.end(), value);
+        }
+
+    }  // namespace
+
+    ScanFilterPushDown PushDownScanFilter(const ScanFilterSpec& spec) {
+        ScanFilterPushDown push_down;
+        push_down.minRssi = spec.minRssi;
+        if (spec.serviceUuids.size() == 1) push_down.serviceUuid = spec.serviceUuids[0];
+
+        std::optional<uint16_t> company;
+        ByteView head;
+        if (spec.manufacturerData.size() == 1) {
+            const auto& pattern = spec.manufacturerData[0];
+            company = pattern.companyId;
+            size_t exact = pattern.prefix.size();
+            if (!pattern.mask.empty()) {
+                exact = 0;
+                while (exact < pattern.mask.size() && pattern.mask[exact] == 0xFF) ++exact;
+            }
+            head = ByteView(pattern.prefix).subview(0, exact);
+        }
+        else if (spec.manufacturerData.empty() && spec.companyIds.size() == 1) {
+            company = spec.companyIds[0];
+        }
+        if (company) {
+            push_down.manufacturerPattern = { static_cast<uint8_t>(*company & 0xFF),
+                                              static_cast<uint8_t>(*company >> 8) };
+            push_down.manufacturerPattern.insert(push_down.manufacturerPattern.end(), head.begin(), head.end());
+        }
+        return push_down;
+    }
+
+    std::optional<ScanFilter> ScanFilter::Compile(const ScanFilterSpec& spec) {
+        ScanFilter filter;
+        filter.min_rssi_ = spec.minRssi;
+
+        if (!spec.companyIds.empty()) {
+            filter.required_ |= kCompany;
+            filter.companies_ = spec.companyIds;
+            SortUnique(filter.companies_);
+        }
+        if (!spec.serviceUuids.empty()) {
+            filter.required_ |= kService;
+            for (const auto& spec_uuid : spec.serviceUuids) {
+                // Advertised UUIDs are shortened before the lookup too, so
+                // every form of a base UUID matches every other.
+                const BluetoothUuid uuid = ShortenBluetoothUuid(spec_uuid);
+                if (uuid.size == 2) {
+                    filter.uuids16_.push_back(ReadUint16(uuid.bytes.data()));
+                }
+                else if (uuid.size == 4) {
+                    filter.uuids32_.push_back(ReadUint32(uuid.bytes.data()));
+                }
+                else if (uuid.size == 16) {
+                    filter.uuids128_.push_back(uuid.bytes);
+                }
+                else {
+                    return std::nullopt;
+                }
+            }
+            SortUnique(filter.uuids16_);
+            SortUnique(filter.uuids32_);
+            SortUnique(filter.uuids128_);
+        }
+        if (!spec.manufacturerData.empty()) {
+            filter.required_ |= kManufacturerData;
+            auto patterns = ManufacturerPatternSet::Compile(spec.manufacturerData);
+            if (!patterns) return std::nullopt;
+            filter.patterns_ = std::move(*patterns);
+        }
+        if (!spec.namePrefixes.empty()) {
+            filter.required_ |= kName;
+            for (const auto& prefix : spec.namePrefixes) {
+                if (prefix.size() > kMaxAdBody) return std::nullopt;
+                filter.names_.push_back(
+                    filter.Pack(ByteView(reinterpret_cast<const uint8_t*>(prefix.data()), prefix.size())));
+            }
+        }
+        // Spans address the pool with 16-bit offsets.
+        if (filter.pool_.size() > 0xFFFF) return std::nullopt;
+        return filter;
+    }
+
+    bool ScanFilter::Matches(int16_t rssi, ByteView advertisement_data) const {
+        if (min_rssi_ && rssi < *min_rssi_) return false;
+        if (required_ == 0) return true;
+
+        uint8_t matched = 0;
+        size_t offset = 0;
+        const size_t size = advertisement_data.size();
+        while (offset < size) {
+            const size_t length = advertisement_data[offset];
+            if (length == 0 || offset + 1 + length > size) break;
+            const uint8_t type = advertisement_data[offset + 1];
+            matched |= Evaluate(type, advertisement_data.subview(offset + 2, length - 1));
+            if ((matched & required_) == required_) return true;
+            offset += 1 + length;
+        }
+        return false;
+    }
+
+    uint8_t ScanFilter::Evaluate(uint8_t type, ByteView body) const {
+        switch (type) {
+        case kAdManufacturerSpecificData: {
+            if (body.size() < 2) return 0;
+            const uint16_t company = ReadUint16(body.data());
+            uint8_t matched = 0;
+            if ((required_ & kCompany) && Contains(companies_, company)) matched |= kCompany;
+            if ((required_ & kManufacturerData) && patterns_.MatchesAny(body)) matched |= kManufacturerData;
+            return matched;
+        }
+        case kAdIncompleteUuid16List:
+        case kAdCompleteUuid16List:
+            return (required_ & kService) && MatchesUuids(body, 2) ? kService : 0;
+        case kAdIncompleteUuid32List:
+        case kAdCompleteUuid32List:
+            return (required_ & kService) && MatchesUuids(body, 4) ? kService : 0;
+        case kAdIncompleteUuid128List:
+        case kAdCompleteUuid128List:
+            return (required_ & kService) && MatchesUuids(body, 16) ? kService : 0;
+        case kAdShortenedLocalName:
+        case kAdCompleteLocalName: {
+            if ((required_ & kName) == 0) return 0;
+            for (const auto& name : names_) {
+                if (body.size() >= name.size &&
+                    std::memcmp(body.data(), pool_.data() + name.offset, name.size) == 0) {
+                    return kName;
+                }
+            }
+            return 0;
+        }
+        default:
+            return 0;
+        }
+    }
+
+    bool ScanFilter::MatchesUuids(ByteView list, size_t size) const {
+        for (size_t offset = 0; offset + size <= list.size(); offset += size) {
+            const uint8_t* bytes = list.data() + offset;
+            if (size == 2) {
+                if (Contains(uuids16_, ReadUint16(bytes))) return true;
+                continue;
+            }
+            // A wider UUID on the base UUID matches the 16- or 32-bit one
+            // the filter holds for it.
+            BluetoothUuid uuid;
+            std::memcpy(uuid.bytes.data(), bytes, size);
+            uuid.size = static_cast<uint8_t>(size);
+            uuid = ShortenBluetoothUuid(uuid);
+            if (uuid.size == 2 && Contains(uuids16_, ReadUint16(uuid.bytes.data()))) return true;
+            if (uuid.size == 4 && Contains(uuids32_, ReadUint32(uuid.bytes.data()))) return true;
+            if (uuid.size == 16 && Contains(uuids128_, uuid.bytes)) return true;
+        }
+        return false;
+    }
+
+    ScanFilter::Span ScanFilter::Pack(ByteView bytes) {
+        Span span;
+        span.offset = static_cast<uint16_t>(pool_.size());
+        span.size = static_cast<uint8_t>(std::min<size_t>(bytes.size(), 0xFF));
+        pool_.insert(pool_.end(), bytes.begin(), bytes.end());
+        return span;
+    }
+
+}  // namespace flutter_ble_peripheral
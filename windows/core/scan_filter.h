@@ -0,0 +1,109 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_SCAN_FILTER_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_SCAN_FILTER_H_
+
+#include "ad_encoder.h"
+#include "byte_buffer.h"
+#include "manufacturer_pattern_set.h"
+#include "scan_result.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+
+    // Which advertisements a scan delivers. Every criterion that is set must
+    // hold; within a list, one matching entry is enough. An empty spec lets
+    // everything through.
+    struct ScanFilterSpec {
+        std::vector<uint16_t> companyIds;
+        std::vector<BluetoothUuid> serviceUuids;
+        std::vector<ManufacturerDataPattern> manufacturerData;
+        std::vector<std::string> namePrefixes;
+        std::optional<int16_t> minRssi;
+
+        bool empty() const {
+            return companyIds.empty() && serviceUuids.empty() && manufacturerData.empty() &&
+                namePrefixes.empty() && !minRssi;
+        }
+    };
+
+    // The part of a spec WinRT's watcher can apply itself, so advertisements
+    // it rules out never reach the process. Its AdvertisementFilter ANDs
+    // everything it is given, so only criteria with a single entry qualify.
+    // The compiled ScanFilter still checks every criterion.
+    struct ScanFilterPushDown {
+        // SignalStrengthFilter.InRangeThresholdInDBm.
+        std::optional<int16_t> minRssi;
+        // An AdvertisementFilter byte pattern at offset 0 of the
+        // manufacturer data section: the little-endian company id followed
+        // by the exactly-masked head of the prefix. Empty if none.
+        std::vector<uint8_t> manufacturerPattern;
+        // AdvertisementFilter service UUID.
+        std::optional<BluetoothUuid> serviceUuid;
+
+        bool empty() const { return !minRssi && manufacturerPattern.empty() && !serviceUuid; }
+    };
+
+    ScanFilterPushDown PushDownScanFilter(const ScanFilterSpec& spec);
+
+    // A ScanFilterSpec compiled for the watcher thread.
+    //
+    // Matching makes one pass over the raw AD structures and never
+    // allocates. Each criterion is a bit in a small mask; a structure that
+    // satisfies a criterion sets its bit, and the pass stops as soon as every
+    // required bit is set. The terms a structure is checked against live in
+    // flat sorted arrays per AD type, with the name bytes packed into one
+    // pool; manufacturer data patterns go to a ManufacturerPatternSet.
+    class ScanFilter {
+    public:
+        // Passes everything.
+        ScanFilter() = default;
+
+        // Returns nullopt if a pattern's mask and prefix differ in length, a
+        // pattern or name is longer than an advertisement can carry or the
+        // names add up to more than 64 KB.
+        static std::optional<ScanFilter> Compile(const ScanFilterSpec& spec);
+
+        bool Matches(int16_t rssi, ByteView advertisement_data) const;
+        bool Matches(const ScanResult& result) const { return Matches(result.rssi, result.advertisementData); }
+
+        bool passes_all() const { return required_ == 0 && !min_rssi_; }
+
+    private:
+        enum Criterion : uint8_t {
+            kCompany = 1u << 0,
+            kService = 1u << 1,
+            kManufacturerData = 1u << 2,
+            kName = 1u << 3,
+        };
+
+        // Bytes [offset, offset + size) of pool_.
+        struct Span {
+            uint16_t offset = 0;
+            uint8_t size = 0;
+        };
+
+        // The Criterion bits |type| with |body| satisfies.
+        uint8_t Evaluate(uint8_t type, ByteView body) const;
+        bool MatchesUuids(ByteView list, size_t size) const;
+        Span Pack(ByteView bytes);
+
+        uint8_t required_ = 0;
+        std::optional<int16_t> min_rssi_;
+        std::vector<uint16_t> companies_;
+        ManufacturerPatternSet patterns_;
+        // The spec's UUIDs, each in its shortest form.
+        std::vector<uint16_t> uuids16_;
+        std::vector<uint32_t> uuids32_;
+        std::vector<std::array<uint8_t, 16>> uuids128_;
+        std::vector<Span> names_;
+        std::vector<uint8_t> pool_;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_SCAN_FILTER_H_
@@ -0,0 +1,84 @@
+#include "scan_record_codec.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace flutter_ble_peripheral {
+
+    namespace {
+
+        void WriteLittleEndian(uint8_t* out, uint64_t value, size_t size) {
+            for (size_t i = 0; i < size; ++i) {
+                out[i] = static_cast<uint8_t>(value >> (8 * i));
+            }
+        }
+
+        uint64_t ReadLittleEndian(const uint8_t* in, size_t size) {
+            uint64_t value = 0;
+            for (size_t i = 0; i < size; ++i) {
+                value |= static_cast<uint64_t>(in[i]) << (8 * i);
+            }
+            return value;
+        }
+
+    }  // namespace
+
+    ScanRecordWriter::ScanRecordWriter() { Reset(); }
+
+    void ScanRecordWriter::Reset() {
+        buffer_.assign(kScanRecordMessageHeaderSize, 0);
+        buffer_[0] = kScanRecordVersion;
+        count_ = 0;
+    }
+
+    bool ScanRecordWriter::Append(const ScanResult& result) {
+        const size_t record_size = kScanRecordHeaderSize + result.advertisementData.size();
+        if (record_size - 2 > UINT16_MAX || count_ == UINT16_MAX) {
+            return false;
+        }
+
+        const size_t offset = buffer_.size();
+        buffer_.resize(offset + record_size);
+        uint8_t* out = buffer_.data() + offset;
+        WriteLittleEndian(out, record_size - 2, 2);
+        WriteLittleEndian(out + 2, result.address, 6);
+        out[8] = static_cast<uint8_t>(std::clamp<int16_t>(result.rssi, INT8_MIN, INT8_MAX));
+        out[9] = result.flags;
+        WriteLittleEndian(out + 10, static_cast<uint64_t>(result.timestamp.count()), 8);
+        if (!result.advertisementData.empty()) {
+            std::memcpy(out + kScanRecordHeaderSize, result.advertisementData.data(),
+                        result.advertisementData.size());
+        }
+
+        ++count_;
+        WriteLittleEndian(buffer_.data() + 2, count_, 2);
+        return true;
+    }
+
+    ScanRecordReader::ScanRecordReader(ByteView message) : message_(message) {
+        if (message.size() >= kScanRecordMessageHeaderSize && message[0] == kScanRecordVersion) {
+            count_ = static_cast<uint16_t>(ReadLittleEndian(message.data() + 2, 2));
+            valid_ = true;
+        }
+    }
+
+    bool ScanRecordReader::Next(ScanRecordView& record) {
+        if (!valid_ || offset_ + kScanRecordHeaderSize > message_.size()) {
+            return false;
+        }
+        const uint8_t* in = message_.data() + offset_;
+        const size_t record_size = 2 + static_cast<size_t>(ReadLittleEndian(in, 2));
+        if (record_size < kScanRecordHeaderSize || offset_ + record_size > message_.size()) {
+            return false;
+        }
+        record.address = ReadLittleEndian(in + 2, 6);
+        record.rssi = static_cast<int8_t>(in[8]);
+        record.flags = in[9];
+        record.timestamp = std::chrono::microseconds(static_cast<int64_t>(ReadLittleEndian(in + 10, 8)));
+        record.advertisementData = message_.subview(offset_ + kScanRecordHeaderSize,
+                                                    record_size - kScanRecordHeaderSize);
+        offset_ += record_size;
+        return true;
+    }
+
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,82 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_SCAN_RECORD_CODEC_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_SCAN_RECORD_CODEC_H_
+
+#include "byte_buffer.h"
+#include "scan_result.h"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+
+    // Compact binary encoding of scan results, the opt-in alternative to one
+    // EncodableMap per advertisement. All integers are little-endian.
+    //
+    //   message := version:u8 reserved:u8 count:u16 record*
+    //   record  := length:u16 address:u8[6] rssi:i8 flags:u8 timestamp:u64
+    //              ad_structures
+    //
+    // |length| counts the bytes after itself, so readers can skip records.
+    // |timestamp| is in microseconds since the Unix epoch. |ad_structures| are
+    // the advertisement's raw AD structures, each already prefixed by its own
+    // length byte. lib/src/models/scan_record.dart decodes this format.
+    constexpr uint8_t kScanRecordVersion = 1;
+    constexpr size_t kScanRecordMessageHeaderSize = 4;
+    constexpr size_t kScanRecordHeaderSize = 2 + 6 + 1 + 1 + 8;
+
+    // Packs scan results into a message. The buffer is reused across messages,
+    // so a steady stream of records stops allocating once it has grown to the
+    // working size.
+    class ScanRecordWriter {
+    public:
+        ScanRecordWriter();
+
+        // Starts a new, empty message, keeping the buffer's capacity.
+        void Reset();
+
+        // Appends |result|. Returns false, leaving the message unchanged, if
+        // its AD data does not fit a record.
+        bool Append(const ScanResult& result);
+
+        size_t count() const { return count_; }
+        bool empty() const { return count_ == 0; }
+        ByteView data() const { return ByteView(buffer_); }
+
+    private:
+        std::vector<uint8_t> buffer_;
+        uint16_t count_ = 0;
+    };
+
+    // One record of a message, borrowing from the message bytes.
+    struct ScanRecordView {
+        uint64_t address = 0;
+        int8_t rssi = 0;
+        uint8_t flags = 0;
+        std::chrono::microseconds timestamp{ 0 };
+        ByteView advertisementData;
+    };
+
+    // Walks the records of a message produced by ScanRecordWriter.
+    class ScanRecordReader {
+    public:
+        explicit ScanRecordReader(ByteView message);
+
+        // False if the message header is malformed or of another version.
+        bool valid() const { return valid_; }
+        uint16_t count() const { return count_; }
+
+        // Reads the next record into |record|. Returns false at the end of
+        // the message or on a truncated record.
+        bool Next(ScanRecordView& record);
+
+    private:
+        ByteView message_;
+        size_t offset_ = kScanRecordMessageHeaderSize;
+        uint16_t count_ = 0;
+        bool valid_ = false;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_SCAN_RECORD_CODEC_H_
@@ -0,0 +1,132 @@
+#include "scan_result.h"
+
+#include <charconv>
+#include <cstring>
+
+namespace flutter_ble_peripheral {
+
+    namespace {
+
+        // Length of the longest run of whole AD structures in |data| that
+        // fits in |limit| bytes.
+        size_t WholeStructuresPrefix(ByteView data, size_t limit) {
+            size_t offset = 0;
+            while (offset < data.size()) {
+                size_t next = offset + 1 + data[offset];
+                if (next > data.size() || next > limit) break;
+                offset = next;
+            }
+            return offset;
+        }
+
+    }  // namespace
+
+    ScanEvent& ScanEvent::operator=(const ScanEvent& other) {
+        if (this == &other) return *this;
+        address = other.address;
+        rssi = other.rssi;
+        flags = other.flags;
+        truncated = other.truncated;
+        advertisementDataSize = other.advertisementDataSize;
+        timestamp = other.timestamp;
+        if (advertisementDataSize != 0) {
+            std::memcpy(advertisementData.data(), other.advertisementData.data(), advertisementDataSize);
+        }
+        fields = other.fields;
+        fields.Rebase(other.advertisementData.data(), advertisementData.data());
+        return *this;
+    }
+
+    void ScanEvent::Assign(const ScanResult& result) {
+        address = result.address;
+        rssi = result.rssi;
+        flags = result.flags;
+        timestamp = result.timestamp;
+        size_t size = result.advertisementData.size();
+        truncated = size > kMaxAdvertisementData;
+        if (truncated) {
+            size = WholeStructuresPrefix(result.advertisementData, kMaxAdvertisementData);
+        }
+        if (size != 0) {
+            std::memcpy(advertisementData.data(), result.advertisementData.data(), size);
+        }
+        advertisementDataSize = static_cast<uint16_t>(size);
+
+        // Fields parsed from the whole data may point past a cut.
+        if (result.fields && !truncated) {
+            fields = *result.fields;
+            fields.Rebase(result.advertisementData.data(), advertisementData.data());
+        }
+        else {
+            ParseAdvertisement(advertisement_data(), fields);
+        }
+    }
+
+    ScanResult ScanEvent::View() const {
+        ScanResult result;
+        result.address = address;
+        result.rssi = rssi;
+        result.flags = flags;
+        result.timestamp = timestamp;
+        result.advertisementData = advertisement_data();
+        result.localName.assign(fields.localName.begin(), fields.localName.end());
+        result.manufacturerData.assign(fields.manufacturerData.begin(), fields.manufacturerData.end());
+        result.fields = &fields;
+        return result;
+    }
+
+    const AdvertisementFields& ParsedFields(const ScanResult& result, AdvertisementFields& scratch) {
+        if (result.fields) return *result.fields;
+        ParseAdvertisement(result.advertisementData, scratch);
+        return scratch;
+    }
+
+    std::string DeviceName(const ScanResult& result) {
+        if (!result.localName.empty()) {
+            return result.localName;
+        }
+        static constexpr char kHexDigits[] = "0123456789abcdef";
+        char buffer[16];
+        char* end = buffer + sizeof(buffer);
+        char* begin = end;
+        uint64_t address = result.address;
+        do {
+            *--begin = kHexDigits[address & 0xF];
+            address >>= 4;
+        } while (address != 0);
+        return std::string(begin, end);
+    }
+
+    std::string AddressString(uint64_t address) {
+        return std::to_string(address);
+    }
+
+    std::optional<uint64_t> ParseAddressString(std::string_view text) {
+        uint64_t address = 0;
+        const char* end = text.data() + text.size();
+        const auto parsed = std::from_chars(text.data(), end, address);
+        if (text.empty() || parsed.ec != std::errc() || parsed.ptr != end || address >> 48 != 0) {
+            return std::nullopt;
+        }
+        return address;
+    }
+
+    std::vector<uint8_t> ManufacturerSpecificData(const ScanResult& result) {
+        if (result.manufacturerData.empty()) {
+            return std::vector<uint8_t>();
+        }
+        const auto& record = result.manufacturerData.front();
+        std::vector<uint8_t> bytes(ManufacturerSpecificDataSize(record));
+        WriteManufacturerSpecificData(record, bytes.data());
+        return bytes;
+    }
+
+    void WriteManufacturerSpecificData(const ManufacturerRecord& record, uint8_t* out) {
+        out[0] = static_cast<uint8_t>(record.companyId & 0xFF);
+        out[1] = static_cast<uint8_t>(record.companyId >> 8);
+        if (!record.data.empty()) {
+            std::memcpy(out + 2, record.data.data(), record.data.size());
+        }
+    }
+
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,112 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_SCAN_RESULT_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_SCAN_RESULT_H_
+
+#include "ad_parser.h"
+#include "byte_buffer.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+
+    // One received advertisement. The byte fields borrow the platform's
+    // buffers, so a ScanResult is only valid for the duration of the
+    // callback that produced it.
+    struct ScanResult {
+        uint64_t address = 0;
+        int16_t rssi = 0;
+        // ScanResultFlags bits.
+        uint8_t flags = 0;
+        // Reception time since the Unix epoch.
+        std::chrono::microseconds timestamp{ 0 };
+        std::string localName;
+        std::vector<ManufacturerRecord> manufacturerData;
+        // The raw AD structures (length, type, data) of the advertisement.
+        ByteView advertisementData;
+        // advertisementData parsed, when the producer already did. Borrowed
+        // like the byte fields; see ParsedFields.
+        const AdvertisementFields* fields = nullptr;
+    };
+
+    // Advertisement type bits of ScanResult::flags.
+    enum ScanResultFlags : uint8_t {
+        kConnectable = 1u << 0,
+        kScannable = 1u << 1,
+        kDirected = 1u << 2,
+        kScanResponse = 1u << 3,
+    };
+
+    // Owning, fixed-size copy of a ScanResult for handing advertisements
+    // between threads. Copying one in or out never allocates; AD data beyond
+    // kMaxAdvertisementData bytes is cut at a structure boundary.
+    //
+    // The parsed AD structures travel with the bytes, so an advertisement is
+    // parsed once however many threads and stages it passes through.
+    struct ScanEvent {
+        static constexpr size_t kMaxAdvertisementData = 255;
+
+        uint64_t address = 0;
+        int16_t rssi = 0;
+        uint8_t flags = 0;
+        bool truncated = false;
+        uint16_t advertisementDataSize = 0;
+        std::chrono::microseconds timestamp{ 0 };
+        std::array<uint8_t, kMaxAdvertisementData> advertisementData;
+        // Parsed from advertisementData, into which its byte fields point.
+        AdvertisementFields fields;
+
+        ScanEvent() = default;
+        // Copies point the parsed fields at their own bytes.
+        ScanEvent(const ScanEvent& other) { *this = other; }
+        ScanEvent& operator=(const ScanEvent& other);
+
+        // Copies |result|, taking its parsed fields when it has them and
+        // parsing otherwise.
+        void Assign(const ScanResult& result);
+
+        ByteView advertisement_data() const {
+            return ByteView(advertisementData.data(), advertisementDataSize);
+        }
+
+        // A ScanResult borrowing from this event, parsed fields included.
+        ScanResult View() const;
+    };
+
+    // |result|'s parsed AD structures: the ones it carries, or |scratch|
+    // parsed from its advertisementData when it carries none.
+    const AdvertisementFields& ParsedFields(const ScanResult& result, AdvertisementFields& scratch);
+
+    // The name shown to Dart: the advertised local name, or the address in
+    // hex when the advertiser did not include one.
+    std::string DeviceName(const ScanResult& result);
+
+    // The "address" field as Dart expects it, the address in decimal.
+    std::string AddressString(uint64_t address);
+
+    // The inverse of AddressString. Returns nullopt unless |text| is all
+    // decimal digits of a 48-bit address.
+    std::optional<uint64_t> ParseAddressString(std::string_view text);
+
+    // Size of a manufacturer record in manufacturerSpecificData layout.
+    inline size_t ManufacturerSpecificDataSize(const ManufacturerRecord& record) {
+        return 2 + record.data.size();
+    }
+
+    // Writes |record| in Android's manufacturerSpecificData layout, the
+    // little-endian company id followed by the payload, to |out|, which must
+    // hold ManufacturerSpecificDataSize(record) bytes.
+    void WriteManufacturerSpecificData(const ManufacturerRecord& record, uint8_t* out);
+
+    // The first manufacturer record in manufacturerSpecificData layout, built
+    // with a single allocation. Empty when the advertisement has no
+    // manufacturer data.
+    std::vector<uint8_t> ManufacturerSpecificData(const ScanResult& result);
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_SCAN_RESULT_H_
@@ -0,0 +1,92 @@
+#include "scan_session.h"
+
+namespace flutter_ble_peripheral {
+
+    ScanSession::ScanSession(RadioBackend& backend, const Clock& clock)
+        : backend_(backend), clock_(clock) {}
+
+    bool ScanSession::Start(const ScanSettings& settings) {
+        Stop();
+        const auto now = clock_.Now();
+        settings_ = settings;
+        started_at_ = now;
+        stopped_at_ = now;
+        scanned_ = std::chrono::nanoseconds(0);
+        windows_ = 0;
+        refused_windows_ = 0;
+        advertisements_.store(0, std::memory_order_relaxed);
+
+        next_window_ = now;
+        OpenWindow(now);
+        if (!scanning_) return false;
+        active_ = true;
+        return true;
+    }
+
+    void ScanSession::Stop() {
+        if (!active_) return;
+        const auto now = clock_.Now();
+        if (scanning_) CloseWindow(now);
+        active_ = false;
+        stopped_at_ = now;
+    }
+
+    std::optional<std::chrono::nanoseconds> ScanSession::Tick() {
+        if (!active_ || settings_.continuous()) return std::nullopt;
+        const auto now = clock_.Now();
+        if (scanning_ && now >= window_end_) CloseWindow(now);
+        if (!scanning_ && now >= next_window_) OpenWindow(now);
+        return NextWakeup();
+    }
+
+    std::optional<std::chrono::nanoseconds> ScanSession::NextWakeup() const {
+        if (!active_ || settings_.continuous()) return std::nullopt;
+        return scanning_ ? window_end_ : next_window_;
+    }
+
+    ScanSession::Stats ScanSession::stats() const {
+        const auto now = active_ ? clock_.Now() : stopped_at_;
+        Stats stats;
+        stats.settings = settings_;
+        stats.active = active_;
+        stats.elapsed = now - started_at_;
+        stats.scanning = scanned_ + (scanning_ ? now - opened_at_ : std::chrono::nanoseconds(0));
+        stats.windows = windows_;
+        stats.refusedWindows = refused_windows_;
+        stats.advertisements = advertisements_.load(std::memory_order_relaxed);
+        if (stats.elapsed.count() > 0) {
+            const auto elapsed = std::chrono::duration<double>(stats.elapsed).count();
+            stats.dutyCycle = std::chrono::duration<double>(stats.scanning).count() / elapsed;
+            stats.advertisementsPerSecond = static_cast<double>(stats.advertisements) / elapsed;
+        }
+        return stats;
+    }
+
+    void ScanSession::OpenWindow(std::chrono::nanoseconds now) {
+        const std::chrono::nanoseconds interval = settings_.interval;
+        const std::chrono::nanoseconds window = settings_.window;
+        // A timer that fired late may have missed whole windows; skip them
+        // rather than catching up.
+        if (now >= next_window_ + interval) next_window_ += (now - next_window_) / interval * interval;
+        const auto start = next_window_;
+        next_window_ += interval;
+        // Past the end of this interval's window: wait for the next one.
+        if (now >= start + window && !settings_.continuous()) return;
+
+        if (!backend_.StartScan(settings_)) {
+            ++refused_windows_;
+            return;
+        }
+        scanning_ = true;
+        opened_at_ = now;
+        window_end_ = start + window;
+        ++windows_;
+    }
+
+    void ScanSession::CloseWindow(std::chrono::nanoseconds now) {
+        backend_.StopScan();
+        scanning_ = false;
+        scanned_ += now - opened_at_;
+    }
+
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,100 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_SCAN_SESSION_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_SCAN_SESSION_H_
+
+#include "clock.h"
+#include "radio_backend.h"
+#include "scan_settings.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+namespace flutter_ble_peripheral {
+
+    // One startScan..stopScan run of the scanner, and what it achieved.
+    //
+    // The WinRT watcher has a scanning mode and a per-device report
+    // interval but no scan window, so a window shorter than the interval is
+    // emulated: the session starts the backend at the top of every interval
+    // and stops it once the window has passed. Windows are anchored to the
+    // session start, so a late timer shortens one window instead of
+    // shifting all that follow. Equal interval and window start the backend
+    // once and leave it running.
+    //
+    // The session does not own a timer: call Tick() when NextWakeup() says
+    // so. Not thread-safe, except for OnAdvertisement.
+    class ScanSession {
+    public:
+        struct Stats {
+            ScanSettings settings;
+            bool active = false;
+            // Since Start, up to Stop once the session has ended.
+            std::chrono::nanoseconds elapsed{ 0 };
+            // Time the backend was scanning.
+            std::chrono::nanoseconds scanning{ 0 };
+            // Scan windows opened, and windows the backend refused.
+            uint64_t windows = 0;
+            uint64_t refusedWindows = 0;
+            uint64_t advertisements = 0;
+            // scanning / elapsed, the duty cycle actually achieved.
+            double dutyCycle = 0;
+            double advertisementsPerSecond = 0;
+        };
+
+        ScanSession(RadioBackend& backend, const Clock& clock);
+
+        // Disallow copy and assign.
+        ScanSession(const ScanSession&) = delete;
+        ScanSession& operator=(const ScanSession&) = delete;
+
+        // Ends any running session and starts a new one with |settings|,
+        // which must pass IsValidScanSettings. Returns false, leaving the
+        // session stopped, if the backend refused to start.
+        bool Start(const ScanSettings& settings);
+
+        // Ends the session and stops the backend. Its stats stay readable
+        // until the next Start.
+        void Stop();
+
+        // Opens or closes the scan window as due and returns NextWakeup().
+        std::optional<std::chrono::nanoseconds> Tick();
+
+        // Clock time at which Tick() next has work to do: the end of the
+        // open window or the start of the next one. Nullopt when the session
+        // is stopped or scans continuously.
+        std::optional<std::chrono::nanoseconds> NextWakeup() const;
+
+        // Counts an advertisement delivered by the backend. Safe to call
+        // from the scanner's callback thread.
+        void OnAdvertisement() { advertisements_.fetch_add(1, std::memory_order_relaxed); }
+
+        Stats stats() const;
+        bool active() const { return active_; }
+        bool scanning() const { return scanning_; }
+
+    private:
+        void OpenWindow(std::chrono::nanoseconds now);
+        void CloseWindow(std::chrono::nanoseconds now);
+
+        RadioBackend& backend_;
+        const Clock& clock_;
+
+        ScanSettings settings_;
+        bool active_ = false;
+        bool scanning_ = false;
+        std::chrono::nanoseconds started_at_{ 0 };
+        std::chrono::nanoseconds stopped_at_{ 0 };
+        std::chrono::nanoseconds opened_at_{ 0 };
+        std::chrono::nanoseconds scanned_{ 0 };
+        // Start of the next window and end of the current one.
+        std::chrono::nanoseconds next_window_{ 0 };
+        std::chrono::nanoseconds window_end_{ 0 };
+        uint64_t windows_ = 0;
+        uint64_t refused_windows_ = 0;
+        std::atomic<uint64_t> advertisements_{ 0 };
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_SCAN_SESSION_H_
@@ -0,0 +1,47 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_SCAN_SETTINGS_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_SCAN_SETTINGS_H_
+
+#include <chrono>
+#include <cstdint>
+
+namespace flutter_ble_peripheral {
+
+    // Numbered like WinRT's BluetoothLEScanningMode.
+    enum class ScanMode : uint8_t {
+        // Only listens; advertisers never learn they were heard.
+        kPassive = 0,
+        // Sends a scan request to scannable advertisers and reports their
+        // scan responses as well, at the cost of transmitting.
+        kActive = 1,
+    };
+
+    // The LE Set Scan Parameters limits for the scan interval and window,
+    // Bluetooth Core Vol 4 Part E 7.8.10.
+    inline constexpr std::chrono::microseconds kMinScanInterval{ 2500 };
+    inline constexpr std::chrono::microseconds kMaxScanInterval{ 10240000 };
+
+    struct ScanSettings {
+        ScanMode mode = ScanMode::kPassive;
+        // The radio listens for |window| out of every |interval|; equal
+        // values scan continuously.
+        std::chrono::microseconds interval{ 100000 };
+        std::chrono::microseconds window{ 100000 };
+
+        bool continuous() const { return window >= interval; }
+
+        // The fraction of time the radio is meant to listen.
+        double duty_cycle() const {
+            return continuous() ? 1.0 : static_cast<double>(window.count()) / static_cast<double>(interval.count());
+        }
+    };
+
+    // Whether the interval and window are within the Bluetooth limits and
+    // the window fits in the interval.
+    inline bool IsValidScanSettings(const ScanSettings& settings) {
+        return settings.interval >= kMinScanInterval && settings.interval <= kMaxScanInterval &&
+            settings.window >= kMinScanInterval && settings.window <= settings.interval;
+    }
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_SCAN_SETTINGS_H_
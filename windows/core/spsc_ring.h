@@ -0,0 +1,100 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_SPSC_RING_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_SPSC_RING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#ifdef _MSC_VER
+#pragma warning( push )
+// The padding added by alignas is the point: it keeps the indices apart.
+#pragma warning( disable : 4324)
+#endif
+
+namespace flutter_ble_peripheral {
+
+    // Bounded, lock-free single-producer/single-consumer ring.
+    //
+    // Exactly one thread may call TryPush and exactly one (possibly different)
+    // thread may call TryPop/Pop. Slots are constructed up front and reused, so
+    // pushing and popping never allocate. Capacity is rounded up to a power of
+    // two.
+    template <typename T>
+    class SpscRing {
+    public:
+        explicit SpscRing(size_t capacity)
+            : capacity_(RoundUpToPowerOfTwo(capacity)),
+              mask_(capacity_ - 1),
+              slots_(std::make_unique<T[]>(capacity_)) {}
+
+        // Disallow copy and assign.
+        SpscRing(const SpscRing&) = delete;
+        SpscRing& operator=(const SpscRing&) = delete;
+
+        // Producer side. Returns false if the ring is full.
+        template <typename Fill>
+        bool TryPushWith(Fill&& fill) {
+            const size_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail - head_cache_ == capacity_) {
+                head_cache_ = head_.load(std::memory_order_acquire);
+                if (tail - head_cache_ == capacity_) return false;
+            }
+            fill(slots_[tail & mask_]);
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool TryPush(const T& value) {
+            return TryPushWith([&value](T& slot) { slot = value; });
+        }
+
+        // Consumer side. Returns false if the ring is empty.
+        template <typename Consume>
+        bool TryPopWith(Consume&& consume) {
+            const size_t head = head_.load(std::memory_order_relaxed);
+            if (head == tail_cache_) {
+                tail_cache_ = tail_.load(std::memory_order_acquire);
+                if (head == tail_cache_) return false;
+            }
+            consume(slots_[head & mask_]);
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool TryPop(T& value) {
+            return TryPopWith([&value](T& slot) { value = std::move(slot); });
+        }
+
+        // Approximate when called concurrently with the other side.
+        size_t size() const {
+            return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+        }
+        size_t capacity() const { return capacity_; }
+
+    private:
+        static size_t RoundUpToPowerOfTwo(size_t value) {
+            size_t result = 1;
+            while (result < value) result <<= 1;
+            return result;
+        }
+
+        const size_t capacity_;
+        const size_t mask_;
+        std::unique_ptr<T[]> slots_;
+
+        // Producer and consumer indices live on separate cache lines, each
+        // with a private cache of the other side's index.
+        alignas(64) std::atomic<size_t> tail_{ 0 };
+        size_t head_cache_ = 0;
+        alignas(64) std::atomic<size_t> head_{ 0 };
+        size_t tail_cache_ = 0;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#ifdef _MSC_VER
+#pragma warning( pop )
+#endif
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_SPSC_RING_H_
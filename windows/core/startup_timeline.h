@@ -0,0 +1,53 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_STARTUP_TIMELINE_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_STARTUP_TIMELINE_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace flutter_ble_peripheral {
+
+    enum class StartupMilestone : size_t {
+        kAdapter,
+        kRadio,
+        kInitialized,
+        kFirstAdvertisement,
+        kCount,
+    };
+
+    // When each startup milestone was first reached, relative to plugin
+    // construction. Milestones are marked from whichever thread reaches them;
+    // the first mark wins.
+    class StartupTimeline {
+    public:
+        explicit StartupTimeline(std::chrono::nanoseconds origin) : origin_(origin) {
+            for (auto& mark : marks_) mark.store(kUnset, std::memory_order_relaxed);
+        }
+
+        // Returns false if |milestone| was already marked.
+        bool Mark(StartupMilestone milestone, std::chrono::nanoseconds now) {
+            int64_t expected = kUnset;
+            const int64_t elapsed = (now - origin_).count();
+            return marks_[static_cast<size_t>(milestone)].compare_exchange_strong(
+                expected, elapsed < 0 ? 0 : elapsed, std::memory_order_relaxed);
+        }
+
+        std::optional<std::chrono::nanoseconds> Elapsed(StartupMilestone milestone) const {
+            const int64_t elapsed = marks_[static_cast<size_t>(milestone)].load(std::memory_order_relaxed);
+            if (elapsed == kUnset) return std::nullopt;
+            return std::chrono::nanoseconds(elapsed);
+        }
+
+    private:
+        static constexpr int64_t kUnset = -1;
+
+        std::chrono::nanoseconds origin_;
+        std::array<std::atomic<int64_t>, static_cast<size_t>(StartupMilestone::kCount)> marks_;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_STARTUP_TIMELINE_H_
@@ -0,0 +1,35 @@
+#include "state_debouncer.h"
+
+namespace flutter_ble_peripheral {
+
+    StateDebouncer::StateDebouncer(std::chrono::nanoseconds window) : window_(window) {}
+
+    std::chrono::nanoseconds StateDebouncer::Offer(PeripheralState state, std::chrono::nanoseconds now) {
+        // Whatever was pending is overtaken without ever being seen.
+        if (pending_) ++suppressed_;
+        pending_ = state;
+        deadline_ = now + window_;
+        return *deadline_;
+    }
+
+    std::optional<PeripheralState> StateDebouncer::Poll(std::chrono::nanoseconds now) {
+        if (!pending_ || now < *deadline_) return std::nullopt;
+        const PeripheralState state = *pending_;
+        pending_.reset();
+        deadline_.reset();
+        if (last_emitted_ == state) {
+            ++suppressed_;
+            return std::nullopt;
+        }
+        last_emitted_ = state;
+        return state;
+    }
+
+    PeripheralState StateDebouncer::Emit(PeripheralState state) {
+        pending_.reset();
+        deadline_.reset();
+        last_emitted_ = state;
+        return state;
+    }
+
+}  // namespace flutter_ble_peripheral
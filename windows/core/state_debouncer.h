@@ -0,0 +1,51 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_STATE_DEBOUNCER_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_STATE_DEBOUNCER_H_
+
+#include "peripheral_state.h"
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+namespace flutter_ble_peripheral {
+
+    // Turns a burst of state transitions into one deduplicated value.
+    //
+    // Starting an advertisement walks the publisher through created, waiting
+    // and started within a few milliseconds, and the radio can flap while it
+    // powers up. Offer records each transition and pushes the deadline out by
+    // |window|. Poll after the deadline returns the settled state, unless it
+    // equals the last state emitted.
+    //
+    // Not thread-safe; the plugin drives it from the platform thread.
+    class StateDebouncer {
+    public:
+        explicit StateDebouncer(std::chrono::nanoseconds window = std::chrono::milliseconds(50));
+
+        // Records |state| seen at |now|. Returns when to Poll.
+        std::chrono::nanoseconds Offer(PeripheralState state, std::chrono::nanoseconds now);
+
+        // The settled state, if the window has passed and it is news.
+        std::optional<PeripheralState> Poll(std::chrono::nanoseconds now);
+
+        // Emits |state| right away, e.g. to greet a new listener, and makes it
+        // the baseline for deduplication.
+        PeripheralState Emit(PeripheralState state);
+
+        // When the pending state settles, if one is pending.
+        std::optional<std::chrono::nanoseconds> deadline() const { return deadline_; }
+
+        // Transitions absorbed without being emitted.
+        uint64_t suppressed() const { return suppressed_; }
+
+    private:
+        std::chrono::nanoseconds window_;
+        std::optional<PeripheralState> pending_;
+        std::optional<std::chrono::nanoseconds> deadline_;
+        std::optional<PeripheralState> last_emitted_;
+        uint64_t suppressed_ = 0;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_STATE_DEBOUNCER_H_
@@ -0,0 +1,104 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_STATE_SNAPSHOT_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_STATE_SNAPSHOT_H_
+
+#include "peripheral_state.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace flutter_ble_peripheral {
+
+    // What the plugin knows about the adapter, the radio and the publisher,
+    // as of |changedAt|.
+    struct StateSnapshot {
+        RadioState radio = RadioState::unknown;
+        PublisherStatus publisher = PublisherStatus::created;
+        bool supported = false;
+        bool connected = false;
+        // Clock time of the last change to any field above.
+        std::chrono::microseconds changedAt{ 0 };
+
+        bool advertising() const { return publisher == PublisherStatus::started; }
+    };
+
+    // The PeripheralState Dart sees for |state|.
+    inline PeripheralState DerivePeripheralState(const StateSnapshot& state) {
+        if (state.radio == RadioState::unknown) return PeripheralState::unknown;
+        if (!state.supported) return PeripheralState::unsupported;
+        if (state.radio != RadioState::on) return PeripheralState::poweredOff;
+        if (state.connected) return PeripheralState::connected;
+        if (state.advertising()) return PeripheralState::advertising;
+        return PeripheralState::idle;
+    }
+
+    // A StateSnapshot packed into one 64-bit word, so event handlers on any
+    // thread can update it and queries can read it without a lock or a WinRT
+    // round-trip.
+    //
+    // Layout: radio in bits 0-3, publisher in bits 4-7, supported in bit 8,
+    // connected in bit 9 and the change time, in microseconds, in bits 16-63.
+    // 48 bits of microseconds cover about eight years of uptime.
+    class AtomicStateSnapshot {
+    public:
+        StateSnapshot Load() const { return Unpack(word_.load(std::memory_order_acquire)); }
+
+        // Each setter only bumps changedAt if the value actually changed.
+        // Returns whether it did.
+        bool SetRadio(RadioState radio, std::chrono::nanoseconds now) {
+            return Update(now, [radio](StateSnapshot& state) { state.radio = radio; });
+        }
+        bool SetPublisher(PublisherStatus publisher, std::chrono::nanoseconds now) {
+            return Update(now, [publisher](StateSnapshot& state) { state.publisher = publisher; });
+        }
+        bool SetSupported(bool supported, std::chrono::nanoseconds now) {
+            return Update(now, [supported](StateSnapshot& state) { state.supported = supported; });
+        }
+        bool SetConnected(bool connected, std::chrono::nanoseconds now) {
+            return Update(now, [connected](StateSnapshot& state) { state.connected = connected; });
+        }
+
+    private:
+        static constexpr uint64_t kTimeMask = (uint64_t{ 1 } << 48) - 1;
+
+        template <typename Apply>
+        bool Update(std::chrono::nanoseconds now, Apply&& apply) {
+            uint64_t current = word_.load(std::memory_order_relaxed);
+            for (;;) {
+                StateSnapshot state = Unpack(current);
+                apply(state);
+                state.changedAt = std::chrono::duration_cast<std::chrono::microseconds>(now);
+                const uint64_t next = Pack(state);
+                // Same fields: leave the change time alone.
+                if ((next & 0xFFFF) == (current & 0xFFFF)) return false;
+                if (word_.compare_exchange_weak(current, next, std::memory_order_acq_rel,
+                                                std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+        }
+
+        static uint64_t Pack(const StateSnapshot& state) {
+            return (static_cast<uint64_t>(state.radio) & 0xF) |
+                ((static_cast<uint64_t>(state.publisher) & 0xF) << 4) |
+                (static_cast<uint64_t>(state.supported) << 8) |
+                (static_cast<uint64_t>(state.connected) << 9) |
+                ((static_cast<uint64_t>(state.changedAt.count()) & kTimeMask) << 16);
+        }
+
+        static StateSnapshot Unpack(uint64_t word) {
+            StateSnapshot state;
+            state.radio = static_cast<RadioState>(word & 0xF);
+            state.publisher = static_cast<PublisherStatus>((word >> 4) & 0xF);
+            state.supported = (word >> 8) & 1;
+            state.connected = (word >> 9) & 1;
+            state.changedAt = std::chrono::microseconds(static_cast<int64_t>(word >> 16));
+            return state;
+        }
+
+        std::atomic<uint64_t> word_{ 0 };
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_STATE_SNAPSHOT_H_
@@ -0,0 +1,311 @@
+#include "ad_encoder.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        constexpr uint8_t kName[] = { 'b', 'e', 'a', 'c', 'o', 'n' };
+
+        constexpr AdField NameField() {
+            AdField field;
+            field.type = kAdCompleteLocalName;
+            field.body = ByteView(kName, sizeof(kName));
+            field.shortenable = true;
+            return field;
+        }
+
+        constexpr size_t CompileTimeSize() {
+            AdPayload<2> payload;
+            AdField flags;
+            flags.type = kAdFlags;
+            flags.header[0] = kAdFlagsGeneralDiscoverable;
+            flags.headerSize = 1;
+            payload.Add(flags);
+            payload.Add(NameField());
+            return payload.Layout() ? payload.advertisement_size() : 0;
+        }
+
+        static_assert(CompileTimeSize() == 3 + 8, "payload is sized at compile time");
+
+        // Walks |bytes| as AD structures and returns them as (type, value).
+        std::vector<std::pair<uint8_t, std::vector<uint8_t>>> Parse(const uint8_t* bytes, size_t size) {
+            std::vector<std::pair<uint8_t, std::vector<uint8_t>>> structures;
+            size_t offset = 0;
+            while (offset < size) {
+                const size_t length = bytes[offset];
+                EXPECT_GT(length, 0u);
+                EXPECT_LE(offset + 1 + length, size);
+                if (length == 0 || offset + 1 + length > size) break;
+                structures.emplace_back(bytes[offset + 1],
+                    std::vector<uint8_t>(bytes + offset + 2, bytes + offset + 1 + length));
+                offset += 1 + length;
+            }
+            return structures;
+        }
+
+        TEST(AdEncoderTest, ParsesUuidsToTheirShortestForm) {
+            auto short_form = ParseBluetoothUuid("180D");
+            ASSERT_TRUE(short_form);
+            EXPECT_EQ(short_form->size, 2);
+            EXPECT_EQ(short_form->bytes[0], 0x0D);
+            EXPECT_EQ(short_form->bytes[1], 0x18);
+
+            auto on_base = ParseBluetoothUuid("0000180d-0000-1000-8000-00805f9b34fb");
+            ASSERT_TRUE(on_base);
+            EXPECT_EQ(on_base->size, 2);
+            EXPECT_EQ(on_base->bytes[0], 0x0D);
+
+            auto padded = ParseBluetoothUuid("0000180D");
+            ASSERT_TRUE(padded);
+            EXPECT_EQ(*padded, *short_form);
+
+            auto thirty_two = ParseBluetoothUuid("1234ABCD-0000-1000-8000-00805F9B34FB");
+            ASSERT_TRUE(thirty_two);
+            EXPECT_EQ(thirty_two->size, 4);
+            EXPECT_EQ(thirty_two->bytes[0], 0xCD);
+            EXPECT_EQ(thirty_two->bytes[3], 0x12);
+
+            auto full = ParseBluetoothUuid("6E400001-B5A3-F393-E0A9-E50E24DCCA9E");
+            ASSERT_TRUE(full);
+            EXPECT_EQ(full->size, 16);
+            EXPECT_EQ(full->bytes[0], 0x9E);
+            EXPECT_EQ(full->bytes[15], 0x6E);
+
+            EXPECT_FALSE(ParseBluetoothUuid("18G0"));
+            EXPECT_FALSE(ParseBluetoothUuid("6E400001B5A3-F393-E0A9-E50E24DCCA9E0"));
+            EXPECT_FALSE(ParseBluetoothUuid(""));
+        }
+
+        TEST(AdEncoderTest, ShortensUuidsOnTheBaseUuid) {
+            BluetoothUuid wide;
+            wide.size = 16;
+            wide.bytes = { 0xFB, 0x34, 0x9B, 0x5F, 0x80, 0x00, 0x00, 0x80,
+                           0x00, 0x10, 0x00, 0x00, 0x0D, 0x18, 0x00, 0x00 };
+            EXPECT_EQ(ShortenBluetoothUuid(wide), *ParseBluetoothUuid("180D"));
+
+            BluetoothUuid thirty_two;
+            thirty_two.size = 4;
+            thirty_two.bytes[0] = 0x0D;
+            thirty_two.bytes[1] = 0x18;
+            EXPECT_EQ(ShortenBluetoothUuid(thirty_two), *ParseBluetoothUuid("180D"));
+
+            const auto custom = *ParseBluetoothUuid("6E400001-B5A3-F393-E0A9-E50E24DCCA9E");
+            EXPECT_EQ(ShortenBluetoothUuid(custom), custom);
+        }
+
+        TEST(AdEncoderTest, EveryFormOfABaseUuidEncodesAs16Bit) {
+            for (const char* text : { "180D", "0000180D", "0000180d-0000-1000-8000-00805f9b34fb" }) {
+                SCOPED_TRACE(text);
+                AdvertiseData data;
+                data.serviceUuid = text;
+                AdvertisePayload payload(kLegacyAdvertisingDataSize, false);
+                ASSERT_TRUE(EncodeAdvertiseData(data, payload, false));
+                uint8_t out[kLegacyAdvertisingDataSize];
+                const size_t size = payload.WriteAdvertisement(out, sizeof(out));
+                auto structures = Parse(out, size);
+                ASSERT_EQ(structures.size(), 1u);
+                EXPECT_EQ(structures[0].first, kAdCompleteUuid16List);
+                EXPECT_EQ(structures[0].second, (std::vector<uint8_t>{ 0x0D, 0x18 }));
+            }
+        }
+
+        TEST(AdEncoderTest, FormatsUuidsInFull) {
+            EXPECT_EQ(FormatBluetoothUuid(*ParseBluetoothUuid("180D")), "0000180d-0000-1000-8000-00805f9b34fb");
+            EXPECT_EQ(FormatBluetoothUuid(*ParseBluetoothUuid("1234ABCD")), "1234abcd-0000-1000-8000-00805f9b34fb");
+            EXPECT_EQ(FormatBluetoothUuid(*ParseBluetoothUuid("6E400001-B5A3-F393-E0A9-E50E24DCCA9E")),
+                      "6e400001-b5a3-f393-e0a9-e50e24dcca9e");
+        }
+
+        TEST(AdEncoderTest, EncodesAdvertiseData) {
+            AdvertiseData data;
+            data.serviceUuid = "180D";
+            data.manufacturerId = 0x004C;
+            data.manufacturerData = SharedBuffer::CopyFrom(std::vector<uint8_t>{ 1, 2 });
+            data.localName = "hr";
+
+            AdvertisePayload payload;
+            ASSERT_TRUE(EncodeAdvertiseData(data, payload));
+            uint8_t out[kLegacyAdvertisingDataSize];
+            const size_t size = payload.WriteAdvertisement(out, sizeof(out));
+
+            const std::vector<uint8_t> expected = {
+                0x02, 0x01, 0x06,
+                0x03, 0x03, 0x0D, 0x18,
+                0x05, 0xFF, 0x4C, 0x00, 0x01, 0x02,
+                0x03, 0x09, 'h', 'r',
+            };
+            EXPECT_EQ(std::vector<uint8_t>(out, out + size), expected);
+            EXPECT_EQ(payload.scan_response_size(), 0u);
+        }
+
+        TEST(AdEncoderTest, OverflowMovesToTheScanResponse) {
+            AdvertiseData data;
+            data.serviceUuid = "6E400001-B5A3-F393-E0A9-E50E24DCCA9E";
+            data.manufacturerData = SharedBuffer::CopyFrom(std::vector<uint8_t>(20, 0xAB));
+
+            AdvertisePayload payload;
+            ASSERT_TRUE(EncodeAdvertiseData(data, payload));
+            EXPECT_EQ(payload.advertisement_size(), 3u + 18u);
+            EXPECT_EQ(payload.scan_response_size(), 24u);
+
+            uint8_t out[kLegacyAdvertisingDataSize];
+            const size_t size = payload.WriteScanResponse(out, sizeof(out));
+            auto structures = Parse(out, size);
+            ASSERT_EQ(structures.size(), 1u);
+            EXPECT_EQ(structures[0].first, kAdManufacturerSpecificData);
+        }
+
+        TEST(AdEncoderTest, RejectsWhatFitsNowhere) {
+            AdvertiseData data;
+            data.manufacturerData = SharedBuffer::CopyFrom(std::vector<uint8_t>(28, 0xAB));
+
+            AdvertisePayload payload;
+            EXPECT_FALSE(EncodeAdvertiseData(data, payload));
+            ASSERT_TRUE(payload.failed_field());
+            EXPECT_STREQ(AdTypeName(payload.field(*payload.failed_field()).type), "manufacturerData");
+            uint8_t out[kLegacyAdvertisingDataSize];
+            EXPECT_EQ(payload.WriteAdvertisement(out, sizeof(out)), 0u);
+
+            AdvertisePayload extended(kExtendedAdvertisingDataSize);
+            EXPECT_TRUE(EncodeAdvertiseData(data, extended));
+        }
+
+        TEST(AdEncoderTest, WithoutScanResponseOverflowIsAnError) {
+            AdvertiseData data;
+            data.serviceUuid = "6E400001-B5A3-F393-E0A9-E50E24DCCA9E";
+            data.manufacturerData = SharedBuffer::CopyFrom(std::vector<uint8_t>(20, 0xAB));
+
+            AdvertisePayload payload(kLegacyAdvertisingDataSize, false);
+            EXPECT_FALSE(EncodeAdvertiseData(data, payload));
+        }
+
+        TEST(AdEncoderTest, BudgetsOnlyWhatAManufacturerDataPublisherSends) {
+            AdvertiseData data;
+            data.serviceUuid = "6E400001-B5A3-F393-E0A9-E50E24DCCA9E";
+            data.manufacturerId = 0x004C;
+            data.manufacturerData = SharedBuffer::CopyFrom(std::vector<uint8_t>(12, 0xAB));
+
+            // Too large with the UUID, but the UUID never goes on air.
+            AdvertisePayload everything(kLegacyAdvertisingDataSize, false);
+            EXPECT_FALSE(EncodeAdvertiseData(data, everything));
+            AdvertisePayload published(kLegacyAdvertisingDataSize, false);
+            ASSERT_TRUE(EncodeAdvertiseData(ManufacturerDataOnly(data), published));
+            EXPECT_EQ(published.advertisement_size(), 3u + 16u);
+
+            // 31 - 3 (flags) - 4 (length, type, company) leaves 24 bytes.
+            data.manufacturerData = SharedBuffer::CopyFrom(std::vector<uint8_t>(24, 0xAB));
+            AdvertisePayload full(kLegacyAdvertisingDataSize, false);
+            EXPECT_TRUE(EncodeAdvertiseData(ManufacturerDataOnly(data), full));
+            data.manufacturerData = SharedBuffer::CopyFrom(std::vector<uint8_t>(25, 0xAB));
+            AdvertisePayload over(kLegacyAdvertisingDataSize, false);
+            EXPECT_FALSE(EncodeAdvertiseData(ManufacturerDataOnly(data), over));
+
+            // Without a company id nothing is sent, however much data there is.
+            data.manufacturerId.reset();
+            data.manufacturerData = SharedBuffer::CopyFrom(std::vector<uint8_t>(40, 0xAB));
+            AdvertisePayload none(kLegacyAdvertisingDataSize, false);
+            ASSERT_TRUE(EncodeAdvertiseData(ManufacturerDataOnly(data), none));
+            EXPECT_EQ(none.advertisement_size(), 3u);
+        }
+
+        TEST(AdEncoderTest, LongNamesAreShortenedOnACharacterBoundary) {
+            AdvertiseData data;
+            data.manufacturerData = SharedBuffer::CopyFrom(std::vector<uint8_t>(20, 0xAB));
+            // 'é' is two bytes in UTF-8.
+            data.localName = std::string("caf\xC3\xA9 ") + std::string(40, 'x');
+
+            AdvertisePayload payload(kLegacyAdvertisingDataSize, false);
+            ASSERT_TRUE(EncodeAdvertiseData(data, payload));
+            uint8_t out[kLegacyAdvertisingDataSize];
+            auto structures = Parse(out, payload.WriteAdvertisement(out, sizeof(out)));
+            ASSERT_EQ(structures.size(), 3u);
+            EXPECT_EQ(structures[2].first, kAdShortenedLocalName);
+            // 31 - 3 (flags) - 24 (manufacturer) - 2 leaves 2 bytes: "ca".
+            EXPECT_EQ(structures[2].second, (std::vector<uint8_t>{ 'c', 'a' }));
+
+            AdvertisePayload tight(12, false);
+            AdvertiseData name_only;
+            name_only.localName = std::string("ab\xC3\xA9") + "cd";
+            ASSERT_TRUE(EncodeAdvertiseData(name_only, tight));
+            // 12 - 3 - 2 leaves 7 bytes, enough for the whole name.
+            EXPECT_EQ(tight.field(1).type, kAdCompleteLocalName);
+            AdvertisePayload tighter(8, false);
+            ASSERT_TRUE(EncodeAdvertiseData(name_only, tighter));
+            // 3 bytes left would split 'é'; the cut backs off to "ab".
+            EXPECT_EQ(tighter.field(1).body.size(), 2u);
+        }
+
+        TEST(AdEncoderTest, RejectsBadUuids) {
+            AdvertiseData data;
+            data.serviceUuid = "not-a-uuid";
+            AdvertisePayload payload;
+            EXPECT_FALSE(EncodeAdvertiseData(data, payload));
+            EXPECT_FALSE(payload.failed_field());
+
+            AdvertiseData orphan;
+            orphan.serviceData = SharedBuffer::CopyFrom(std::vector<uint8_t>{ 1 });
+            AdvertisePayload orphan_payload;
+            EXPECT_FALSE(EncodeAdvertiseData(orphan, orphan_payload));
+        }
+
+        // Random field sets against both budgets. Whatever Layout accepts must
+        // serialize to well-formed AD structures within budget, with every
+        // field placed exactly once; whatever it rejects must really not fit.
+        TEST(AdEncoderTest, FuzzLayout) {
+            std::mt19937 rng(20240101);
+            std::vector<uint8_t> pool(300);
+            for (auto& byte : pool) byte = static_cast<uint8_t>('a' + rng() % 26);
+
+            for (int round = 0; round < 20000; ++round) {
+                const size_t budget = round % 2 ? kLegacyAdvertisingDataSize : kExtendedAdvertisingDataSize;
+                const bool scan_response = rng() % 4 != 0;
+                AdPayload<8> payload(budget, scan_response);
+                const size_t fields = rng() % 9;
+                for (size_t i = 0; i < fields; ++i) {
+                    AdField field;
+                    field.type = static_cast<uint8_t>(0x10 + i);
+                    field.headerSize = static_cast<uint8_t>(rng() % 17);
+                    field.body = ByteView(pool.data(), rng() % (budget + 8));
+                    field.shortenable = rng() % 5 == 0;
+                    field.advertisementOnly = rng() % 7 == 0;
+                    payload.Add(field);
+                }
+
+                uint8_t advertisement[kExtendedAdvertisingDataSize];
+                uint8_t response[kExtendedAdvertisingDataSize];
+                if (!payload.Layout()) {
+                    ASSERT_TRUE(payload.failed_field());
+                    const AdField& failed = payload.field(*payload.failed_field());
+                    EXPECT_GT(failed.EncodedSize(), budget - payload.advertisement_size());
+                    EXPECT_EQ(payload.WriteAdvertisement(advertisement, sizeof(advertisement)), 0u);
+                    continue;
+                }
+
+                const size_t advertisement_size = payload.WriteAdvertisement(advertisement, sizeof(advertisement));
+                const size_t response_size = payload.WriteScanResponse(response, sizeof(response));
+                ASSERT_EQ(advertisement_size, payload.advertisement_size());
+                ASSERT_EQ(response_size, payload.scan_response_size());
+                ASSERT_LE(advertisement_size, budget);
+                ASSERT_LE(response_size, budget);
+                if (!scan_response) {
+                    ASSERT_EQ(response_size, 0u);
+                }
+
+                auto in_advertisement = Parse(advertisement, advertisement_size);
+                auto in_response = Parse(response, response_size);
+                ASSERT_EQ(in_advertisement.size() + in_response.size(), payload.size());
+                for (size_t i = 0; i < payload.size(); ++i) {
+                    if (payload.field(i).advertisementOnly) {
+                        EXPECT_EQ(payload.placement(i), AdPlacement::kAdvertisement);
+                    }
+                }
+            }
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
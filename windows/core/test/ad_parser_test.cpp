@@ -0,0 +1,158 @@
+#include "ad_parser.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        std::string Text(ByteView bytes) {
+            return std::string(bytes.begin(), bytes.end());
+        }
+
+        TEST(AdParserTest, ParsesEveryReportedType) {
+            const std::vector<uint8_t> data = {
+                0x02, kAdFlags, 0x06,
+                0x05, kAdCompleteUuid16List, 0x0D, 0x18, 0x0F, 0x18,
+                0x05, kAdIncompleteUuid32List, 0xCD, 0xAB, 0x34, 0x12,
+                0x11, kAdCompleteUuid128List, 0x9E, 0xCA, 0xDC, 0x24, 0x0E, 0xE5, 0xA9, 0xE0,
+                      0x93, 0xF3, 0xA3, 0xB5, 0x01, 0x00, 0x40, 0x6E,
+                0x02, kAdTxPowerLevel, 0xF4,
+                0x03, kAdAppearance, 0xC1, 0x03,
+                0x05, kAdServiceData16, 0x6F, 0xFD, 0xAA, 0xBB,
+                0x05, kAdServiceData32, 0xCD, 0xAB, 0x34, 0x12,
+                0x05, kAdShortenedLocalName, 'S', 'e', 'n', 's',
+                0x04, kAdManufacturerSpecificData, 0x4C, 0x00, 0x02,
+                0x03, kAdManufacturerSpecificData, 0x06, 0x00,
+                0x07, kAdCompleteLocalName, 'S', 'e', 'n', 's', 'o', 'r',
+            };
+            AdvertisementFields fields;
+            ParseAdvertisement(data, fields);
+
+            EXPECT_FALSE(fields.malformed);
+            EXPECT_FALSE(fields.truncated);
+            EXPECT_EQ(fields.flags, 0x06);
+            EXPECT_EQ(fields.txPowerLevel, -12);
+            EXPECT_EQ(fields.appearance, 0x03C1);
+            EXPECT_EQ(Text(fields.localName), "Sensor");
+            EXPECT_TRUE(fields.completeLocalName);
+
+            ASSERT_EQ(fields.serviceUuids.size(), 4u);
+            EXPECT_EQ(fields.serviceUuids[0], *ParseBluetoothUuid("180D"));
+            EXPECT_EQ(fields.serviceUuids[1], *ParseBluetoothUuid("180F"));
+            EXPECT_EQ(fields.serviceUuids[2], *ParseBluetoothUuid("1234ABCD"));
+            EXPECT_EQ(fields.serviceUuids[3], *ParseBluetoothUuid("6E400001-B5A3-F393-E0A9-E50E24DCCA9E"));
+
+            ASSERT_EQ(fields.serviceData.size(), 2u);
+            EXPECT_EQ(fields.serviceData[0].uuid, *ParseBluetoothUuid("FD6F"));
+            EXPECT_EQ(fields.serviceData[0].data.ToVector(), (std::vector<uint8_t>{ 0xAA, 0xBB }));
+            EXPECT_EQ(fields.serviceData[1].uuid, *ParseBluetoothUuid("1234ABCD"));
+            EXPECT_TRUE(fields.serviceData[1].data.empty());
+
+            ASSERT_EQ(fields.manufacturerData.size(), 2u);
+            EXPECT_EQ(fields.manufacturerData[0].companyId, 0x004C);
+            EXPECT_EQ(fields.manufacturerData[0].data.ToVector(), (std::vector<uint8_t>{ 0x02 }));
+            EXPECT_EQ(fields.manufacturerData[1].companyId, 0x0006);
+            EXPECT_TRUE(fields.manufacturerData[1].data.empty());
+        }
+
+        TEST(AdParserTest, ShortenedNameNeverReplacesCompleteName) {
+            const std::vector<uint8_t> data = {
+                0x03, kAdCompleteLocalName, 'a', 'b',
+                0x02, kAdShortenedLocalName, 'a',
+            };
+            AdvertisementFields fields;
+            ParseAdvertisement(data, fields);
+            EXPECT_EQ(Text(fields.localName), "ab");
+        }
+
+        TEST(AdParserTest, StopsAtMalformedStructures) {
+            const std::vector<uint8_t> data = {
+                0x02, kAdTxPowerLevel, 0x04,
+                0x09, kAdManufacturerSpecificData, 0x4C, 0x00,
+            };
+            AdvertisementFields fields;
+            ParseAdvertisement(data, fields);
+            EXPECT_TRUE(fields.malformed);
+            EXPECT_EQ(fields.txPowerLevel, 4);
+            EXPECT_TRUE(fields.manufacturerData.empty());
+        }
+
+        TEST(AdParserTest, StopsAtZeroPadding) {
+            const std::vector<uint8_t> data = { 0x02, kAdFlags, 0x06, 0x00, 0x00, 0x02, kAdTxPowerLevel, 0x00 };
+            AdvertisementFields fields;
+            ParseAdvertisement(data, fields);
+            EXPECT_FALSE(fields.malformed);
+            EXPECT_EQ(fields.flags, 0x06);
+            EXPECT_FALSE(fields.txPowerLevel);
+        }
+
+        TEST(AdParserTest, SkipsStructuresTooShortForTheirType) {
+            const std::vector<uint8_t> data = {
+                0x01, kAdFlags,
+                0x02, kAdAppearance, 0x01,
+                0x02, kAdManufacturerSpecificData, 0x4C,
+                0x02, kAdServiceData16, 0x6F,
+                // Three bytes of a 16-bit list: the odd byte is ignored.
+                0x04, kAdCompleteUuid16List, 0x0D, 0x18, 0x0F,
+            };
+            AdvertisementFields fields;
+            ParseAdvertisement(data, fields);
+            EXPECT_FALSE(fields.malformed);
+            EXPECT_FALSE(fields.flags);
+            EXPECT_FALSE(fields.appearance);
+            EXPECT_TRUE(fields.manufacturerData.empty());
+            EXPECT_TRUE(fields.serviceData.empty());
+            EXPECT_EQ(fields.serviceUuids.size(), 1u);
+        }
+
+        TEST(AdParserTest, DropsEntriesPastCapacity) {
+            std::vector<uint8_t> data;
+            for (uint8_t i = 0; i < 10; ++i) data.insert(data.end(), { 0x03, kAdManufacturerSpecificData, i, 0x00 });
+            data.push_back(1 + 2 * 20);
+            data.push_back(kAdCompleteUuid16List);
+            for (uint8_t i = 0; i < 20; ++i) data.insert(data.end(), { i, 0x18 });
+            AdvertisementFields fields;
+            ParseAdvertisement(data, fields);
+            EXPECT_TRUE(fields.truncated);
+            EXPECT_EQ(fields.manufacturerData.size(), decltype(fields.manufacturerData)::kCapacity);
+            EXPECT_EQ(fields.manufacturerData.back().companyId, decltype(fields.manufacturerData)::kCapacity - 1);
+            EXPECT_EQ(fields.serviceUuids.size(), decltype(fields.serviceUuids)::kCapacity);
+        }
+
+        TEST(AdParserTest, ReuseStartsFromScratch) {
+            AdvertisementFields fields;
+            ParseAdvertisement(std::vector<uint8_t>{ 0x02, kAdFlags, 0x06, 0x03, kAdCompleteLocalName, 'a', 'b' },
+                               fields);
+            ParseAdvertisement(std::vector<uint8_t>{ 0x02, kAdTxPowerLevel, 0x00 }, fields);
+            EXPECT_FALSE(fields.flags);
+            EXPECT_TRUE(fields.localName.empty());
+            EXPECT_FALSE(fields.completeLocalName);
+            EXPECT_EQ(fields.txPowerLevel, 0);
+        }
+
+        // Random bytes must never make the parser read past the data or
+        // hand out views that leave it.
+        TEST(AdParserTest, FuzzStaysInBounds) {
+            std::mt19937 random(20);
+            AdvertisementFields fields;
+            for (int round = 0; round < 5000; ++round) {
+                std::vector<uint8_t> data(random() % 64);
+                for (auto& byte : data) byte = static_cast<uint8_t>(random() % 4 == 0 ? random() % 8 : random());
+                ParseAdvertisement(data, fields);
+                const uint8_t* begin = data.data();
+                const uint8_t* end = data.data() + data.size();
+                auto inside = [&](ByteView view) {
+                    return view.empty() || (view.begin() >= begin && view.end() <= end);
+                };
+                ASSERT_TRUE(inside(fields.localName));
+                for (const auto& record : fields.manufacturerData) ASSERT_TRUE(inside(record.data));
+                for (const auto& record : fields.serviceData) ASSERT_TRUE(inside(record.data));
+            }
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
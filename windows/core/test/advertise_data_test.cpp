@@ -0,0 +1,61 @@
+#include "advertise_data.h"
+
+#include <gtest/gtest.h>
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        AdvertiseData WithBytes(std::vector<uint8_t> bytes) {
+            AdvertiseData data;
+            data.manufacturerId = 0x004C;
+            data.manufacturerData = SharedBuffer::CopyFrom(bytes);
+            return data;
+        }
+
+        TEST(AdvertiseDataTest, IdenticalPayloadsHaveNoDiff) {
+            EXPECT_EQ(DiffAdvertiseData(WithBytes({1, 2}), WithBytes({1, 2})), 0u);
+
+            AdvertiseData data = WithBytes({1, 2});
+            EXPECT_EQ(DiffAdvertiseData(data, data), 0u);
+        }
+
+        TEST(AdvertiseDataTest, ReportsEachChangedField) {
+            AdvertiseData current = WithBytes({1, 2});
+            AdvertiseData next = WithBytes({1, 3});
+            EXPECT_EQ(DiffAdvertiseData(current, next), kManufacturerData);
+
+            next.manufacturerId = 0x0006;
+            next.localName = "beacon";
+            EXPECT_EQ(DiffAdvertiseData(current, next),
+                      kManufacturerData | kManufacturerId | kLocalName);
+
+            next = current;
+            next.includePowerLevel = true;
+            EXPECT_EQ(DiffAdvertiseData(current, next), kIncludePowerLevel);
+        }
+
+        TEST(AdvertiseDataTest, ManufacturerDataOnlyKeepsTheRecord) {
+            AdvertiseData data = WithBytes({1, 2});
+            data.serviceUuid = "180D";
+            data.localName = "beacon";
+            data.includePowerLevel = true;
+            const AdvertiseData published = ManufacturerDataOnly(data);
+            EXPECT_EQ(DiffAdvertiseData(WithBytes({1, 2}), published), 0u);
+            EXPECT_EQ(published.manufacturerData.data(), data.manufacturerData.data());
+
+            data.manufacturerId.reset();
+            EXPECT_EQ(DiffAdvertiseData(AdvertiseData(), ManufacturerDataOnly(data)), 0u);
+        }
+
+        TEST(AdvertiseDataTest, SliceOfTheSameStorageIsAChange) {
+            AdvertiseData current = WithBytes({1, 2, 3});
+            AdvertiseData next = current;
+            EXPECT_EQ(DiffAdvertiseData(current, next), 0u);
+
+            next.manufacturerData = current.manufacturerData.Slice(0, 2);
+            EXPECT_EQ(DiffAdvertiseData(current, next), kManufacturerData);
+            EXPECT_EQ(DiffAdvertiseData(next, current), kManufacturerData);
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
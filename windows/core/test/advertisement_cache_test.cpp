@@ -0,0 +1,133 @@
+#include "advertisement_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        using std::chrono::milliseconds;
+        using std::chrono::seconds;
+
+        using Outcome = AdvertisementCache::Outcome;
+
+        struct Advert {
+            uint64_t address;
+            int16_t rssi;
+            std::vector<uint8_t> payload;
+            std::string name;
+
+            ScanResult result() const {
+                ScanResult result;
+                result.address = address;
+                result.rssi = rssi;
+                result.advertisementData = payload;
+                result.localName = name;
+                return result;
+            }
+        };
+
+        TEST(AdvertisementCacheTest, ReportsNewChangedAndUnchanged) {
+            AdvertisementCache cache(8);
+            Advert advert{ 0xA1B2C3D4E5F6, -60, { 0x02, 0x01, 0x06 }, "tag" };
+
+            EXPECT_EQ(cache.Classify(advert.result(), milliseconds(0)), Outcome::kNew);
+            advert.rssi = -70;
+            EXPECT_EQ(cache.Classify(advert.result(), milliseconds(10)), Outcome::kUnchanged);
+            advert.payload.push_back(0x00);
+            EXPECT_EQ(cache.Classify(advert.result(), milliseconds(20)), Outcome::kChanged);
+            advert.name = "tag2";
+            EXPECT_EQ(cache.Classify(advert.result(), milliseconds(30)), Outcome::kChanged);
+
+            const auto* entry = cache.Find(advert.address);
+            ASSERT_NE(entry, nullptr);
+            EXPECT_EQ(entry->rssiCount, 4u);
+            EXPECT_EQ(entry->rssiMin, -70);
+            EXPECT_EQ(entry->rssiMax, -60);
+            EXPECT_EQ(entry->rssiLast, -70);
+            EXPECT_EQ(entry->lastSeen, milliseconds(30));
+
+            const auto stats = cache.stats();
+            EXPECT_EQ(stats.misses, 1u);
+            EXPECT_EQ(stats.hits, 1u);
+            EXPECT_EQ(stats.changes, 2u);
+            EXPECT_EQ(stats.size, 1u);
+        }
+
+        TEST(AdvertisementCacheTest, EvictsLeastRecentlySeenWhenFull) {
+            AdvertisementCache cache(2);
+            Advert a{ 1, -50, {}, "" };
+            Advert b{ 2, -50, {}, "" };
+            Advert c{ 3, -50, {}, "" };
+
+            cache.Classify(a.result(), milliseconds(0));
+            cache.Classify(b.result(), milliseconds(1));
+            cache.Classify(a.result(), milliseconds(2));
+            cache.Classify(c.result(), milliseconds(3));
+
+            EXPECT_NE(cache.Find(1), nullptr);
+            EXPECT_EQ(cache.Find(2), nullptr);
+            EXPECT_NE(cache.Find(3), nullptr);
+            EXPECT_EQ(cache.stats().evictions, 1u);
+            EXPECT_EQ(cache.Classify(b.result(), milliseconds(4)), Outcome::kNew);
+        }
+
+        TEST(AdvertisementCacheTest, ExpiresStaleDevices) {
+            AdvertisementCache cache(8, seconds(1));
+            Advert a{ 1, -50, {}, "" };
+            Advert b{ 2, -50, {}, "" };
+
+            cache.Classify(a.result(), milliseconds(0));
+            cache.Classify(b.result(), milliseconds(800));
+            cache.ExpireOlderThan(milliseconds(1500));
+
+            EXPECT_EQ(cache.Find(1), nullptr);
+            EXPECT_NE(cache.Find(2), nullptr);
+            EXPECT_EQ(cache.size(), 1u);
+            EXPECT_EQ(cache.Classify(a.result(), milliseconds(1600)), Outcome::kNew);
+        }
+
+        // Random inserts, hits and evictions against a std::map model; catches
+        // broken probe chains after backward-shift deletion.
+        TEST(AdvertisementCacheTest, MatchesReferenceModel) {
+            constexpr size_t kCapacity = 16;
+            AdvertisementCache cache(kCapacity, seconds(3600));
+            std::map<uint64_t, uint8_t> model;
+            std::map<uint64_t, int64_t> last_seen;
+            std::mt19937 rng(7);
+
+            for (int64_t step = 0; step < 20000; ++step) {
+                // Few distinct low bits so that many addresses share a home slot.
+                const uint64_t address = (rng() % 40) << 40;
+                const uint8_t payload = static_cast<uint8_t>(rng() % 3);
+                Advert advert{ address, -50, { payload }, "" };
+
+                Outcome expected;
+                auto it = model.find(address);
+                if (it == model.end()) {
+                    expected = Outcome::kNew;
+                    if (model.size() == kCapacity) {
+                        auto oldest = std::min_element(last_seen.begin(), last_seen.end(),
+                            [](const auto& l, const auto& r) { return l.second < r.second; });
+                        model.erase(oldest->first);
+                        last_seen.erase(oldest);
+                    }
+                }
+                else {
+                    expected = it->second == payload ? Outcome::kUnchanged : Outcome::kChanged;
+                }
+                model[address] = payload;
+                last_seen[address] = step;
+
+                ASSERT_EQ(cache.Classify(advert.result(), milliseconds(step)), expected) << step;
+                ASSERT_EQ(cache.size(), model.size());
+            }
+            for (const auto& [address, payload] : model) {
+                EXPECT_NE(cache.Find(address), nullptr);
+            }
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
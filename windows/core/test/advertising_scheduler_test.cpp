@@ -0,0 +1,131 @@
+#include "advertising_scheduler.h"
+
+#include <gtest/gtest.h>
+
+#include "mock_radio_backend.h"
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        using std::chrono::milliseconds;
+
+        AdvertiseData Payload(uint8_t tag) {
+            AdvertiseData data;
+            data.manufacturerId = 0x004C;
+            data.manufacturerData = SharedBuffer::CopyFrom(std::vector<uint8_t>{ tag });
+            return data;
+        }
+
+        AdvertiseSetParameters Every(milliseconds interval) {
+            AdvertiseSetParameters parameters;
+            parameters.interval = interval;
+            return parameters;
+        }
+
+        class AdvertisingSchedulerTest : public ::testing::Test {
+        protected:
+            // Runs the scheduler the way the plugin's timer does, until |end|.
+            void RunUntil(milliseconds end) {
+                while (true) {
+                    auto wakeup = scheduler.Tick();
+                    if (!wakeup || *wakeup > end) break;
+                    clock.Set(*wakeup);
+                }
+                clock.Set(end);
+                scheduler.Tick();
+            }
+
+            uint8_t OnAirTag() const {
+                return core.advertise_data().manufacturerData.view()[0];
+            }
+
+            MockRadioBackend backend;
+            PeripheralCore core{ backend };
+            VirtualClock clock;
+            AdvertisingScheduler scheduler{ core, clock, milliseconds(100) };
+        };
+
+        TEST_F(AdvertisingSchedulerTest, SingleSetStaysOnAir) {
+            auto id = scheduler.Add(Payload(1), Every(milliseconds(100)));
+            RunUntil(milliseconds(1000));
+
+            auto stats = scheduler.Stats(id);
+            ASSERT_TRUE(stats);
+            EXPECT_TRUE(stats->onAir);
+            EXPECT_EQ(stats->airtime, milliseconds(1000));
+            EXPECT_EQ(stats->events, 11u);
+            EXPECT_EQ(backend.start_count, 1);
+            EXPECT_EQ(backend.stop_count, 0);
+        }
+
+        TEST_F(AdvertisingSchedulerTest, RotatesSetsAndSplitsAirtime) {
+            auto a = scheduler.Add(Payload(1), Every(milliseconds(200)));
+            auto b = scheduler.Add(Payload(2), Every(milliseconds(200)));
+
+            scheduler.Tick();
+            EXPECT_EQ(OnAirTag(), 1);
+            clock.Set(milliseconds(100));
+            scheduler.Tick();
+            EXPECT_EQ(OnAirTag(), 2);
+            clock.Set(milliseconds(200));
+            scheduler.Tick();
+            EXPECT_EQ(OnAirTag(), 1);
+
+            RunUntil(milliseconds(2000));
+            EXPECT_EQ(scheduler.Stats(a)->airtime, milliseconds(1000));
+            EXPECT_EQ(scheduler.Stats(b)->airtime, milliseconds(1000));
+        }
+
+        TEST_F(AdvertisingSchedulerTest, FrequentSetGetsMoreSlots) {
+            auto fast = scheduler.Add(Payload(1), Every(milliseconds(200)));
+            auto slow = scheduler.Add(Payload(2), Every(milliseconds(1000)));
+            RunUntil(milliseconds(5000));
+
+            EXPECT_GT(scheduler.Stats(fast)->events, 3 * scheduler.Stats(slow)->events);
+            EXPECT_EQ(scheduler.Stats(slow)->events, 5u);
+        }
+
+        TEST_F(AdvertisingSchedulerTest, MaxEventsRetiresTheSet) {
+            auto parameters = Every(milliseconds(100));
+            parameters.maxExtendedAdvertisingEvents = 3;
+            auto id = scheduler.Add(Payload(1), parameters);
+            RunUntil(milliseconds(1000));
+
+            auto stats = scheduler.Stats(id);
+            EXPECT_TRUE(stats->expired);
+            EXPECT_FALSE(stats->onAir);
+            EXPECT_EQ(stats->events, 3u);
+            EXPECT_EQ(stats->airtime, milliseconds(300));
+            EXPECT_FALSE(core.IsAdvertising());
+            EXPECT_FALSE(scheduler.NextWakeup());
+        }
+
+        TEST_F(AdvertisingSchedulerTest, DurationRetiresTheSet) {
+            auto parameters = Every(milliseconds(100));
+            parameters.duration = milliseconds(250);
+            auto id = scheduler.Add(Payload(1), parameters);
+            RunUntil(milliseconds(1000));
+
+            auto stats = scheduler.Stats(id);
+            EXPECT_TRUE(stats->expired);
+            EXPECT_EQ(stats->airtime, milliseconds(250));
+            EXPECT_FALSE(core.IsAdvertising());
+        }
+
+        TEST_F(AdvertisingSchedulerTest, RemoveTakesTheSetOffAir) {
+            auto a = scheduler.Add(Payload(1), Every(milliseconds(100)));
+            auto b = scheduler.Add(Payload(2), Every(milliseconds(100)));
+            scheduler.Tick();
+
+            EXPECT_TRUE(scheduler.Remove(a));
+            EXPECT_FALSE(scheduler.Remove(a));
+            EXPECT_FALSE(core.IsAdvertising());
+
+            RunUntil(milliseconds(500));
+            EXPECT_EQ(OnAirTag(), 2);
+            EXPECT_FALSE(scheduler.Stats(a));
+            EXPECT_TRUE(scheduler.Stats(b)->onAir);
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,67 @@
+#include "buffer_pool.h"
+
+#include <gtest/gtest.h>
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        TEST(BufferPoolTest, RoundsUpToAClassAndReuses) {
+            BufferPool pool;
+            PooledBytes bytes = pool.Acquire(300);
+            ASSERT_TRUE(bytes);
+            EXPECT_TRUE(bytes->empty());
+            EXPECT_GE(bytes->capacity(), 512u);
+            const auto* storage = bytes->data();
+            bytes->assign(300, 7);
+            pool.Release(std::move(bytes));
+
+            PooledBytes again = pool.Acquire(400);
+            EXPECT_TRUE(again->empty());
+            EXPECT_EQ(again->data(), storage);
+            EXPECT_EQ(pool.stats().allocations, 1u);
+            EXPECT_EQ(pool.stats().reuses, 1u);
+
+            // A larger class does not take the smaller vector.
+            pool.Release(std::move(again));
+            EXPECT_GE(pool.Acquire(600)->capacity(), 1024u);
+            EXPECT_EQ(pool.stats().allocations, 2u);
+        }
+
+        TEST(BufferPoolTest, RefusesSizesAboveTheLargestClass) {
+            BufferPool pool;
+            EXPECT_FALSE(pool.Acquire((size_t{ 1 } << BufferPool::kMaxClass) + 1));
+        }
+
+        TEST(BufferPoolTest, CachesAtMostTheLimitPerClass) {
+            BufferPool pool(1);
+            PooledBytes a = pool.Acquire(10);
+            PooledBytes b = pool.Acquire(10);
+            pool.Release(std::move(a));
+            pool.Release(std::move(b));
+            EXPECT_EQ(pool.stats().cached, 1u);
+        }
+
+        TEST(BufferPoolTest, SharedBuffersReturnWhenTheLastCopyGoes) {
+            auto pool = std::make_unique<BufferPool>();
+            PooledBytes bytes = pool->Acquire(10);
+            bytes->assign({ 1, 2, 3 });
+            const auto* storage = bytes->data();
+
+            SharedBuffer shared = pool->Share(std::move(bytes));
+            SharedBuffer slice = shared.Slice(1);
+            EXPECT_EQ(shared.data(), storage);
+            EXPECT_EQ(slice.size(), 2u);
+            shared = SharedBuffer();
+            EXPECT_EQ(pool->stats().cached, 0u);
+            slice = SharedBuffer();
+            EXPECT_EQ(pool->stats().cached, 1u);
+            EXPECT_EQ(pool->Acquire(10)->data(), storage);
+
+            // Outliving the pool is fine.
+            SharedBuffer orphan = pool->Share(pool->Acquire(10));
+            pool.reset();
+            orphan = SharedBuffer();
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,52 @@
+#include "byte_buffer.h"
+
+#include <gtest/gtest.h>
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        TEST(ByteBufferTest, ViewDoesNotCopy) {
+            std::vector<uint8_t> bytes = {1, 2, 3, 4};
+            ByteView view(bytes);
+            EXPECT_EQ(view.data(), bytes.data());
+            EXPECT_EQ(view.size(), 4u);
+        }
+
+        TEST(ByteBufferTest, SubviewClampsToTheEnd) {
+            std::vector<uint8_t> bytes = {1, 2, 3, 4};
+            ByteView view(bytes);
+            EXPECT_EQ(view.subview(1, 2).ToVector(), (std::vector<uint8_t>{2, 3}));
+            EXPECT_EQ(view.subview(3).ToVector(), (std::vector<uint8_t>{4}));
+            EXPECT_TRUE(view.subview(9).empty());
+        }
+
+        TEST(ByteBufferTest, SharedBufferCopiesShareStorage) {
+            std::vector<uint8_t> bytes = {1, 2, 3};
+            SharedBuffer buffer = SharedBuffer::CopyFrom(bytes);
+            SharedBuffer copy = buffer;
+
+            EXPECT_NE(buffer.data(), bytes.data());
+            EXPECT_EQ(copy.data(), buffer.data());
+            EXPECT_TRUE(copy.view() == ByteView(bytes));
+        }
+
+        TEST(ByteBufferTest, EmptyBufferHasNoStorage) {
+            SharedBuffer buffer = SharedBuffer::CopyFrom(ByteView());
+            EXPECT_TRUE(buffer.empty());
+            EXPECT_EQ(buffer.data(), nullptr);
+        }
+
+        TEST(ByteBufferTest, SlicesShareStorageAndClamp) {
+            SharedBuffer buffer = SharedBuffer::CopyFrom(std::vector<uint8_t>{1, 2, 3, 4, 5});
+            SharedBuffer middle = buffer.Slice(1, 3);
+            EXPECT_EQ(middle.data(), buffer.data() + 1);
+            EXPECT_EQ(middle.view().ToVector(), (std::vector<uint8_t>{2, 3, 4}));
+
+            SharedBuffer tail = middle.Slice(2, 10);
+            EXPECT_EQ(tail.view().ToVector(), std::vector<uint8_t>{4});
+            EXPECT_TRUE(buffer.Slice(9).empty());
+            EXPECT_EQ(buffer.Slice(5).data(), nullptr);
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,71 @@
+#include "callback_guard.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        TEST(CallbackGuardTest, RefusesScopesAfterShutdown) {
+            CallbackGuard guard;
+            {
+                auto scope = guard.Enter();
+                EXPECT_TRUE(scope);
+                EXPECT_EQ(guard.running(), 1u);
+            }
+            EXPECT_EQ(guard.running(), 0u);
+
+            guard.Shutdown();
+            EXPECT_TRUE(guard.shut_down());
+            EXPECT_FALSE(guard.Enter());
+            EXPECT_EQ(guard.running(), 0u);
+        }
+
+        TEST(CallbackGuardTest, ShutdownWaitsForRunningCallbacks) {
+            auto guard = std::make_shared<CallbackGuard>();
+            std::atomic<bool> entered{ false };
+            std::atomic<bool> finished{ false };
+            std::thread callback([guard, &entered, &finished] {
+                auto scope = guard->Enter();
+                ASSERT_TRUE(scope);
+                entered = true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                finished = true;
+            });
+            while (!entered) std::this_thread::yield();
+
+            guard->Shutdown();
+            EXPECT_TRUE(finished);
+            callback.join();
+        }
+
+        // Timer callbacks racing the owner's shutdown: each one either runs
+        // to completion before Shutdown returns or does not run at all.
+        TEST(CallbackGuardTest, NoCallbackRunsPastShutdown) {
+            auto guard = std::make_shared<CallbackGuard>();
+            std::atomic<bool> owner_alive{ true };
+            std::atomic<int> ran_after{ 0 };
+            std::vector<std::thread> callbacks;
+            for (int i = 0; i < 8; ++i) {
+                callbacks.emplace_back([guard, &owner_alive, &ran_after] {
+                    for (int n = 0; n < 1000; ++n) {
+                        auto scope = guard->Enter();
+                        if (!scope) return;
+                        if (!owner_alive) ran_after.fetch_add(1);
+                    }
+                });
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            guard->Shutdown();
+            owner_alive = false;
+            for (auto& callback : callbacks) callback.join();
+            EXPECT_EQ(ran_after.load(), 0);
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
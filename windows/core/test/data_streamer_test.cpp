@@ -0,0 +1,224 @@
+#include "data_streamer.h"
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+
+#include "loopback_gatt_transport.h"
+#include "simulated_gatt_link.h"
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        using std::chrono::milliseconds;
+
+        SharedBuffer Payload(size_t size) {
+            std::vector<uint8_t> bytes(size);
+            std::iota(bytes.begin(), bytes.end(), uint8_t{ 0 });
+            return SharedBuffer::CopyFrom(bytes);
+        }
+
+        GattHandle AddTx(GattServer& server) {
+            GattService service;
+            service.uuid = *ParseBluetoothUuid("180F");
+            service.characteristics.push_back({ *ParseBluetoothUuid("2A19"), kGattNotify, {} });
+            server.AddService(service);
+            return service.characteristics[0].handle;
+        }
+
+        class DataStreamerTest : public ::testing::Test {
+        protected:
+            void SetUp() override {
+                tx_ = AddTx(server_);
+                server_.OnClientConnected(1);
+                server_.OnSubscriptionChanged(1, tx_, GattSubscription::kNotify);
+            }
+
+            // Reports the oldest undelivered chunk to |client| as sent.
+            void Complete(GattClientId client, bool delivered = true) {
+                auto& inbox = transport_.inboxes[client];
+                ASSERT_LT(completed_, inbox.size());
+                streamer_.OnSent(client, inbox[completed_++].value, delivered);
+            }
+
+            VirtualClock clock_;
+            LoopbackGattTransport transport_;
+            GattServer server_{ transport_ };
+            DataStreamer streamer_{ server_, clock_, DataStreamOptions{ 4, 100 } };
+            GattHandle tx_ = 0;
+            size_t completed_ = 0;
+        };
+
+        TEST_F(DataStreamerTest, ChunksAreSlicesOfThePayload) {
+            SharedBuffer payload = Payload(50);
+            streamer_.Send(1, tx_, payload);
+            EXPECT_EQ(streamer_.Pump(), 3u);
+
+            const auto& inbox = transport_.inboxes[1];
+            ASSERT_EQ(inbox.size(), 3u);
+            EXPECT_EQ(inbox[0].value.data(), payload.data());
+            EXPECT_EQ(inbox[0].value.size(), 20u);
+            EXPECT_EQ(inbox[1].value.data(), payload.data() + 20);
+            EXPECT_EQ(inbox[2].value.size(), 10u);
+        }
+
+        TEST_F(DataStreamerTest, WindowBoundsChunksInFlight) {
+            streamer_.Send(1, tx_, Payload(200));
+            EXPECT_EQ(streamer_.Pump(), 4u);
+            EXPECT_EQ(streamer_.Pump(), 0u);
+
+            Complete(1);
+            Complete(1);
+            EXPECT_EQ(streamer_.Pump(), 2u);
+            EXPECT_EQ(transport_.inboxes[1].size(), 6u);
+        }
+
+        TEST_F(DataStreamerTest, TransportBackpressureWaitsForCredit) {
+            transport_.inbox_capacity = 2;
+            streamer_.Send(1, tx_, Payload(100));
+            EXPECT_EQ(streamer_.Pump(), 2u);
+            Complete(1);
+            transport_.inboxes[1].erase(transport_.inboxes[1].begin());
+            completed_ = 0;
+            EXPECT_EQ(streamer_.Pump(), 1u);
+        }
+
+        TEST_F(DataStreamerTest, ReportsProgressAndCompletion) {
+            const auto id = streamer_.Send(1, tx_, Payload(250));
+            for (int i = 0; i < 13; ++i) {
+                streamer_.Pump();
+                clock_.Advance(milliseconds(10));
+                Complete(1);
+            }
+
+            auto reports = streamer_.TakeProgress();
+            // Crossing 100 and 200 bytes coalesces with the final report for
+            // the same stream into one entry per TakeProgress.
+            ASSERT_EQ(reports.size(), 1u);
+            EXPECT_EQ(reports[0].id, id);
+            EXPECT_TRUE(reports[0].done);
+            EXPECT_FALSE(reports[0].failed);
+            EXPECT_EQ(reports[0].sentBytes, 250u);
+            EXPECT_EQ(reports[0].chunks, 13u);
+            EXPECT_EQ(reports[0].elapsed, milliseconds(130));
+            EXPECT_DOUBLE_EQ(reports[0].bytesPerSecond(), 250 / 0.13);
+            EXPECT_FALSE(streamer_.Progress(id));
+            EXPECT_EQ(streamer_.active(), 0u);
+        }
+
+        TEST_F(DataStreamerTest, IntermediateReportsAtTheInterval) {
+            streamer_.Send(1, tx_, Payload(250));
+            streamer_.Pump();
+            for (int i = 0; i < 4; ++i) Complete(1);
+            EXPECT_TRUE(streamer_.TakeProgress().empty());
+            streamer_.Pump();
+            Complete(1);
+            auto reports = streamer_.TakeProgress();
+            ASSERT_EQ(reports.size(), 1u);
+            EXPECT_EQ(reports[0].sentBytes, 100u);
+            EXPECT_FALSE(reports[0].done);
+        }
+
+        TEST_F(DataStreamerTest, StreamsToOneClientGoOutInOrder) {
+            SharedBuffer first = Payload(30);
+            SharedBuffer second = Payload(30);
+            streamer_.Send(1, tx_, first);
+            streamer_.Send(1, tx_, second);
+            EXPECT_EQ(streamer_.Pump(), 4u);
+            const auto& inbox = transport_.inboxes[1];
+            EXPECT_EQ(inbox[0].value.data(), first.data());
+            EXPECT_EQ(inbox[1].value.data(), first.data() + 20);
+            EXPECT_EQ(inbox[2].value.data(), second.data());
+        }
+
+        TEST_F(DataStreamerTest, FailedChunkFailsTheStreamOnceCreditsReturn) {
+            streamer_.Send(1, tx_, Payload(200));
+            streamer_.Pump();
+            Complete(1, false);
+            EXPECT_TRUE(streamer_.TakeProgress().empty());
+            Complete(1);
+            Complete(1);
+            Complete(1);
+            auto reports = streamer_.TakeProgress();
+            ASSERT_EQ(reports.size(), 1u);
+            EXPECT_TRUE(reports[0].failed);
+            EXPECT_TRUE(reports[0].done);
+            EXPECT_EQ(streamer_.Pump(), 0u);
+        }
+
+        TEST_F(DataStreamerTest, DisconnectAndUnsubscribeFail) {
+            streamer_.Send(1, tx_, Payload(200));
+            streamer_.Pump();
+            streamer_.OnClientDisconnected(1);
+            auto reports = streamer_.TakeProgress();
+            ASSERT_EQ(reports.size(), 1u);
+            EXPECT_TRUE(reports[0].failed);
+
+            streamer_.Send(2, tx_, Payload(10));
+            EXPECT_EQ(streamer_.Pump(), 0u);
+            reports = streamer_.TakeProgress();
+            ASSERT_EQ(reports.size(), 1u);
+            EXPECT_TRUE(reports[0].failed);
+        }
+
+        TEST_F(DataStreamerTest, ChunksFollowTheNegotiatedMtu) {
+            streamer_.Send(1, tx_, Payload(400));
+            EXPECT_EQ(streamer_.Pump(), 4u);
+            Complete(1);
+            server_.OnMtuChanged(1, 103);
+            EXPECT_EQ(streamer_.Pump(), 1u);
+
+            const auto& inbox = transport_.inboxes[1];
+            ASSERT_EQ(inbox.size(), 5u);
+            EXPECT_EQ(inbox[3].value.size(), 20u);
+            EXPECT_EQ(inbox[4].value.size(), 100u);
+        }
+
+        TEST_F(DataStreamerTest, IgnoresCreditsForOtherValues) {
+            streamer_.Send(1, tx_, Payload(40));
+            streamer_.Pump();
+            streamer_.OnSent(1, Payload(20), true);
+            EXPECT_EQ(streamer_.Progress(1)->sentBytes, 0u);
+        }
+
+        TEST_F(DataStreamerTest, EmptyPayloadIsDoneAtOnce) {
+            streamer_.Send(1, tx_, SharedBuffer());
+            EXPECT_EQ(streamer_.Pump(), 0u);
+            auto reports = streamer_.TakeProgress();
+            ASSERT_EQ(reports.size(), 1u);
+            EXPECT_TRUE(reports[0].done);
+        }
+
+        TEST(DataStreamerLinkTest, LargerMtuAndWindowRaiseThroughput) {
+            auto run = [](size_t mtu, size_t window) {
+                VirtualClock clock;
+                SimulatedGattLink link(clock);
+                link.latency = milliseconds(15);
+                GattServer server(link);
+                const GattHandle tx = AddTx(server);
+                server.OnClientConnected(1);
+                server.OnMtuChanged(1, mtu);
+                server.OnSubscriptionChanged(1, tx, GattSubscription::kNotify);
+                DataStreamer streamer(server, clock, DataStreamOptions{ window, 1 << 30 });
+
+                streamer.Send(1, tx, Payload(32 * 1024));
+                streamer.Pump();
+                while (link.DeliverNext([&](GattClientId client, const SharedBuffer& value) {
+                    streamer.OnSent(client, value, true);
+                    streamer.Pump();
+                })) {}
+                auto reports = streamer.TakeProgress();
+                EXPECT_EQ(reports.size(), 1u);
+                EXPECT_EQ(reports.back().sentBytes, 32u * 1024);
+                return reports.back().bytesPerSecond();
+            };
+
+            const double small_serial = run(23, 1);
+            const double small_windowed = run(23, 8);
+            const double large_windowed = run(247, 8);
+            EXPECT_GT(small_windowed, 5 * small_serial);
+            EXPECT_GT(large_windowed, 3 * small_windowed);
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,143 @@
+#include "event_pump.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        TEST(EventPumpTest, CoalescesWakeupsUntilDrained) {
+            int wakes = 0;
+            EventPump<int> pump(16, [&wakes] {
+                ++wakes;
+                return true;
+            });
+
+            EXPECT_TRUE(pump.Post(1));
+            EXPECT_TRUE(pump.Post(2));
+            EXPECT_TRUE(pump.Post(3));
+            EXPECT_EQ(wakes, 1);
+
+            std::vector<int> seen;
+            EXPECT_EQ(pump.Drain([&seen](int& value) { seen.push_back(value); }), 3u);
+            EXPECT_EQ(seen, (std::vector<int>{ 1, 2, 3 }));
+
+            EXPECT_TRUE(pump.Post(4));
+            EXPECT_EQ(wakes, 2);
+        }
+
+        TEST(EventPumpTest, BoundedDrainWakesAgainForTheRest) {
+            int wakes = 0;
+            EventPump<int> pump(16, [&wakes] {
+                ++wakes;
+                return true;
+            });
+            for (int i = 0; i < 5; ++i) pump.Post(i);
+
+            EXPECT_EQ(pump.Drain([](int&) {}, 2), 2u);
+            EXPECT_EQ(wakes, 2);
+            EXPECT_EQ(pump.pending(), 3u);
+            EXPECT_EQ(pump.Drain([](int&) {}), 3u);
+            EXPECT_EQ(wakes, 2);
+        }
+
+        TEST(EventPumpTest, ReserveKeepsHeadroomAndCountsDrops) {
+            EventPump<int> pump(8, [] { return true; });
+            int accepted = 0;
+            for (int i = 0; i < 8; ++i) accepted += pump.Post(i, 2) ? 1 : 0;
+            EXPECT_EQ(accepted, 6);
+
+            // Unreserved posts still fit in the headroom.
+            EXPECT_TRUE(pump.Post(100));
+            EXPECT_TRUE(pump.Post(101));
+            EXPECT_FALSE(pump.Post(102));
+
+            const auto stats = pump.stats();
+            EXPECT_EQ(stats.posted, 8u);
+            EXPECT_EQ(stats.dropped, 3u);
+            EXPECT_EQ(stats.capacity, 8u);
+        }
+
+        TEST(EventPumpTest, DeliversWithoutAWindowToWake) {
+            // Nothing to post a drain message to yet.
+            bool window = false;
+            int wakes = 0;
+            EventPump<int> pump(16, [&] {
+                if (!window) return false;
+                ++wakes;
+                return true;
+            });
+
+            EXPECT_TRUE(pump.Post(1));
+            EXPECT_TRUE(pump.Post(2));
+            EXPECT_EQ(pump.stats().failedWakeups, 2u);
+
+            // The consumer drains on its own, say on the next method call.
+            std::vector<int> seen;
+            EXPECT_EQ(pump.Drain([&seen](int& value) { seen.push_back(value); }), 2u);
+            EXPECT_EQ(seen, (std::vector<int>{ 1, 2 }));
+
+            // A failed wake leaves no drain pending, so once there is a
+            // window the next post reaches it.
+            EXPECT_TRUE(pump.Post(3));
+            window = true;
+            EXPECT_TRUE(pump.Post(4));
+            EXPECT_EQ(wakes, 1);
+            EXPECT_EQ(pump.Drain([&seen](int& value) { seen.push_back(value); }), 2u);
+            EXPECT_EQ(seen, (std::vector<int>{ 1, 2, 3, 4 }));
+            EXPECT_EQ(pump.stats().wakeups, 1u);
+        }
+
+        // Producers on several threads, consumer woken through a signal
+        // counter the way the plugin is woken through posted window messages.
+        // No event may be stranded without a pending wakeup.
+        TEST(EventPumpTest, NoLostWakeups) {
+            constexpr int kProducers = 4;
+            constexpr int kEvents = 20000;
+            std::atomic<int> signals{ 0 };
+            EventPump<int> pump(256, [&signals] {
+                signals.fetch_add(1);
+                return true;
+            });
+
+            std::atomic<int> handled{ 0 };
+            std::atomic<bool> done{ false };
+            std::thread consumer([&] {
+                for (;;) {
+                    int pending = signals.load();
+                    if (pending == 0) {
+                        if (done.load() && signals.load() == 0) return;
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    if (!signals.compare_exchange_weak(pending, pending - 1)) continue;
+                    pump.Drain([&handled](int&) { handled.fetch_add(1); }, 64);
+                }
+            });
+
+            std::vector<std::thread> producers;
+            for (int p = 0; p < kProducers; ++p) {
+                producers.emplace_back([&pump] {
+                    for (int i = 0; i < kEvents; ++i) {
+                        while (!pump.Post(i)) std::this_thread::yield();
+                    }
+                });
+            }
+            for (auto& producer : producers) producer.join();
+
+            // Everything must drain through wakeups alone.
+            for (int spins = 0; handled.load() < kProducers * kEvents && spins < 10000; ++spins) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            done = true;
+            consumer.join();
+
+            EXPECT_EQ(handled.load(), kProducers * kEvents);
+            EXPECT_EQ(pump.stats().drained, static_cast<uint64_t>(kProducers * kEvents));
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
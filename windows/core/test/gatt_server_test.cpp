@@ -0,0 +1,196 @@
+#include "gatt_server.h"
+
+#include <gtest/gtest.h>
+
+#include "loopback_gatt_transport.h"
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        BluetoothUuid Uuid(const char* text) { return *ParseBluetoothUuid(text); }
+
+        SharedBuffer Bytes(std::vector<uint8_t> bytes) { return SharedBuffer::CopyFrom(bytes); }
+
+        class GattServerTest : public ::testing::Test {
+        protected:
+            void SetUp() override {
+                service_.uuid = Uuid("180F");
+                service_.characteristics.push_back({ Uuid("2A19"), kGattRead | kGattNotify, Bytes({ 100 }) });
+                service_.characteristics.push_back({ Uuid("2A3D"), kGattWrite | kGattWriteWithoutResponse | kGattIndicate, {} });
+                ASSERT_TRUE(server_.AddService(service_));
+                level_ = service_.characteristics[0].handle;
+                text_ = service_.characteristics[1].handle;
+            }
+
+            LoopbackGattTransport transport_;
+            GattServer server_{ transport_ };
+            GattService service_;
+            GattHandle level_ = 0;
+            GattHandle text_ = 0;
+        };
+
+        TEST_F(GattServerTest, AssignsHandlesAndPublishes) {
+            EXPECT_EQ(service_.handle, 1);
+            EXPECT_EQ(level_, 2);
+            EXPECT_EQ(text_, 3);
+            ASSERT_EQ(transport_.services.size(), 1u);
+            EXPECT_EQ(transport_.services[0].characteristics[1].handle, 3);
+            EXPECT_EQ(server_.FindCharacteristic(Uuid("2A3D")), text_);
+            EXPECT_EQ(server_.FindCharacteristic(Uuid("2A00")), 0);
+        }
+
+        TEST_F(GattServerTest, RefusedServiceLeavesTableUnchanged) {
+            transport_.accept_publish = false;
+            GattService other;
+            other.uuid = Uuid("1812");
+            other.characteristics.push_back({ Uuid("2A4D"), kGattRead, {} });
+            EXPECT_FALSE(server_.AddService(other));
+            EXPECT_EQ(other.handle, 0);
+            EXPECT_EQ(server_.FindCharacteristic(Uuid("2A4D")), 0);
+
+            transport_.accept_publish = true;
+            ASSERT_TRUE(server_.AddService(other));
+            EXPECT_EQ(other.handle, 4);
+        }
+
+        TEST_F(GattServerTest, ReadsHonourPropertiesAndOffsets) {
+            auto read = server_.OnRead(7, level_, 0);
+            EXPECT_EQ(read.status, GattStatus::kSuccess);
+            EXPECT_EQ(read.bytes().ToVector(), std::vector<uint8_t>{ 100 });
+
+            EXPECT_EQ(server_.OnRead(7, level_, 2).status, GattStatus::kInvalidOffset);
+            EXPECT_EQ(server_.OnRead(7, text_, 0).status, GattStatus::kReadNotPermitted);
+            EXPECT_EQ(server_.OnRead(7, 99, 0).status, GattStatus::kInvalidHandle);
+            EXPECT_EQ(server_.stats().reads, 1u);
+            EXPECT_EQ(server_.stats().rejected, 3u);
+        }
+
+        TEST_F(GattServerTest, ReadHandlerCanSupplyTheValue) {
+            server_.SetReadHandler([](GattClientId, GattHandle, SharedBuffer& value) {
+                value = Bytes({ 42 });
+                return GattStatus::kSuccess;
+            });
+            EXPECT_EQ(server_.OnRead(7, level_, 0).bytes().ToVector(), std::vector<uint8_t>{ 42 });
+            EXPECT_EQ(server_.GetValue(level_)->view().ToVector(), std::vector<uint8_t>{ 42 });
+        }
+
+        TEST_F(GattServerTest, WritesStoreAndSpliceAtOffset) {
+            const std::vector<uint8_t> hello = { 'h', 'e', 'l', 'l', 'o' };
+            EXPECT_EQ(server_.OnWrite(7, text_, 0, hello, true), GattStatus::kSuccess);
+            const std::vector<uint8_t> p = { 'p', '!' };
+            EXPECT_EQ(server_.OnWrite(7, text_, 3, p, false), GattStatus::kSuccess);
+            EXPECT_EQ(server_.GetValue(text_)->view().ToVector(), (std::vector<uint8_t>{ 'h', 'e', 'l', 'p', '!' }));
+
+            EXPECT_EQ(server_.OnWrite(7, text_, 9, p, true), GattStatus::kInvalidOffset);
+            EXPECT_EQ(server_.OnWrite(7, level_, 0, p, true), GattStatus::kWriteNotPermitted);
+            const std::vector<uint8_t> too_long(kGattMaxAttributeSize, 0);
+            EXPECT_EQ(server_.OnWrite(7, text_, 1, too_long, true), GattStatus::kInvalidAttributeValueLength);
+        }
+
+        TEST_F(GattServerTest, WriteHandlerCanReject) {
+            server_.SetWriteHandler([](GattClientId, GattHandle, size_t, ByteView value) {
+                return value.size() > 2 ? GattStatus::kInvalidAttributeValueLength : GattStatus::kSuccess;
+            });
+            const std::vector<uint8_t> three = { 1, 2, 3 };
+            EXPECT_EQ(server_.OnWrite(7, text_, 0, three, true), GattStatus::kInvalidAttributeValueLength);
+            EXPECT_TRUE(server_.GetValue(text_)->empty());
+        }
+
+        TEST_F(GattServerTest, NotifyFansOutOneSharedBuffer) {
+            server_.OnClientConnected(1);
+            server_.OnClientConnected(2);
+            server_.OnClientConnected(3);
+            EXPECT_EQ(server_.OnSubscriptionChanged(1, level_, GattSubscription::kNotify), GattStatus::kSuccess);
+            EXPECT_EQ(server_.OnSubscriptionChanged(2, level_, GattSubscription::kNotify), GattStatus::kSuccess);
+            EXPECT_EQ(server_.OnSubscriptionChanged(3, level_, GattSubscription::kIndicate), GattStatus::kWriteNotPermitted);
+
+            SharedBuffer value = Bytes({ 55 });
+            EXPECT_EQ(server_.Notify(level_, value), 2u);
+            ASSERT_EQ(transport_.inboxes[1].size(), 1u);
+            ASSERT_EQ(transport_.inboxes[2].size(), 1u);
+            EXPECT_TRUE(transport_.inboxes[3].empty());
+            EXPECT_EQ(transport_.inboxes[1][0].value.data(), value.data());
+            EXPECT_EQ(transport_.inboxes[2][0].value.data(), value.data());
+            EXPECT_FALSE(transport_.inboxes[1][0].indicate);
+            EXPECT_EQ(server_.OnRead(1, level_, 0).bytes().ToVector(), std::vector<uint8_t>{ 55 });
+
+            auto stats = server_.stats();
+            EXPECT_EQ(stats.notifications, 2u);
+            EXPECT_EQ(stats.bytesSent, 2u);
+            EXPECT_EQ(stats.subscriptions, 2u);
+        }
+
+        TEST_F(GattServerTest, IndicationsAndBackpressure) {
+            server_.OnSubscriptionChanged(1, text_, GattSubscription::kIndicate);
+            server_.OnSubscriptionChanged(2, text_, GattSubscription::kIndicate);
+            transport_.inbox_capacity = 1;
+            transport_.inboxes[2].push_back({});
+
+            EXPECT_EQ(server_.Notify(text_, Bytes({ 1 })), 1u);
+            EXPECT_TRUE(transport_.inboxes[1][0].indicate);
+            EXPECT_EQ(server_.stats().indications, 1u);
+            EXPECT_EQ(server_.stats().dropped, 1u);
+        }
+
+        TEST_F(GattServerTest, DisconnectDropsSubscriptions) {
+            EXPECT_TRUE(server_.OnClientConnected(1));
+            EXPECT_FALSE(server_.OnClientConnected(2));
+            EXPECT_FALSE(server_.OnClientConnected(2));
+            server_.OnSubscriptionChanged(1, level_, GattSubscription::kNotify);
+            server_.OnSubscriptionChanged(2, level_, GattSubscription::kNotify);
+
+            EXPECT_FALSE(server_.OnClientDisconnected(1));
+            EXPECT_EQ(server_.subscriber_count(level_), 1u);
+            EXPECT_TRUE(server_.OnClientDisconnected(2));
+            EXPECT_FALSE(server_.connected());
+            EXPECT_EQ(server_.subscriber_count(level_), 0u);
+        }
+
+        TEST_F(GattServerTest, TracksMtuPerClient) {
+            EXPECT_FALSE(server_.OnMtuChanged(1, 247));
+            server_.OnClientConnected(1);
+            server_.OnClientConnected(2);
+            EXPECT_EQ(server_.mtu(1), kDefaultAttMtu);
+
+            EXPECT_TRUE(server_.OnMtuChanged(1, 247));
+            EXPECT_FALSE(server_.OnMtuChanged(1, 247));
+            EXPECT_EQ(server_.mtu(1), 247u);
+            EXPECT_EQ(server_.mtu(2), kDefaultAttMtu);
+            EXPECT_TRUE(server_.OnMtuChanged(2, 9000));
+            EXPECT_EQ(server_.mtu(2), kMaxAttMtu);
+
+            server_.OnClientDisconnected(1);
+            server_.OnClientConnected(1);
+            EXPECT_EQ(server_.mtu(1), kDefaultAttMtu);
+        }
+
+        TEST_F(GattServerTest, ResubscribingReplacesAndNoneUnsubscribes) {
+            server_.OnSubscriptionChanged(1, level_, GattSubscription::kNotify);
+            server_.OnSubscriptionChanged(1, level_, GattSubscription::kNotify);
+            EXPECT_EQ(server_.subscriber_count(level_), 1u);
+            server_.OnSubscriptionChanged(1, level_, GattSubscription::kNone);
+            EXPECT_EQ(server_.subscriber_count(level_), 0u);
+            EXPECT_EQ(server_.Notify(level_, Bytes({ 1 })), 0u);
+        }
+
+        TEST_F(GattServerTest, RemoveServiceForgetsCharacteristics) {
+            EXPECT_TRUE(server_.RemoveService(service_.handle));
+            EXPECT_TRUE(transport_.services.empty());
+            EXPECT_EQ(server_.OnRead(1, level_, 0).status, GattStatus::kInvalidHandle);
+            EXPECT_FALSE(server_.RemoveService(service_.handle));
+        }
+
+        TEST(GattServerHandlesTest, RefusesServicesOnceHandlesRunOut) {
+            LoopbackGattTransport transport;
+            GattServer server(transport);
+            GattService big;
+            big.characteristics.resize(0xFFFE);
+            ASSERT_TRUE(server.AddService(big));
+            EXPECT_EQ(big.characteristics.back().handle, 0xFFFF);
+
+            GattService one_more;
+            EXPECT_FALSE(server.AddService(one_more));
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
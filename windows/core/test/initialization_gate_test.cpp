@@ -0,0 +1,44 @@
+#include "initialization_gate.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        using Gate = InitializationGate<std::unique_ptr<int>>;
+
+        TEST(InitializationGateTest, DefersUntilOpenThenReplaysInOrder) {
+            Gate gate;
+            EXPECT_EQ(gate.Admit(std::make_unique<int>(1)), Gate::Admission::kDeferred);
+            EXPECT_EQ(gate.Admit(std::make_unique<int>(2)), Gate::Admission::kDeferred);
+            EXPECT_EQ(gate.pending(), 2u);
+
+            auto replay = gate.Open();
+            ASSERT_EQ(replay.size(), 2u);
+            EXPECT_EQ(*replay[0], 1);
+            EXPECT_EQ(*replay[1], 2);
+            EXPECT_FALSE(gate.failed());
+
+            EXPECT_EQ(gate.Admit(std::make_unique<int>(3)), Gate::Admission::kRun);
+            EXPECT_EQ(gate.pending(), 0u);
+            EXPECT_EQ(gate.total_deferred(), 2u);
+        }
+
+        TEST(InitializationGateTest, RejectsBeyondTheLimit) {
+            Gate gate(1);
+            EXPECT_EQ(gate.Admit(std::make_unique<int>(1)), Gate::Admission::kDeferred);
+            EXPECT_EQ(gate.Admit(std::make_unique<int>(2)), Gate::Admission::kRejected);
+        }
+
+        TEST(InitializationGateTest, RemembersTheFailure) {
+            Gate gate;
+            gate.Admit(std::make_unique<int>(1));
+            EXPECT_EQ(gate.Open("no Bluetooth adapter").size(), 1u);
+            EXPECT_TRUE(gate.failed());
+            EXPECT_EQ(gate.error(), "no Bluetooth adapter");
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,51 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_TEST_LOOPBACK_GATT_TRANSPORT_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_TEST_LOOPBACK_GATT_TRANSPORT_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <vector>
+
+#include "gatt_transport.h"
+
+namespace flutter_ble_peripheral {
+
+    // A GattTransport whose clients live in memory: every value sent lands
+    // in the client's inbox. Shared by the tests and the benchmarks.
+    class LoopbackGattTransport : public GattTransport {
+    public:
+        struct Delivery {
+            GattHandle characteristic = 0;
+            SharedBuffer value;
+            bool indicate = false;
+        };
+
+        bool PublishService(const GattService& service) override {
+            if (!accept_publish) return false;
+            services.push_back(service);
+            return true;
+        }
+
+        void RemoveService(GattHandle service) override {
+            services.erase(std::remove_if(services.begin(), services.end(),
+                                          [service](const GattService& s) { return s.handle == service; }),
+                           services.end());
+        }
+
+        bool SendValue(GattClientId client, GattHandle characteristic,
+                       const SharedBuffer& value, bool indicate) override {
+            auto& inbox = inboxes[client];
+            if (inbox.size() >= inbox_capacity) return false;
+            inbox.push_back({ characteristic, value, indicate });
+            return true;
+        }
+
+        bool accept_publish = true;
+        size_t inbox_capacity = static_cast<size_t>(-1);
+        std::vector<GattService> services;
+        std::map<GattClientId, std::vector<Delivery>> inboxes;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_TEST_LOOPBACK_GATT_TRANSPORT_H_
@@ -0,0 +1,192 @@
+#include "manufacturer_pattern_set.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        constexpr SimdLevel kLevels[] = { SimdLevel::kScalar, SimdLevel::kSse2, SimdLevel::kAvx2 };
+
+        std::vector<uint8_t> Record(uint16_t company, std::vector<uint8_t> data) {
+            data.insert(data.begin(), { static_cast<uint8_t>(company & 0xFF), static_cast<uint8_t>(company >> 8) });
+            return data;
+        }
+
+        // The matcher spelled out: the first pattern, in order, whose bytes
+        // all agree under the mask.
+        std::optional<uint32_t> ReferenceMatch(const std::vector<ManufacturerDataPattern>& patterns,
+                                               const std::vector<uint8_t>& record) {
+            for (size_t i = 0; i < patterns.size(); ++i) {
+                const auto& pattern = patterns[i];
+                if (record.size() < 2 + pattern.prefix.size()) continue;
+                if ((record[0] | record[1] << 8) != pattern.companyId) continue;
+                bool equal = true;
+                for (size_t b = 0; b < pattern.prefix.size() && equal; ++b) {
+                    const uint8_t mask = pattern.mask.empty() ? 0xFF : pattern.mask[b];
+                    equal = (record[2 + b] & mask) == (pattern.prefix[b] & mask);
+                }
+                if (equal) return static_cast<uint32_t>(i);
+            }
+            return std::nullopt;
+        }
+
+        // iBeacon-style identities: one of a few UUIDs, then major and minor.
+        std::vector<ManufacturerDataPattern> BeaconPatterns(size_t count) {
+            std::vector<ManufacturerDataPattern> patterns;
+            for (size_t i = 0; i < count; ++i) {
+                std::vector<uint8_t> prefix = { 0x02, 0x15 };
+                for (uint8_t b = 0; b < 16; ++b) prefix.push_back(static_cast<uint8_t>(b + (i % 3) * 0x10));
+                prefix.push_back(static_cast<uint8_t>(i >> 8));
+                prefix.push_back(static_cast<uint8_t>(i));
+                prefix.push_back(0x00);
+                prefix.push_back(static_cast<uint8_t>(i * 7));
+                patterns.push_back({ 0x004C, prefix, {} });
+            }
+            return patterns;
+        }
+
+        TEST(ManufacturerPatternSetTest, EmptySetMatchesNothing) {
+            ManufacturerPatternSet set;
+            EXPECT_FALSE(set.Match(Record(0x004C, { 1, 2, 3 })));
+            EXPECT_FALSE(set.MatchesAny(Record(0x004C, { 1, 2, 3 })));
+            auto compiled = ManufacturerPatternSet::Compile({});
+            ASSERT_TRUE(compiled);
+            EXPECT_FALSE(compiled->Match(Record(0x004C, {})));
+        }
+
+        TEST(ManufacturerPatternSetTest, MatchesCompanyAndMaskedPrefix) {
+            auto set = ManufacturerPatternSet::Compile({
+                { 0x0059, { 0x10, 0x20 }, { 0xF0, 0xFF } },
+                { 0x004C, {}, {} },
+                });
+            ASSERT_TRUE(set);
+            EXPECT_EQ(set->Match(Record(0x0059, { 0x1F, 0x20, 0x99 })), 0u);
+            EXPECT_FALSE(set->Match(Record(0x0059, { 0x2F, 0x20 })));
+            EXPECT_FALSE(set->Match(Record(0x0059, { 0x10, 0x21 })));
+            EXPECT_EQ(set->Match(Record(0x004C, {})), 1u);
+            EXPECT_FALSE(set->Match(Record(0x4C00, { 0x10, 0x20 })));
+            EXPECT_FALSE(set->Match(ByteView()));
+        }
+
+        TEST(ManufacturerPatternSetTest, ShortRecordNeverMatchesLongerPattern) {
+            // The record is zero-padded before the comparison; a pattern that
+            // expects zeros past its end must still miss.
+            auto set = ManufacturerPatternSet::Compile({ { 0x0001, { 0x00, 0x00, 0x00 }, {} } });
+            ASSERT_TRUE(set);
+            EXPECT_FALSE(set->MatchesAny(Record(0x0001, { 0x00, 0x00 })));
+            EXPECT_TRUE(set->MatchesAny(Record(0x0001, { 0x00, 0x00, 0x00 })));
+        }
+
+        TEST(ManufacturerPatternSetTest, ChecksBytesPastTheSlot) {
+            std::vector<uint8_t> prefix(60);
+            for (size_t i = 0; i < prefix.size(); ++i) prefix[i] = static_cast<uint8_t>(i);
+            auto set = ManufacturerPatternSet::Compile({ { 0x00E0, prefix, {} } });
+            ASSERT_TRUE(set);
+            auto record = Record(0x00E0, prefix);
+            EXPECT_TRUE(set->MatchesAny(record));
+            record[50] ^= 1;
+            EXPECT_FALSE(set->MatchesAny(record));
+            record[50] ^= 1;
+            record.pop_back();
+            EXPECT_FALSE(set->MatchesAny(record));
+        }
+
+        TEST(ManufacturerPatternSetTest, RejectsInvalidPatterns) {
+            EXPECT_FALSE(ManufacturerPatternSet::Compile({ { 0x0001, { 1, 2 }, { 0xFF } } }));
+            EXPECT_FALSE(ManufacturerPatternSet::Compile({ { 0x0001, std::vector<uint8_t>(251), {} } }));
+            EXPECT_TRUE(ManufacturerPatternSet::Compile({ { 0x0001, std::vector<uint8_t>(250), {} } }));
+        }
+
+        TEST(ManufacturerPatternSetTest, IndexesBeaconIdentitiesByMajorAndMinor) {
+            const auto patterns = BeaconPatterns(4000);
+            auto set = ManufacturerPatternSet::Compile(patterns);
+            ASSERT_TRUE(set);
+            EXPECT_EQ(set->indexed(), patterns.size());
+            for (uint32_t i = 0; i < patterns.size(); i += 97) {
+                auto record = Record(0x004C, patterns[i].prefix);
+                record.push_back(0xC5);
+                EXPECT_EQ(set->Match(record), i);
+            }
+        }
+
+        TEST(ManufacturerPatternSetTest, ReturnsTheFirstPatternAcrossIndexAndResidual) {
+            auto patterns = BeaconPatterns(64);
+            // A catch-all for the company comes after the identities and
+            // cannot be indexed; the identity it shadows still wins.
+            patterns.push_back({ 0x004C, { 0x02 }, {} });
+            auto set = ManufacturerPatternSet::Compile(patterns);
+            ASSERT_TRUE(set);
+            EXPECT_EQ(set->indexed(), 64u);
+            EXPECT_EQ(set->Match(Record(0x004C, patterns[10].prefix)), 10u);
+            EXPECT_EQ(set->Match(Record(0x004C, { 0x02, 0x15, 0xEE })), 64u);
+
+            // Put it first and it shadows every identity.
+            patterns.insert(patterns.begin(), patterns.back());
+            patterns.pop_back();
+            set = ManufacturerPatternSet::Compile(patterns);
+            ASSERT_TRUE(set);
+            EXPECT_EQ(set->Match(Record(0x004C, patterns[10].prefix)), 0u);
+        }
+
+        TEST(ManufacturerPatternSetTest, ClampsTheLevelToTheCpu) {
+            ManufacturerPatternSetOptions options;
+            options.simdLevel = SimdLevel::kAvx2;
+            auto set = ManufacturerPatternSet::Compile({ { 1, {}, {} } }, options);
+            ASSERT_TRUE(set);
+            EXPECT_LE(set->simd_level(), DetectSimdLevel());
+            options.simdLevel = SimdLevel::kScalar;
+            EXPECT_EQ(ManufacturerPatternSet::Compile({ { 1, {}, {} } }, options)->simd_level(), SimdLevel::kScalar);
+        }
+
+        // Random patterns of every length and mask against random records
+        // that often share a pattern's head; every kernel, with and without
+        // the index, has to agree with the reference.
+        TEST(ManufacturerPatternSetTest, AgreesWithReferenceAtEveryLevel) {
+            std::mt19937 random(19);
+            const uint16_t companies[] = { 0x004C, 0x0006, 0x0059 };
+            std::vector<ManufacturerDataPattern> patterns;
+            for (int i = 0; i < 600; ++i) {
+                ManufacturerDataPattern pattern;
+                pattern.companyId = companies[random() % 3];
+                const size_t size = random() % 8 == 0 ? random() % 48 : random() % 12;
+                for (size_t b = 0; b < size; ++b) pattern.prefix.push_back(static_cast<uint8_t>(random() % 4));
+                if (random() % 3 == 0) {
+                    for (size_t b = 0; b < size; ++b) {
+                        pattern.mask.push_back(random() % 2 ? 0xFF : static_cast<uint8_t>(random()));
+                    }
+                }
+                patterns.push_back(std::move(pattern));
+            }
+            std::vector<std::vector<uint8_t>> records;
+            for (int i = 0; i < 3000; ++i) {
+                std::vector<uint8_t> data;
+                const size_t size = random() % 50;
+                for (size_t b = 0; b < size; ++b) data.push_back(static_cast<uint8_t>(random() % 4));
+                records.push_back(Record(companies[random() % 3], data));
+            }
+
+            for (SimdLevel level : kLevels) {
+                for (bool index : { false, true }) {
+                    SCOPED_TRACE(std::string(SimdLevelName(level)) + (index ? " indexed" : " linear"));
+                    ManufacturerPatternSetOptions options;
+                    options.simdLevel = level;
+                    options.bucketIndex = index;
+                    auto set = ManufacturerPatternSet::Compile(patterns, options);
+                    ASSERT_TRUE(set);
+                    if (!index) {
+                        EXPECT_EQ(set->indexed(), 0u);
+                    }
+                    for (const auto& record : records) {
+                        const auto expected = ReferenceMatch(patterns, record);
+                        ASSERT_EQ(set->Match(record), expected);
+                        ASSERT_EQ(set->MatchesAny(record), expected.has_value());
+                    }
+                }
+            }
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,109 @@
+#include "method_arguments.h"
+
+#include <gtest/gtest.h>
+
+#include "test_value.h"
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        TEST(MethodArgumentsTest, DecodesStartArguments) {
+            TestMap arguments{
+                {std::string("manufacturerId"), int32_t{1234}},
+                {std::string("manufacturerDataBytes"), std::vector<uint8_t>{1, 2, 3}},
+                {std::string("localName"), std::string("test")},
+                {std::string("includePowerLevel"), true},
+            };
+
+            AdvertiseData data = DecodeAdvertiseData(arguments);
+
+            ASSERT_TRUE(data.manufacturerId.has_value());
+            EXPECT_EQ(*data.manufacturerId, 1234);
+            EXPECT_EQ(data.manufacturerData.view().ToVector(), (std::vector<uint8_t>{1, 2, 3}));
+            EXPECT_EQ(data.localName, "test");
+            EXPECT_FALSE(data.serviceUuid.has_value());
+            EXPECT_FALSE(data.includeDeviceName);
+            EXPECT_TRUE(data.includePowerLevel);
+        }
+
+        TEST(MethodArgumentsTest, NullEntriesKeepDefaults) {
+            // AdvertiseData.toJson() sends every field, null or not.
+            TestMap arguments{
+                {std::string("manufacturerId"), std::monostate()},
+                {std::string("manufacturerDataBytes"), std::monostate()},
+                {std::string("serviceUuid"), std::monostate()},
+                {std::string("includeDeviceName"), std::monostate()},
+            };
+
+            AdvertiseData data = DecodeAdvertiseData(arguments);
+
+            EXPECT_FALSE(data.manufacturerId.has_value());
+            EXPECT_TRUE(data.manufacturerData.empty());
+            EXPECT_FALSE(data.serviceUuid.has_value());
+            EXPECT_FALSE(data.includeDeviceName);
+        }
+
+        TEST(MethodArgumentsTest, DecodesServiceDataAndSolicitation) {
+            TestMap arguments{
+                {std::string("serviceDataUuid"), std::string("180F")},
+                {std::string("serviceDataBytes"), std::vector<uint8_t>{0x64}},
+                {std::string("serviceSolicitationUuid"), std::string("1812")},
+            };
+
+            AdvertiseData data = DecodeAdvertiseData(arguments);
+
+            EXPECT_EQ(data.serviceDataUuid, "180F");
+            EXPECT_EQ(data.serviceData.view().ToVector(), (std::vector<uint8_t>{0x64}));
+            EXPECT_EQ(data.serviceSolicitationUuid, "1812");
+        }
+
+        TEST(MethodArgumentsTest, InternedKeysMatchTheirNames) {
+            for (size_t i = 0; i < kArgumentCount; ++i) {
+                const TestValue& key = InternedKey<TestValue>(static_cast<Argument>(i));
+                EXPECT_EQ(key, TestValue(std::string(kArgumentNames[i])));
+            }
+            // One key object per argument, shared by every lookup.
+            EXPECT_EQ(&InternedKey<TestValue>(Argument::kLocalName),
+                      &InternedKey<TestValue>(Argument::kLocalName));
+
+            TestMap arguments{{std::string("maxAgeMs"), int32_t{250}}};
+            EXPECT_EQ(GetInt(FindArgument(arguments, Argument::kMaxAgeMs)), 250);
+            EXPECT_EQ(FindArgument(arguments, Argument::kCapacity), nullptr);
+        }
+
+        TEST(MethodArgumentsTest, AcceptsInt64AndTruncatesCompanyId) {
+            TestMap arguments{{std::string("manufacturerId"), int64_t{0x1FFFF}}};
+            EXPECT_EQ(DecodeAdvertiseData(arguments).manufacturerId, 0xFFFF);
+        }
+
+        TEST(MethodArgumentsTest, DecodesScanSettings) {
+            ScanSettings settings = DecodeScanSettings(TestMap{});
+            EXPECT_EQ(settings.mode, ScanMode::kPassive);
+            EXPECT_TRUE(settings.continuous());
+            EXPECT_TRUE(IsValidScanSettings(settings));
+
+            settings = DecodeScanSettings(TestMap{
+                {std::string("scanMode"), int32_t{1}},
+                {std::string("intervalMicros"), int64_t{5120000}},
+                {std::string("windowMicros"), int32_t{512000}},
+            });
+            EXPECT_EQ(settings.mode, ScanMode::kActive);
+            EXPECT_EQ(settings.interval, std::chrono::milliseconds(5120));
+            EXPECT_EQ(settings.window, std::chrono::milliseconds(512));
+            EXPECT_DOUBLE_EQ(settings.duty_cycle(), 0.1);
+            EXPECT_TRUE(IsValidScanSettings(settings));
+
+            // Without a window the interval is scanned end to end.
+            settings = DecodeScanSettings(TestMap{{std::string("intervalMicros"), int32_t{30000}}});
+            EXPECT_EQ(settings.window, std::chrono::milliseconds(30));
+
+            settings = DecodeScanSettings(TestMap{
+                {std::string("intervalMicros"), int32_t{10000}},
+                {std::string("windowMicros"), int32_t{20000}},
+            });
+            EXPECT_FALSE(IsValidScanSettings(settings));
+            EXPECT_FALSE(IsValidScanSettings(DecodeScanSettings(TestMap{{std::string("intervalMicros"), int32_t{2000}}})));
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
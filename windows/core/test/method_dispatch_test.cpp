@@ -0,0 +1,43 @@
+#include "method_dispatch.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        constexpr std::array<std::string_view, 3> kNames = { "a", "b", "ab" };
+        constexpr PerfectHashTable<3> kSmallTable{ kNames };
+        static_assert(kSmallTable.valid());
+        static_assert(*kSmallTable.Find("ab") == 2);
+        static_assert(!kSmallTable.Find("ba"));
+        static_assert(FindMethod("start") == Method::kStart);
+
+        TEST(MethodDispatchTest, FindsEveryMethodByName) {
+            for (size_t i = 0; i < kMethodCount; ++i) {
+                auto method = static_cast<Method>(i);
+                // Look up a copy so the match cannot come from comparing the
+                // table's own pointers.
+                std::string name(MethodName(method));
+                EXPECT_EQ(FindMethod(name), method) << name;
+            }
+        }
+
+        TEST(MethodDispatchTest, RejectsUnknownNames) {
+            EXPECT_FALSE(FindMethod(""));
+            EXPECT_FALSE(FindMethod("enableBluetooth"));
+            EXPECT_FALSE(FindMethod("star"));
+            EXPECT_FALSE(FindMethod("startt"));
+            EXPECT_FALSE(FindMethod("Start"));
+            EXPECT_FALSE(FindMethod(std::string_view("start\0", 6)));
+        }
+
+        TEST(MethodDispatchTest, DuplicateNamesLeaveTheTableInvalid) {
+            constexpr std::array<std::string_view, 2> names = { "stop", "stop" };
+            constexpr PerfectHashTable<2> table{ names };
+            EXPECT_FALSE(table.valid());
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,138 @@
+#include "metrics.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        using std::chrono::microseconds;
+        using std::chrono::milliseconds;
+        using std::chrono::nanoseconds;
+
+        TEST(LatencyHistogramTest, BucketsAreLogLinear) {
+            for (uint64_t value = 0; value < 32; ++value) {
+                EXPECT_EQ(LatencyHistogram::BucketIndex(value), value);
+            }
+            size_t previous = LatencyHistogram::BucketIndex(31);
+            for (uint64_t value = 32; value < (uint64_t{ 1 } << 20); value += value / 37 + 1) {
+                const size_t index = LatencyHistogram::BucketIndex(value);
+                EXPECT_GE(index, previous);
+                previous = index;
+                const uint64_t lower = LatencyHistogram::BucketLowerBound(index);
+                const uint64_t next = LatencyHistogram::BucketLowerBound(index + 1);
+                EXPECT_LE(lower, value);
+                EXPECT_LT(value, next);
+                // A bucket is no wider than 1/16 of the values in it.
+                EXPECT_LE((next - lower) * 16, lower);
+            }
+            EXPECT_EQ(LatencyHistogram::BucketIndex(UINT64_MAX), LatencyHistogram::kBucketCount - 1);
+            EXPECT_EQ(LatencyHistogram::BucketIndex((uint64_t{ 1 } << 36) - 1), LatencyHistogram::kBucketCount - 1);
+            EXPECT_EQ(LatencyHistogram::BucketIndex(uint64_t{ 1 } << 36), LatencyHistogram::kBucketCount - 1);
+        }
+
+        TEST(LatencyHistogramTest, Percentiles) {
+            LatencyHistogram histogram;
+            EXPECT_EQ(histogram.ValueAtPercentile(50), 0u);
+            for (uint64_t value = 1; value <= 1000; ++value) histogram.Record(value * 1000);
+
+            EXPECT_EQ(histogram.count(), 1000u);
+            EXPECT_EQ(histogram.min(), 1000u);
+            EXPECT_EQ(histogram.max(), 1000000u);
+            EXPECT_DOUBLE_EQ(histogram.mean(), 500500.0);
+            EXPECT_NEAR(static_cast<double>(histogram.ValueAtPercentile(50)), 500000, 500000 / 16);
+            EXPECT_NEAR(static_cast<double>(histogram.ValueAtPercentile(99)), 990000, 990000 / 16);
+            EXPECT_EQ(histogram.ValueAtPercentile(0), histogram.ValueAtPercentile(0.01));
+            EXPECT_EQ(histogram.ValueAtPercentile(100), 1000000u);
+
+            LatencyHistogram other;
+            other.Record(5);
+            histogram.Merge(other);
+            EXPECT_EQ(histogram.count(), 1001u);
+            EXPECT_EQ(histogram.min(), 5u);
+            EXPECT_EQ(histogram.ValueAtPercentile(0), 5u);
+        }
+
+        class MetricsTest : public ::testing::Test {
+        protected:
+            void SetUp() override {
+                if (!kMetricsEnabled) GTEST_SKIP() << "built with FLUTTER_BLE_PERIPHERAL_METRICS=0";
+            }
+
+            VirtualClock clock;
+            Metrics metrics{ clock };
+        };
+
+        TEST_F(MetricsTest, CountersSumAcrossThreads) {
+            constexpr int kThreads = 20;
+            constexpr int kAdds = 10000;
+            std::vector<std::thread> threads;
+            for (int t = 0; t < kThreads; ++t) {
+                threads.emplace_back([this] {
+                    for (int i = 0; i < kAdds; ++i) {
+                        metrics.Add(MetricCounter::kScanReceived);
+                        metrics.Record(MetricLatency::kCallbackToSink, nanoseconds(i));
+                    }
+                    metrics.Add(MetricCounter::kScanDropped, 3);
+                });
+            }
+            for (auto& thread : threads) thread.join();
+
+            auto snapshot = metrics.Collect();
+            EXPECT_TRUE(snapshot.enabled);
+            EXPECT_EQ(snapshot.counter(MetricCounter::kScanReceived), uint64_t{ kThreads } * kAdds);
+            EXPECT_EQ(snapshot.counter(MetricCounter::kScanDropped), uint64_t{ kThreads } * 3);
+            EXPECT_EQ(snapshot.counter(MetricCounter::kScanFiltered), 0u);
+            const auto& latency = snapshot.latency(MetricLatency::kCallbackToSink);
+            EXPECT_EQ(latency.count(), uint64_t{ kThreads } * kAdds);
+            EXPECT_EQ(latency.min(), 0u);
+            EXPECT_EQ(latency.max(), uint64_t{ kAdds } - 1);
+            EXPECT_TRUE(snapshot.latency(MetricLatency::kPublisherStart).empty());
+        }
+
+        TEST_F(MetricsTest, TimesMethodCalls) {
+            {
+                MethodTimer timer(metrics, Method::kStart);
+                clock.Advance(microseconds(250));
+            }
+            {
+                MethodTimer timer(metrics, Method::kStart);
+                clock.Advance(microseconds(750));
+            }
+            auto snapshot = metrics.Collect();
+            const auto& start = snapshot.method(Method::kStart);
+            EXPECT_EQ(start.count(), 2u);
+            EXPECT_EQ(start.min(), 250000u);
+            EXPECT_EQ(start.max(), 750000u);
+            EXPECT_TRUE(snapshot.method(Method::kStop).empty());
+        }
+
+        TEST_F(MetricsTest, TimesPublisherStarts) {
+            clock.Set(milliseconds(100));
+            metrics.OnPublisherStartRequested();
+            metrics.OnPublisherStatus(PublisherStatus::waiting);
+            clock.Set(milliseconds(130));
+            metrics.OnPublisherStatus(PublisherStatus::started);
+            // A Started without a request, e.g. after the radio came back.
+            metrics.OnPublisherStatus(PublisherStatus::started);
+
+            // A start that aborts is not timed, even once the next one starts.
+            metrics.OnPublisherStartRequested();
+            metrics.OnPublisherStatus(PublisherStatus::aborted);
+            clock.Set(milliseconds(900));
+            metrics.OnPublisherStatus(PublisherStatus::started);
+
+            auto snapshot = metrics.Collect();
+            EXPECT_EQ(snapshot.counter(MetricCounter::kPublisherStartRequests), 2u);
+            EXPECT_EQ(snapshot.counter(MetricCounter::kPublisherWaiting), 1u);
+            EXPECT_EQ(snapshot.counter(MetricCounter::kPublisherStarted), 3u);
+            EXPECT_EQ(snapshot.counter(MetricCounter::kPublisherAborted), 1u);
+            const auto& start = snapshot.latency(MetricLatency::kPublisherStart);
+            EXPECT_EQ(start.count(), 1u);
+            EXPECT_EQ(start.max(), 30000000u);
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,61 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_TEST_MOCK_RADIO_BACKEND_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_TEST_MOCK_RADIO_BACKEND_H_
+
+#include "radio_backend.h"
+
+namespace flutter_ble_peripheral {
+
+    // Records what the core asked the radio to do. Shared by the tests and the
+    // benchmarks.
+    class MockRadioBackend : public RadioBackend {
+    public:
+        bool StartAdvertising(const AdvertiseData& data) override {
+            ++start_count;
+            advertising = accept_start;
+            if (accept_start) last_started = data;
+            return accept_start;
+        }
+
+        void StopAdvertising() override {
+            ++stop_count;
+            advertising = false;
+        }
+
+        bool UpdateAdvertisement(const AdvertiseData& data, uint32_t changed) override {
+            ++update_count;
+            last_changed = changed;
+            if (accept_update) last_started = data;
+            return accept_update;
+        }
+
+        bool StartScan(const ScanSettings& settings) override {
+            ++scan_start_count;
+            scanning = accept_scan;
+            if (accept_scan) last_scan = settings;
+            return accept_scan;
+        }
+
+        void StopScan() override {
+            ++scan_stop_count;
+            scanning = false;
+        }
+
+        bool accept_start = true;
+        bool accept_update = true;
+        bool advertising = false;
+        int start_count = 0;
+        int stop_count = 0;
+        int update_count = 0;
+        uint32_t last_changed = 0;
+        AdvertiseData last_started;
+
+        bool accept_scan = true;
+        bool scanning = false;
+        int scan_start_count = 0;
+        int scan_stop_count = 0;
+        ScanSettings last_scan;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_TEST_MOCK_RADIO_BACKEND_H_
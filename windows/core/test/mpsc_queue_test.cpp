@@ -0,0 +1,86 @@
+#include "mpsc_queue.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        TEST(MpscQueueTest, PushesAndPopsInOrder) {
+            MpscQueue<int> queue(3);
+            EXPECT_EQ(queue.capacity(), 4u);
+
+            for (int i = 0; i < 4; ++i) EXPECT_TRUE(queue.TryPush(i));
+            EXPECT_FALSE(queue.TryPush(4));
+            EXPECT_EQ(queue.size(), 4u);
+
+            int value = -1;
+            for (int i = 0; i < 4; ++i) {
+                ASSERT_TRUE(queue.TryPop(value));
+                EXPECT_EQ(value, i);
+            }
+            EXPECT_FALSE(queue.TryPop(value));
+            EXPECT_TRUE(queue.TryPush(5));
+        }
+
+        struct Item {
+            uint32_t producer = 0;
+            uint32_t sequence = 0;
+        };
+
+        // Many producers hammer a small queue while one consumer drains it.
+        // Every accepted item must arrive exactly once and in per-producer
+        // order; run under FLUTTER_BLE_PERIPHERAL_CORE_SANITIZE=thread to check
+        // the memory ordering as well.
+        TEST(MpscQueueTest, ManyProducersStress) {
+            constexpr uint32_t kProducers = 8;
+            constexpr uint32_t kItemsPerProducer = 50000;
+            MpscQueue<Item> queue(64);
+
+            std::atomic<uint32_t> producers_done{ 0 };
+            std::vector<uint32_t> accepted(kProducers, 0);
+            std::vector<std::thread> producers;
+            for (uint32_t p = 0; p < kProducers; ++p) {
+                producers.emplace_back([&, p] {
+                    uint32_t pushed = 0;
+                    for (uint32_t i = 0; i < kItemsPerProducer; ++i) {
+                        // Retry a few times, then give up like a callback
+                        // that drops under back-pressure.
+                        for (int attempt = 0; attempt < 8; ++attempt) {
+                            if (queue.TryPush(Item{ p, pushed })) {
+                                ++pushed;
+                                break;
+                            }
+                            std::this_thread::yield();
+                        }
+                    }
+                    accepted[p] = pushed;
+                    producers_done.fetch_add(1, std::memory_order_release);
+                });
+            }
+
+            std::vector<uint32_t> next(kProducers, 0);
+            bool in_order = true;
+            Item item;
+            for (;;) {
+                if (queue.TryPop(item)) {
+                    in_order = in_order && item.sequence == next[item.producer];
+                    next[item.producer] = item.sequence + 1;
+                    continue;
+                }
+                if (producers_done.load(std::memory_order_acquire) == kProducers && queue.size() == 0) break;
+                std::this_thread::yield();
+            }
+            for (auto& producer : producers) producer.join();
+
+            EXPECT_TRUE(in_order);
+            for (uint32_t p = 0; p < kProducers; ++p) {
+                EXPECT_EQ(next[p], accepted[p]) << "producer " << p;
+            }
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
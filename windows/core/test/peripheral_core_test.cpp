@@ -0,0 +1,149 @@
+#include "peripheral_core.h"
+
+#include <gtest/gtest.h>
+
+#include "mock_radio_backend.h"
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        AdvertiseData Payload(uint8_t first_byte) {
+            AdvertiseData data;
+            data.manufacturerId = 0x004C;
+            const uint8_t bytes[] = {first_byte, 0x02, 0x03};
+            data.manufacturerData = SharedBuffer::CopyFrom(ByteView(bytes, sizeof(bytes)));
+            return data;
+        }
+
+        TEST(PeripheralCoreTest, StartAndStop) {
+            MockRadioBackend backend;
+            PeripheralCore core(backend);
+            EXPECT_EQ(core.state(), PeripheralState::idle);
+
+            EXPECT_EQ(core.Start(Payload(1)), BluetoothPeripheralState::ready);
+            EXPECT_TRUE(core.IsAdvertising());
+            EXPECT_TRUE(backend.advertising);
+            EXPECT_TRUE(backend.last_started.manufacturerData == Payload(1).manufacturerData);
+
+            EXPECT_EQ(core.Stop(), BluetoothPeripheralState::ready);
+            EXPECT_FALSE(core.IsAdvertising());
+            EXPECT_FALSE(backend.advertising);
+            EXPECT_TRUE(core.advertise_data().manufacturerData.empty());
+        }
+
+        TEST(PeripheralCoreTest, RestartStopsThePreviousAdvertisement) {
+            MockRadioBackend backend;
+            PeripheralCore core(backend);
+
+            core.Start(Payload(1));
+            core.Start(Payload(2));
+
+            EXPECT_EQ(backend.start_count, 2);
+            EXPECT_EQ(backend.stop_count, 1);
+            EXPECT_EQ(core.advertise_data().manufacturerData.view()[0], 2);
+        }
+
+        TEST(PeripheralCoreTest, StartSharesThePayloadWithTheBackend) {
+            MockRadioBackend backend;
+            PeripheralCore core(backend);
+            core.Start(Payload(1));
+
+            EXPECT_EQ(backend.last_started.manufacturerData.data(),
+                      core.advertise_data().manufacturerData.data());
+        }
+
+        TEST(PeripheralCoreTest, RefusedStartStaysIdle) {
+            MockRadioBackend backend;
+            backend.accept_start = false;
+            PeripheralCore core(backend);
+
+            EXPECT_EQ(core.Start(Payload(1)), BluetoothPeripheralState::unsupported);
+            EXPECT_FALSE(core.IsAdvertising());
+        }
+
+        TEST(PeripheralCoreTest, UpdateSwapsInPlace) {
+            MockRadioBackend backend;
+            PeripheralCore core(backend);
+            core.Start(Payload(1));
+
+            UpdateResult result = core.Update(Payload(2));
+
+            EXPECT_EQ(result.state, BluetoothPeripheralState::ready);
+            EXPECT_EQ(result.changedFields, kManufacturerData);
+            EXPECT_FALSE(result.restarted);
+            EXPECT_EQ(backend.update_count, 1);
+            EXPECT_EQ(backend.last_changed, kManufacturerData);
+            EXPECT_EQ(backend.stop_count, 0);
+            EXPECT_EQ(core.advertise_data().manufacturerData.view()[0], 2);
+        }
+
+        TEST(PeripheralCoreTest, UpdateWithSamePayloadIsANoOp) {
+            MockRadioBackend backend;
+            PeripheralCore core(backend);
+            core.Start(Payload(1));
+
+            UpdateResult result = core.Update(Payload(1));
+
+            EXPECT_EQ(result.changedFields, 0u);
+            EXPECT_EQ(backend.update_count, 0);
+        }
+
+        TEST(PeripheralCoreTest, UpdateFallsBackToRestart) {
+            MockRadioBackend backend;
+            backend.accept_update = false;
+            PeripheralCore core(backend);
+            core.Start(Payload(1));
+
+            UpdateResult result = core.Update(Payload(2));
+
+            EXPECT_TRUE(result.restarted);
+            EXPECT_EQ(backend.stop_count, 1);
+            EXPECT_EQ(backend.start_count, 2);
+            EXPECT_EQ(core.advertise_data().manufacturerData.view()[0], 2);
+        }
+
+        TEST(PeripheralCoreTest, UpdateStartsWhenIdle) {
+            MockRadioBackend backend;
+            PeripheralCore core(backend);
+
+            UpdateResult result = core.Update(Payload(1));
+
+            EXPECT_TRUE(result.restarted);
+            EXPECT_TRUE(core.IsAdvertising());
+            EXPECT_EQ(backend.update_count, 0);
+        }
+
+        TEST(PeripheralCoreTest, PublisherAbortEndsAdvertising) {
+            MockRadioBackend backend;
+            PeripheralCore core(backend);
+            core.Start(Payload(1));
+
+            core.OnPublisherStatusChanged(PublisherStatus::started, core.publisher());
+            EXPECT_TRUE(core.IsAdvertising());
+
+            core.OnPublisherStatusChanged(PublisherStatus::aborted, core.publisher());
+            EXPECT_FALSE(core.IsAdvertising());
+            EXPECT_EQ(core.publisher_status(), PublisherStatus::aborted);
+        }
+
+        TEST(PeripheralCoreTest, IgnoresStatusesOfReplacedPublishers) {
+            MockRadioBackend backend;
+            PeripheralCore core(backend);
+            core.Start(Payload(1));
+            EXPECT_EQ(core.publisher(), 1u);
+            core.Start(Payload(2));
+            EXPECT_EQ(core.publisher(), 2u);
+            core.OnPublisherStatusChanged(PublisherStatus::started, 2);
+
+            core.OnPublisherStatusChanged(PublisherStatus::stopped, 1);
+            EXPECT_TRUE(core.IsAdvertising());
+            EXPECT_EQ(core.publisher_status(), PublisherStatus::started);
+
+            // A refused start still uses up a number.
+            backend.accept_start = false;
+            core.Start(Payload(3));
+            EXPECT_EQ(core.publisher(), 3u);
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
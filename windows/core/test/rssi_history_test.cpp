@@ -0,0 +1,187 @@
+#include "rssi_history.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        using std::chrono::microseconds;
+        using std::chrono::milliseconds;
+
+        constexpr SimdLevel kLevels[] = { SimdLevel::kScalar, SimdLevel::kSse2, SimdLevel::kAvx2 };
+
+        RssiHistoryOptions Options(size_t samples_per_device, SimdLevel level = DetectSimdLevel()) {
+            RssiHistoryOptions options;
+            options.samplesPerDevice = samples_per_device;
+            options.simdLevel = level;
+            return options;
+        }
+
+        TEST(RssiHistoryTest, UnknownDeviceHasNoStats) {
+            RssiHistory history;
+            EXPECT_FALSE(history.Query(1));
+            history.Record(2, microseconds(0), -60);
+            EXPECT_FALSE(history.Query(1));
+            EXPECT_TRUE(history.Query(2));
+        }
+
+        TEST(RssiHistoryTest, SummarizesTheWholeRing) {
+            RssiHistory history(Options(8));
+            const int16_t readings[] = { -70, -60, -80, -50, -65 };
+            for (size_t i = 0; i < 5; ++i) {
+                history.Record(7, milliseconds(100 * i), readings[i], i == 1 ? std::optional<int8_t>(-4) : std::nullopt);
+            }
+            auto stats = history.Query(7);
+            ASSERT_TRUE(stats);
+            EXPECT_EQ(stats->samples, 5u);
+            EXPECT_EQ(stats->totalSamples, 5u);
+            EXPECT_EQ(stats->first, microseconds(0));
+            EXPECT_EQ(stats->last, milliseconds(400));
+            EXPECT_EQ(stats->latest, -65);
+            EXPECT_EQ(stats->min, -80);
+            EXPECT_EQ(stats->max, -50);
+            EXPECT_FLOAT_EQ(stats->mean, -65.0f);
+            EXPECT_NEAR(stats->standardDeviation, std::sqrt(100.0f), 1e-4);
+            EXPECT_EQ(stats->p10, -80);
+            EXPECT_EQ(stats->median, -65);
+            EXPECT_EQ(stats->p90, -50);
+            EXPECT_FLOAT_EQ(stats->advertisementsPerSecond, 10.0f);
+            EXPECT_EQ(stats->txPower, -4);
+        }
+
+        TEST(RssiHistoryTest, WrapsAndKeepsTheNewestSamples) {
+            RssiHistory history(Options(4));
+            for (int i = 0; i < 10; ++i) history.Record(1, milliseconds(i), static_cast<int16_t>(-i));
+            auto stats = history.Query(1);
+            ASSERT_TRUE(stats);
+            EXPECT_EQ(stats->samples, 4u);
+            EXPECT_EQ(stats->totalSamples, 10u);
+            EXPECT_EQ(stats->first, milliseconds(6));
+            EXPECT_EQ(stats->min, -9);
+            EXPECT_EQ(stats->max, -6);
+            EXPECT_FLOAT_EQ(stats->mean, -7.5f);
+            EXPECT_FALSE(stats->txPower);
+        }
+
+        TEST(RssiHistoryTest, LimitsTheWindowBySamplesAndSpan) {
+            RssiHistory history(Options(64));
+            for (int i = 0; i < 40; ++i) history.Record(1, milliseconds(i * 10), static_cast<int16_t>(-40 - i));
+            auto stats = history.Query(1, { 5, microseconds(0) });
+            ASSERT_TRUE(stats);
+            EXPECT_EQ(stats->samples, 5u);
+            EXPECT_EQ(stats->max, -75);
+
+            // 95 ms before the newest sample at 390 ms reaches back to 300.
+            stats = history.Query(1, { 0, microseconds(95000) });
+            ASSERT_TRUE(stats);
+            EXPECT_EQ(stats->samples, 10u);
+            EXPECT_EQ(stats->first, milliseconds(300));
+
+            stats = history.Query(1, { 3, microseconds(95000) });
+            ASSERT_TRUE(stats);
+            EXPECT_EQ(stats->samples, 3u);
+        }
+
+        TEST(RssiHistoryTest, KalmanEstimateSettlesOnTheTrueLevel) {
+            RssiHistory history(Options(16));
+            std::mt19937 random(3);
+            std::normal_distribution<float> noise(0.0f, 4.0f);
+            for (int i = 0; i < 500; ++i) {
+                history.Record(1, milliseconds(i * 100), static_cast<int16_t>(std::lround(-70.0f + noise(random))));
+            }
+            auto stats = history.Query(1);
+            ASSERT_TRUE(stats);
+            EXPECT_NEAR(stats->kalman, -70.0f, 2.0f);
+            // The raw readings spread much wider than the estimate's error.
+            EXPECT_GT(stats->max - stats->min, 6);
+        }
+
+        TEST(RssiHistoryTest, OutOfOrderTimestampsAreClamped) {
+            RssiHistory history(Options(8));
+            history.Record(1, milliseconds(100), -50);
+            history.Record(1, milliseconds(50), -60);
+            auto stats = history.Query(1);
+            ASSERT_TRUE(stats);
+            EXPECT_EQ(stats->first, milliseconds(100));
+            EXPECT_EQ(stats->last, milliseconds(100));
+            EXPECT_FLOAT_EQ(stats->advertisementsPerSecond, 0.0f);
+        }
+
+        TEST(RssiHistoryTest, EvictsTheDeviceHeardFromLeastRecently) {
+            RssiHistoryOptions options = Options(4);
+            options.maxDevices = 2;
+            RssiHistory history(options);
+            history.Record(1, milliseconds(10), -50);
+            history.Record(2, milliseconds(5), -50);
+            history.Record(1, milliseconds(20), -50);
+            history.Record(3, milliseconds(30), -50);
+            EXPECT_TRUE(history.Query(1));
+            EXPECT_FALSE(history.Query(2));
+            EXPECT_TRUE(history.Query(3));
+            EXPECT_EQ(history.Query(3)->totalSamples, 1u);
+            EXPECT_EQ(history.stats().evictions, 1u);
+            EXPECT_EQ(history.size(), 2u);
+
+            history.Clear();
+            EXPECT_EQ(history.size(), 0u);
+            EXPECT_FALSE(history.Query(1));
+        }
+
+        TEST(RssiHistoryTest, ClampsReadingsAndOptions) {
+            RssiHistoryOptions options = Options(1000000);
+            options.maxDevices = 1;
+            RssiHistory history(options);
+            EXPECT_EQ(history.samples_per_device(), RssiHistory::kMaxSamplesPerDevice);
+            EXPECT_EQ(RssiHistory(Options(100)).samples_per_device(), 128u);
+            history.Record(1, microseconds(0), -300);
+            history.Record(1, microseconds(1), 300);
+            EXPECT_EQ(history.Query(1)->min, INT8_MIN);
+            EXPECT_EQ(history.Query(1)->max, INT8_MAX);
+        }
+
+        // Full rings of random readings, queried through windows that
+        // wrap; every kernel has to agree with the statistics spelled out.
+        TEST(RssiHistoryTest, AgreesWithReferenceAtEveryLevel) {
+            std::mt19937 random(21);
+            std::vector<int8_t> readings;
+            for (int i = 0; i < 5000; ++i) {
+                readings.push_back(static_cast<int8_t>(static_cast<int>(random() % 256) - 128));
+            }
+
+            for (SimdLevel level : kLevels) {
+                SCOPED_TRACE(SimdLevelName(level));
+                RssiHistory history(Options(4096, level));
+                for (size_t i = 0; i < readings.size(); ++i) history.Record(9, microseconds(i), readings[i]);
+                for (size_t window : { size_t{ 1 }, size_t{ 15 }, size_t{ 33 }, size_t{ 1000 }, size_t{ 4096 } }) {
+                    std::vector<int8_t> expected(readings.end() - static_cast<std::ptrdiff_t>(window), readings.end());
+                    int64_t sum = 0;
+                    int64_t squares = 0;
+                    for (int8_t value : expected) {
+                        sum += value;
+                        squares += value * value;
+                    }
+                    const double mean = static_cast<double>(sum) / static_cast<double>(window);
+                    std::sort(expected.begin(), expected.end());
+
+                    auto stats = history.Query(9, { window, microseconds(0) });
+                    ASSERT_TRUE(stats);
+                    ASSERT_EQ(stats->samples, window);
+                    EXPECT_EQ(stats->min, expected.front());
+                    EXPECT_EQ(stats->max, expected.back());
+                    EXPECT_NEAR(stats->mean, mean, 1e-3);
+                    EXPECT_NEAR(stats->standardDeviation,
+                                std::sqrt(std::max(static_cast<double>(squares) / static_cast<double>(window) -
+                                                   mean * mean, 0.0)),
+                                1e-2);
+                    EXPECT_EQ(stats->median, expected[(window + 1) / 2 - 1]);
+                }
+            }
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
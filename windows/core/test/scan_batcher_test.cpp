@@ -0,0 +1,117 @@
+#include "scan_batcher.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        using std::chrono::milliseconds;
+
+        ScanResult Result(uint64_t address, int16_t rssi) {
+            ScanResult result;
+            result.address = address;
+            result.rssi = rssi;
+            return result;
+        }
+
+        TEST(ScanBatcherTest, FlushesOnSizeOrInterval) {
+            ScanBatchOptions options;
+            options.flushInterval = milliseconds(100);
+            options.maxBatchSize = 3;
+            ScanBatcher batcher(options);
+
+            EXPECT_FALSE(batcher.FlushDue(milliseconds(500)));
+            EXPECT_FALSE(batcher.Push(Result(1, -50)));
+            EXPECT_TRUE(batcher.FlushDue(milliseconds(100)));
+            batcher.Flush(milliseconds(100));
+
+            EXPECT_FALSE(batcher.Push(Result(1, -50)));
+            EXPECT_FALSE(batcher.FlushDue(milliseconds(150)));
+            EXPECT_FALSE(batcher.Push(Result(2, -50)));
+            EXPECT_TRUE(batcher.Push(Result(3, -50)));
+            EXPECT_TRUE(batcher.FlushDue(milliseconds(150)));
+            EXPECT_EQ(batcher.Flush(milliseconds(150)).size(), 3u);
+            EXPECT_EQ(batcher.flushes(), 2u);
+        }
+
+        TEST(ScanBatcherTest, CoalescesByAddress) {
+            ScanBatchOptions options;
+            options.coalesce = true;
+            ScanBatcher batcher(options);
+            batcher.Push(Result(1, -60));
+            batcher.Push(Result(2, -70));
+            batcher.Push(Result(1, -40));
+            batcher.Push(Result(1, -55));
+
+            const auto& batch = batcher.Flush(milliseconds(0));
+
+            ASSERT_EQ(batch.size(), 2u);
+            EXPECT_EQ(batch[0].latest.address, 1u);
+            EXPECT_EQ(batch[0].latest.rssi, -55);
+            EXPECT_EQ(batch[0].rssiMin, -60);
+            EXPECT_EQ(batch[0].rssiMax, -40);
+            EXPECT_EQ(batch[0].count, 3u);
+            EXPECT_EQ(batch[1].count, 1u);
+        }
+
+        TEST(ScanBatcherTest, DropsWhenFull) {
+            ScanBatcher batcher(ScanBatchOptions(), 4);
+            for (int i = 0; i < 6; ++i) batcher.Push(Result(static_cast<uint64_t>(i), -50));
+
+            EXPECT_EQ(batcher.dropped(), 2u);
+            EXPECT_EQ(batcher.Flush(milliseconds(0)).size(), 4u);
+        }
+
+        TEST(ScanBatcherTest, EventKeepsAdvertisementData) {
+            const std::vector<uint8_t> ad = {0x05, 0x09, 'a', 'b', 'c', 'd', 0x04, 0xFF, 0x4C, 0x00, 0x07};
+            ScanResult result = Result(1, -50);
+            result.advertisementData = ad;
+            ScanBatcher batcher;
+            batcher.Push(result);
+
+            ScanResult view = batcher.Flush(milliseconds(0))[0].latest.View();
+
+            EXPECT_EQ(view.localName, "abcd");
+            ASSERT_EQ(view.manufacturerData.size(), 1u);
+            EXPECT_EQ(view.manufacturerData[0].companyId, 0x004C);
+            EXPECT_EQ(view.manufacturerData[0].data.ToVector(), (std::vector<uint8_t>{0x07}));
+        }
+
+        TEST(ScanBatcherTest, OversizedAdvertisementIsCutAtAStructureBoundary) {
+            std::vector<uint8_t> ad;
+            for (int i = 0; i < 30; ++i) {
+                ad.insert(ad.end(), {0x09, 0xFF, 0x4C, 0x00, 1, 2, 3, 4, 5, 6});
+            }
+            ScanEvent event;
+            ScanResult result;
+            result.advertisementData = ad;
+            event.Assign(result);
+
+            EXPECT_TRUE(event.truncated);
+            EXPECT_EQ(event.advertisementDataSize, 250u);
+        }
+
+        TEST(ScanBatcherTest, ProducerAndConsumerOnSeparateThreads) {
+            constexpr uint64_t kCount = 100000;
+            ScanBatcher batcher(ScanBatchOptions(), 256);
+            std::thread producer([&batcher] {
+                for (uint64_t i = 0; i < kCount; ++i) {
+                    while (batcher.pending() == 256) std::this_thread::yield();
+                    batcher.Push(Result(i, -50));
+                }
+            });
+            uint64_t expected = 0;
+            while (expected < kCount) {
+                for (const auto& entry : batcher.Flush(milliseconds(0))) {
+                    ASSERT_EQ(entry.latest.address, expected);
+                    ++expected;
+                }
+            }
+            producer.join();
+            EXPECT_EQ(batcher.dropped(), 0u);
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,241 @@
+#include "scan_capture.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+#include "simulated_radio.h"
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        using std::chrono::milliseconds;
+
+        class ScanCaptureTest : public ::testing::Test {
+        protected:
+            void SetUp() override {
+                const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+                path_ = std::filesystem::temp_directory_path() /
+                    (std::string("flutter_ble_peripheral_") + info->name() + ".blec");
+            }
+
+            void TearDown() override {
+                std::error_code error;
+                std::filesystem::remove(path_, error);
+            }
+
+            std::string path() const { return path_.u8string(); }
+
+            std::vector<uint8_t> ReadFile() const {
+                std::ifstream file(path_, std::ios::binary);
+                return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            }
+
+            // Captures |duration| of a simulated room into path(). Returns the
+            // captured advertisements.
+            std::vector<ScanEvent> Capture(const SimulatedRadioOptions& room, milliseconds duration,
+                                           bool delta_compressed) {
+                ScanCaptureOptions options;
+                options.deltaCompressed = delta_compressed;
+                // Room for the whole capture, so nothing is dropped.
+                options.bufferSize = 16 << 20;
+                auto writer = ScanCaptureWriter::Open(path(), options);
+                EXPECT_TRUE(writer);
+                if (!writer) return {};
+
+                VirtualClock clock;
+                SimulatedRadio radio(clock, room);
+                radio.StartScan(ScanSettings());
+                std::vector<ScanEvent> events;
+                radio.RunUntil(duration, [&](const ScanResult& result) {
+                    EXPECT_TRUE(writer->Append(result));
+                    events.emplace_back();
+                    events.back().Assign(result);
+                });
+                writer->Close();
+                EXPECT_FALSE(writer->Append(events.front().View()));
+
+                const auto stats = writer->stats();
+                EXPECT_EQ(stats.records, events.size());
+                EXPECT_EQ(stats.dropped, 0u);
+                EXPECT_FALSE(stats.failed);
+                EXPECT_EQ(stats.bytes, std::filesystem::file_size(path_));
+                return events;
+            }
+
+            static void ExpectSameEvent(const ScanEvent& actual, const ScanEvent& expected) {
+                EXPECT_EQ(actual.address, expected.address);
+                EXPECT_EQ(actual.rssi, expected.rssi);
+                EXPECT_EQ(actual.flags, expected.flags);
+                EXPECT_EQ(actual.timestamp, expected.timestamp);
+                EXPECT_EQ(actual.advertisement_data(), expected.advertisement_data());
+            }
+
+            std::filesystem::path path_;
+        };
+
+        TEST_F(ScanCaptureTest, RoundTripsPlainAndDeltaCaptures) {
+            SimulatedRadioOptions room;
+            room.rssiModel = RssiModel::kWalking;
+            uintmax_t sizes[2] = {};
+            for (bool delta : { false, true }) {
+                const auto expected = Capture(room, milliseconds(1000), delta);
+                ASSERT_GT(expected.size(), 9000u);
+                sizes[delta] = std::filesystem::file_size(path_);
+
+                auto reader = ScanCaptureReader::Open(path());
+                ASSERT_TRUE(reader);
+                EXPECT_EQ(reader->delta_compressed(), delta);
+                ScanEvent event;
+                for (const auto& want : expected) {
+                    ASSERT_TRUE(reader->Next(event));
+                    ExpectSameEvent(event, want);
+                }
+                EXPECT_FALSE(reader->Next(event));
+                EXPECT_FALSE(reader->truncated());
+
+                reader->Rewind();
+                ASSERT_TRUE(reader->Next(event));
+                ExpectSameEvent(event, expected.front());
+            }
+            // Repeated payloads and small timestamp steps from a stable room.
+            EXPECT_LT(sizes[true] * 4, sizes[false]);
+        }
+
+        TEST_F(ScanCaptureTest, IndexesOnlyTheFirstDevices) {
+            SimulatedRadioOptions room;
+            room.advertisers = kScanCaptureMaxDevices + 1000;
+            room.advertisementsPerSecond = 50000;
+            const auto expected = Capture(room, milliseconds(400), true);
+
+            auto reader = ScanCaptureReader::Open(path());
+            ASSERT_TRUE(reader);
+            ScanEvent event;
+            for (const auto& want : expected) {
+                ASSERT_TRUE(reader->Next(event));
+                ExpectSameEvent(event, want);
+            }
+            EXPECT_FALSE(reader->Next(event));
+        }
+
+        TEST_F(ScanCaptureTest, StopsAtATornRecord) {
+            const auto expected = Capture(SimulatedRadioOptions(), milliseconds(100), true);
+            auto bytes = ReadFile();
+            bytes.resize(bytes.size() - 3);
+
+            ScanCaptureReader reader{ ByteView(bytes) };
+            ASSERT_TRUE(reader.valid());
+            ScanEvent event;
+            size_t count = 0;
+            while (reader.Next(event)) ++count;
+            EXPECT_EQ(count, expected.size() - 1);
+            EXPECT_TRUE(reader.truncated());
+        }
+
+        TEST_F(ScanCaptureTest, RejectsOtherFiles) {
+            EXPECT_FALSE(ScanCaptureReader::Open(path()));
+            {
+                std::ofstream file(path_, std::ios::binary);
+                file << "BLEC";
+            }
+            EXPECT_FALSE(ScanCaptureReader::Open(path()));
+
+            const std::vector<uint8_t> other_version = { 'B', 'L', 'E', 'C', kScanCaptureVersion + 1, 0, 0, 0 };
+            EXPECT_FALSE(ScanCaptureReader(ByteView(other_version)).valid());
+            EXPECT_FALSE(ScanCaptureWriter::Open((path_ / "missing" / "capture.blec").u8string()));
+        }
+
+        TEST_F(ScanCaptureTest, DropsRatherThanWaits) {
+            ScanCaptureOptions options;
+            options.bufferSize = 4096;
+            auto writer = ScanCaptureWriter::Open(path(), options);
+            ASSERT_TRUE(writer);
+
+            VirtualClock clock;
+            SimulatedRadio radio(clock, SimulatedRadioOptions());
+            radio.StartScan(ScanSettings());
+            uint64_t appended = 0;
+            radio.RunUntil(milliseconds(2000), [&](const ScanResult& result) {
+                appended += writer->Append(result);
+            });
+            writer->Close();
+
+            // However the writer thread kept up, every record is either in
+            // the file or counted as dropped.
+            const auto stats = writer->stats();
+            EXPECT_EQ(stats.records, appended);
+            EXPECT_EQ(stats.records + stats.dropped, radio.generated());
+            auto reader = ScanCaptureReader::Open(path());
+            ASSERT_TRUE(reader);
+            ScanEvent event;
+            uint64_t count = 0;
+            while (reader->Next(event)) ++count;
+            EXPECT_EQ(count, stats.records);
+            EXPECT_FALSE(reader->truncated());
+        }
+
+        TEST_F(ScanCaptureTest, ReplaysAtTheRecordedPace) {
+            const auto expected = Capture(SimulatedRadioOptions(), milliseconds(300), true);
+            auto reader = ScanCaptureReader::Open(path());
+            ASSERT_TRUE(reader);
+
+            VirtualClock clock;
+            clock.Set(std::chrono::seconds(7));
+            ScanReplay replay(*reader, clock, ReplaySpeed::kRecorded);
+            size_t index = 0;
+            const auto deliver = [&](const ScanResult& result) {
+                ASSERT_LT(index, expected.size());
+                EXPECT_EQ(result.timestamp, expected[index].timestamp);
+                // On time to the nanosecond, as the clock jumps to each due time.
+                const auto offset = result.timestamp - expected.front().timestamp;
+                EXPECT_EQ(clock.Now() - std::chrono::seconds(7), offset);
+                ++index;
+            };
+            while (auto next = replay.Pump(deliver)) {
+                EXPECT_GT(*next, clock.Now());
+                clock.Set(*next);
+            }
+            EXPECT_EQ(index, expected.size());
+            EXPECT_EQ(replay.delivered(), expected.size());
+            EXPECT_TRUE(replay.done());
+        }
+
+        TEST_F(ScanCaptureTest, ReplaysAtMaximumSpeedInBoundedPumps) {
+            const auto expected = Capture(SimulatedRadioOptions(), milliseconds(300), false);
+            auto reader = ScanCaptureReader::Open(path());
+            ASSERT_TRUE(reader);
+
+            VirtualClock clock;
+            ScanReplay replay(*reader, clock, ReplaySpeed::kMaximum);
+            size_t pumps = 0;
+            while (auto next = replay.Pump([](const ScanResult&) {}, 100)) {
+                EXPECT_EQ(*next, clock.Now());
+                EXPECT_EQ(replay.delivered(), ++pumps * 100);
+            }
+            EXPECT_EQ(replay.delivered(), expected.size());
+        }
+
+        TEST_F(ScanCaptureTest, ReplaysInTheBackground) {
+            const auto expected = Capture(SimulatedRadioOptions(), milliseconds(300), true);
+            auto reader = ScanCaptureReader::Open(path());
+            ASSERT_TRUE(reader);
+
+            std::atomic<uint64_t> received{ 0 };
+            BackgroundScanReplay replay(std::move(reader), ReplaySpeed::kMaximum,
+                                        [&](const ScanResult&) { received.fetch_add(1); });
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            while (!replay.finished() && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(milliseconds(1));
+            }
+            replay.Stop();
+            EXPECT_TRUE(replay.finished());
+            EXPECT_EQ(replay.delivered(), expected.size());
+            EXPECT_EQ(received.load(), expected.size());
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
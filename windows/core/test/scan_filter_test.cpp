@@ -0,0 +1,176 @@
+#include "scan_filter.h"
+
+#include <gtest/gtest.h>
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        BluetoothUuid Uuid(const char* text) { return *ParseBluetoothUuid(text); }
+
+        // Appends one AD structure to |out|.
+        void Ad(std::vector<uint8_t>& out, uint8_t type, std::vector<uint8_t> body) {
+            out.push_back(static_cast<uint8_t>(body.size() + 1));
+            out.push_back(type);
+            out.insert(out.end(), body.begin(), body.end());
+        }
+
+        std::vector<uint8_t> Beacon() {
+            std::vector<uint8_t> data;
+            Ad(data, kAdFlags, { 0x06 });
+            Ad(data, kAdCompleteUuid16List, { 0x0D, 0x18, 0x0F, 0x18 });
+            Ad(data, kAdManufacturerSpecificData, { 0x4C, 0x00, 0x02, 0x15, 0xAA, 0xBB });
+            Ad(data, kAdCompleteLocalName, { 'T', 'a', 'g', '-', '7' });
+            return data;
+        }
+
+        ScanFilter Compile(const ScanFilterSpec& spec) {
+            auto filter = ScanFilter::Compile(spec);
+            EXPECT_TRUE(filter);
+            return filter ? *filter : ScanFilter();
+        }
+
+        TEST(ScanFilterTest, EmptySpecPassesEverything) {
+            ScanFilter filter = Compile({});
+            EXPECT_TRUE(filter.passes_all());
+            EXPECT_TRUE(filter.Matches(-127, ByteView()));
+        }
+
+        TEST(ScanFilterTest, RssiThreshold) {
+            ScanFilterSpec spec;
+            spec.minRssi = -70;
+            ScanFilter filter = Compile(spec);
+            EXPECT_TRUE(filter.Matches(-70, Beacon()));
+            EXPECT_FALSE(filter.Matches(-71, Beacon()));
+        }
+
+        TEST(ScanFilterTest, CompanyIds) {
+            ScanFilterSpec spec;
+            spec.companyIds = { 0x0006, 0x004C };
+            EXPECT_TRUE(Compile(spec).Matches(-50, Beacon()));
+            spec.companyIds = { 0x0006 };
+            EXPECT_FALSE(Compile(spec).Matches(-50, Beacon()));
+        }
+
+        TEST(ScanFilterTest, ServiceUuidsOfEverySize) {
+            ScanFilterSpec spec;
+            spec.serviceUuids = { Uuid("180F") };
+            EXPECT_TRUE(Compile(spec).Matches(-50, Beacon()));
+            spec.serviceUuids = { Uuid("1810") };
+            EXPECT_FALSE(Compile(spec).Matches(-50, Beacon()));
+
+            const auto wide = Uuid("8ebdb2f3-7817-45c9-95c5-c5e9031aaa47");
+            std::vector<uint8_t> data;
+            Ad(data, kAdIncompleteUuid128List, std::vector<uint8_t>(wide.bytes.begin(), wide.bytes.end()));
+            Ad(data, kAdCompleteUuid32List, { 0x01, 0x02, 0x03, 0x04 });
+            spec.serviceUuids = { wide };
+            EXPECT_TRUE(Compile(spec).Matches(-50, data));
+            spec.serviceUuids = { Uuid("04030201") };
+            EXPECT_TRUE(Compile(spec).Matches(-50, data));
+        }
+
+        TEST(ScanFilterTest, BaseUuidsMatchAcrossWidths) {
+            ScanFilterSpec spec;
+            for (const char* text : { "180D", "0000180D", "0000180d-0000-1000-8000-00805f9b34fb" }) {
+                SCOPED_TRACE(text);
+                spec.serviceUuids = { Uuid(text) };
+                EXPECT_TRUE(Compile(spec).Matches(-50, Beacon()));
+            }
+
+            // A spec built without the parser is shortened as well.
+            BluetoothUuid wide;
+            wide.size = 16;
+            wide.bytes = { 0xFB, 0x34, 0x9B, 0x5F, 0x80, 0x00, 0x00, 0x80,
+                           0x00, 0x10, 0x00, 0x00, 0x0F, 0x18, 0x00, 0x00 };
+            spec.serviceUuids = { wide };
+            EXPECT_TRUE(Compile(spec).Matches(-50, Beacon()));
+
+            // So are advertised 32- and 128-bit forms of a 16-bit UUID.
+            spec.serviceUuids = { Uuid("180F") };
+            std::vector<uint8_t> thirty_two;
+            Ad(thirty_two, kAdCompleteUuid32List, { 0x0F, 0x18, 0x00, 0x00 });
+            EXPECT_TRUE(Compile(spec).Matches(-50, thirty_two));
+            std::vector<uint8_t> full;
+            Ad(full, kAdCompleteUuid128List, std::vector<uint8_t>(wide.bytes.begin(), wide.bytes.end()));
+            EXPECT_TRUE(Compile(spec).Matches(-50, full));
+            spec.serviceUuids = { Uuid("1810") };
+            EXPECT_FALSE(Compile(spec).Matches(-50, thirty_two));
+            EXPECT_FALSE(Compile(spec).Matches(-50, full));
+        }
+
+        TEST(ScanFilterTest, ManufacturerPrefixUnderMask) {
+            ScanFilterSpec spec;
+            spec.manufacturerData = { { 0x004C, { 0x02, 0x15, 0xA0 }, { 0xFF, 0xFF, 0xF0 } } };
+            EXPECT_TRUE(Compile(spec).Matches(-50, Beacon()));
+            spec.manufacturerData[0].mask = { 0xFF, 0xFF, 0xFF };
+            EXPECT_FALSE(Compile(spec).Matches(-50, Beacon()));
+            // Any pattern for the company may match.
+            spec.manufacturerData.push_back({ 0x004C, { 0x02 }, {} });
+            EXPECT_TRUE(Compile(spec).Matches(-50, Beacon()));
+            // Longer than the data never matches.
+            spec.manufacturerData = { { 0x004C, std::vector<uint8_t>(5, 0), std::vector<uint8_t>(5, 0) } };
+            EXPECT_FALSE(Compile(spec).Matches(-50, Beacon()));
+        }
+
+        TEST(ScanFilterTest, NamePrefixes) {
+            ScanFilterSpec spec;
+            spec.namePrefixes = { "Lamp", "Tag-" };
+            EXPECT_TRUE(Compile(spec).Matches(-50, Beacon()));
+            spec.namePrefixes = { "Tag-77" };
+            EXPECT_FALSE(Compile(spec).Matches(-50, Beacon()));
+        }
+
+        TEST(ScanFilterTest, CriteriaAreAnded) {
+            ScanFilterSpec spec;
+            spec.companyIds = { 0x004C };
+            spec.namePrefixes = { "Tag" };
+            spec.minRssi = -80;
+            EXPECT_TRUE(Compile(spec).Matches(-50, Beacon()));
+            spec.serviceUuids = { Uuid("1810") };
+            EXPECT_FALSE(Compile(spec).Matches(-50, Beacon()));
+        }
+
+        TEST(ScanFilterTest, StopsAtMalformedStructures) {
+            ScanFilterSpec spec;
+            spec.namePrefixes = { "Tag" };
+            auto data = Beacon();
+            // The manufacturer structure claims to run past the end.
+            data[9] = 40;
+            EXPECT_FALSE(Compile(spec).Matches(-50, data));
+            EXPECT_FALSE(Compile(spec).Matches(-50, std::vector<uint8_t>{ 0x00, 0x09, 'T' }));
+        }
+
+        TEST(ScanFilterTest, RejectsInvalidSpecs) {
+            ScanFilterSpec spec;
+            spec.manufacturerData = { { 1, { 1, 2 }, { 0xFF } } };
+            EXPECT_FALSE(ScanFilter::Compile(spec));
+            spec.manufacturerData = { { 1, std::vector<uint8_t>(300), {} } };
+            EXPECT_FALSE(ScanFilter::Compile(spec));
+        }
+
+        TEST(ScanFilterTest, PushesDownSingleEntryCriteria) {
+            ScanFilterSpec spec;
+            EXPECT_TRUE(PushDownScanFilter(spec).empty());
+
+            spec.minRssi = -60;
+            spec.serviceUuids = { Uuid("180F") };
+            spec.companyIds = { 0x004C };
+            auto push_down = PushDownScanFilter(spec);
+            EXPECT_EQ(push_down.minRssi, -60);
+            ASSERT_TRUE(push_down.serviceUuid);
+            EXPECT_EQ(*push_down.serviceUuid, Uuid("180F"));
+            EXPECT_EQ(push_down.manufacturerPattern, (std::vector<uint8_t>{ 0x4C, 0x00 }));
+
+            // Only the exactly-masked head of a pattern goes down.
+            spec.manufacturerData = { { 0x004C, { 0x02, 0x15, 0xA0, 0x01 }, { 0xFF, 0xFF, 0xF0, 0xFF } } };
+            EXPECT_EQ(PushDownScanFilter(spec).manufacturerPattern, (std::vector<uint8_t>{ 0x4C, 0x00, 0x02, 0x15 }));
+
+            // Lists of two would be ANDed by the watcher.
+            spec.serviceUuids.push_back(Uuid("1810"));
+            spec.manufacturerData.push_back({ 0x0006, {}, {} });
+            push_down = PushDownScanFilter(spec);
+            EXPECT_FALSE(push_down.serviceUuid);
+            EXPECT_TRUE(push_down.manufacturerPattern.empty());
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
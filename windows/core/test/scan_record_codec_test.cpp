@@ -0,0 +1,77 @@
+#include "scan_record_codec.h"
+
+#include <gtest/gtest.h>
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        TEST(ScanRecordCodecTest, RoundTripsRecords) {
+            // Flags AD structure followed by a manufacturer specific one.
+            const std::vector<uint8_t> ad = {0x02, 0x01, 0x06, 0x04, 0xFF, 0x4C, 0x00, 0x01};
+            ScanResult first;
+            first.address = 0xA1B2C3D4E5F6;
+            first.rssi = -67;
+            first.flags = kConnectable | kScannable;
+            first.timestamp = std::chrono::microseconds(1700000000123456);
+            first.advertisementData = ad;
+            ScanResult second;
+            second.address = 1;
+            second.rssi = -300;  // Clamped to the i8 range.
+
+            ScanRecordWriter writer;
+            ASSERT_TRUE(writer.Append(first));
+            ASSERT_TRUE(writer.Append(second));
+            EXPECT_EQ(writer.count(), 2u);
+            EXPECT_EQ(writer.data().size(),
+                      kScanRecordMessageHeaderSize + 2 * kScanRecordHeaderSize + ad.size());
+
+            ScanRecordReader reader(writer.data());
+            ASSERT_TRUE(reader.valid());
+            EXPECT_EQ(reader.count(), 2u);
+
+            ScanRecordView record;
+            ASSERT_TRUE(reader.Next(record));
+            EXPECT_EQ(record.address, first.address);
+            EXPECT_EQ(record.rssi, -67);
+            EXPECT_EQ(record.flags, kConnectable | kScannable);
+            EXPECT_EQ(record.timestamp, first.timestamp);
+            EXPECT_EQ(record.advertisementData.ToVector(), ad);
+
+            ASSERT_TRUE(reader.Next(record));
+            EXPECT_EQ(record.address, 1u);
+            EXPECT_EQ(record.rssi, -128);
+            EXPECT_TRUE(record.advertisementData.empty());
+
+            EXPECT_FALSE(reader.Next(record));
+        }
+
+        TEST(ScanRecordCodecTest, ResetReusesTheBuffer) {
+            ScanRecordWriter writer;
+            ScanResult result;
+            writer.Append(result);
+            const uint8_t* storage = writer.data().data();
+
+            writer.Reset();
+            EXPECT_TRUE(writer.empty());
+            EXPECT_EQ(writer.data().size(), kScanRecordMessageHeaderSize);
+            writer.Append(result);
+            EXPECT_EQ(writer.data().data(), storage);
+        }
+
+        TEST(ScanRecordCodecTest, RejectsTruncatedMessages) {
+            ScanRecordWriter writer;
+            ScanResult result;
+            writer.Append(result);
+            auto bytes = writer.data().ToVector();
+
+            ScanRecordReader truncated(ByteView(bytes.data(), bytes.size() - 1));
+            ScanRecordView record;
+            EXPECT_TRUE(truncated.valid());
+            EXPECT_FALSE(truncated.Next(record));
+
+            bytes[0] = kScanRecordVersion + 1;
+            EXPECT_FALSE(ScanRecordReader(bytes).valid());
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
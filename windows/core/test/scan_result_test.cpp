@@ -0,0 +1,132 @@
+#include "scan_result.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        TEST(ScanResultTest, DeviceNameFallsBackToHexAddress) {
+            ScanResult result;
+            result.address = 0xA1B2C3D4E5F6;
+            EXPECT_EQ(DeviceName(result), "a1b2c3d4e5f6");
+
+            result.localName = "beacon";
+            EXPECT_EQ(DeviceName(result), "beacon");
+        }
+
+        TEST(ScanResultTest, AddressIsDecimal) {
+            EXPECT_EQ(AddressString(0), "0");
+            EXPECT_EQ(AddressString(0xA1B2C3D4E5F6), "177789161760246");
+        }
+
+        TEST(ScanResultTest, ParsesDecimalAddresses) {
+            EXPECT_EQ(ParseAddressString("177789161760246"), 0xA1B2C3D4E5F6u);
+            EXPECT_EQ(ParseAddressString(AddressString(0xFFFFFFFFFFFF)), 0xFFFFFFFFFFFFu);
+            EXPECT_FALSE(ParseAddressString(""));
+            EXPECT_FALSE(ParseAddressString("-1"));
+            EXPECT_FALSE(ParseAddressString("12ab"));
+            EXPECT_FALSE(ParseAddressString(AddressString(1ull << 48)));
+        }
+
+        TEST(ScanResultTest, ManufacturerDataHasLittleEndianCompanyPrefix) {
+            ScanResult result;
+            EXPECT_TRUE(ManufacturerSpecificData(result).empty());
+
+            const std::vector<uint8_t> first = {0x02, 0x15};
+            const std::vector<uint8_t> second = {0xFF};
+            result.manufacturerData.push_back({0x004C, first});
+            result.manufacturerData.push_back({0x0006, second});
+            EXPECT_EQ(ManufacturerSpecificData(result),
+                      (std::vector<uint8_t>{0x4C, 0x00, 0x02, 0x15}));
+        }
+
+        // A local name, a manufacturer record and TX power.
+        const std::vector<uint8_t> kAdvertisement = {
+            0x03, kAdCompleteLocalName, 'h', 'i',
+            0x05, kAdManufacturerSpecificData, 0x4C, 0x00, 0x02, 0x15,
+            0x02, kAdTxPowerLevel, 0xF4,
+        };
+
+        bool Within(ByteView view, const ScanEvent& event) {
+            return view.data() >= event.advertisementData.data() &&
+                view.data() + view.size() <= event.advertisementData.data() + event.advertisementDataSize;
+        }
+
+        TEST(ScanEventTest, CarriesTheProducersParsedFields) {
+            AdvertisementFields parsed;
+            ParseAdvertisement(kAdvertisement, parsed);
+            ScanResult result;
+            result.advertisementData = kAdvertisement;
+            result.fields = &parsed;
+
+            ScanEvent event;
+            event.Assign(result);
+            EXPECT_EQ(event.fields.txPowerLevel, -12);
+            ASSERT_EQ(event.fields.manufacturerData.size(), 1u);
+            EXPECT_TRUE(Within(event.fields.manufacturerData[0].data, event));
+            EXPECT_TRUE(Within(event.fields.localName, event));
+
+            const auto view = event.View();
+            EXPECT_EQ(view.fields, &event.fields);
+            EXPECT_EQ(view.localName, "hi");
+            ASSERT_EQ(view.manufacturerData.size(), 1u);
+            EXPECT_EQ(view.manufacturerData[0].companyId, 0x004C);
+        }
+
+        TEST(ScanEventTest, CopiesPointAtTheirOwnBytes) {
+            ScanResult result;
+            result.advertisementData = kAdvertisement;
+            auto event = std::make_unique<ScanEvent>();
+            event->Assign(result);
+            EXPECT_EQ(event->fields.localName, ByteView(kAdvertisement).subview(2, 2));
+
+            ScanEvent copy(*event);
+            ScanEvent assigned;
+            assigned = *event;
+            event.reset();
+            for (const ScanEvent* other : { &copy, &assigned }) {
+                EXPECT_TRUE(Within(other->fields.localName, *other));
+                EXPECT_EQ(other->View().localName, "hi");
+                ASSERT_EQ(other->fields.manufacturerData.size(), 1u);
+                EXPECT_EQ(other->fields.manufacturerData[0].data, ByteView(kAdvertisement).subview(8, 2));
+            }
+        }
+
+        TEST(ScanEventTest, ParsesAgainAfterACut) {
+            // A name past the cut must not be carried over.
+            std::vector<uint8_t> bytes(250, 0);
+            for (size_t i = 0; i < bytes.size(); i += 10) {
+                bytes[i] = 9;
+                bytes[i + 1] = 0xFF;
+            }
+            bytes.insert(bytes.end(), { 0x06, kAdCompleteLocalName, 'l', 'o', 'n', 'g', '!' });
+            AdvertisementFields parsed;
+            ParseAdvertisement(bytes, parsed);
+            ASSERT_FALSE(parsed.localName.empty());
+
+            ScanResult result;
+            result.advertisementData = bytes;
+            result.fields = &parsed;
+            ScanEvent event;
+            event.Assign(result);
+            EXPECT_TRUE(event.truncated);
+            EXPECT_EQ(event.advertisementDataSize, 250u);
+            EXPECT_TRUE(event.fields.localName.empty());
+        }
+
+        TEST(ScanResultTest, ParsedFieldsPrefersCarriedFields) {
+            AdvertisementFields carried;
+            carried.txPowerLevel = 3;
+            ScanResult result;
+            result.advertisementData = kAdvertisement;
+            AdvertisementFields scratch;
+            EXPECT_EQ(ParsedFields(result, scratch).txPowerLevel, -12);
+            result.fields = &carried;
+            EXPECT_EQ(&ParsedFields(result, scratch), &carried);
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,129 @@
+#include "scan_session.h"
+
+#include <gtest/gtest.h>
+
+#include "mock_radio_backend.h"
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        using std::chrono::milliseconds;
+
+        ScanSettings Settings(ScanMode mode, milliseconds interval, milliseconds window) {
+            ScanSettings settings;
+            settings.mode = mode;
+            settings.interval = interval;
+            settings.window = window;
+            return settings;
+        }
+
+        class ScanSessionTest : public ::testing::Test {
+        protected:
+            // Runs the session the way the plugin's timer does, until |end|.
+            void RunUntil(milliseconds end) {
+                while (true) {
+                    auto wakeup = session.Tick();
+                    if (!wakeup || *wakeup > end) break;
+                    clock.Set(*wakeup);
+                }
+                clock.Set(end);
+                session.Tick();
+            }
+
+            MockRadioBackend backend;
+            VirtualClock clock;
+            ScanSession session{ backend, clock };
+        };
+
+        TEST_F(ScanSessionTest, ContinuousScanStartsTheBackendOnce) {
+            ASSERT_TRUE(session.Start(Settings(ScanMode::kActive, milliseconds(100), milliseconds(100))));
+            EXPECT_TRUE(backend.scanning);
+            EXPECT_EQ(backend.last_scan.mode, ScanMode::kActive);
+            EXPECT_FALSE(session.NextWakeup());
+
+            for (int i = 0; i < 50; ++i) session.OnAdvertisement();
+            RunUntil(milliseconds(10000));
+            auto stats = session.stats();
+            EXPECT_TRUE(stats.active);
+            EXPECT_EQ(stats.elapsed, milliseconds(10000));
+            EXPECT_DOUBLE_EQ(stats.dutyCycle, 1.0);
+            EXPECT_DOUBLE_EQ(stats.advertisementsPerSecond, 5.0);
+            EXPECT_EQ(stats.windows, 1u);
+            EXPECT_EQ(backend.scan_start_count, 1);
+
+            session.Stop();
+            EXPECT_FALSE(backend.scanning);
+            EXPECT_FALSE(session.active());
+        }
+
+        TEST_F(ScanSessionTest, ShortWindowCyclesTheBackend) {
+            // Android's SCAN_MODE_LOW_POWER: 512 ms out of every 5120 ms.
+            ASSERT_TRUE(session.Start(Settings(ScanMode::kPassive, milliseconds(5120), milliseconds(512))));
+            EXPECT_EQ(session.NextWakeup(), milliseconds(512));
+            RunUntil(milliseconds(600));
+            EXPECT_FALSE(backend.scanning);
+            EXPECT_EQ(session.NextWakeup(), milliseconds(5120));
+
+            RunUntil(milliseconds(51000));
+            session.Stop();
+            auto stats = session.stats();
+            EXPECT_FALSE(stats.active);
+            EXPECT_EQ(stats.windows, 10u);
+            EXPECT_EQ(stats.scanning, milliseconds(5120));
+            EXPECT_NEAR(stats.dutyCycle, 0.1, 1e-3);
+            EXPECT_EQ(backend.scan_start_count, 10);
+            EXPECT_EQ(backend.scan_stop_count, 10);
+        }
+
+        TEST_F(ScanSessionTest, LateTimerSkipsMissedWindows) {
+            ASSERT_TRUE(session.Start(Settings(ScanMode::kPassive, milliseconds(1000), milliseconds(100))));
+            clock.Set(milliseconds(100));
+            session.Tick();
+            // The next timer fires well into the fourth interval's off time.
+            clock.Set(milliseconds(3500));
+            EXPECT_EQ(session.Tick(), milliseconds(4000));
+            EXPECT_FALSE(backend.scanning);
+            // Inside a window it opens for what is left of it.
+            clock.Set(milliseconds(4050));
+            EXPECT_EQ(session.Tick(), milliseconds(4100));
+            EXPECT_TRUE(backend.scanning);
+            clock.Set(milliseconds(4100));
+            session.Tick();
+            EXPECT_EQ(session.stats().scanning, milliseconds(150));
+            EXPECT_EQ(session.stats().windows, 2u);
+        }
+
+        TEST_F(ScanSessionTest, RefusedStartLeavesTheSessionStopped) {
+            backend.accept_scan = false;
+            EXPECT_FALSE(session.Start(ScanSettings()));
+            EXPECT_FALSE(session.active());
+            EXPECT_FALSE(session.Tick());
+            EXPECT_EQ(session.stats().refusedWindows, 1u);
+
+            // A refused window later on is retried at the next interval.
+            backend.accept_scan = true;
+            ASSERT_TRUE(session.Start(Settings(ScanMode::kPassive, milliseconds(100), milliseconds(50))));
+            backend.accept_scan = false;
+            RunUntil(milliseconds(150));
+            EXPECT_FALSE(backend.scanning);
+            backend.accept_scan = true;
+            RunUntil(milliseconds(210));
+            EXPECT_TRUE(backend.scanning);
+            EXPECT_EQ(session.stats().refusedWindows, 1u);
+        }
+
+        TEST_F(ScanSessionTest, RestartResetsTheStats) {
+            ASSERT_TRUE(session.Start(ScanSettings()));
+            session.OnAdvertisement();
+            clock.Set(milliseconds(500));
+            ASSERT_TRUE(session.Start(Settings(ScanMode::kActive, milliseconds(200), milliseconds(200))));
+            EXPECT_EQ(backend.scan_stop_count, 1);
+            EXPECT_EQ(backend.scan_start_count, 2);
+            auto stats = session.stats();
+            EXPECT_EQ(stats.advertisements, 0u);
+            EXPECT_EQ(stats.elapsed, milliseconds(0));
+            EXPECT_EQ(stats.settings.mode, ScanMode::kActive);
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
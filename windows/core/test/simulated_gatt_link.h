@@ -0,0 +1,75 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_TEST_SIMULATED_GATT_LINK_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_TEST_SIMULATED_GATT_LINK_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+#include "clock.h"
+#include "gatt_transport.h"
+
+namespace flutter_ble_peripheral {
+
+    // A GattTransport over a simulated connection, on a VirtualClock. Each
+    // value holds the link for its airtime plus a fixed per-packet gap
+    // (inter-frame spaces and the empty acknowledgement) and is reported sent
+    // |latency| after it has left. Shared by the tests and the benchmarks.
+    class SimulatedGattLink : public GattTransport {
+    public:
+        struct Completion {
+            std::chrono::nanoseconds at{ 0 };
+            GattClientId client = 0;
+            SharedBuffer value;
+        };
+
+        // Link-layer, L2CAP and ATT headers around each value, plus preamble,
+        // access address and CRC.
+        static constexpr size_t kPacketOverhead = 17;
+
+        explicit SimulatedGattLink(VirtualClock& clock) : clock_(clock) {}
+
+        bool PublishService(const GattService&) override { return true; }
+        void RemoveService(GattHandle) override {}
+
+        bool SendValue(GattClientId client, GattHandle, const SharedBuffer& value, bool) override {
+            if (completions_.size() >= queue_limit) return false;
+            const auto bits = static_cast<int64_t>((value.size() + kPacketOverhead) * 8);
+            const auto airtime = std::chrono::nanoseconds(bits * 1000000000 / bits_per_second);
+            busy_until_ = std::max(busy_until_, clock_.Now()) + airtime + packet_gap;
+            completions_.push_back({ busy_until_ + latency, client, value });
+            bytes_sent += value.size();
+            return true;
+        }
+
+        // Moves the clock to the next completion and hands it to
+        // |on_sent(client, value)|. Returns false if nothing is pending.
+        template <typename OnSent>
+        bool DeliverNext(OnSent&& on_sent) {
+            if (completions_.empty()) return false;
+            Completion completion = std::move(completions_.front());
+            completions_.pop_front();
+            if (completion.at > clock_.Now()) clock_.Set(completion.at);
+            on_sent(completion.client, completion.value);
+            return true;
+        }
+
+        size_t pending() const { return completions_.size(); }
+
+        int64_t bits_per_second = 1000000;
+        std::chrono::nanoseconds packet_gap = std::chrono::microseconds(380);
+        std::chrono::nanoseconds latency{ 0 };
+        // Values the controller buffers before SendValue pushes back.
+        size_t queue_limit = 16;
+        uint64_t bytes_sent = 0;
+
+    private:
+        VirtualClock& clock_;
+        std::chrono::nanoseconds busy_until_{ 0 };
+        std::deque<Completion> completions_;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_TEST_SIMULATED_GATT_LINK_H_
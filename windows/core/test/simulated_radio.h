@@ -0,0 +1,463 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_TEST_SIMULATED_RADIO_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_TEST_SIMULATED_RADIO_H_
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "ad_encoder.h"
+#include "clock.h"
+#include "peripheral_state.h"
+#include "radio_backend.h"
+#include "scan_result.h"
+
+namespace flutter_ble_peripheral {
+
+    // xoshiro256** seeded through splitmix64. Unlike the std distributions
+    // it produces the same sequence with every standard library.
+    class SimulationRandom {
+    public:
+        explicit SimulationRandom(uint64_t seed) {
+            for (auto& word : state_) {
+                seed += 0x9E3779B97F4A7C15ull;
+                uint64_t z = seed;
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+                word = z ^ (z >> 31);
+            }
+        }
+
+        uint64_t Next() {
+            const uint64_t result = Rotate(state_[1] * 5, 7) * 9;
+            const uint64_t t = state_[1] << 17;
+            state_[2] ^= state_[0];
+            state_[3] ^= state_[1];
+            state_[1] ^= state_[2];
+            state_[0] ^= state_[3];
+            state_[2] ^= t;
+            state_[3] = Rotate(state_[3], 45);
+            return result;
+        }
+
+        // Uniform in [0, bound), for bound > 0.
+        uint64_t Below(uint64_t bound) { return Next() % bound; }
+
+        // Uniform in [low, high].
+        int64_t Between(int64_t low, int64_t high) {
+            return low + static_cast<int64_t>(Below(static_cast<uint64_t>(high - low) + 1));
+        }
+
+        // Uniform in [0, 1).
+        double Unit() { return static_cast<double>(Next() >> 11) * 0x1.0p-53; }
+
+        // Roughly normal with mean 0 and standard deviation 1: the scaled
+        // sum of four uniforms, which needs no libm.
+        double Normal() { return (Unit() + Unit() + Unit() + Unit() - 2.0) * 1.7320508075688772; }
+
+    private:
+        static uint64_t Rotate(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+        std::array<uint64_t, 4> state_{};
+    };
+
+    // What a SimulatedRadio's advertisers send.
+    enum class SimulatedPayload : uint8_t {
+        // Apple iBeacon manufacturer data, non-connectable. 30 bytes.
+        kBeacon,
+        // Eddystone-UID service data, scannable. 31 bytes.
+        kServiceData,
+        // A connectable device with a local name and a short manufacturer
+        // record from one of a few vendors. 23 bytes.
+        kNamed,
+    };
+
+    enum class RssiModel : uint8_t {
+        // Every advertisement arrives at the advertiser's base RSSI.
+        kFixed,
+        // Base RSSI plus independent noise of rssiNoise dB per advertisement.
+        kNoisy,
+        // The base itself walks by up to rssiNoise dB per advertisement,
+        // within the base range: people carrying phones around.
+        kWalking,
+    };
+
+    struct SimulatedRadioOptions {
+        uint64_t seed = 1;
+        size_t advertisers = 200;
+        // Advertisements per second across the population. Each advertiser
+        // advertises periodically, at a rate drawn from +-50% of the
+        // mean, plus a random advDelay of up to a quarter of the mean or
+        // 10 ms, whichever is less.
+        double advertisementsPerSecond = 10000;
+        // Relative weights of the payload kinds, indexed by
+        // SimulatedPayload.
+        std::array<uint32_t, 3> payloadMix{ 5, 2, 3 };
+        RssiModel rssiModel = RssiModel::kNoisy;
+        // Base RSSIs are drawn uniformly from this range.
+        int16_t rssiMin = -100;
+        int16_t rssiMax = -40;
+        double rssiNoise = 4;
+        // Chance that an advertisement carries a changed payload: a new
+        // beacon minor, Eddystone instance or manufacturer byte.
+        double payloadChurn = 0.05;
+        // The publisher side: how long the radio takes from StartAdvertising
+        // to Started and from StopAdvertising to Stopped, and the interval
+        // of our own advertisement, at whose events an in-place update goes
+        // on air.
+        std::chrono::nanoseconds startLatency = std::chrono::milliseconds(25);
+        std::chrono::nanoseconds stopLatency{ 0 };
+        std::chrono::nanoseconds advertisingInterval = std::chrono::milliseconds(100);
+        // ScanResult::timestamp of clock time 0, since the Unix epoch.
+        std::chrono::microseconds epoch = std::chrono::seconds(1704067200);
+    };
+
+    // A RadioBackend over a simulated room of advertisers, on a VirtualClock.
+    //
+    // The advertisement stream is a pure function of the options: the same
+    // seed replays the same advertisers, payloads, RSSIs and timings, event
+    // for event, on every platform. Advertisements are only delivered while
+    // the core has the scanner running.
+    //
+    // Publisher commands are timestamped with the clock and logged with the
+    // time their payload goes on air. Status changes come back through
+    // |on_status|, with the number of the publisher that raised them, as
+    // RunUntil passes their time: waiting straight away, started after
+    // startLatency and stopped after stopLatency. Shared by the tests and
+    // the benchmarks.
+    class SimulatedRadio : public RadioBackend {
+    public:
+        enum class CommandKind : uint8_t {
+            kStartAdvertising,
+            kStopAdvertising,
+            kUpdateAdvertisement,
+            kStartScan,
+            kStopScan,
+        };
+
+        struct Command {
+            CommandKind kind = CommandKind::kStartAdvertising;
+            std::chrono::nanoseconds at{ 0 };
+            // When the payload is on air: after startLatency for a start, at
+            // our advertisement's next event for an update. |at| otherwise.
+            std::chrono::nanoseconds onAir{ 0 };
+            uint32_t changed = 0;
+            bool accepted = true;
+        };
+
+        SimulatedRadio(VirtualClock& clock, const SimulatedRadioOptions& options)
+            : clock_(clock), options_(options), random_(options.seed) {
+            const double mean_interval = static_cast<double>(options.advertisers) / options.advertisementsPerSecond;
+            const auto mean = std::chrono::nanoseconds(static_cast<int64_t>(mean_interval * 1e9));
+            max_adv_delay_ = std::min<std::chrono::nanoseconds>(mean / 4, std::chrono::milliseconds(10));
+
+            uint32_t total_weight = 0;
+            for (auto weight : options.payloadMix) total_weight += weight;
+            advertisers_.resize(options.advertisers);
+            for (size_t i = 0; i < advertisers_.size(); ++i) {
+                auto& advertiser = advertisers_[i];
+                advertiser.address = random_.Next() & 0xFFFFFFFFFFFFull;
+                // Drawing the rate rather than the interval keeps the sum of
+                // the rates on the mean.
+                const double period = mean_interval / (0.5 + random_.Unit());
+                advertiser.interval =
+                    std::chrono::nanoseconds(static_cast<int64_t>(period * 1e9)) - max_adv_delay_ / 2;
+                advertiser.base = static_cast<double>(random_.Between(options.rssiMin, options.rssiMax));
+                uint64_t pick = total_weight ? random_.Below(total_weight) : 0;
+                size_t kind = 0;
+                while (kind + 1 < options.payloadMix.size() && pick >= options.payloadMix[kind]) {
+                    pick -= options.payloadMix[kind++];
+                }
+                advertiser.kind = static_cast<SimulatedPayload>(kind);
+                BuildPayload(advertiser);
+                // Spread the first advertisements over one interval.
+                pending_.push({ std::chrono::nanoseconds(random_.Below(static_cast<uint64_t>(advertiser.interval.count()))), i });
+            }
+        }
+
+        // Disallow copy and assign.
+        SimulatedRadio(const SimulatedRadio&) = delete;
+        SimulatedRadio& operator=(const SimulatedRadio&) = delete;
+
+        bool StartAdvertising(const AdvertiseData&) override {
+            const auto now = clock_.Now();
+            Log(CommandKind::kStartAdvertising, now, now + options_.startLatency, 0, accept_start);
+            ++publisher_;
+            if (!accept_start) return false;
+            on_air_since_ = now + options_.startLatency;
+            PushStatus(now, PublisherStatus::waiting);
+            PushStatus(on_air_since_, PublisherStatus::started);
+            return true;
+        }
+
+        void StopAdvertising() override {
+            const auto now = clock_.Now();
+            Log(CommandKind::kStopAdvertising, now, now, 0, true);
+            PushStatus(now + options_.stopLatency, PublisherStatus::stopped);
+        }
+
+        bool UpdateAdvertisement(const AdvertiseData&, uint32_t changed) override {
+            const auto now = clock_.Now();
+            // The controller picks the new payload up at its next event.
+            auto on_air = on_air_since_;
+            if (now > on_air) {
+                const auto interval = options_.advertisingInterval;
+                on_air += (now - on_air + interval - std::chrono::nanoseconds(1)) / interval * interval;
+            }
+            Log(CommandKind::kUpdateAdvertisement, now, on_air, changed, accept_update);
+            return accept_update;
+        }
+
+        bool StartScan(const ScanSettings&) override {
+            Log(CommandKind::kStartScan, clock_.Now(), clock_.Now(), 0, accept_scan);
+            scanning_ = accept_scan;
+            return accept_scan;
+        }
+
+        void StopScan() override {
+            Log(CommandKind::kStopScan, clock_.Now(), clock_.Now(), 0, true);
+            scanning_ = false;
+        }
+
+        // Moves the clock through every event up to |end|, in time order,
+        // and hands each advertisement received while scanning to
+        // |on_result(const ScanResult&)|. The result borrows the radio's
+        // buffers until the callback returns. Returns the number delivered.
+        template <typename OnResult>
+        uint64_t RunUntil(std::chrono::nanoseconds end, OnResult&& on_result) {
+            uint64_t delivered = 0;
+            while (true) {
+                const bool status_due = !statuses_.empty() && statuses_.top().at <= end;
+                const bool advertisement_due = !pending_.empty() && pending_.top().at <= end;
+                if (!status_due && !advertisement_due) break;
+                if (status_due && (!advertisement_due || statuses_.top().at <= pending_.top().at)) {
+                    const auto status = statuses_.top();
+                    statuses_.pop();
+                    Advance(status.at);
+                    if (on_status) on_status(status.status, status.publisher);
+                    continue;
+                }
+                const auto event = pending_.top();
+                pending_.pop();
+                Advance(event.at);
+                auto& advertiser = advertisers_[event.advertiser];
+                const auto delay = std::chrono::nanoseconds(
+                    random_.Below(static_cast<uint64_t>(max_adv_delay_.count()) + 1));
+                pending_.push({ event.at + advertiser.interval + delay, event.advertiser });
+                if (!scanning_) continue;
+
+                ++generated_;
+                Emit(advertiser);
+                on_result(static_cast<const ScanResult&>(result_));
+                ++delivered;
+            }
+            Advance(end);
+            return delivered;
+        }
+
+        // Publisher status changes delivered by RunUntil.
+        std::function<void(PublisherStatus, uint64_t)> on_status;
+
+        const std::vector<Command>& commands() const { return commands_; }
+        void ClearCommands() { commands_.clear(); }
+        uint64_t generated() const { return generated_; }
+        bool scanning() const { return scanning_; }
+        // Mean advertisements per second the population produces, after
+        // rounding the intervals.
+        double rate() const {
+            double rate = 0;
+            const double delay = std::chrono::duration<double>(max_adv_delay_).count() / 2;
+            for (const auto& advertiser : advertisers_) {
+                rate += 1.0 / (std::chrono::duration<double>(advertiser.interval).count() + delay);
+            }
+            return rate;
+        }
+
+        bool accept_start = true;
+        bool accept_update = true;
+        bool accept_scan = true;
+
+    private:
+        struct Advertiser {
+            uint64_t address = 0;
+            std::chrono::nanoseconds interval{ 0 };
+            double base = 0;
+            SimulatedPayload kind = SimulatedPayload::kBeacon;
+            std::vector<uint8_t> payload;
+            // Offset of the byte churn changes, and the local name.
+            size_t churn_offset = 0;
+            std::string name;
+            uint8_t flags = 0;
+            uint16_t company = 0;
+            size_t manufacturer_offset = 0;
+            size_t manufacturer_size = 0;
+        };
+
+        struct PendingAdvertisement {
+            std::chrono::nanoseconds at{ 0 };
+            size_t advertiser = 0;
+
+            // Earliest first, ties by advertiser for a stable order.
+            bool operator<(const PendingAdvertisement& other) const {
+                return at != other.at ? at > other.at : advertiser > other.advertiser;
+            }
+        };
+
+        struct PendingStatus {
+            std::chrono::nanoseconds at{ 0 };
+            PublisherStatus status = PublisherStatus::created;
+            uint64_t publisher = 0;
+            // Order of raising, which breaks ties in |at|.
+            uint64_t sequence = 0;
+
+            // Earliest first, then in the order they were raised.
+            bool operator<(const PendingStatus& other) const {
+                return at != other.at ? at > other.at : sequence > other.sequence;
+            }
+        };
+
+        void PushStatus(std::chrono::nanoseconds at, PublisherStatus status) {
+            statuses_.push({ at, status, publisher_, status_sequence_++ });
+        }
+
+        void Advance(std::chrono::nanoseconds to) {
+            if (to > clock_.Now()) clock_.Set(to);
+        }
+
+        void Log(CommandKind kind, std::chrono::nanoseconds at, std::chrono::nanoseconds on_air, uint32_t changed,
+                 bool accepted) {
+            commands_.push_back({ kind, at, on_air, changed, accepted });
+        }
+
+        void Append(std::vector<uint8_t>& payload, uint8_t type, std::initializer_list<uint8_t> body) {
+            payload.push_back(static_cast<uint8_t>(body.size() + 1));
+            payload.push_back(type);
+            payload.insert(payload.end(), body);
+        }
+
+        uint8_t RandomByte() { return static_cast<uint8_t>(random_.Next()); }
+
+        void BuildPayload(Advertiser& advertiser) {
+            auto& payload = advertiser.payload;
+            switch (advertiser.kind) {
+            case SimulatedPayload::kBeacon: {
+                Append(payload, kAdFlags, { kAdFlagsGeneralDiscoverable });
+                // Company 0x004C, iBeacon type and length, proximity UUID,
+                // major, minor and measured power.
+                payload.push_back(26);
+                payload.push_back(kAdManufacturerSpecificData);
+                advertiser.manufacturer_offset = payload.size();
+                payload.insert(payload.end(), { 0x4C, 0x00, 0x02, 0x15 });
+                for (int i = 0; i < 20; ++i) payload.push_back(RandomByte());
+                payload.push_back(0xC5);
+                advertiser.manufacturer_size = payload.size() - advertiser.manufacturer_offset;
+                advertiser.company = 0x004C;
+                advertiser.churn_offset = payload.size() - 2;
+                break;
+            }
+            case SimulatedPayload::kServiceData: {
+                Append(payload, kAdFlags, { kAdFlagsGeneralDiscoverable });
+                Append(payload, kAdCompleteUuid16List, { 0xAA, 0xFE });
+                // Eddystone-UID: frame type, ranging data, 10-byte namespace,
+                // 6-byte instance and two reserved bytes.
+                payload.push_back(23);
+                payload.push_back(kAdServiceData16);
+                payload.insert(payload.end(), { 0xAA, 0xFE, 0x00, 0xEE });
+                for (int i = 0; i < 16; ++i) payload.push_back(RandomByte());
+                advertiser.churn_offset = payload.size() - 1;
+                payload.insert(payload.end(), { 0x00, 0x00 });
+                advertiser.flags = kScannable;
+                break;
+            }
+            case SimulatedPayload::kNamed: {
+                static constexpr std::array<uint16_t, 3> kCompanies = { 0x0006, 0x0075, 0x00E0 };
+                static constexpr char kHex[] = "0123456789ABCDEF";
+                Append(payload, kAdFlags, { kAdFlagsGeneralDiscoverable });
+                advertiser.name = "Sim-";
+                for (int shift = 12; shift >= 0; shift -= 4) {
+                    advertiser.name.push_back(kHex[(advertiser.address >> shift) & 0xF]);
+                }
+                payload.push_back(static_cast<uint8_t>(advertiser.name.size() + 1));
+                payload.push_back(kAdCompleteLocalName);
+                payload.insert(payload.end(), advertiser.name.begin(), advertiser.name.end());
+                advertiser.company = kCompanies[random_.Below(kCompanies.size())];
+                payload.push_back(9);
+                payload.push_back(kAdManufacturerSpecificData);
+                advertiser.manufacturer_offset = payload.size();
+                payload.push_back(static_cast<uint8_t>(advertiser.company & 0xFF));
+                payload.push_back(static_cast<uint8_t>(advertiser.company >> 8));
+                for (int i = 0; i < 6; ++i) payload.push_back(RandomByte());
+                advertiser.manufacturer_size = payload.size() - advertiser.manufacturer_offset;
+                advertiser.churn_offset = payload.size() - 1;
+                advertiser.flags = kConnectable | kScannable;
+                break;
+            }
+            }
+        }
+
+        int16_t NextRssi(Advertiser& advertiser) {
+            const double low = options_.rssiMin;
+            const double high = options_.rssiMax;
+            double rssi = advertiser.base;
+            switch (options_.rssiModel) {
+            case RssiModel::kFixed:
+                break;
+            case RssiModel::kNoisy:
+                rssi += random_.Normal() * options_.rssiNoise;
+                break;
+            case RssiModel::kWalking:
+                advertiser.base = std::clamp(advertiser.base + (random_.Unit() * 2 - 1) * options_.rssiNoise, low, high);
+                rssi = advertiser.base;
+                break;
+            }
+            return static_cast<int16_t>(std::clamp(rssi, -127.0, 20.0));
+        }
+
+        // Fills result_ the way WinRtRadioBackend's ToScanResult does.
+        void Emit(Advertiser& advertiser) {
+            if (options_.payloadChurn > 0 && random_.Unit() < options_.payloadChurn) {
+                ++advertiser.payload[advertiser.churn_offset];
+            }
+            result_.address = advertiser.address;
+            result_.rssi = NextRssi(advertiser);
+            result_.flags = advertiser.flags;
+            result_.timestamp = options_.epoch + std::chrono::duration_cast<std::chrono::microseconds>(clock_.Now());
+            result_.localName = advertiser.name;
+            result_.manufacturerData.clear();
+            if (advertiser.manufacturer_size >= 2) {
+                ManufacturerRecord record;
+                record.companyId = advertiser.company;
+                record.data = ByteView(advertiser.payload.data() + advertiser.manufacturer_offset + 2,
+                                       advertiser.manufacturer_size - 2);
+                result_.manufacturerData.push_back(record);
+            }
+            result_.advertisementData = ByteView(advertiser.payload.data(), advertiser.payload.size());
+        }
+
+        VirtualClock& clock_;
+        SimulatedRadioOptions options_;
+        SimulationRandom random_;
+        std::vector<Advertiser> advertisers_;
+        std::priority_queue<PendingAdvertisement> pending_;
+        std::chrono::nanoseconds max_adv_delay_{ 0 };
+        ScanResult result_;
+        uint64_t generated_ = 0;
+        bool scanning_ = false;
+
+        std::chrono::nanoseconds on_air_since_{ 0 };
+        std::priority_queue<PendingStatus> statuses_;
+        uint64_t status_sequence_ = 0;
+        // Number of the publisher the last StartAdvertising set up.
+        uint64_t publisher_ = 0;
+        std::vector<Command> commands_;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_TEST_SIMULATED_RADIO_H_
@@ -0,0 +1,170 @@
+#include "simulated_radio.h"
+
+#include <gtest/gtest.h>
+
+#include "ad_parser.h"
+#include "advertisement_cache.h"
+#include "peripheral_core.h"
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        using std::chrono::milliseconds;
+        using std::chrono::seconds;
+
+        // Everything a scan result carries, folded into one value.
+        uint64_t Fingerprint(const ScanResult& result) {
+            return HashBytes(result.advertisementData) ^ (result.address * 31) ^
+                (static_cast<uint64_t>(result.rssi + 128) << 56) ^
+                static_cast<uint64_t>(result.timestamp.count());
+        }
+
+        std::vector<uint64_t> Record(const SimulatedRadioOptions& options, milliseconds duration) {
+            VirtualClock clock;
+            SimulatedRadio radio(clock, options);
+            radio.StartScan(ScanSettings());
+            std::vector<uint64_t> fingerprints;
+            radio.RunUntil(duration, [&](const ScanResult& result) { fingerprints.push_back(Fingerprint(result)); });
+            return fingerprints;
+        }
+
+        TEST(SimulatedRadioTest, ReplaysASeedExactly) {
+            SimulatedRadioOptions options;
+            options.rssiModel = RssiModel::kWalking;
+            auto first = Record(options, milliseconds(500));
+            ASSERT_GT(first.size(), 4000u);
+            EXPECT_EQ(Record(options, milliseconds(500)), first);
+
+            options.seed = 2;
+            EXPECT_NE(Record(options, milliseconds(500)), first);
+        }
+
+        TEST(SimulatedRadioTest, ProducesTheConfiguredRate) {
+            SimulatedRadioOptions options;
+            options.advertisers = 2000;
+            options.advertisementsPerSecond = 100000;
+            VirtualClock clock;
+            SimulatedRadio radio(clock, options);
+            EXPECT_NEAR(radio.rate(), 100000, 5000);
+
+            // Nothing is delivered until the scanner runs.
+            EXPECT_EQ(radio.RunUntil(seconds(1), [](const ScanResult&) {}), 0u);
+            EXPECT_EQ(clock.Now(), seconds(1));
+            radio.StartScan(ScanSettings());
+            const auto delivered = radio.RunUntil(seconds(3), [](const ScanResult&) {});
+            EXPECT_NEAR(static_cast<double>(delivered), 200000, 10000);
+            EXPECT_EQ(radio.generated(), delivered);
+        }
+
+        TEST(SimulatedRadioTest, PayloadsAreWellFormed) {
+            SimulatedRadioOptions options;
+            options.rssiModel = RssiModel::kNoisy;
+            VirtualClock clock;
+            SimulatedRadio radio(clock, options);
+            radio.StartScan(ScanSettings());
+
+            size_t beacons = 0;
+            size_t named = 0;
+            std::chrono::microseconds last{ 0 };
+            radio.RunUntil(seconds(1), [&](const ScanResult& result) {
+                AdvertisementFields fields;
+                ParseAdvertisement(result.advertisementData, fields);
+                EXPECT_FALSE(fields.malformed);
+                EXPECT_LE(result.advertisementData.size(), kLegacyAdvertisingDataSize);
+                EXPECT_EQ(fields.flags, kAdFlagsGeneralDiscoverable);
+                EXPECT_GE(result.rssi, options.rssiMin - 20);
+                EXPECT_LE(result.rssi, options.rssiMax + 20);
+                EXPECT_GE(result.timestamp, last);
+                last = result.timestamp;
+                ASSERT_EQ(fields.manufacturerData.size(), result.manufacturerData.size());
+                if (!result.manufacturerData.empty()) {
+                    EXPECT_EQ(fields.manufacturerData[0].companyId, result.manufacturerData[0].companyId);
+                    beacons += result.manufacturerData[0].companyId == 0x004C;
+                }
+                if (!result.localName.empty()) {
+                    EXPECT_EQ(std::string(fields.localName.begin(), fields.localName.end()), result.localName);
+                    EXPECT_TRUE(result.flags & kConnectable);
+                    ++named;
+                }
+            });
+            // 5:2:3 by weight.
+            EXPECT_NEAR(static_cast<double>(beacons) / static_cast<double>(radio.generated()), 0.5, 0.1);
+            EXPECT_NEAR(static_cast<double>(named) / static_cast<double>(radio.generated()), 0.3, 0.1);
+        }
+
+        TEST(SimulatedRadioTest, TimestampsPublisherCommands) {
+            SimulatedRadioOptions options;
+            options.advertisers = 1;
+            VirtualClock clock;
+            SimulatedRadio radio(clock, options);
+            PeripheralCore core(radio);
+            radio.on_status = [&](PublisherStatus status, uint64_t publisher) {
+                core.OnPublisherStatusChanged(status, publisher);
+            };
+
+            clock.Set(seconds(1));
+            AdvertiseData data;
+            data.manufacturerId = 1234;
+            core.Start(data);
+            radio.RunUntil(milliseconds(1010), [](const ScanResult&) {});
+            EXPECT_EQ(core.publisher_status(), PublisherStatus::waiting);
+            radio.RunUntil(milliseconds(1100), [](const ScanResult&) {});
+            EXPECT_EQ(core.publisher_status(), PublisherStatus::started);
+
+            // On air at the advertisement's next event: 1025 ms plus two
+            // intervals.
+            clock.Set(milliseconds(1200));
+            data.manufacturerData = SharedBuffer::CopyFrom(std::vector<uint8_t>{ 1, 2, 3 });
+            EXPECT_FALSE(core.Update(data).restarted);
+
+            radio.accept_update = false;
+            data.manufacturerData = SharedBuffer::CopyFrom(std::vector<uint8_t>{ 4 });
+            EXPECT_TRUE(core.Update(data).restarted);
+
+            const auto& commands = radio.commands();
+            ASSERT_EQ(commands.size(), 5u);
+            EXPECT_EQ(commands[0].kind, SimulatedRadio::CommandKind::kStartAdvertising);
+            EXPECT_EQ(commands[0].at, seconds(1));
+            EXPECT_EQ(commands[0].onAir, milliseconds(1025));
+            EXPECT_EQ(commands[1].kind, SimulatedRadio::CommandKind::kUpdateAdvertisement);
+            EXPECT_EQ(commands[1].onAir, milliseconds(1225));
+            EXPECT_TRUE(commands[1].accepted);
+            EXPECT_FALSE(commands[2].accepted);
+            EXPECT_EQ(commands[3].kind, SimulatedRadio::CommandKind::kStopAdvertising);
+            EXPECT_EQ(commands[4].kind, SimulatedRadio::CommandKind::kStartAdvertising);
+            EXPECT_EQ(commands[4].onAir, milliseconds(1225));
+        }
+
+        TEST(SimulatedRadioTest, LateStoppedOfAReplacedPublisherKeepsAdvertising) {
+            SimulatedRadioOptions options;
+            options.advertisers = 1;
+            // The old publisher reports Stopped after the new one started.
+            options.stopLatency = milliseconds(50);
+            VirtualClock clock;
+            SimulatedRadio radio(clock, options);
+            PeripheralCore core(radio);
+            std::vector<std::pair<PublisherStatus, uint64_t>> statuses;
+            radio.on_status = [&](PublisherStatus status, uint64_t publisher) {
+                statuses.emplace_back(status, publisher);
+                core.OnPublisherStatusChanged(status, publisher);
+            };
+
+            AdvertiseData data;
+            data.manufacturerId = 1234;
+            core.Start(data);
+            radio.RunUntil(milliseconds(100), [](const ScanResult&) {});
+            ASSERT_TRUE(core.IsAdvertising());
+
+            radio.accept_update = false;
+            data.manufacturerData = SharedBuffer::CopyFrom(std::vector<uint8_t>{ 1 });
+            ASSERT_TRUE(core.Update(data).restarted);
+            radio.RunUntil(milliseconds(300), [](const ScanResult&) {});
+
+            ASSERT_FALSE(statuses.empty());
+            EXPECT_EQ(statuses.back(), std::make_pair(PublisherStatus::stopped, uint64_t{ 1 }));
+            EXPECT_TRUE(core.IsAdvertising());
+            EXPECT_EQ(core.publisher_status(), PublisherStatus::started);
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,24 @@
+#include "startup_timeline.h"
+
+#include <gtest/gtest.h>
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        using std::chrono::milliseconds;
+
+        TEST(StartupTimelineTest, FirstMarkWins) {
+            StartupTimeline timeline(milliseconds(100));
+            EXPECT_FALSE(timeline.Elapsed(StartupMilestone::kAdapter));
+
+            EXPECT_TRUE(timeline.Mark(StartupMilestone::kAdapter, milliseconds(112)));
+            EXPECT_FALSE(timeline.Mark(StartupMilestone::kAdapter, milliseconds(500)));
+            EXPECT_TRUE(timeline.Mark(StartupMilestone::kFirstAdvertisement, milliseconds(340)));
+
+            EXPECT_EQ(timeline.Elapsed(StartupMilestone::kAdapter), milliseconds(12));
+            EXPECT_EQ(timeline.Elapsed(StartupMilestone::kFirstAdvertisement), milliseconds(240));
+            EXPECT_FALSE(timeline.Elapsed(StartupMilestone::kRadio));
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,64 @@
+#include "state_debouncer.h"
+#include "state_snapshot.h"
+
+#include <gtest/gtest.h>
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        using std::chrono::milliseconds;
+
+        TEST(StateDebouncerTest, EmitsTheSettledStateOfABurst) {
+            StateDebouncer debouncer(milliseconds(50));
+            debouncer.Offer(PeripheralState::idle, milliseconds(0));
+            debouncer.Offer(PeripheralState::advertising, milliseconds(10));
+            debouncer.Offer(PeripheralState::idle, milliseconds(20));
+            EXPECT_EQ(debouncer.Offer(PeripheralState::advertising, milliseconds(30)), milliseconds(80));
+
+            EXPECT_FALSE(debouncer.Poll(milliseconds(79)));
+            EXPECT_EQ(debouncer.Poll(milliseconds(80)), PeripheralState::advertising);
+            EXPECT_FALSE(debouncer.deadline());
+            EXPECT_EQ(debouncer.suppressed(), 3u);
+        }
+
+        TEST(StateDebouncerTest, DropsRepeatsOfTheLastEmittedState) {
+            StateDebouncer debouncer(milliseconds(50));
+            debouncer.Offer(PeripheralState::advertising, milliseconds(0));
+            EXPECT_EQ(debouncer.Poll(milliseconds(50)), PeripheralState::advertising);
+
+            // A stop/start blip that settles back where it was is not news.
+            debouncer.Offer(PeripheralState::idle, milliseconds(100));
+            debouncer.Offer(PeripheralState::advertising, milliseconds(110));
+            EXPECT_FALSE(debouncer.Poll(milliseconds(200)));
+
+            debouncer.Offer(PeripheralState::poweredOff, milliseconds(300));
+            EXPECT_EQ(debouncer.Poll(milliseconds(350)), PeripheralState::poweredOff);
+        }
+
+        TEST(StateDebouncerTest, EmitSetsTheBaseline) {
+            StateDebouncer debouncer(milliseconds(50));
+            debouncer.Offer(PeripheralState::idle, milliseconds(0));
+            EXPECT_EQ(debouncer.Emit(PeripheralState::idle), PeripheralState::idle);
+            EXPECT_FALSE(debouncer.deadline());
+
+            debouncer.Offer(PeripheralState::idle, milliseconds(10));
+            EXPECT_FALSE(debouncer.Poll(milliseconds(60)));
+        }
+
+        TEST(StateDebouncerTest, DerivesPeripheralStateFromTheSnapshot) {
+            StateSnapshot state;
+            EXPECT_EQ(DerivePeripheralState(state), PeripheralState::unknown);
+            state.radio = RadioState::on;
+            EXPECT_EQ(DerivePeripheralState(state), PeripheralState::unsupported);
+            state.supported = true;
+            EXPECT_EQ(DerivePeripheralState(state), PeripheralState::idle);
+            state.publisher = PublisherStatus::started;
+            EXPECT_EQ(DerivePeripheralState(state), PeripheralState::advertising);
+            state.connected = true;
+            EXPECT_EQ(DerivePeripheralState(state), PeripheralState::connected);
+            state.radio = RadioState::off;
+            EXPECT_EQ(DerivePeripheralState(state), PeripheralState::poweredOff);
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,73 @@
+#include "state_snapshot.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        using std::chrono::microseconds;
+        using std::chrono::milliseconds;
+
+        TEST(StateSnapshotTest, StartsUnknown) {
+            AtomicStateSnapshot snapshot;
+            auto state = snapshot.Load();
+            EXPECT_EQ(state.radio, RadioState::unknown);
+            EXPECT_EQ(state.publisher, PublisherStatus::created);
+            EXPECT_FALSE(state.supported);
+            EXPECT_FALSE(state.connected);
+            EXPECT_FALSE(state.advertising());
+            EXPECT_EQ(state.changedAt, microseconds(0));
+        }
+
+        TEST(StateSnapshotTest, RecordsWhenAFieldLastChanged) {
+            AtomicStateSnapshot snapshot;
+            EXPECT_TRUE(snapshot.SetRadio(RadioState::on, milliseconds(5)));
+            EXPECT_TRUE(snapshot.SetSupported(true, milliseconds(6)));
+            EXPECT_TRUE(snapshot.SetPublisher(PublisherStatus::started, milliseconds(7)));
+
+            // Repeating a value is not a change.
+            EXPECT_FALSE(snapshot.SetRadio(RadioState::on, milliseconds(50)));
+
+            auto state = snapshot.Load();
+            EXPECT_EQ(state.radio, RadioState::on);
+            EXPECT_TRUE(state.supported);
+            EXPECT_TRUE(state.advertising());
+            EXPECT_EQ(state.changedAt, milliseconds(7));
+
+            EXPECT_TRUE(snapshot.SetPublisher(PublisherStatus::aborted, milliseconds(60)));
+            state = snapshot.Load();
+            EXPECT_FALSE(state.advertising());
+            EXPECT_EQ(state.publisher, PublisherStatus::aborted);
+            EXPECT_EQ(state.radio, RadioState::on);
+            EXPECT_EQ(state.changedAt, milliseconds(60));
+        }
+
+        // Radio and publisher events arrive on different threads; neither may
+        // overwrite the other's field.
+        TEST(StateSnapshotTest, ConcurrentSettersKeepEachOthersFields) {
+            AtomicStateSnapshot snapshot;
+            std::thread radio([&snapshot] {
+                for (int i = 0; i < 10000; ++i) {
+                    snapshot.SetRadio(i % 2 ? RadioState::on : RadioState::off, microseconds(i));
+                }
+                snapshot.SetRadio(RadioState::disabled, microseconds(10000));
+            });
+            std::thread publisher([&snapshot] {
+                for (int i = 0; i < 10000; ++i) {
+                    snapshot.SetPublisher(i % 2 ? PublisherStatus::started : PublisherStatus::stopped, microseconds(i));
+                }
+                snapshot.SetPublisher(PublisherStatus::waiting, microseconds(10000));
+            });
+            radio.join();
+            publisher.join();
+
+            auto state = snapshot.Load();
+            EXPECT_EQ(state.radio, RadioState::disabled);
+            EXPECT_EQ(state.publisher, PublisherStatus::waiting);
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
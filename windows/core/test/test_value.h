@@ -0,0 +1,20 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_TEST_TEST_VALUE_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_TEST_TEST_VALUE_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+
+    // Stand-in for flutter::EncodableValue with the alternatives the plugin
+    // actually decodes.
+    using TestValue = std::variant<std::monostate, bool, int32_t, int64_t, double,
+                                   std::string, std::vector<uint8_t>>;
+    using TestMap = std::map<TestValue, TestValue>;
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_TEST_TEST_VALUE_H_
@@ -0,0 +1,330 @@
+#include "write_assembler.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <optional>
+#include <random>
+
+namespace flutter_ble_peripheral {
+    namespace {
+
+        using std::chrono::milliseconds;
+        using std::chrono::seconds;
+
+        constexpr size_t kMtu = 23;
+        // A full fragment at kMtu: 18 bytes.
+        constexpr size_t kFull = kMtu - kAttPrepareWriteHeaderSize;
+
+        std::vector<uint8_t> Pattern(size_t size, uint8_t seed = 0) {
+            std::vector<uint8_t> bytes(size);
+            for (size_t i = 0; i < size; ++i) bytes[i] = static_cast<uint8_t>(seed + i * 7);
+            return bytes;
+        }
+
+        class WriteAssemblerTest : public ::testing::Test {
+        protected:
+            AssembledWrite Write(GattClientId client, ByteView value, size_t offset = 0) {
+                return assembler_.Append(client, 9, GattWriteKind::kWrite, offset, value, milliseconds(0));
+            }
+
+            AssembledWrite Prepare(GattClientId client, size_t offset, ByteView fragment,
+                                   milliseconds at = milliseconds(0)) {
+                return assembler_.Append(client, 9, GattWriteKind::kPrepare, offset, fragment, at);
+            }
+
+            AssembledWrite Execute(GattClientId client, bool cancel = false) {
+                const auto kind = cancel ? GattWriteKind::kCancel : GattWriteKind::kExecute;
+                return assembler_.Append(client, 9, kind, 0, ByteView(), milliseconds(0));
+            }
+
+            BufferPool pool_;
+            WriteAssembler assembler_{ pool_, WriteAssemblerOptions{ 200, seconds(1), 2 } };
+        };
+
+        TEST_F(WriteAssemblerTest, ShortWriteIsAMessageOfItsOwn) {
+            auto bytes = Pattern(5);
+            auto result = Write(1, bytes);
+            EXPECT_EQ(result.status, GattStatus::kSuccess);
+            EXPECT_TRUE(result.complete);
+            EXPECT_TRUE(result.message.view() == ByteView(bytes));
+            EXPECT_EQ(assembler_.stats().open, 0u);
+        }
+
+        TEST_F(WriteAssemblerTest, FullPacketWriteIsAMessageOfItsOwn) {
+            // The largest write request at kMtu: 20 bytes.
+            auto bytes = Pattern(kMtu - 3);
+            auto result = Write(1, bytes);
+            ASSERT_TRUE(result.complete);
+            EXPECT_TRUE(result.message.view() == ByteView(bytes));
+            EXPECT_EQ(assembler_.stats().open, 0u);
+        }
+
+        TEST_F(WriteAssemblerTest, SeparateWritesAtZeroAreSeparateMessages) {
+            auto first = Pattern(kMtu - 3, 1);
+            auto second = Pattern(kMtu - 3, 2);
+            auto result = Write(1, first);
+            ASSERT_TRUE(result.complete);
+            EXPECT_TRUE(result.message.view() == ByteView(first));
+            result = Write(1, second);
+            ASSERT_TRUE(result.complete);
+            EXPECT_TRUE(result.message.view() == ByteView(second));
+            EXPECT_EQ(assembler_.stats().messages, 2u);
+        }
+
+        TEST_F(WriteAssemblerTest, LongWriteCompletesOnExecute) {
+            // An exact multiple of the fragment size needs nothing extra.
+            auto bytes = Pattern(2 * kFull);
+            ByteView view(bytes);
+            EXPECT_FALSE(Prepare(1, 0, view.subview(0, kFull)).complete);
+            EXPECT_FALSE(Prepare(1, kFull, view.subview(kFull)).complete);
+            EXPECT_EQ(assembler_.stats().open, 1u);
+            auto result = Execute(1);
+            ASSERT_TRUE(result.complete);
+            EXPECT_TRUE(result.message.view() == view);
+            EXPECT_EQ(assembler_.stats().open, 0u);
+
+            // With nothing prepared an execute completes nothing.
+            result = Execute(1);
+            EXPECT_EQ(result.status, GattStatus::kSuccess);
+            EXPECT_FALSE(result.complete);
+        }
+
+        TEST_F(WriteAssemblerTest, WritesLeaveAnOpenLongWriteAlone) {
+            auto prepared = Pattern(kFull, 1);
+            auto written = Pattern(3, 2);
+            Prepare(1, 0, prepared);
+            auto result = Write(1, written);
+            ASSERT_TRUE(result.complete);
+            EXPECT_TRUE(result.message.view() == ByteView(written));
+            result = Execute(1);
+            ASSERT_TRUE(result.complete);
+            EXPECT_TRUE(result.message.view() == ByteView(prepared));
+        }
+
+        TEST_F(WriteAssemblerTest, CancelDropsTheLongWrite) {
+            auto bytes = Pattern(kFull);
+            Prepare(1, 0, bytes);
+            auto result = Execute(1, true);
+            EXPECT_EQ(result.status, GattStatus::kSuccess);
+            EXPECT_FALSE(result.complete);
+            EXPECT_FALSE(Execute(1).complete);
+            EXPECT_EQ(assembler_.stats().expired, 1u);
+        }
+
+        TEST_F(WriteAssemblerTest, PrepareAtZeroStartsOver) {
+            auto stale = Pattern(kFull, 1);
+            auto fresh = Pattern(4, 2);
+            Prepare(1, 0, stale);
+            Prepare(1, 0, fresh);
+            auto result = Execute(1);
+            ASSERT_TRUE(result.complete);
+            EXPECT_TRUE(result.message.view() == ByteView(fresh));
+        }
+
+        TEST_F(WriteAssemblerTest, StackReassembledValueCompletesAtOnce) {
+            auto bytes = Pattern(120);
+            auto result = Write(1, bytes);
+            EXPECT_TRUE(result.complete);
+            EXPECT_EQ(result.message.size(), 120u);
+        }
+
+        TEST_F(WriteAssemblerTest, ClientsAndCharacteristicsAssembleSeparately) {
+            auto a = Pattern(kFull, 1);
+            auto b = Pattern(kFull, 2);
+            Prepare(1, 0, a);
+            Prepare(2, 0, b);
+            auto tail = Pattern(1, 3);
+            Prepare(2, kFull, tail);
+            auto result = Execute(2);
+            ASSERT_TRUE(result.complete);
+            EXPECT_EQ(result.message.view().subview(0, kFull), ByteView(b));
+            EXPECT_EQ(assembler_.stats().open, 1u);
+        }
+
+        TEST_F(WriteAssemblerTest, GapInOffsetsRejectsAndDrops) {
+            auto bytes = Pattern(kFull);
+            Prepare(1, 0, bytes);
+            EXPECT_EQ(Prepare(1, kFull + 1, bytes).status, GattStatus::kInvalidOffset);
+            EXPECT_EQ(assembler_.stats().open, 0u);
+            EXPECT_EQ(Prepare(2, 4, bytes).status, GattStatus::kInvalidOffset);
+            // Write requests carry no offset.
+            EXPECT_EQ(Write(2, bytes, 4).status, GattStatus::kInvalidOffset);
+        }
+
+        TEST_F(WriteAssemblerTest, OversizedMessageRejectsAndDrops) {
+            auto bytes = Pattern(kFull);
+            for (size_t offset = 0; offset + kFull <= 198; offset += kFull) {
+                EXPECT_EQ(Prepare(1, offset, bytes).status, GattStatus::kSuccess);
+            }
+            EXPECT_EQ(Prepare(1, 198, bytes).status, GattStatus::kInvalidAttributeValueLength);
+            EXPECT_EQ(assembler_.stats().open, 0u);
+            EXPECT_EQ(Write(1, Pattern(201)).status, GattStatus::kInvalidAttributeValueLength);
+            EXPECT_EQ(assembler_.stats().rejected, 2u);
+        }
+
+        TEST_F(WriteAssemblerTest, TableFullRefusesNewLongWrites) {
+            auto bytes = Pattern(kFull);
+            Prepare(1, 0, bytes);
+            Prepare(2, 0, bytes);
+            EXPECT_EQ(Prepare(3, 0, bytes).status, GattStatus::kInsufficientResources);
+            // Writes need no slot.
+            EXPECT_TRUE(Write(3, bytes).complete);
+        }
+
+        TEST_F(WriteAssemblerTest, TimedOutLongWritesAreDelivered) {
+            auto bytes = Pattern(kFull + 2);
+            ByteView view(bytes);
+            Prepare(1, 0, view.subview(0, kFull), milliseconds(0));
+            Prepare(1, kFull, view.subview(kFull), milliseconds(100));
+            Prepare(2, 0, view, milliseconds(600));
+            EXPECT_EQ(assembler_.NextTimeout(), milliseconds(1100));
+            EXPECT_TRUE(assembler_.Expire(milliseconds(1000)).empty());
+
+            const auto& timed_out = assembler_.Expire(milliseconds(1100));
+            ASSERT_EQ(timed_out.size(), 1u);
+            EXPECT_EQ(timed_out[0].client, 1u);
+            EXPECT_EQ(timed_out[0].characteristic, 9u);
+            EXPECT_TRUE(timed_out[0].message.view() == view);
+            EXPECT_EQ(assembler_.NextTimeout(), milliseconds(1600));
+            // Client 1 starts over; offset kFull no longer continues anything.
+            EXPECT_EQ(Prepare(1, kFull, bytes, milliseconds(1100)).status, GattStatus::kInvalidOffset);
+
+            assembler_.OnClientDisconnected(2);
+            EXPECT_FALSE(assembler_.NextTimeout());
+            const auto stats = assembler_.stats();
+            EXPECT_EQ(stats.open, 0u);
+            EXPECT_EQ(stats.timedOut, 1u);
+            EXPECT_EQ(stats.expired, 1u);
+            EXPECT_EQ(stats.messages, 1u);
+        }
+
+        TEST_F(WriteAssemblerTest, MessagesReusePooledStorage) {
+            auto bytes = Pattern(100);
+            ByteView view(bytes);
+            for (int round = 0; round < 3; ++round) {
+                for (size_t offset = 0; offset < view.size(); offset += kFull) {
+                    Prepare(1, offset, view.subview(offset, kFull));
+                }
+                auto result = Execute(1);
+                EXPECT_TRUE(result.message.view() == view);
+            }
+            const auto allocations = pool_.stats().allocations;
+            EXPECT_GT(pool_.stats().reuses, 0u);
+            Prepare(1, 0, view.subview(0, kFull));
+            Prepare(1, kFull, view.subview(kFull, 1));
+            Execute(1);
+            EXPECT_EQ(pool_.stats().allocations, allocations);
+        }
+
+        // Random writes, prepares, executes, clients and pauses against a
+        // plain model of the rules: whatever the assembler accepts or
+        // rejects, every message it completes or times out must be exactly
+        // what the model assembled.
+        TEST(WriteAssemblerFuzzTest, MatchesAReferenceModel) {
+            BufferPool pool(2);
+            const WriteAssemblerOptions options{ 300, milliseconds(50), 3 };
+            WriteAssembler assembler(pool, options);
+            using Key = std::pair<GattClientId, GattHandle>;
+            std::map<Key, std::pair<std::vector<uint8_t>, milliseconds>> model;
+            std::mt19937 random(20241017);
+            milliseconds now(0);
+            size_t messages = 0;
+            size_t timed_out = 0;
+
+            for (int step = 0; step < 50000; ++step) {
+                now += milliseconds(random() % 8);
+                for (const auto& write : assembler.Expire(now)) {
+                    auto it = model.find({ write.client, write.characteristic });
+                    ASSERT_TRUE(it != model.end()) << "step " << step;
+                    ASSERT_GE(now - it->second.second, options.timeout) << "step " << step;
+                    ASSERT_TRUE(write.message.view() == ByteView(it->second.first)) << "step " << step;
+                    model.erase(it);
+                    ++timed_out;
+                }
+                for (const auto& entry : model) {
+                    ASSERT_LT(now - entry.second.second, options.timeout) << "step " << step;
+                }
+
+                const GattClientId client = random() % 4;
+                const GattHandle characteristic = static_cast<GattHandle>(1 + random() % 2);
+                const auto roll = random() % 10;
+                const auto kind = roll < 2 ? GattWriteKind::kWrite
+                    : roll < 8 ? GattWriteKind::kPrepare
+                    : roll < 9 ? GattWriteKind::kExecute
+                    : GattWriteKind::kCancel;
+                const size_t full = (random() % 4 == 0 ? 247 : kMtu) - kAttPrepareWriteHeaderSize;
+                const size_t length = kind == GattWriteKind::kExecute || kind == GattWriteKind::kCancel ? 0
+                    : random() % 3 == 0 ? random() % (full + 8)
+                    : full;
+                auto fragment = Pattern(length, static_cast<uint8_t>(step));
+
+                const Key key(client, characteristic);
+                auto open = model.find(key);
+                const size_t assembled = open == model.end() ? 0 : open->second.first.size();
+                const size_t offset = random() % 5 == 0 ? random() % 400 : (random() % 2 ? assembled : 0);
+
+                auto result = assembler.Append(client, characteristic, kind, offset, fragment, now);
+                GattStatus expected = GattStatus::kSuccess;
+                std::optional<std::vector<uint8_t>> message;
+                switch (kind) {
+                case GattWriteKind::kWrite:
+                    if (offset != 0) {
+                        expected = GattStatus::kInvalidOffset;
+                    }
+                    else if (length > options.maxMessageSize) {
+                        expected = GattStatus::kInvalidAttributeValueLength;
+                    }
+                    else {
+                        message = fragment;
+                    }
+                    break;
+                case GattWriteKind::kExecute:
+                    if (open != model.end()) {
+                        message = open->second.first;
+                        model.erase(open);
+                    }
+                    break;
+                case GattWriteKind::kCancel:
+                    model.erase(key);
+                    break;
+                case GattWriteKind::kPrepare: {
+                    const size_t continued = offset == 0 ? 0 : assembled;
+                    if (offset == 0) model.erase(key);
+                    if (offset != continued) {
+                        expected = GattStatus::kInvalidOffset;
+                    }
+                    else if (continued + length > options.maxMessageSize) {
+                        expected = GattStatus::kInvalidAttributeValueLength;
+                    }
+                    else if (!model.count(key) && model.size() == options.maxAssemblies) {
+                        expected = GattStatus::kInsufficientResources;
+                    }
+                    if (expected == GattStatus::kSuccess) {
+                        auto& entry = model[key];
+                        entry.first.insert(entry.first.end(), fragment.begin(), fragment.end());
+                        entry.second = now;
+                    }
+                    else if (expected != GattStatus::kInsufficientResources) {
+                        model.erase(key);
+                    }
+                    break;
+                }
+                }
+
+                ASSERT_EQ(result.status, expected) << "step " << step;
+                ASSERT_EQ(result.complete, message.has_value()) << "step " << step;
+                if (message) {
+                    ASSERT_TRUE(result.message.view() == ByteView(*message)) << "step " << step;
+                    ++messages;
+                }
+                ASSERT_EQ(assembler.stats().open, model.size()) << "step " << step;
+            }
+            EXPECT_GT(messages, 1000u);
+            EXPECT_GT(timed_out, 10u);
+            EXPECT_EQ(assembler.stats().timedOut, timed_out);
+            EXPECT_LE(pool.stats().cached, 2u * (BufferPool::kMaxClass - BufferPool::kMinClass + 1));
+        }
+
+    }  // namespace
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,169 @@
+#include "write_assembler.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace flutter_ble_peripheral {
+
+    WriteAssembler::WriteAssembler(BufferPool& pool, WriteAssemblerOptions options)
+        : pool_(pool), options_(options) {
+        if (options_.maxAssemblies == 0) options_.maxAssemblies = 1;
+        options_.maxMessageSize = std::min(options_.maxMessageSize, size_t{ 1 } << BufferPool::kMaxClass);
+        assemblies_.reserve(options_.maxAssemblies);
+    }
+
+    AssembledWrite WriteAssembler::Append(GattClientId client, GattHandle characteristic, GattWriteKind kind,
+                                          size_t offset, ByteView fragment, std::chrono::nanoseconds now) {
+        AssembledWrite result;
+        ++stats_.fragments;
+        Assembly* assembly = Find(client, characteristic);
+
+        switch (kind) {
+        case GattWriteKind::kWrite:
+            // A whole message in one write skips the table.
+            if (offset != 0) return Reject(nullptr, GattStatus::kInvalidOffset);
+            if (fragment.size() > options_.maxMessageSize) {
+                return Reject(nullptr, GattStatus::kInvalidAttributeValueLength);
+            }
+            if (!fragment.empty()) {
+                PooledBytes bytes = pool_.Acquire(fragment.size());
+                bytes->assign(fragment.begin(), fragment.end());
+                result.message = pool_.Share(std::move(bytes));
+            }
+            result.complete = true;
+            ++stats_.messages;
+            stats_.bytes += fragment.size();
+            return result;
+        case GattWriteKind::kExecute:
+            // Nothing prepared executes as nothing.
+            if (!assembly) return result;
+            result.complete = true;
+            result.message = Close(*assembly);
+            return result;
+        case GattWriteKind::kCancel:
+            if (assembly) {
+                Drop(*assembly);
+                ++stats_.expired;
+            }
+            return result;
+        case GattWriteKind::kPrepare:
+            break;
+        }
+
+        // A prepare at offset 0 starts the long write over.
+        if (assembly && offset == 0) {
+            Drop(*assembly);
+            ++stats_.expired;
+            assembly = nullptr;
+        }
+        const size_t assembled = assembly ? assembly->bytes->size() : 0;
+        if (offset != assembled) return Reject(assembly, GattStatus::kInvalidOffset);
+        if (assembled + fragment.size() > options_.maxMessageSize) {
+            return Reject(assembly, GattStatus::kInvalidAttributeValueLength);
+        }
+
+        if (!assembly) {
+            if (assemblies_.size() == options_.maxAssemblies) {
+                return Reject(nullptr, GattStatus::kInsufficientResources);
+            }
+            const size_t capacity = std::min(
+                std::max(fragment.size(), kDefaultAttMtu - kAttPrepareWriteHeaderSize) * 4, options_.maxMessageSize);
+            PooledBytes bytes = pool_.Acquire(capacity);
+            if (!bytes) return Reject(nullptr, GattStatus::kInsufficientResources);
+            assemblies_.push_back({ client, characteristic, std::move(bytes), now });
+            assembly = &assemblies_.back();
+        }
+        if (!Reserve(*assembly, fragment.size())) return Reject(assembly, GattStatus::kInsufficientResources);
+        assembly->bytes->insert(assembly->bytes->end(), fragment.begin(), fragment.end());
+        assembly->lastFragment = now;
+        return result;
+    }
+
+    void WriteAssembler::OnClientDisconnected(GattClientId client) {
+        for (size_t i = 0; i < assemblies_.size();) {
+            if (assemblies_[i].client == client) {
+                Drop(assemblies_[i]);
+                ++stats_.expired;
+            }
+            else {
+                ++i;
+            }
+        }
+    }
+
+    const std::vector<TimedOutWrite>& WriteAssembler::Expire(std::chrono::nanoseconds now) {
+        timed_out_.clear();
+        for (size_t i = 0; i < assemblies_.size();) {
+            auto& assembly = assemblies_[i];
+            if (now - assembly.lastFragment >= options_.timeout) {
+                const GattClientId client = assembly.client;
+                const GattHandle characteristic = assembly.characteristic;
+                timed_out_.push_back({ client, characteristic, Close(assembly) });
+                ++stats_.timedOut;
+            }
+            else {
+                ++i;
+            }
+        }
+        return timed_out_;
+    }
+
+    std::optional<std::chrono::nanoseconds> WriteAssembler::NextTimeout() const {
+        std::optional<std::chrono::nanoseconds> next;
+        for (const auto& assembly : assemblies_) {
+            const auto due = assembly.lastFragment + options_.timeout;
+            if (!next || due < *next) next = due;
+        }
+        return next;
+    }
+
+    WriteAssembler::Stats WriteAssembler::stats() const {
+        Stats stats = stats_;
+        stats.open = assemblies_.size();
+        return stats;
+    }
+
+    WriteAssembler::Assembly* WriteAssembler::Find(GattClientId client, GattHandle characteristic) {
+        for (auto& assembly : assemblies_) {
+            if (assembly.client == client && assembly.characteristic == characteristic) return &assembly;
+        }
+        return nullptr;
+    }
+
+    AssembledWrite WriteAssembler::Reject(Assembly* assembly, GattStatus status) {
+        if (assembly) Drop(*assembly);
+        ++stats_.rejected;
+        AssembledWrite result;
+        result.status = status;
+        return result;
+    }
+
+    SharedBuffer WriteAssembler::Close(Assembly& assembly) {
+        ++stats_.messages;
+        stats_.bytes += assembly.bytes->size();
+        SharedBuffer message;
+        if (!assembly.bytes->empty()) message = pool_.Share(std::move(assembly.bytes));
+        Drop(assembly);
+        return message;
+    }
+
+    void WriteAssembler::Drop(Assembly& assembly) {
+        pool_.Release(std::move(assembly.bytes));
+        // Swap-remove; callers iterating by index revisit this slot.
+        if (&assembly != &assemblies_.back()) assembly = std::move(assemblies_.back());
+        assemblies_.pop_back();
+    }
+
+    bool WriteAssembler::Reserve(Assembly& assembly, size_t extra) {
+        auto& bytes = assembly.bytes;
+        const size_t needed = bytes->size() + extra;
+        if (needed <= bytes->capacity()) return true;
+        PooledBytes larger = pool_.Acquire(std::max(needed, bytes->capacity() * 2));
+        if (!larger) return false;
+        larger->assign(bytes->begin(), bytes->end());
+        pool_.Release(std::move(bytes));
+        bytes = std::move(larger);
+        return true;
+    }
+
+}  // namespace flutter_ble_peripheral
@@ -0,0 +1,136 @@
+#ifndef FLUTTER_BLE_PERIPHERAL_CORE_WRITE_ASSEMBLER_H_
+#define FLUTTER_BLE_PERIPHERAL_CORE_WRITE_ASSEMBLER_H_
+
+#include "buffer_pool.h"
+#include "byte_buffer.h"
+#include "gatt_transport.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace flutter_ble_peripheral {
+
+    // Payload of a prepare write request: ATT_MTU minus the opcode, handle
+    // and value offset.
+    inline constexpr size_t kAttPrepareWriteHeaderSize = 5;
+
+    struct WriteAssemblerOptions {
+        // Messages above this are rejected, along with everything assembled
+        // for them so far. Capped at BufferPool's largest class.
+        size_t maxMessageSize = 64 * 1024;
+        // A long write that has seen no fragment for this long is closed by
+        // Expire without waiting any longer for its execute.
+        std::chrono::nanoseconds timeout = std::chrono::seconds(5);
+        // Long writes open at once, across all clients.
+        size_t maxAssemblies = 16;
+    };
+
+    // Outcome of WriteAssembler::Append.
+    struct AssembledWrite {
+        // Sent back to the client; anything but kSuccess also drops the
+        // assembly.
+        GattStatus status = GattStatus::kSuccess;
+        // Set when the write finished a message, which may be empty.
+        bool complete = false;
+        SharedBuffer message;
+    };
+
+    // A long write Expire closed before its execute came.
+    struct TimedOutWrite {
+        GattClientId client = 0;
+        GattHandle characteristic = 0;
+        // Everything prepared before the timeout.
+        SharedBuffer message;
+    };
+
+    // Reassembles long writes, one assembly per (client, characteristic).
+    //
+    // A write request or command is a message of its own, whatever its
+    // size; it neither needs nor touches an open long write. Prepare writes
+    // open an assembly at offset 0 and continue it at the offset where the
+    // previous one ended, until the execute write turns the assembly into a
+    // message or a cancel drops it. Stacks that queue prepared writes
+    // themselves and hand over the executed value report it as a plain
+    // write.
+    //
+    // A long write whose execute never comes is not lost: Expire closes it
+    // after the timeout and hands out what was prepared, so the owner can
+    // still deliver it.
+    //
+    // Messages are built in BufferPool vectors and handed out as
+    // SharedBuffers over them, so a delivered message is never copied and
+    // its storage returns to the pool when the last copy is dropped. Not
+    // thread-safe; the owner serializes calls.
+    class WriteAssembler {
+    public:
+        struct Stats {
+            uint64_t fragments = 0;
+            uint64_t messages = 0;
+            uint64_t bytes = 0;
+            // Writes answered with an error.
+            uint64_t rejected = 0;
+            // Long writes dropped by a cancel, a restart at offset 0 or a
+            // disconnect.
+            uint64_t expired = 0;
+            // Long writes closed by Expire; also counted in messages.
+            uint64_t timedOut = 0;
+            size_t open = 0;
+        };
+
+        explicit WriteAssembler(BufferPool& pool, WriteAssemblerOptions options = {});
+
+        // Disallow copy and assign.
+        WriteAssembler(const WriteAssembler&) = delete;
+        WriteAssembler& operator=(const WriteAssembler&) = delete;
+
+        // Handles a |kind| write |client| made to |characteristic| at
+        // |offset|, at time |now|. |fragment| is empty for an execute or a
+        // cancel.
+        AssembledWrite Append(GattClientId client, GattHandle characteristic, GattWriteKind kind,
+                              size_t offset, ByteView fragment, std::chrono::nanoseconds now);
+
+        // Drops everything |client| was writing.
+        void OnClientDisconnected(GattClientId client);
+
+        // Closes long writes idle since before |now| - timeout and returns
+        // what they had assembled. The vector is reused by the next call.
+        const std::vector<TimedOutWrite>& Expire(std::chrono::nanoseconds now);
+
+        // When the oldest open long write times out, or nullopt if none is
+        // open.
+        std::optional<std::chrono::nanoseconds> NextTimeout() const;
+
+        const WriteAssemblerOptions& options() const { return options_; }
+        Stats stats() const;
+
+    private:
+        struct Assembly {
+            GattClientId client = 0;
+            GattHandle characteristic = 0;
+            PooledBytes bytes;
+            std::chrono::nanoseconds lastFragment{ 0 };
+        };
+
+        Assembly* Find(GattClientId client, GattHandle characteristic);
+        AssembledWrite Reject(Assembly* assembly, GattStatus status);
+        // Turns |assembly| into a message and removes it from the table.
+        SharedBuffer Close(Assembly& assembly);
+        void Drop(Assembly& assembly);
+        // Makes room for |extra| more bytes in |assembly|, moving it to a
+        // larger pooled vector if needed.
+        bool Reserve(Assembly& assembly, size_t extra);
+
+        BufferPool& pool_;
+        WriteAssemblerOptions options_;
+        // At most options_.maxAssemblies entries; slots are reused.
+        std::vector<Assembly> assemblies_;
+        std::vector<TimedOutWrite> timed_out_;
+        Stats stats_;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_BLE_PERIPHERAL_CORE_WRITE_ASSEMBLER_H_
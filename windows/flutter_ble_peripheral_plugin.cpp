@@ -28,12 +28,204 @@
 // For getPlatformVersion; remove unless needed for your plugin implementation.
 #include <VersionHelpers.h>
 
+#include "core/ad_encoder.h"
+#include "core/method_arguments.h"
+#include "core/method_dispatch.h"
+
 #pragma warning( push )
 #pragma warning( disable : 4101)
 #pragma warning( disable : 4244)
 
 namespace flutter_ble_peripheral {
 
+    constexpr char kScanResultBinaryChannel[] = "dev.steenbakker.flutter_ble_peripheral/scan_result_binary";
+    constexpr char kDataReceivedChannel[] = "dev.steenbakker.flutter_ble_peripheral/ble_data_received";
+
+    // Room for a few seconds of a busy scan; scan results leave the last
+    // kPlatformEventReserve slots to status changes and flush requests.
+    constexpr size_t kPlatformEventCapacity = 1024;
+    constexpr size_t kPlatformEventReserve = 64;
+    // Events handled per drain message before yielding back to the message loop.
+    constexpr size_t kPlatformEventsPerDrain = 256;
+
+    namespace {
+
+        UINT DrainMessage() {
+            static const UINT message = RegisterWindowMessage(L"FlutterBlePeripheralDrainEvents");
+            return message;
+        }
+
+        // Returns why |data| cannot be advertised, if it cannot. The WinRT
+        // publisher sends legacy advertisements without a scan response and
+        // carries only the manufacturer record, so that record has to fit in
+        // one 31-byte payload next to the flags. Fields it does not send are
+        // not counted.
+        std::optional<std::string> CheckAdvertiseData(const AdvertiseData& data) {
+            const AdvertiseData published = ManufacturerDataOnly(data);
+            AdvertisePayload payload(kLegacyAdvertisingDataSize, false);
+            if (EncodeAdvertiseData(published, payload)) return std::nullopt;
+            return std::string("manufacturerData does not fit in the 31-byte advertisement");
+        }
+
+        // The service and characteristics the iOS and Android sides use for
+        // sendData: the peripheral notifies on tx and clients write to rx.
+        constexpr char kDataServiceUuid[] = "8ebdb2f3-7817-45c9-95c5-c5e9031aaa47";
+        constexpr char kDataTxCharacteristicUuid[] = "08590F7E-DB05-467E-8757-72F6FAEB13D4";
+        constexpr char kDataRxCharacteristicUuid[] = "08590F7E-DB05-467E-8757-72F6FAEB13D5";
+
+        // Decodes an addGattService argument map. Returns nullopt if a UUID
+        // does not parse or a value is too long.
+        std::optional<GattService> DecodeGattService(const EncodableMap& arguments) {
+            const auto* uuid = GetString(FindArgument(arguments, Argument::kUuid));
+            auto service_uuid = uuid ? ParseBluetoothUuid(*uuid) : std::nullopt;
+            if (!service_uuid) return std::nullopt;
+
+            GattService service;
+            service.uuid = *service_uuid;
+            const auto* list = std::get_if<flutter::EncodableList>(FindArgument(arguments, Argument::kCharacteristics));
+            if (!list) return service;
+            for (const auto& entry : *list) {
+                const auto* map = std::get_if<EncodableMap>(&entry);
+                if (!map) return std::nullopt;
+                const auto* characteristic_uuid = GetString(FindArgument(*map, Argument::kUuid));
+                auto parsed = characteristic_uuid ? ParseBluetoothUuid(*characteristic_uuid) : std::nullopt;
+                if (!parsed) return std::nullopt;
+
+                GattCharacteristic characteristic;
+                characteristic.uuid = *parsed;
+                characteristic.properties = static_cast<uint8_t>(
+                    GetInt(FindArgument(*map, Argument::kProperties)).value_or(0) & 0xFF);
+                if (const auto* value = GetBytes(FindArgument(*map, Argument::kValue))) {
+                    if (value->size() > kGattMaxAttributeSize) return std::nullopt;
+                    characteristic.value = SharedBuffer::CopyFrom(*value);
+                }
+                service.characteristics.push_back(std::move(characteristic));
+            }
+            return service;
+        }
+
+        // Decodes a setScanFilter argument map. Returns nullopt if an entry
+        // has the wrong type or a UUID does not parse.
+        std::optional<ScanFilterSpec> DecodeScanFilterSpec(const EncodableMap& arguments) {
+            ScanFilterSpec spec;
+            if (const auto* list = std::get_if<flutter::EncodableList>(FindArgument(arguments, Argument::kCompanyIds))) {
+                for (const auto& entry : *list) {
+                    auto id = GetInt(&entry);
+                    if (!id || *id < 0 || *id > 0xFFFF) return std::nullopt;
+                    spec.companyIds.push_back(static_cast<uint16_t>(*id));
+                }
+            }
+            if (const auto* list = std::get_if<flutter::EncodableList>(FindArgument(arguments, Argument::kServiceUuids))) {
+                for (const auto& entry : *list) {
+                    const auto* uuid = GetString(&entry);
+                    auto parsed = uuid ? ParseBluetoothUuid(*uuid) : std::nullopt;
+                    if (!parsed) return std::nullopt;
+                    spec.serviceUuids.push_back(*parsed);
+                }
+            }
+            if (const auto* list = std::get_if<flutter::EncodableList>(FindArgument(arguments, Argument::kManufacturerData))) {
+                for (const auto& entry : *list) {
+                    const auto* map = std::get_if<EncodableMap>(&entry);
+                    auto id = map ? GetInt(FindArgument(*map, Argument::kCompanyId)) : std::nullopt;
+                    if (!id || *id < 0 || *id > 0xFFFF) return std::nullopt;
+                    ManufacturerDataPattern pattern;
+                    pattern.companyId = static_cast<uint16_t>(*id);
+                    if (const auto* prefix = GetBytes(FindArgument(*map, Argument::kPrefix))) pattern.prefix = *prefix;
+                    if (const auto* mask = GetBytes(FindArgument(*map, Argument::kMask))) pattern.mask = *mask;
+                    spec.manufacturerData.push_back(std::move(pattern));
+                }
+            }
+            if (const auto* list = std::get_if<flutter::EncodableList>(FindArgument(arguments, Argument::kNamePrefixes))) {
+                for (const auto& entry : *list) {
+                    const auto* name = GetString(&entry);
+                    if (!name) return std::nullopt;
+                    spec.namePrefixes.push_back(*name);
+                }
+            }
+            if (auto rssi = GetInt(FindArgument(arguments, Argument::kMinRssi))) {
+                spec.minRssi = static_cast<int16_t>(std::clamp<int64_t>(*rssi, -127, 20));
+            }
+            return spec;
+        }
+
+        int64_t ToMicros(std::chrono::nanoseconds duration) {
+            return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        }
+
+        EncodableMap ScanSessionStatsToMap(const ScanSession::Stats& stats) {
+            return EncodableMap{
+                {"scanMode", static_cast<int32_t>(stats.settings.mode)},
+                {"intervalMicros", static_cast<int64_t>(stats.settings.interval.count())},
+                {"windowMicros", static_cast<int64_t>(stats.settings.window.count())},
+                {"active", stats.active},
+                {"elapsedMicros", ToMicros(stats.elapsed)},
+                {"scanningMicros", ToMicros(stats.scanning)},
+                {"windows", static_cast<int64_t>(stats.windows)},
+                {"refusedWindows", static_cast<int64_t>(stats.refusedWindows)},
+                {"advertisements", static_cast<int64_t>(stats.advertisements)},
+                {"dutyCycle", stats.dutyCycle},
+                {"advertisementsPerSecond", stats.advertisementsPerSecond},
+            };
+        }
+
+        EncodableMap ScanCaptureStatsToMap(const ScanCaptureWriter::Stats& stats) {
+            return EncodableMap{
+                {"records", static_cast<int64_t>(stats.records)},
+                {"dropped", static_cast<int64_t>(stats.dropped)},
+                {"bytes", static_cast<int64_t>(stats.bytes)},
+                {"failed", stats.failed},
+            };
+        }
+
+        EncodableMap ScanReplayToMap(const BackgroundScanReplay* replay) {
+            return EncodableMap{
+                {"delivered", static_cast<int64_t>(replay ? replay->delivered() : 0)},
+                {"finished", replay && replay->finished()},
+            };
+        }
+
+        EncodableMap LatencyToMap(const LatencyHistogram& histogram) {
+            return EncodableMap{
+                {"count", static_cast<int64_t>(histogram.count())},
+                {"minNanos", static_cast<int64_t>(histogram.min())},
+                {"maxNanos", static_cast<int64_t>(histogram.max())},
+                {"meanNanos", histogram.mean()},
+                {"p50Nanos", static_cast<int64_t>(histogram.ValueAtPercentile(50))},
+                {"p90Nanos", static_cast<int64_t>(histogram.ValueAtPercentile(90))},
+                {"p99Nanos", static_cast<int64_t>(histogram.ValueAtPercentile(99))},
+                {"p999Nanos", static_cast<int64_t>(histogram.ValueAtPercentile(99.9))},
+            };
+        }
+
+        EncodableMap MetricsToMap(const Metrics::Snapshot& snapshot) {
+            EncodableMap counters;
+            for (size_t i = 0; i < kMetricCounterCount; ++i) {
+                counters.emplace(EncodableValue(std::string(kMetricCounterNames[i])),
+                                 EncodableValue(static_cast<int64_t>(snapshot.counters[i])));
+            }
+            EncodableMap latencies;
+            for (size_t i = 0; i < kMetricLatencyCount; ++i) {
+                latencies.emplace(EncodableValue(std::string(kMetricLatencyNames[i])),
+                                  EncodableValue(LatencyToMap(snapshot.latency(static_cast<MetricLatency>(i)))));
+            }
+            // Only the methods that were called.
+            EncodableMap methods;
+            for (size_t i = 0; i < kMethodCount; ++i) {
+                const auto method = static_cast<Method>(i);
+                if (snapshot.method(method).empty()) continue;
+                methods.emplace(EncodableValue(std::string(MethodName(method))),
+                                EncodableValue(LatencyToMap(snapshot.method(method))));
+            }
+            return EncodableMap{
+                {"enabled", snapshot.enabled},
+                {"counters", std::move(counters)},
+                {"latencies", std::move(latencies)},
+                {"methods", std::move(methods)},
+            };
+        }
+
+    }  // namespace
+
     // static
     void FlutterBlePeripheralPlugin::RegisterWithRegistrar(
         flutter::PluginRegistrarWindows* registrar) {
@@ -42,8 +234,8 @@ namespace flutter_ble_peripheral {
                 registrar->messenger(), "dev.steenbakker.flutter_ble_peripheral/ble_state",
                 &flutter::StandardMethodCodec::GetInstance());
 
-        auto channelState =
-            std::make_unique<flutter::MethodChannel<flutter::EncodableValue>>(
+        auto event_state_changed =
+            std::make_unique<flutter::EventChannel<flutter::EncodableValue>>(
                 registrar->messenger(), "dev.steenbakker.flutter_ble_peripheral/ble_state_changed",
                 &flutter::StandardMethodCodec::GetInstance());
 
@@ -52,7 +244,22 @@ namespace flutter_ble_peripheral {
                 registrar->messenger(), "dev.steenbakker.flutter_ble_peripheral/scan_result",
                 &flutter::StandardMethodCodec::GetInstance());
 
-        auto plugin = std::make_unique<FlutterBlePeripheralPlugin>();
+        auto event_mtu_changed =
+            std::make_unique<flutter::EventChannel<flutter::EncodableValue>>(
+                registrar->messenger(), "dev.steenbakker.flutter_ble_peripheral/ble_mtu_changed",
+                &flutter::StandardMethodCodec::GetInstance());
+
+        auto event_send_progress =
+            std::make_unique<flutter::EventChannel<flutter::EncodableValue>>(
+                registrar->messenger(), "dev.steenbakker.flutter_ble_peripheral/ble_send_progress",
+                &flutter::StandardMethodCodec::GetInstance());
+
+        auto event_metrics =
+            std::make_unique<flutter::EventChannel<flutter::EncodableValue>>(
+                registrar->messenger(), "dev.steenbakker.flutter_ble_peripheral/ble_metrics",
+                &flutter::StandardMethodCodec::GetInstance());
+
+        auto plugin = std::make_unique<FlutterBlePeripheralPlugin>(registrar);
 
         channel->SetMethodCallHandler(
             [plugin_pointer = plugin.get()](const auto& call, auto result) {
@@ -73,136 +280,1309 @@ namespace flutter_ble_peripheral {
                 });
         event_scan_result->SetStreamHandler(std::move(handler));
 
+        auto state_handler = std::make_unique<
+            flutter::StreamHandlerFunctions<>>(
+                [plugin_pointer = plugin.get()](
+                    const flutter::EncodableValue* arguments,
+                    std::unique_ptr<flutter::EventSink<>>&& events)
+                -> std::unique_ptr<flutter::StreamHandlerError<>> {
+                    return plugin_pointer->OnStateListen(std::move(events));
+                },
+                [plugin_pointer = plugin.get()](const flutter::EncodableValue* arguments)
+                    -> std::unique_ptr<flutter::StreamHandlerError<>> {
+                    return plugin_pointer->OnStateCancel();
+                });
+        event_state_changed->SetStreamHandler(std::move(state_handler));
+
+        auto send_progress_handler = std::make_unique<
+            flutter::StreamHandlerFunctions<>>(
+                [plugin_pointer = plugin.get()](
+                    const flutter::EncodableValue* arguments,
+                    std::unique_ptr<flutter::EventSink<>>&& events)
+                -> std::unique_ptr<flutter::StreamHandlerError<>> {
+                    return plugin_pointer->OnSendProgressListen(std::move(events));
+                },
+                [plugin_pointer = plugin.get()](const flutter::EncodableValue* arguments)
+                    -> std::unique_ptr<flutter::StreamHandlerError<>> {
+                    return plugin_pointer->OnSendProgressCancel();
+                });
+        event_send_progress->SetStreamHandler(std::move(send_progress_handler));
 
+        auto mtu_handler = std::make_unique<
+            flutter::StreamHandlerFunctions<>>(
+                [plugin_pointer = plugin.get()](
+                    const flutter::EncodableValue* arguments,
+                    std::unique_ptr<flutter::EventSink<>>&& events)
+                -> std::unique_ptr<flutter::StreamHandlerError<>> {
+                    return plugin_pointer->OnMtuListen(std::move(events));
+                },
+                [plugin_pointer = plugin.get()](const flutter::EncodableValue* arguments)
+                    -> std::unique_ptr<flutter::StreamHandlerError<>> {
+                    return plugin_pointer->OnMtuCancel();
+                });
+        event_mtu_changed->SetStreamHandler(std::move(mtu_handler));
+
+        auto metrics_handler = std::make_unique<
+            flutter::StreamHandlerFunctions<>>(
+                [plugin_pointer = plugin.get()](
+                    const flutter::EncodableValue* arguments,
+                    std::unique_ptr<flutter::EventSink<>>&& events)
+                -> std::unique_ptr<flutter::StreamHandlerError<>> {
+                    return plugin_pointer->OnMetricsListen(arguments, std::move(events));
+                },
+                [plugin_pointer = plugin.get()](const flutter::EncodableValue* arguments)
+                    -> std::unique_ptr<flutter::StreamHandlerError<>> {
+                    return plugin_pointer->OnMetricsCancel();
+                });
+        event_metrics->SetStreamHandler(std::move(metrics_handler));
 
         registrar->AddPlugin(std::move(plugin));
     }
 
-    FlutterBlePeripheralPlugin::FlutterBlePeripheralPlugin() {
-        InitializeAsync();
+    FlutterBlePeripheralPlugin::FlutterBlePeripheralPlugin(flutter::PluginRegistrarWindows* registrar)
+        : registrar_(registrar),
+          messenger_(registrar->messenger()),
+          events_(kPlatformEventCapacity, [this] {
+              const HWND window = platform_window_.load(std::memory_order_acquire);
+              return window && PostMessage(window, DrainMessage(), 0, 0);
+          }),
+          backend_(
+            metrics_,
+            [this, guard = callback_guard_](PublisherStatus status, uint64_t publisher) {
+                auto scope = guard->Enter();
+                if (!scope) return;
+                const auto now = clock_.Now();
+                if (status == PublisherStatus::started) {
+                    startup_.Mark(StartupMilestone::kFirstAdvertisement, now);
+                }
+                const bool changed = state_.SetPublisher(status, now);
+                events_.PostWith([status, publisher](PlatformEvent& event) {
+                    event.kind = PlatformEvent::Kind::kPublisherStatus;
+                    event.status = status;
+                    event.publisher = publisher;
+                });
+                if (changed) PostStateChanged();
+            },
+            [this, guard = callback_guard_](const ScanResult& result) {
+                auto scope = guard->Enter();
+                if (!scope) return;
+                OnScanResult(result);
+            }),
+          core_(backend_),
+          scheduler_(core_, clock_),
+          gatt_transport_(GattCallbacks()) {
+        HWND window = nullptr;
+        if (auto* view = registrar_->GetView()) {
+            window = GetAncestor(view->GetNativeWindow(), GA_ROOT);
+        }
+        if (!window) {
+            message_window_ = CreateMessageWindow();
+            window = message_window_;
+        }
+        platform_window_.store(window, std::memory_order_release);
+        window_proc_id_ = registrar_->RegisterTopLevelWindowProcDelegate(
+            [this](HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam) {
+                return HandleWindowProc(hwnd, message, wparam, lparam);
+            });
+        initialization_ = InitializeAsync();
+    }
+
+    FlutterBlePeripheralPlugin::~FlutterBlePeripheralPlugin() {
+        // Cancelled first so that it unwinds at its pending co_await rather
+        // than run on while the guard below waits for it.
+        if (initialization_ && initialization_.Status() == AsyncStatus::Started) {
+            initialization_.Cancel();
+        }
+        // Timer, radio, backend and GATT callbacks and InitializeAsync
+        // already running finish before anything they touch goes away;
+        // later ones return at once. Neither lock may be held here, as the
+        // callbacks take them.
+        callback_guard_->Shutdown();
+        // Its handlers touch the transport itself, and gatt_ is destroyed
+        // before it.
+        gatt_transport_.Shutdown();
+        // Every thread that posts events has stopped, so nothing reads the
+        // window any more.
+        platform_window_.store(nullptr, std::memory_order_release);
+        registrar_->UnregisterTopLevelWindowProcDelegate(window_proc_id_);
+        if (message_window_) {
+            DestroyWindow(message_window_);
+        }
+        if (bluetoothRadio) {
+            bluetoothRadio.StateChanged(bluetoothRadioStateChangedToken);
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (scheduler_timer_) {
+            scheduler_timer_.Cancel();
+        }
+        if (scan_session_timer_) {
+            scan_session_timer_.Cancel();
+        }
+        scan_session_.Stop();
+        if (scan_replay_) {
+            scan_replay_->Stop();
+        }
+        if (scan_capture_) {
+            backend_.SetScanCapture(nullptr);
+            scan_capture_->Close();
+        }
+        if (scan_flush_timer_) {
+            scan_flush_timer_.Cancel();
+        }
+        if (state_debounce_timer_) {
+            state_debounce_timer_.Cancel();
+        }
+        if (metrics_timer_) {
+            metrics_timer_.Cancel();
+        }
+    }
+
+    WinRtGattTransport::Callbacks FlutterBlePeripheralPlugin::GattCallbacks() {
+        // Each callback enters callback_guard_ before it touches the plugin,
+        // as the timer callbacks do.
+        WinRtGattTransport::Callbacks callbacks;
+        callbacks.connected = [this, guard = callback_guard_](GattClientId client) {
+            auto scope = guard->Enter();
+            if (!scope) return;
+            OnGattClientChanged(client, true);
+        };
+        callbacks.disconnected = [this, guard = callback_guard_](GattClientId client) {
+            auto scope = guard->Enter();
+            if (!scope) return;
+            OnGattClientChanged(client, false);
+        };
+        callbacks.subscriptionChanged = [this, guard = callback_guard_](GattClientId client, GattHandle characteristic,
+                                                                        GattSubscription subscription) {
+            auto scope = guard->Enter();
+            if (!scope) return;
+            std::lock_guard<std::mutex> lock(gatt_mutex_);
+            gatt_.OnSubscriptionChanged(client, characteristic, subscription);
+        };
+        callbacks.mtuChanged = [this, guard = callback_guard_](GattClientId client, size_t mtu) {
+            auto scope = guard->Enter();
+            if (!scope) return;
+            {
+                std::lock_guard<std::mutex> lock(gatt_mutex_);
+                if (!gatt_.OnMtuChanged(client, mtu)) return;
+                mtu = gatt_.mtu(client);
+            }
+            events_.PostWith([client, mtu](PlatformEvent& event) {
+                event.kind = PlatformEvent::Kind::kMtuChanged;
+                event.client = client;
+                event.mtu = mtu;
+            });
+        };
+        callbacks.read = [this, guard = callback_guard_](GattClientId client, GattHandle characteristic,
+                                                         size_t offset) {
+            auto scope = guard->Enter();
+            if (!scope) return GattReadResult{ GattStatus::kUnlikelyError };
+            std::lock_guard<std::mutex> lock(gatt_mutex_);
+            return gatt_.OnRead(client, characteristic, offset);
+        };
+        callbacks.write = [this, guard = callback_guard_](GattClientId client, GattHandle characteristic,
+                                                          GattWriteKind kind, size_t offset, ByteView value,
+                                                          bool with_response) {
+            auto scope = guard->Enter();
+            if (!scope) return GattStatus::kUnlikelyError;
+            std::lock_guard<std::mutex> lock(gatt_mutex_);
+            if (data_rx_ && characteristic == data_rx_) return OnDataWrite(client, kind, offset, value);
+            return gatt_.OnWrite(client, characteristic, offset, value, with_response);
+        };
+        // Credits go through the platform thread: the stack may complete a
+        // notification inside SendValue, while Pump holds gatt_mutex_.
+        callbacks.sent = [this, guard = callback_guard_](GattClientId client, GattHandle, const SharedBuffer& value,
+                                                         bool delivered) {
+            auto scope = guard->Enter();
+            if (!scope) return;
+            events_.PostWith([&](PlatformEvent& event) {
+                event.kind = PlatformEvent::Kind::kGattValueSent;
+                event.client = client;
+                event.value = value;
+                event.delivered = delivered;
+            });
+        };
+        return callbacks;
     }
 
-    FlutterBlePeripheralPlugin::~FlutterBlePeripheralPlugin() {}
+    void FlutterBlePeripheralPlugin::OnGattClientChanged(GattClientId client, bool connected) {
+        bool any_connected = false;
+        {
+            std::lock_guard<std::mutex> lock(gatt_mutex_);
+            if (connected) {
+                gatt_.OnClientConnected(client);
+            }
+            else {
+                gatt_.OnClientDisconnected(client);
+                streamer_.OnClientDisconnected(client);
+                write_assembler_.OnClientDisconnected(client);
+            }
+            any_connected = gatt_.connected();
+        }
+        if (!connected) {
+            events_.PostWith([](PlatformEvent& event) {
+                event.kind = PlatformEvent::Kind::kDataStreamsChanged;
+            });
+        }
+        if (state_.SetConnected(any_connected, clock_.Now())) {
+            PostStateChanged();
+        }
+    }
+
+    bool FlutterBlePeripheralPlugin::EnsureDataService() {
+        if (data_tx_) return true;
+        GattService service;
+        service.uuid = *ParseBluetoothUuid(kDataServiceUuid);
+        service.characteristics.push_back(
+            { *ParseBluetoothUuid(kDataTxCharacteristicUuid), kGattRead | kGattNotify, {} });
+        service.characteristics.push_back(
+            { *ParseBluetoothUuid(kDataRxCharacteristicUuid), kGattRead | kGattWrite | kGattWriteWithoutResponse, {} });
+        if (!gatt_.AddService(service)) return false;
+        data_tx_ = service.characteristics[0].handle;
+        data_rx_ = service.characteristics[1].handle;
+        return true;
+    }
+
+    GattStatus FlutterBlePeripheralPlugin::OnDataWrite(GattClientId client, GattWriteKind kind, size_t offset,
+                                                       ByteView value) {
+        auto write = write_assembler_.Append(client, data_rx_, kind, offset, value, clock_.Now());
+        if (write.complete) PostDataReceived(std::move(write.message));
+        return write.status;
+    }
+
+    void FlutterBlePeripheralPlugin::PostDataReceived(SharedBuffer message) {
+        if (message.empty()) return;
+        events_.PostWith([&message](PlatformEvent& event) {
+            event.kind = PlatformEvent::Kind::kDataReceived;
+            event.value = std::move(message);
+        });
+    }
+
+    void FlutterBlePeripheralPlugin::PumpDataStreams() {
+        std::vector<StreamProgress> reports;
+        {
+            std::lock_guard<std::mutex> lock(gatt_mutex_);
+            streamer_.Pump();
+            reports = streamer_.TakeProgress();
+        }
+        for (const auto& report : reports) {
+            if (send_progress_sink_) {
+                send_progress_sink_->Success(EncodableMap{
+                    {"stream", static_cast<int64_t>(report.id)},
+                    {"totalBytes", static_cast<int64_t>(report.totalBytes)},
+                    {"sentBytes", static_cast<int64_t>(report.sentBytes)},
+                    {"chunks", static_cast<int64_t>(report.chunks)},
+                    {"elapsedMicros", static_cast<int64_t>(report.elapsed.count() / 1000)},
+                    {"bytesPerSecond", report.bytesPerSecond()},
+                    {"done", report.done},
+                    {"failed", report.failed},
+                    });
+            }
+            if (!report.done) continue;
+
+            for (auto call = pending_send_data_.begin(); call != pending_send_data_.end(); ++call) {
+                auto stream = std::find(call->streams.begin(), call->streams.end(), report.id);
+                if (stream == call->streams.end()) continue;
+                call->streams.erase(stream);
+                call->failed |= report.failed;
+                if (call->streams.empty()) {
+                    const auto duration = clock_.Now() - call->started;
+                    const double seconds = std::chrono::duration<double>(duration).count();
+                    const auto total = static_cast<double>(call->bytes * call->clients);
+                    call->result->Success(EncodableMap{
+                        {"bytes", static_cast<int64_t>(call->bytes)},
+                        {"clients", static_cast<int32_t>(call->clients)},
+                        {"failed", call->failed},
+                        {"durationMicros", static_cast<int64_t>(duration.count() / 1000)},
+                        {"bytesPerSecond", seconds > 0 ? total / seconds : 0.0},
+                        });
+                    pending_send_data_.erase(call);
+                }
+                break;
+            }
+        }
+    }
+
+    std::unique_ptr<flutter::StreamHandlerError<>> FlutterBlePeripheralPlugin::OnSendProgressListen(
+        std::unique_ptr<flutter::EventSink<>>&& events) {
+        send_progress_sink_ = std::move(events);
+        return nullptr;
+    }
+
+    std::unique_ptr<flutter::StreamHandlerError<>> FlutterBlePeripheralPlugin::OnSendProgressCancel() {
+        send_progress_sink_ = nullptr;
+        return nullptr;
+    }
+
+    std::unique_ptr<flutter::StreamHandlerError<>> FlutterBlePeripheralPlugin::OnMtuListen(
+        std::unique_ptr<flutter::EventSink<>>&& events) {
+        mtu_sink_ = std::move(events);
+        return nullptr;
+    }
+
+    std::unique_ptr<flutter::StreamHandlerError<>> FlutterBlePeripheralPlugin::OnMtuCancel() {
+        mtu_sink_ = nullptr;
+        return nullptr;
+    }
+
+    std::unique_ptr<flutter::StreamHandlerError<>> FlutterBlePeripheralPlugin::OnMetricsListen(
+        const flutter::EncodableValue* arguments, std::unique_ptr<flutter::EventSink<>>&& events) {
+        const int64_t interval_ms = GetInt(arguments).value_or(1000);
+        if (metrics_timer_) metrics_timer_.Cancel();
+        metrics_sink_ = std::move(events);
+        metrics_timer_ = ThreadPoolTimer::CreatePeriodicTimer(
+            [this, guard = callback_guard_](ThreadPoolTimer const&) {
+                auto scope = guard->Enter();
+                if (!scope) return;
+                events_.PostWith([](PlatformEvent& event) {
+                    event.kind = PlatformEvent::Kind::kMetricsTick;
+                });
+            },
+            std::chrono::duration_cast<TimeSpan>(std::chrono::milliseconds(std::max<int64_t>(interval_ms, 10))));
+        return nullptr;
+    }
+
+    std::unique_ptr<flutter::StreamHandlerError<>> FlutterBlePeripheralPlugin::OnMetricsCancel() {
+        if (metrics_timer_) {
+            metrics_timer_.Cancel();
+            metrics_timer_ = nullptr;
+        }
+        metrics_sink_ = nullptr;
+        return nullptr;
+    }
+
+    IAsyncAction FlutterBlePeripheralPlugin::InitializeAsync() {
+        // Cancelling this cancels the lookup it is waiting on, so the
+        // destructor's Cancel ends it at its next co_await.
+        auto cancellation = co_await winrt::get_cancellation_token();
+        cancellation.enable_propagation();
+        // Held to the end, so the destructor waits for this to finish or
+        // unwind. Only ever held off the platform thread, which the
+        // destructor blocks.
+        auto guard = callback_guard_;
+        // Let the constructor return; the platform thread defers method calls
+        // until this finishes.
+        co_await winrt::resume_background();
+        auto scope = guard->Enter();
+        if (!scope) co_return;
+
+        // The radio can only be had from the adapter, so those two lookups
+        // are sequential. Loading the publisher's activation factory does not
+        // depend on either and overlaps with the adapter lookup.
+        auto adapterOperation = BluetoothAdapter::GetDefaultAsync();
+        winrt::get_activation_factory<BluetoothLEAdvertisementPublisher>();
+        auto bluetoothAdapter = co_await adapterOperation;
+        startup_.Mark(StartupMilestone::kAdapter, clock_.Now());
+        if (!bluetoothAdapter) {
+            FinishInitialization("no Bluetooth adapter");
+            co_return;
+        }
+        if (state_.SetSupported(bluetoothAdapter.IsPeripheralRoleSupported(), clock_.Now())) {
+            PostStateChanged();
+        }
 
-    winrt::fire_and_forget FlutterBlePeripheralPlugin::InitializeAsync() {
-        auto bluetoothAdapter = co_await BluetoothAdapter::GetDefaultAsync();
         bluetoothRadio = co_await bluetoothAdapter.GetRadioAsync();
+        startup_.Mark(StartupMilestone::kRadio, clock_.Now());
+        if (!bluetoothRadio) {
+            FinishInitialization("the Bluetooth adapter has no radio");
+            co_return;
+        }
+        bluetoothRadioStateChangedToken = bluetoothRadio.StateChanged(
+            [this, guard](Radio const& sender, IInspectable const& args) {
+                auto scope = guard->Enter();
+                if (!scope) return;
+                Radio_StateChanged(sender, args);
+            });
+        Radio_StateChanged(bluetoothRadio, nullptr);
+        FinishInitialization(std::string());
+    }
+
+    void FlutterBlePeripheralPlugin::FinishInitialization(std::string error) {
+        // Published to the platform thread by the post below.
+        initialization_error_ = std::move(error);
+        events_.PostWith([](PlatformEvent& event) {
+            event.kind = PlatformEvent::Kind::kInitialized;
+        });
+    }
+
+    void FlutterBlePeripheralPlugin::Radio_StateChanged(Radio const& sender, IInspectable const& args) {
+        // The core enum mirrors winrt::Windows::Devices::Radios::RadioState.
+        if (state_.SetRadio(static_cast<RadioState>(sender.State()), clock_.Now())) {
+            PostStateChanged();
+        }
+    }
+
+    void FlutterBlePeripheralPlugin::PostStateChanged() {
+        events_.PostWith([](PlatformEvent& event) {
+            event.kind = PlatformEvent::Kind::kStateChanged;
+        });
+    }
+
+    std::unique_ptr<flutter::StreamHandlerError<>> FlutterBlePeripheralPlugin::OnStateListen(
+        std::unique_ptr<flutter::EventSink<>>&& events) {
+        state_sink_ = std::move(events);
+        // A new listener gets the current state straight away.
+        auto state = state_debouncer_.Emit(DerivePeripheralState(state_.Load()));
+        state_sink_->Success(static_cast<int32_t>(state));
+        return nullptr;
+    }
+
+    std::unique_ptr<flutter::StreamHandlerError<>> FlutterBlePeripheralPlugin::OnStateCancel() {
+        state_sink_ = nullptr;
+        return nullptr;
+    }
+
+    void FlutterBlePeripheralPlugin::OnStateChanged() {
+        auto deadline = state_debouncer_.Offer(DerivePeripheralState(state_.Load()), clock_.Now());
+        // An armed timer re-arms itself for the moved deadline when it fires.
+        if (!state_debounce_timer_) ArmStateDebounceTimer(deadline);
+    }
+
+    void FlutterBlePeripheralPlugin::OnStateSettled() {
+        state_debounce_timer_ = nullptr;
+        if (auto state = state_debouncer_.Poll(clock_.Now())) {
+            if (state_sink_) state_sink_->Success(static_cast<int32_t>(*state));
+        }
+        else if (auto deadline = state_debouncer_.deadline()) {
+            ArmStateDebounceTimer(*deadline);
+        }
+    }
+
+    void FlutterBlePeripheralPlugin::ArmStateDebounceTimer(std::chrono::nanoseconds deadline) {
+        auto delay = std::max(deadline - clock_.Now(), std::chrono::nanoseconds(0));
+        state_debounce_timer_ = ThreadPoolTimer::CreateTimer(
+            [this, guard = callback_guard_](ThreadPoolTimer const&) {
+                auto scope = guard->Enter();
+                if (!scope) return;
+                events_.PostWith([](PlatformEvent& event) {
+                    event.kind = PlatformEvent::Kind::kStateSettled;
+                });
+            },
+            std::chrono::duration_cast<TimeSpan>(delay));
     }
 
     void FlutterBlePeripheralPlugin::HandleMethodCall(
         const flutter::MethodCall<flutter::EncodableValue>& method_call,
         std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-        if (method_call.method_name().compare("start") == 0) {
-            if (!bluetoothLEPublisher) {
-                bluetoothLEPublisher = BluetoothLEAdvertisementPublisher();
-            } 
+        // Catch up first, in case a drain message could not be posted: this
+        // is also where kInitialized opens the gate.
+        DrainPlatformEvents();
+        if (initialization_gate_.open()) {
+            DispatchMethodCall(method_call, std::move(result));
+            return;
+        }
+
+        // The incoming call only lives for this invocation, so keep a copy.
+        DeferredMethodCall deferred;
+        deferred.call = std::make_unique<flutter::MethodCall<flutter::EncodableValue>>(
+            method_call.method_name(),
+            method_call.arguments() ? std::make_unique<EncodableValue>(*method_call.arguments()) : nullptr);
+        deferred.result = std::move(result);
+        auto* rejected = deferred.result.get();
+        if (initialization_gate_.Admit(std::move(deferred)) ==
+            InitializationGate<DeferredMethodCall>::Admission::kRejected) {
+            rejected->Error("initializing", "too many calls before the plugin finished initializing");
+        }
+    }
+
+    void FlutterBlePeripheralPlugin::DispatchMethodCall(
+        const flutter::MethodCall<flutter::EncodableValue>& method_call,
+        std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+        auto method = FindMethod(method_call.method_name());
+        if (!method) {
+            result->NotImplemented();
+            return;
+        }
+        // Includes waiting for mutex_ behind a timer tick.
+        MethodTimer timer(metrics_, *method);
 
+        std::lock_guard<std::mutex> lock(mutex_);
+        switch (*method) {
+        case Method::kInitialize: {
+            // Deferred like every other call, so this answers once
+            // initialization has finished.
+            if (initialization_gate_.failed()) {
+                result->Error("bluetooth_unavailable", initialization_gate_.error());
+            }
+            else {
+                result->Success();
+            }
+            break;
+        }
+        case Method::kGetStartupTimings: {
+            auto elapsed = [this](StartupMilestone milestone) {
+                auto time = startup_.Elapsed(milestone);
+                return time ? EncodableValue(static_cast<int64_t>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(*time).count())) : EncodableValue();
+            };
+            result->Success(EncodableMap{
+                {"adapterMicros", elapsed(StartupMilestone::kAdapter)},
+                {"radioMicros", elapsed(StartupMilestone::kRadio)},
+                {"initializedMicros", elapsed(StartupMilestone::kInitialized)},
+                {"firstAdvertisementMicros", elapsed(StartupMilestone::kFirstAdvertisement)},
+                {"deferredCalls", static_cast<int32_t>(initialization_gate_.total_deferred())},
+                {"error", initialization_gate_.failed()
+                    ? EncodableValue(initialization_gate_.error()) : EncodableValue()},
+                });
+            break;
+        }
+        case Method::kStart: {
+            const auto* arguments = std::get_if<EncodableMap>(method_call.arguments());
+            auto data = arguments ? DecodeAdvertiseData(*arguments) : AdvertiseData();
+            if (auto error = CheckAdvertiseData(data)) {
+                result->Error("advertise_data_too_large", *error);
+                return;
+            }
+            result->Success(static_cast<int32_t>(core_.Start(data)));
+            break;
+        }
+        case Method::kUpdateAdvertiseData: {
+            const auto* arguments = std::get_if<EncodableMap>(method_call.arguments());
+            auto data = arguments ? DecodeAdvertiseData(*arguments) : AdvertiseData();
+            if (auto error = CheckAdvertiseData(data)) {
+                result->Error("advertise_data_too_large", *error);
+                return;
+            }
+            auto update = core_.Update(data);
+            result->Success(EncodableMap{
+                {"state", static_cast<int32_t>(update.state)},
+                {"changedFields", static_cast<int32_t>(update.changedFields)},
+                {"restarted", update.restarted},
+                {"durationMicros", static_cast<int64_t>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(update.duration).count())},
+                });
+            break;
+        }
+        case Method::kAddAdvertisingSet: {
+            const auto* arguments = std::get_if<EncodableMap>(method_call.arguments());
+            if (!arguments) {
+                result->Error("invalid_arguments", "addAdvertisingSet expects a map");
+                return;
+            }
+            auto data = DecodeAdvertiseData(*arguments);
+            if (auto error = CheckAdvertiseData(data)) {
+                result->Error("advertise_data_too_large", *error);
+                return;
+            }
+            auto id = scheduler_.Add(data, DecodeAdvertiseSetParameters(*arguments));
+            ScheduleNextTick(scheduler_.Tick());
+            result->Success(static_cast<int32_t>(id));
+            break;
+        }
+        case Method::kRemoveAdvertisingSet: {
+            auto id = GetInt(method_call.arguments());
+            bool removed = id && scheduler_.Remove(static_cast<AdvertisingScheduler::SetId>(*id));
+            ScheduleNextTick(scheduler_.Tick());
+            result->Success(removed);
+            break;
+        }
+        case Method::kGetAdvertisingSetStats: {
+            flutter::EncodableList stats;
+            for (const auto& set : scheduler_.Stats()) {
+                stats.push_back(EncodableMap{
+                    {"id", static_cast<int32_t>(set.id)},
+                    {"events", static_cast<int64_t>(set.events)},
+                    {"airtimeMicros", static_cast<int64_t>(
+                        std::chrono::duration_cast<std::chrono::microseconds>(set.airtime).count())},
+                    {"onAir", set.onAir},
+                    {"expired", set.expired},
+                    });
+            }
+            result->Success(stats);
+            break;
+        }
+        case Method::kSetScanResultFormat: {
+            const auto* format = GetString(method_call.arguments());
+            binary_scan_results_ = format && *format == "binary";
+            result->Success();
+            break;
+        }
+        case Method::kSetScanBatching: {
             const auto* arguments = std::get_if<EncodableMap>(method_call.arguments());
-            Advertisement::BluetoothLEManufacturerData manufacturerData = Advertisement::BluetoothLEManufacturerData();
+            ScanBatchOptions options;
+            bool enabled = false;
             if (arguments) {
-                auto manuDataIt = arguments->find(EncodableValue("manufacturerDataBytes"));
-                if (manuDataIt != arguments->end()) {
-                    auto dataWriter = DataWriter();
-                    auto& vector = std::get<std::vector<uint8_t>>(manuDataIt->second);
-                    dataWriter.WriteBytes(vector);
-                    manufacturerData.Data(dataWriter.DetachBuffer());
+                enabled = GetBool(FindArgument(*arguments, Argument::kEnabled)).value_or(false);
+                if (auto interval = GetInt(FindArgument(*arguments, Argument::kFlushIntervalMs))) {
+                    options.flushInterval = std::chrono::milliseconds(std::max<int64_t>(*interval, 1));
                 }
-                auto manuIdIt = arguments->find(EncodableValue("manufacturerId"));
-                if (manuIdIt != arguments->end()) {
-                    auto test = std::get<std::int32_t>(manuIdIt->second);
-                    printf("%ld", test);
-                    //dataWriter2.WriteUInt16(std::get<std::uint16_t>(manuIdIt->second));
-                    manufacturerData.CompanyId(test);
-
-//                    int32_t manuIdInt = std::get<std::int32_t>(manuIdIt->second);
- //                  uint16_t manuId = manuIdInt & 0xFFFF;
-//                    manufacturerData.CompanyId(manuId);
+                if (auto size = GetInt(FindArgument(*arguments, Argument::kMaxBatchSize))) {
+                    options.maxBatchSize = static_cast<size_t>(std::max<int64_t>(*size, 1));
                 }
+                options.coalesce = GetBool(FindArgument(*arguments, Argument::kCoalesce)).value_or(false);
             }
-
-            bluetoothLEPublisher.Advertisement().ManufacturerData().Append(manufacturerData);
-            bluetoothLEPublisher.Start();
-
-            result->Success(8);
+            scan_batcher_.SetOptions(options);
+            batch_scan_results_ = enabled;
+            RestartScanFlushTimer();
+            result->Success();
+            break;
+        }
+        case Method::kSetScanCache: {
+            const auto* arguments = std::get_if<EncodableMap>(method_call.arguments());
+            bool enabled = false;
+            size_t capacity = 1024;
+            std::chrono::nanoseconds max_age = std::chrono::seconds(30);
+            if (arguments) {
+                enabled = GetBool(FindArgument(*arguments, Argument::kEnabled)).value_or(false);
+                if (auto value = GetInt(FindArgument(*arguments, Argument::kCapacity))) {
+                    capacity = static_cast<size_t>(std::max<int64_t>(*value, 1));
+                }
+                if (auto value = GetInt(FindArgument(*arguments, Argument::kMaxAgeMs))) {
+                    max_age = std::chrono::milliseconds(std::max<int64_t>(*value, 0));
+                }
+            }
+            {
+                std::lock_guard<std::mutex> cache_lock(scan_cache_mutex_);
+                scan_cache_ = AdvertisementCache(capacity, max_age);
+                dedup_scan_results_ = enabled;
+            }
+            result->Success();
+            break;
+        }
+        case Method::kGetScanCacheStats: {
+            AdvertisementCache::Stats stats;
+            {
+                std::lock_guard<std::mutex> cache_lock(scan_cache_mutex_);
+                stats = scan_cache_.stats();
+            }
+            result->Success(EncodableMap{
+                {"hits", static_cast<int64_t>(stats.hits)},
+                {"misses", static_cast<int64_t>(stats.misses)},
+                {"changes", static_cast<int64_t>(stats.changes)},
+                {"evictions", static_cast<int64_t>(stats.evictions)},
+                {"size", static_cast<int32_t>(stats.size)},
+                {"capacity", static_cast<int32_t>(stats.capacity)},
+                });
+            break;
+        }
+        case Method::kStop: {
+            result->Success(static_cast<int32_t>(core_.Stop()));
+            break;
+        }
+        case Method::kIsAdvertising: {
+            result->Success(state_.Load().advertising());
+            break;
+        }
+        case Method::kIsSupported: {
+            result->Success(state_.Load().supported);
+            break;
+        }
+        case Method::kIsConnected: {
+            result->Success(state_.Load().connected);
+            break;
+        }
+        case Method::kGetStateSnapshot: {
+            auto state = state_.Load();
+            auto age = std::chrono::duration_cast<std::chrono::microseconds>(clock_.Now()) - state.changedAt;
+            result->Success(EncodableMap{
+                {"radioState", static_cast<int32_t>(state.radio)},
+                {"publisherStatus", static_cast<int32_t>(state.publisher)},
+                {"isSupported", state.supported},
+                {"isAdvertising", state.advertising()},
+                {"isConnected", state.connected},
+                {"ageMicros", static_cast<int64_t>(age.count())},
+                });
+            break;
+        }
+        case Method::kGetEventQueueStats: {
+            auto stats = events_.stats();
+            result->Success(EncodableMap{
+                {"posted", static_cast<int64_t>(stats.posted)},
+                {"dropped", static_cast<int64_t>(stats.dropped)},
+                {"drained", static_cast<int64_t>(stats.drained)},
+                {"wakeups", static_cast<int64_t>(stats.wakeups)},
+                {"failedWakeups", static_cast<int64_t>(stats.failedWakeups)},
+                {"highWater", static_cast<int32_t>(stats.highWater)},
+                {"capacity", static_cast<int32_t>(stats.capacity)},
+                {"scanResultsDropped", static_cast<int64_t>(scan_batcher_.dropped())},
+                {"scanResultsFiltered", static_cast<int64_t>(backend_.filtered())},
+                });
+            break;
         }
-        else if (method_call.method_name().compare("stop") == 0) {
-            if (bluetoothLEPublisher) {
-                bluetoothLEPublisher.Advertisement().ManufacturerData().Clear();
-                bluetoothLEPublisher.Stop();
+        case Method::kAddGattService: {
+            const auto* arguments = std::get_if<EncodableMap>(method_call.arguments());
+            auto service = arguments ? DecodeGattService(*arguments) : std::nullopt;
+            if (!service) {
+                result->Error("invalid_arguments", "addGattService expects a service with valid UUIDs and values");
+                return;
+            }
+            bool added = false;
+            {
+                std::lock_guard<std::mutex> gatt_lock(gatt_mutex_);
+                added = gatt_.AddService(*service);
             }
-            result->Success(8);
-        } else if (method_call.method_name().compare("isAdvertising") == 0) {
-            result->Success(true);
+            if (!added) {
+                result->Error("gatt_service_refused", "the GATT service could not be added");
+                return;
+            }
+            flutter::EncodableList handles;
+            for (const auto& characteristic : service->characteristics) {
+                handles.push_back(static_cast<int32_t>(characteristic.handle));
+            }
+            result->Success(EncodableMap{
+                {"handle", static_cast<int32_t>(service->handle)},
+                {"characteristicHandles", handles},
+                });
+            break;
         }
-        else {
+        case Method::kRemoveGattService: {
+            auto handle = GetInt(method_call.arguments());
+            std::lock_guard<std::mutex> gatt_lock(gatt_mutex_);
+            result->Success(handle && gatt_.RemoveService(static_cast<GattHandle>(*handle)));
+            break;
+        }
+        case Method::kSetCharacteristicValue: {
+            const auto* arguments = std::get_if<EncodableMap>(method_call.arguments());
+            auto handle = arguments ? GetInt(FindArgument(*arguments, Argument::kHandle)) : std::nullopt;
+            const auto* value = arguments ? GetBytes(FindArgument(*arguments, Argument::kValue)) : nullptr;
+            if (!handle || !value || value->size() > kGattMaxAttributeSize) {
+                result->Error("invalid_arguments", "setCharacteristicValue expects a handle and at most 512 bytes");
+                return;
+            }
+            const bool notify = GetBool(FindArgument(*arguments, Argument::kNotify)).value_or(true);
+            auto characteristic = static_cast<GattHandle>(*handle);
+            auto buffer = SharedBuffer::CopyFrom(*value);
+            std::lock_guard<std::mutex> gatt_lock(gatt_mutex_);
+            if (!gatt_.GetValue(characteristic)) {
+                result->Error("invalid_handle", "no characteristic with this handle");
+                return;
+            }
+            size_t notified = 0;
+            if (notify) {
+                notified = gatt_.Notify(characteristic, std::move(buffer));
+            }
+            else {
+                gatt_.SetValue(characteristic, std::move(buffer));
+            }
+            result->Success(static_cast<int32_t>(notified));
+            break;
+        }
+        case Method::kSendData: {
+            const auto* data = GetBytes(method_call.arguments());
+            if (!data) {
+                result->Error("invalid_arguments", "sendData expects bytes");
+                return;
+            }
+            PendingSendData call;
+            call.bytes = data->size();
+            call.started = clock_.Now();
+            {
+                std::lock_guard<std::mutex> gatt_lock(gatt_mutex_);
+                if (!EnsureDataService()) {
+                    result->Error("gatt_service_refused", "the data service could not be added");
+                    return;
+                }
+                // Every client's stream slices the same copy.
+                const SharedBuffer payload = SharedBuffer::CopyFrom(*data);
+                for (GattClientId client : gatt_.subscribers(data_tx_)) {
+                    call.streams.push_back(streamer_.Send(client, data_tx_, payload));
+                }
+            }
+            call.clients = call.streams.size();
+            if (call.streams.empty()) {
+                result->Success(EncodableMap{
+                    {"bytes", static_cast<int64_t>(call.bytes)},
+                    {"clients", 0},
+                    {"failed", false},
+                    {"durationMicros", static_cast<int64_t>(0)},
+                    {"bytesPerSecond", 0.0},
+                    });
+                break;
+            }
+            call.result = std::move(result);
+            pending_send_data_.push_back(std::move(call));
+            PumpDataStreams();
+            break;
+        }
+        case Method::kAddDataService: {
+            std::lock_guard<std::mutex> gatt_lock(gatt_mutex_);
+            result->Success(EnsureDataService());
+            break;
+        }
+        case Method::kSetScanFilter: {
+            const auto* arguments = std::get_if<EncodableMap>(method_call.arguments());
+            auto spec = arguments ? DecodeScanFilterSpec(*arguments) : std::optional<ScanFilterSpec>(ScanFilterSpec{});
+            auto filter = spec ? ScanFilter::Compile(*spec) : std::nullopt;
+            if (!filter) {
+                result->Error("invalid_arguments", "setScanFilter expects valid UUIDs and masks as long as their prefixes");
+                return;
+            }
+            if (spec->empty()) {
+                backend_.SetScanFilter(nullptr, {});
+            } else {
+                backend_.SetScanFilter(std::make_shared<const ScanFilter>(std::move(*filter)), PushDownScanFilter(*spec));
+            }
+            result->Success();
+            break;
+        }
+        case Method::kStartScan: {
+            const auto* arguments = std::get_if<EncodableMap>(method_call.arguments());
+            auto settings = arguments ? DecodeScanSettings(*arguments) : ScanSettings();
+            if (!IsValidScanSettings(settings)) {
+                result->Error("invalid_arguments",
+                              "startScan expects an interval from 2.5 ms to 10.24 s and a window no longer than it");
+                return;
+            }
+            if (scan_replay_ && !scan_replay_->finished()) {
+                result->Error("replay_active", "stopScanReplay before scanning the radio again");
+                return;
+            }
+            const bool started = scan_session_.Start(settings);
+            ScheduleScanTick(scan_session_.NextWakeup());
+            if (!started) {
+                result->Error("scan_refused", "the Bluetooth watcher could not be started");
+                return;
+            }
+            result->Success();
+            break;
+        }
+        case Method::kStopScan: {
+            scan_session_.Stop();
+            ScheduleScanTick(std::nullopt);
+            result->Success(ScanSessionStatsToMap(scan_session_.stats()));
+            break;
+        }
+        case Method::kGetScanSessionStats: {
+            result->Success(ScanSessionStatsToMap(scan_session_.stats()));
+            break;
+        }
+        case Method::kGetMetrics: {
+            result->Success(MetricsToMap(metrics_.Collect()));
+            break;
+        }
+        case Method::kStartScanCapture: {
+            const auto* arguments = std::get_if<EncodableMap>(method_call.arguments());
+            const auto* path = arguments ? GetString(FindArgument(*arguments, Argument::kPath)) : nullptr;
+            if (!path || path->empty()) {
+                result->Error("invalid_arguments", "startScanCapture expects a file path");
+                return;
+            }
+            ScanCaptureOptions options;
+            options.deltaCompressed = GetBool(FindArgument(*arguments, Argument::kDeltaCompressed)).value_or(true);
+            std::shared_ptr<ScanCaptureWriter> capture = ScanCaptureWriter::Open(*path, options);
+            if (!capture) {
+                result->Error("capture_failed", "could not create " + *path);
+                return;
+            }
+            // A capture already running ends here.
+            backend_.SetScanCapture(capture);
+            if (scan_capture_) scan_capture_->Close();
+            scan_capture_ = std::move(capture);
+            result->Success();
+            break;
+        }
+        case Method::kStopScanCapture: {
+            ScanCaptureWriter::Stats stats;
+            if (scan_capture_) {
+                backend_.SetScanCapture(nullptr);
+                scan_capture_->Close();
+                stats = scan_capture_->stats();
+                scan_capture_ = nullptr;
+            }
+            result->Success(ScanCaptureStatsToMap(stats));
+            break;
+        }
+        case Method::kStartScanReplay: {
+            const auto* arguments = std::get_if<EncodableMap>(method_call.arguments());
+            const auto* path = arguments ? GetString(FindArgument(*arguments, Argument::kPath)) : nullptr;
+            if (!path || path->empty()) {
+                result->Error("invalid_arguments", "startScanReplay expects a file path");
+                return;
+            }
+            if (scan_session_.active()) {
+                result->Error("scan_active", "stopScan before replaying a capture");
+                return;
+            }
+            auto reader = ScanCaptureReader::Open(*path);
+            if (!reader) {
+                result->Error("invalid_capture", *path + " is not a scan capture");
+                return;
+            }
+            const bool real_time = GetBool(FindArgument(*arguments, Argument::kRealTime)).value_or(true);
+            if (scan_replay_) scan_replay_->Stop();
+            scan_replay_ = std::make_unique<BackgroundScanReplay>(
+                std::move(reader), real_time ? ReplaySpeed::kRecorded : ReplaySpeed::kMaximum,
+                [this](const ScanResult& recorded) { backend_.Replay(recorded); });
+            result->Success();
+            break;
+        }
+        case Method::kStopScanReplay: {
+            if (scan_replay_) scan_replay_->Stop();
+            result->Success(ScanReplayToMap(scan_replay_.get()));
+            scan_replay_ = nullptr;
+            break;
+        }
+        case Method::kSetRssiHistory: {
+            const auto* arguments = std::get_if<EncodableMap>(method_call.arguments());
+            bool enabled = false;
+            RssiHistoryOptions options{ 1, 1 };
+            if (arguments) {
+                enabled = GetBool(FindArgument(*arguments, Argument::kEnabled)).value_or(false);
+            }
+            if (enabled) {
+                options = RssiHistoryOptions();
+                if (auto value = GetInt(FindArgument(*arguments, Argument::kMaxDevices))) {
+                    options.maxDevices = static_cast<size_t>(std::max<int64_t>(*value, 1));
+                }
+                if (auto value = GetInt(FindArgument(*arguments, Argument::kSamplesPerDevice))) {
+                    options.samplesPerDevice = static_cast<size_t>(std::max<int64_t>(*value, 1));
+                }
+            }
+            // Allocated before taking the lock the watcher thread records
+            // under.
+            RssiHistory history(options);
+            {
+                std::lock_guard<std::mutex> history_lock(rssi_history_mutex_);
+                rssi_history_ = std::move(history);
+                record_rssi_history_ = enabled;
+            }
+            result->Success();
+            break;
+        }
+        case Method::kGetRssiStats: {
+            const auto* arguments = std::get_if<EncodableMap>(method_call.arguments());
+            const auto* address_text = arguments ? GetString(FindArgument(*arguments, Argument::kAddress)) : nullptr;
+            auto address = address_text ? ParseAddressString(*address_text) : std::nullopt;
+            if (!address) {
+                result->Error("invalid_arguments", "getRssiStats expects the decimal address of a scan result");
+                return;
+            }
+            RssiWindow window;
+            if (auto value = GetInt(FindArgument(*arguments, Argument::kWindowSamples))) {
+                window.samples = static_cast<size_t>(std::max<int64_t>(*value, 0));
+            }
+            if (auto value = GetInt(FindArgument(*arguments, Argument::kWindowMs))) {
+                window.span = std::chrono::milliseconds(std::max<int64_t>(*value, 0));
+            }
+            std::optional<RssiStats> stats;
+            {
+                std::lock_guard<std::mutex> history_lock(rssi_history_mutex_);
+                stats = rssi_history_.Query(*address, window);
+            }
+            if (!stats) {
+                result->Success();
+                break;
+            }
+            EncodableMap map{
+                {"samples", static_cast<int32_t>(stats->samples)},
+                {"totalSamples", static_cast<int64_t>(stats->totalSamples)},
+                {"firstMicros", static_cast<int64_t>(stats->first.count())},
+                {"lastMicros", static_cast<int64_t>(stats->last.count())},
+                {"latest", static_cast<int32_t>(stats->latest)},
+                {"min", static_cast<int32_t>(stats->min)},
+                {"max", static_cast<int32_t>(stats->max)},
+                {"mean", static_cast<double>(stats->mean)},
+                {"standardDeviation", static_cast<double>(stats->standardDeviation)},
+                {"p10", static_cast<int32_t>(stats->p10)},
+                {"median", static_cast<int32_t>(stats->median)},
+                {"p90", static_cast<int32_t>(stats->p90)},
+                {"kalman", static_cast<double>(stats->kalman)},
+                {"advertisementsPerSecond", static_cast<double>(stats->advertisementsPerSecond)},
+            };
+            if (stats->txPower) map[EncodableValue("txPower")] = static_cast<int32_t>(*stats->txPower);
+            result->Success(EncodableValue(std::move(map)));
+            break;
+        }
+        case Method::kGetGattServerStats: {
+            GattServer::Stats stats;
+            WriteAssembler::Stats received;
+            {
+                std::lock_guard<std::mutex> gatt_lock(gatt_mutex_);
+                stats = gatt_.stats();
+                received = write_assembler_.stats();
+            }
+            result->Success(EncodableMap{
+                {"reads", static_cast<int64_t>(stats.reads)},
+                {"writes", static_cast<int64_t>(stats.writes)},
+                {"rejected", static_cast<int64_t>(stats.rejected)},
+                {"notifications", static_cast<int64_t>(stats.notifications)},
+                {"indications", static_cast<int64_t>(stats.indications)},
+                {"dropped", static_cast<int64_t>(stats.dropped)},
+                {"bytesSent", static_cast<int64_t>(stats.bytesSent)},
+                {"clients", static_cast<int32_t>(stats.clients)},
+                {"subscriptions", static_cast<int32_t>(stats.subscriptions)},
+                {"fragmentsReceived", static_cast<int64_t>(received.fragments)},
+                {"messagesReceived", static_cast<int64_t>(received.messages)},
+                {"bytesReceived", static_cast<int64_t>(received.bytes)},
+                {"writesRejected", static_cast<int64_t>(received.rejected)},
+                {"writesExpired", static_cast<int64_t>(received.expired)},
+                });
+            break;
+        }
+        case Method::kCount:
             result->NotImplemented();
+            break;
         }
     }
 
-    BluetoothLEAdvertisementPublisherStatusChangedEventArgs statuss = nullptr;
+    void FlutterBlePeripheralPlugin::ScheduleNextTick(std::optional<std::chrono::nanoseconds> wakeup) {
+        if (scheduler_timer_) {
+            scheduler_timer_.Cancel();
+            scheduler_timer_ = nullptr;
+        }
+        if (!wakeup) return;
 
-    void Publisher_StatusChanged(BluetoothLEAdvertisementPublisher sender,
-        BluetoothLEAdvertisementPublisherStatusChangedEventArgs args)
-    {
+        auto delay = std::max(*wakeup - clock_.Now(), std::chrono::nanoseconds(0));
+        scheduler_timer_ = ThreadPoolTimer::CreateTimer(
+            [this, guard = callback_guard_](ThreadPoolTimer const&) {
+                auto scope = guard->Enter();
+                if (!scope) return;
+                std::lock_guard<std::mutex> lock(mutex_);
+                ScheduleNextTick(scheduler_.Tick());
+            },
+            std::chrono::duration_cast<TimeSpan>(delay));
+    }
+
+    void FlutterBlePeripheralPlugin::ScheduleScanTick(std::optional<std::chrono::nanoseconds> wakeup) {
+        if (scan_session_timer_) {
+            scan_session_timer_.Cancel();
+            scan_session_timer_ = nullptr;
+        }
+        if (!wakeup) return;
 
-        statuss = args;
+        auto delay = std::max(*wakeup - clock_.Now(), std::chrono::nanoseconds(0));
+        scan_session_timer_ = ThreadPoolTimer::CreateTimer(
+            [this, guard = callback_guard_](ThreadPoolTimer const&) {
+                auto scope = guard->Enter();
+                if (!scope) return;
+                std::lock_guard<std::mutex> lock(mutex_);
+                ScheduleScanTick(scan_session_.Tick());
+            },
+            std::chrono::duration_cast<TimeSpan>(delay));
     }
 
-    union uint16_t_union {
-        uint16_t uint16;
-        byte bytes[sizeof(uint16_t)];
-    };
+    namespace {
+
+        EncodableMap ScanResultToMap(const ScanResult& result) {
+            AdvertisementFields scratch;
+            const auto& fields = ParsedFields(result, scratch);
 
-    std::vector<uint8_t> to_bytevc(IBuffer buffer) {
-        auto reader = DataReader::FromBuffer(buffer);
-        auto result = std::vector<uint8_t>(reader.UnconsumedBufferLength());
-        reader.ReadBytes(result);
-        return result;
+            EncodableMap map{
+              {"deviceName", DeviceName(result)},
+              {"address", AddressString(result.address)},
+              {"manufacturerSpecificData", ManufacturerSpecificData(result)},
+              {"rssi", static_cast<int32_t>(result.rssi)},
+            };
+            flutter::EncodableList service_uuids;
+            for (const auto& uuid : fields.serviceUuids) service_uuids.push_back(FormatBluetoothUuid(uuid));
+            map[EncodableValue("serviceUuids")] = std::move(service_uuids);
+            EncodableMap service_data;
+            for (const auto& record : fields.serviceData) {
+                service_data.emplace(EncodableValue(FormatBluetoothUuid(record.uuid)), EncodableValue(record.data.ToVector()));
+            }
+            map[EncodableValue("serviceData")] = std::move(service_data);
+            // Keyed by company id; the first record of a company wins, as on
+            // Android.
+            EncodableMap manufacturer_data;
+            for (const auto& record : fields.manufacturerData) {
+                manufacturer_data.emplace(EncodableValue(static_cast<int32_t>(record.companyId)),
+                                          EncodableValue(record.data.ToVector()));
+            }
+            map[EncodableValue("manufacturerData")] = std::move(manufacturer_data);
+            if (fields.txPowerLevel) map[EncodableValue("txPowerLevel")] = static_cast<int32_t>(*fields.txPowerLevel);
+            if (fields.appearance) map[EncodableValue("appearance")] = static_cast<int32_t>(*fields.appearance);
+            if (fields.flags) map[EncodableValue("advertiseFlags")] = static_cast<int32_t>(*fields.flags);
+            return map;
+        }
+
+    }  // namespace
+
+    void FlutterBlePeripheralPlugin::OnScanResult(const ScanResult& result) {
+        const auto received = metrics_.Now();
+        scan_session_.OnAdvertisement();
+        if (record_rssi_history_) {
+            AdvertisementFields scratch;
+            const auto tx_power = ParsedFields(result, scratch).txPowerLevel;
+            std::lock_guard<std::mutex> lock(rssi_history_mutex_);
+            rssi_history_.Record(result.address, result.timestamp, result.rssi, tx_power);
+        }
+        if (dedup_scan_results_) {
+            std::lock_guard<std::mutex> lock(scan_cache_mutex_);
+            if (scan_cache_.Classify(result, clock_.Now()) == AdvertisementCache::Outcome::kUnchanged) {
+                metrics_.Add(MetricCounter::kScanDeduplicated);
+                return;
+            }
+        }
+        if (batch_scan_results_) {
+            if (scan_batcher_.Push(result)) {
+                events_.PostWith([](PlatformEvent& event) {
+                    event.kind = PlatformEvent::Kind::kFlushScanResults;
+                }, kPlatformEventReserve);
+            }
+            return;
+        }
+        // |result| borrows the watcher's buffers, so copy it into the slot.
+        const bool posted = events_.PostWith([&result, received](PlatformEvent& event) {
+            event.kind = PlatformEvent::Kind::kScanResult;
+            event.scan.Assign(result);
+            event.received = received;
+        }, kPlatformEventReserve);
+        if (!posted) metrics_.Add(MetricCounter::kScanDropped);
     }
 
-    std::vector<uint8_t> parseManufacturerData(BluetoothLEAdvertisement advertisement) {
-        if (advertisement.ManufacturerData().Size() == 0)
-            return std::vector<uint8_t>();
+    std::optional<LRESULT> FlutterBlePeripheralPlugin::HandleWindowProc(
+        HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam) {
+        if (message != DrainMessage()) return std::nullopt;
+        DrainPlatformEvents();
+        return 0;
+    }
 
-        auto manufacturerData = advertisement.ManufacturerData().GetAt(0);
-        // FIXME Compat with REG_DWORD_BIG_ENDIAN
-        uint8_t* prefix = uint16_t_union{ manufacturerData.CompanyId() }.bytes;
-        auto result = std::vector<uint8_t>{ prefix, prefix + sizeof(uint16_t_union) };
+    HWND FlutterBlePeripheralPlugin::CreateMessageWindow() {
+        static constexpr wchar_t kClassName[] = L"FlutterBlePeripheralEvents";
+        WNDCLASS window_class = {};
+        window_class.lpfnWndProc = &FlutterBlePeripheralPlugin::MessageWindowProc;
+        window_class.hInstance = GetModuleHandle(nullptr);
+        window_class.lpszClassName = kClassName;
+        // Fails harmlessly once the class is registered.
+        RegisterClass(&window_class);
+        HWND window = CreateWindowEx(0, kClassName, L"", 0, 0, 0, 0, 0, HWND_MESSAGE, nullptr,
+                                     window_class.hInstance, nullptr);
+        if (window) SetWindowLongPtr(window, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(this));
+        return window;
+    }
 
-        auto data = to_bytevc(manufacturerData.Data());
-        result.insert(result.end(), data.begin(), data.end());
-        return result;
+    LRESULT CALLBACK FlutterBlePeripheralPlugin::MessageWindowProc(
+        HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam) {
+        if (message == DrainMessage()) {
+            auto* plugin = reinterpret_cast<FlutterBlePeripheralPlugin*>(GetWindowLongPtr(hwnd, GWLP_USERDATA));
+            if (plugin) plugin->DrainPlatformEvents();
+            return 0;
+        }
+        return DefWindowProc(hwnd, message, wparam, lparam);
     }
 
-    void FlutterBlePeripheralPlugin::BluetoothLEWatcher_Received(
-        BluetoothLEAdvertisementWatcher sender,
-        BluetoothLEAdvertisementReceivedEventArgs args) {
-        //OutputDebugString((L"Received " + winrt::to_hstring(args.BluetoothAddress()) + L"\n").c_str());
-        auto manufacturer_data = parseManufacturerData(args.Advertisement());
-        if (scan_result_sink_) {
-            auto bluetoothAddress = args.BluetoothAddress();
-            auto localName = args.Advertisement().LocalName();
-            auto name = winrt::to_string(localName);
-            if (localName.empty()) {
-                // TODO
-                // auto device = co_await BluetoothLEDevice::FromBluetoothAddressAsync(bluetoothAddress);
-                // name = winrt::to_string(device.Name());
+    void FlutterBlePeripheralPlugin::DrainPlatformEvents() {
+        events_.Drain([this](PlatformEvent& event) { HandlePlatformEvent(event); }, kPlatformEventsPerDrain);
+    }
 
-                std::stringstream sstream;
-                sstream << std::hex << bluetoothAddress;
-                name = sstream.str();
+    void FlutterBlePeripheralPlugin::HandlePlatformEvent(PlatformEvent& event) {
+        switch (event.kind) {
+        case PlatformEvent::Kind::kPublisherStatus: {
+            std::lock_guard<std::mutex> lock(mutex_);
+            // Events queued before a restart can still name the old
+            // publisher; the core drops those.
+            core_.OnPublisherStatusChanged(event.status, event.publisher);
+            break;
+        }
+        case PlatformEvent::Kind::kScanResult:
+            if (binary_scan_results_) {
+                SendScanRecord(event.scan.View());
             }
-            scan_result_sink_->Success(flutter::EncodableMap{
-              {"deviceName", name},
-              {"address", std::to_string(bluetoothAddress)},
-              {"manufacturerSpecificData", manufacturer_data},
-              {"rssi", args.RawSignalStrengthInDBm()},
-              //{"serviceUuids", args.Advertisement().ServiceUuids()},
-                });
+            else if (scan_result_sink_) {
+                scan_result_sink_->Success(ScanResultToMap(event.scan.View()));
+            }
+            else {
+                break;
+            }
+            metrics_.Add(MetricCounter::kScanDelivered);
+            metrics_.RecordSince(MetricLatency::kCallbackToSink, event.received);
+            break;
+        case PlatformEvent::Kind::kFlushScanResults:
+            FlushScanResults();
+            break;
+        case PlatformEvent::Kind::kStateChanged:
+            OnStateChanged();
+            break;
+        case PlatformEvent::Kind::kStateSettled:
+            OnStateSettled();
+            break;
+        case PlatformEvent::Kind::kGattValueSent: {
+            {
+                std::lock_guard<std::mutex> lock(gatt_mutex_);
+                streamer_.OnSent(event.client, event.value, event.delivered);
+            }
+            // The slot is reused; do not keep the payload alive with it.
+            event.value = SharedBuffer();
+            PumpDataStreams();
+            break;
+        }
+        case PlatformEvent::Kind::kDataStreamsChanged:
+            PumpDataStreams();
+            break;
+        case PlatformEvent::Kind::kMtuChanged:
+            if (mtu_sink_) mtu_sink_->Success(static_cast<int32_t>(event.mtu));
+            // Streams to the client fill the larger packets from their next
+            // chunk on.
+            PumpDataStreams();
+            break;
+        case PlatformEvent::Kind::kDataReceived:
+            // Straight from the pooled buffer; it goes back to the pool when
+            // the slot lets go of it.
+            messenger_->Send(kDataReceivedChannel, event.value.data(), event.value.size());
+            event.value = SharedBuffer();
+            break;
+        case PlatformEvent::Kind::kMetricsTick:
+            if (metrics_sink_) metrics_sink_->Success(MetricsToMap(metrics_.Collect()));
+            break;
+        case PlatformEvent::Kind::kInitialized:
+            startup_.Mark(StartupMilestone::kInitialized, clock_.Now());
+            for (auto& deferred : initialization_gate_.Open(initialization_error_)) {
+                DispatchMethodCall(*deferred.call, std::move(deferred.result));
+            }
+            break;
+        }
+    }
+
+    void FlutterBlePeripheralPlugin::SendScanRecord(const ScanResult& result) {
+        scan_record_writer_.Reset();
+        if (scan_record_writer_.Append(result)) {
+            auto message = scan_record_writer_.data();
+            messenger_->Send(kScanResultBinaryChannel, message.data(), message.size());
+        }
+    }
+
+    void FlutterBlePeripheralPlugin::FlushScanResults() {
+        const auto& batch = scan_batcher_.Flush(clock_.Now());
+        if (batch.empty()) return;
+
+        if (binary_scan_results_) {
+            scan_record_writer_.Reset();
+            for (const auto& entry : batch) {
+                scan_record_writer_.Append(entry.latest.View());
+            }
+            auto message = scan_record_writer_.data();
+            messenger_->Send(kScanResultBinaryChannel, message.data(), message.size());
+            metrics_.Add(MetricCounter::kScanDelivered, batch.size());
+            return;
+        }
+        if (!scan_result_sink_) return;
+
+        flutter::EncodableList results;
+        results.reserve(batch.size());
+        const bool coalesced = scan_batcher_.options().coalesce;
+        for (const auto& entry : batch) {
+            auto map = ScanResultToMap(entry.latest.View());
+            if (coalesced) {
+                map[EncodableValue("rssiMin")] = static_cast<int32_t>(entry.rssiMin);
+                map[EncodableValue("rssiMax")] = static_cast<int32_t>(entry.rssiMax);
+                map[EncodableValue("count")] = static_cast<int32_t>(entry.count);
+            }
+            results.push_back(std::move(map));
         }
+        scan_result_sink_->Success(results);
+        metrics_.Add(MetricCounter::kScanDelivered, batch.size());
     }
 
+    void FlutterBlePeripheralPlugin::RestartScanFlushTimer() {
+        if (scan_flush_timer_) {
+            scan_flush_timer_.Cancel();
+            scan_flush_timer_ = nullptr;
+        }
+        if (!batch_scan_results_) {
+            // Deliver whatever was still waiting when batching was turned off.
+            FlushScanResults();
+            return;
+        }
 
+        scan_flush_timer_ = ThreadPoolTimer::CreatePeriodicTimer(
+            [this, guard = callback_guard_](ThreadPoolTimer const&) {
+                auto scope = guard->Enter();
+                if (!scope) return;
+                events_.PostWith([](PlatformEvent& event) {
+                    event.kind = PlatformEvent::Kind::kFlushScanResults;
+                });
+            },
+            std::chrono::duration_cast<TimeSpan>(scan_batcher_.options().flushInterval));
+    }
 
     std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> FlutterBlePeripheralPlugin::OnListenInternal(
         const flutter::EncodableValue* arguments, std::unique_ptr<flutter::EventSink<flutter::EncodableValue>>&& events)
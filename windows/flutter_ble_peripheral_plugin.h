@@ -11,6 +11,7 @@
 #include <winrt/Windows.Devices.Bluetooth.Advertisement.h>
 #include <winrt/Windows.Devices.Bluetooth.GenericAttributeProfile.h>
 #include <winrt/Windows.Devices.Enumeration.h>
+#include <winrt/Windows.System.Threading.h>
 
 #include <flutter/method_channel.h>
 #include <flutter/basic_message_channel.h>
@@ -25,6 +26,35 @@
 #include <sstream>
 #include <algorithm>
 #include <iomanip>
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "core/advertisement_cache.h"
+#include "core/advertising_scheduler.h"
+#include "core/buffer_pool.h"
+#include "core/callback_guard.h"
+#include "core/clock.h"
+#include "core/data_streamer.h"
+#include "core/event_pump.h"
+#include "core/gatt_server.h"
+#include "core/initialization_gate.h"
+#include "core/metrics.h"
+#include "core/peripheral_core.h"
+#include "core/rssi_history.h"
+#include "core/scan_batcher.h"
+#include "core/scan_capture.h"
+#include "core/scan_record_codec.h"
+#include "core/scan_result.h"
+#include "core/scan_session.h"
+#include "core/startup_timeline.h"
+#include "core/state_debouncer.h"
+#include "core/state_snapshot.h"
+#include "core/write_assembler.h"
+#include "winrt_gatt_transport.h"
+#include "winrt_radio_backend.h"
 
 namespace flutter_ble_peripheral {
 
@@ -37,17 +67,72 @@ namespace flutter_ble_peripheral {
     using namespace winrt::Windows::Devices::Bluetooth::Advertisement;
     using namespace winrt::Windows::Devices::Bluetooth::GenericAttributeProfile;
     using namespace winrt::Windows::Devices::Enumeration;
+    using namespace winrt::Windows::System::Threading;
 
     using flutter::EncodableMap;
     using flutter::EncodableValue;
 
 
 
+    // Work raised on a WinRT thread that must finish on the platform thread.
+    struct PlatformEvent {
+        enum class Kind {
+            kPublisherStatus,
+            kScanResult,
+            kFlushScanResults,
+            // state_ changed; feed the debouncer.
+            kStateChanged,
+            // The state debounce timer fired.
+            kStateSettled,
+            // InitializeAsync finished; replay deferred method calls.
+            kInitialized,
+            // The transport finished sending |value| to |client|.
+            kGattValueSent,
+            // A client disconnected; report the streams that failed.
+            kDataStreamsChanged,
+            // |client| negotiated ATT_MTU |mtu|.
+            kMtuChanged,
+            // |value| is a message reassembled from writes to the data rx
+            // characteristic.
+            kDataReceived,
+            // The metrics stream timer fired.
+            kMetricsTick,
+        };
+
+        Kind kind = Kind::kPublisherStatus;
+        PublisherStatus status = PublisherStatus::created;
+        // Number of the publisher that raised |status|.
+        uint64_t publisher = 0;
+        ScanEvent scan;
+        GattClientId client = 0;
+        SharedBuffer value;
+        bool delivered = false;
+        size_t mtu = 0;
+        // Metrics::Now() when the watcher raised |scan|.
+        std::chrono::nanoseconds received{ 0 };
+    };
+
+    // A sendData call waiting for its streams to finish.
+    struct PendingSendData {
+        std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result;
+        std::vector<StreamId> streams;
+        size_t bytes = 0;
+        size_t clients = 0;
+        bool failed = false;
+        std::chrono::nanoseconds started{ 0 };
+    };
+
+    // A method call that arrived before initialization finished.
+    struct DeferredMethodCall {
+        std::unique_ptr<flutter::MethodCall<flutter::EncodableValue>> call;
+        std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result;
+    };
+
     class FlutterBlePeripheralPlugin : public flutter::Plugin, public flutter::StreamHandler<flutter::EncodableValue> {
     public:
         static void RegisterWithRegistrar(flutter::PluginRegistrarWindows* registrar);
 
-        FlutterBlePeripheralPlugin();
+        explicit FlutterBlePeripheralPlugin(flutter::PluginRegistrarWindows* registrar);
 
         virtual ~FlutterBlePeripheralPlugin();
 
@@ -56,12 +141,30 @@ namespace flutter_ble_peripheral {
         FlutterBlePeripheralPlugin& operator=(const FlutterBlePeripheralPlugin&) = delete;
 
     private:
-        winrt::fire_and_forget InitializeAsync();
+        // Fetches the adapter and radio off the platform thread. Completes
+        // by posting kInitialized, with initialization_error_ set on failure.
+        IAsyncAction InitializeAsync();
+        void FinishInitialization(std::string error);
+        void Radio_StateChanged(Radio const& sender, IInspectable const& args);
+
+        // Any thread, after a state_ setter reported a change.
+        void PostStateChanged();
+
+        // Platform thread. ble_state_changed stream handling.
+        std::unique_ptr<flutter::StreamHandlerError<>> OnStateListen(std::unique_ptr<flutter::EventSink<>>&& events);
+        std::unique_ptr<flutter::StreamHandlerError<>> OnStateCancel();
+        void OnStateChanged();
+        void OnStateSettled();
+        void ArmStateDebounceTimer(std::chrono::nanoseconds deadline);
 
         // Called when a method is called on this plugin's channel from Dart.
+        // Defers the call until initialization has finished.
         void HandleMethodCall(
             const flutter::MethodCall<flutter::EncodableValue>& method_call,
             std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+        void DispatchMethodCall(
+            const flutter::MethodCall<flutter::EncodableValue>& method_call,
+            std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
 
         std::unique_ptr<flutter::StreamHandlerError<>> OnListenInternal(
             const flutter::EncodableValue* arguments,
@@ -69,18 +172,181 @@ namespace flutter_ble_peripheral {
         std::unique_ptr<flutter::StreamHandlerError<>> OnCancelInternal(
             const flutter::EncodableValue* arguments) override;
 
+        // Runs on the platform thread when a drain message arrives.
+        std::optional<LRESULT> HandleWindowProc(HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam);
+        // Without a view there is no top-level window to post drain messages
+        // to; a message-only window on the platform thread takes them instead.
+        HWND CreateMessageWindow();
+        static LRESULT CALLBACK MessageWindowProc(HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam);
+        // Platform thread. Handles a bounded batch of queued events.
+        void DrainPlatformEvents();
+        void HandlePlatformEvent(PlatformEvent& event);
+
+        // Watcher thread.
+        void OnScanResult(const ScanResult& result);
+
+        // GATT transport callbacks, on thread-pool threads.
+        WinRtGattTransport::Callbacks GattCallbacks();
+        void OnGattClientChanged(GattClientId client, bool connected);
+
+        // Adds the service sendData notifies through, if it is not there yet.
+        // Must be called with gatt_mutex_ held.
+        bool EnsureDataService();
+
+        // Feeds a write to the data rx characteristic to write_assembler_.
+        // Must be called with gatt_mutex_ held.
+        GattStatus OnDataWrite(GattClientId client, GattWriteKind kind, size_t offset, ByteView value);
+        // Posts a message the data rx characteristic received.
+        void PostDataReceived(SharedBuffer message);
+
+        // Platform thread. Refills the streams' windows, reports their
+        // progress and completes sendData calls whose streams are done.
+        void PumpDataStreams();
+        std::unique_ptr<flutter::StreamHandlerError<>> OnSendProgressListen(
+            std::unique_ptr<flutter::EventSink<>>&& events);
+        std::unique_ptr<flutter::StreamHandlerError<>> OnSendProgressCancel();
+
+        // Platform thread. ble_mtu_changed stream handling.
+        std::unique_ptr<flutter::StreamHandlerError<>> OnMtuListen(std::unique_ptr<flutter::EventSink<>>&& events);
+        std::unique_ptr<flutter::StreamHandlerError<>> OnMtuCancel();
+
+        // Platform thread. ble_metrics stream handling; the listen argument
+        // is the interval in milliseconds.
+        std::unique_ptr<flutter::StreamHandlerError<>> OnMetricsListen(
+            const flutter::EncodableValue* arguments, std::unique_ptr<flutter::EventSink<>>&& events);
+        std::unique_ptr<flutter::StreamHandlerError<>> OnMetricsCancel();
+
+        // Platform thread. Drains scan_batcher_ to the sink as one list or
+        // binary message.
+        void FlushScanResults();
+        void SendScanRecord(const ScanResult& result);
+        void RestartScanFlushTimer();
+
+        // Arms the scheduler timer for |wakeup|, a SteadyClock time. Must be
+        // called with mutex_ held.
+        void ScheduleNextTick(std::optional<std::chrono::nanoseconds> wakeup);
+
+        // Arms the scan window timer for |wakeup|, a SteadyClock time. Must
+        // be called with mutex_ held.
+        void ScheduleScanTick(std::optional<std::chrono::nanoseconds> wakeup);
+
+        flutter::PluginRegistrarWindows* registrar_;
+        flutter::BinaryMessenger* messenger_;
+
+        SteadyClock clock_;
+        // Entered by every thread-pool timer callback, every radio, backend
+        // and GATT callback and InitializeAsync; the destructor shuts it
+        // down before cancelling the timers, which does not wait for
+        // callbacks already running.
+        std::shared_ptr<CallbackGuard> callback_guard_ = std::make_shared<CallbackGuard>();
+        // Recorded from every thread; read by getMetrics and the ble_metrics
+        // stream, whose timer only posts kMetricsTick.
+        Metrics metrics_{ clock_ };
+        std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> metrics_sink_;
+        ThreadPoolTimer metrics_timer_{ nullptr };
+
+        // Callback threads post here; the top-level window proc delegate, or
+        // message_window_ when there is no view, drains it on the platform
+        // thread, which is the only thread that touches sinks, channels and
+        // core_'s publisher status. Method calls drain it too, so events
+        // still flow if no drain message can be posted.
+        // Read by the wake on every posting thread.
+        std::atomic<HWND> platform_window_{ nullptr };
+        HWND message_window_ = nullptr;
+        int window_proc_id_ = -1;
+        EventPump<PlatformEvent> events_;
+
         std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> scan_result_sink_;
 
+        // Opt-in compact scan results, see core/scan_record_codec.h.
+        std::atomic<bool> binary_scan_results_{ false };
+
+        // Opt-in per-device dedup: advertisements whose payload and name match
+        // the last one from the same address only update scan_cache_. The
+        // watcher thread classifies; scan_cache_mutex_ lets the platform thread
+        // reconfigure it and read its stats.
+        std::atomic<bool> dedup_scan_results_{ false };
+        AdvertisementCache scan_cache_;
+        std::mutex scan_cache_mutex_;
+
+        // Opt-in per-device RSSI history behind getRssiStats. The watcher
+        // thread records every result that passed the scan filter, dedup
+        // or not; rssi_history_mutex_ lets the platform thread query and
+        // replace it. Sized down to one sample until setRssiHistory.
+        std::atomic<bool> record_rssi_history_{ false };
+        RssiHistory rssi_history_{ RssiHistoryOptions{ 1, 1 } };
+        std::mutex rssi_history_mutex_;
+
+        // Opt-in batching between the watcher and the sink. The watcher thread
+        // is the batcher's producer and the platform thread its consumer; the
+        // flush timer only posts a flush event.
+        std::atomic<bool> batch_scan_results_{ false };
+        ScanBatcher scan_batcher_;
+        ScanRecordWriter scan_record_writer_;
+        ThreadPoolTimer scan_flush_timer_{ nullptr };
+
+        IAsyncAction initialization_{ nullptr };
+        std::string initialization_error_;
+        // Platform thread only.
+        InitializationGate<DeferredMethodCall> initialization_gate_;
+
         Radio bluetoothRadio{ nullptr };
+        winrt::event_token bluetoothRadioStateChangedToken;
+
+        // Kept current from radio and publisher events on whatever thread
+        // raises them, so isSupported, isAdvertising and isConnected answer
+        // without a WinRT round-trip.
+        AtomicStateSnapshot state_;
 
-        BluetoothLEAdvertisementWatcher bluetoothLEWatcher{ nullptr };
-        winrt::event_token bluetoothLEWatcherReceivedToken;
-        void BluetoothLEWatcher_Received(BluetoothLEAdvertisementWatcher sender, BluetoothLEAdvertisementReceivedEventArgs args);
+        // Platform thread only. Debounced, deduplicated PeripheralState for
+        // the ble_state_changed event channel.
+        std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> state_sink_;
+        StateDebouncer state_debouncer_;
+        ThreadPoolTimer state_debounce_timer_{ nullptr };
 
+        WinRtRadioBackend backend_;
+        PeripheralCore core_;
 
-        BluetoothLEAdvertisementPublisher bluetoothLEPublisher{ nullptr };
+        // Guards core_, scheduler_ and scan_session_, which their timers
+        // drive from thread-pool threads, and with them backend_.
+        std::mutex mutex_;
+        StartupTimeline startup_{ clock_.Now() };
+        AdvertisingScheduler scheduler_;
+        ThreadPoolTimer scheduler_timer_{ nullptr };
+        // The startScan..stopScan session. Its timer opens and closes scan
+        // windows shorter than the interval.
+        ScanSession scan_session_{ backend_, clock_ };
+        ThreadPoolTimer scan_session_timer_{ nullptr };
+        // startScanCapture..stopScanCapture records what the watcher receives.
+        // A replay feeds backend_ from its own thread in place of the
+        // watcher, so the two never run at once: scan_batcher_ takes a
+        // single producer.
+        std::shared_ptr<ScanCaptureWriter> scan_capture_;
+        std::unique_ptr<BackgroundScanReplay> scan_replay_;
 
+        // The GATT server. gatt_mutex_ serializes the transport's callbacks
+        // with method calls. It and the data characteristics are declared
+        // before the transport so that they outlive it; the destructor shuts
+        // the transport down before gatt_ and the rest go away.
+        std::mutex gatt_mutex_;
+        // Characteristics of the data service, 0 until sendData first runs.
+        GattHandle data_tx_ = 0;
+        GattHandle data_rx_ = 0;
+        WinRtGattTransport gatt_transport_;
+        GattServer gatt_{ gatt_transport_ };
+        DataStreamer streamer_{ gatt_, clock_ };
+        // Writes to the data rx characteristic bypass gatt_, which keeps
+        // attribute values to 512 bytes. WinRT only ever reports plain
+        // writes, which write_assembler_ turns into messages in pooled
+        // buffers; it sees no prepare writes to assemble.
+        BufferPool write_pool_;
+        WriteAssembler write_assembler_{ write_pool_ };
 
+        // Platform thread only. sendData calls in flight and the
+        // ble_send_progress event channel.
+        std::vector<PendingSendData> pending_send_data_;
+        std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> send_progress_sink_;
+        std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> mtu_sink_;
     };
 
 }  // namespace flutter_ble_peripheral
@@ -0,0 +1,33 @@
+#ifndef FLUTTER_PLUGIN_WINRT_BLUETOOTH_UUID_H_
+#define FLUTTER_PLUGIN_WINRT_BLUETOOTH_UUID_H_
+
+// This must be included before many other Windows headers.
+#include <windows.h>
+#include <winrt/Windows.Foundation.h>
+#include <winrt/Windows.Devices.Bluetooth.h>
+
+#include <cstdint>
+
+#include "core/ad_encoder.h"
+
+namespace flutter_ble_peripheral {
+
+    // BluetoothUuid keeps the over-the-air little-endian bytes; a GUID is the
+    // big-endian textual form split into fields.
+    inline winrt::guid ToGuid(const BluetoothUuid& uuid) {
+        const auto& b = uuid.bytes;
+        if (uuid.size != 16) {
+            uint32_t id = b[0] | (b[1] << 8) | (uint32_t{ b[2] } << 16) | (uint32_t{ b[3] } << 24);
+            return winrt::Windows::Devices::Bluetooth::BluetoothUuidHelper::FromShortId(id);
+        }
+        return winrt::guid{
+            uint32_t{ b[12] } | (uint32_t{ b[13] } << 8) | (uint32_t{ b[14] } << 16) | (uint32_t{ b[15] } << 24),
+            static_cast<uint16_t>(b[10] | (b[11] << 8)),
+            static_cast<uint16_t>(b[8] | (b[9] << 8)),
+            { b[7], b[6], b[5], b[4], b[3], b[2], b[1], b[0] },
+        };
+    }
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_PLUGIN_WINRT_BLUETOOTH_UUID_H_
@@ -0,0 +1,353 @@
+#include "winrt_gatt_transport.h"
+
+#include <algorithm>
+
+#include "winrt_bluetooth_uuid.h"
+#include "winrt_shared_buffer.h"
+
+#pragma warning( push )
+#pragma warning( disable : 4101)
+#pragma warning( disable : 4244)
+
+namespace flutter_ble_peripheral {
+
+    using namespace winrt;
+    using namespace winrt::Windows::Foundation;
+    using namespace winrt::Windows::Storage::Streams;
+    using namespace winrt::Windows::Devices::Bluetooth;
+    using namespace winrt::Windows::Devices::Bluetooth::GenericAttributeProfile;
+
+    WinRtGattTransport::WinRtGattTransport(Callbacks callbacks) : callbacks_(std::move(callbacks)) {}
+
+    WinRtGattTransport::~WinRtGattTransport() {
+        Shutdown();
+    }
+
+    void WinRtGattTransport::Shutdown() {
+        if (callback_guard_->shut_down()) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& [handle, characteristic] : characteristics_) RevokeCharacteristic(characteristic);
+            for (auto& [handle, service] : services_) {
+                if (service.provider) service.provider.StopAdvertising();
+            }
+            for (auto& [id, client] : clients_) RevokeSession(client);
+        }
+        // Revoking does not wait for a handler that already started, and
+        // those take mutex_.
+        callback_guard_->Shutdown();
+    }
+
+    bool WinRtGattTransport::PublishService(const GattService& service) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            services_.emplace(service.handle, LocalService());
+        }
+        PublishAsync(service);
+        return true;
+    }
+
+    void WinRtGattTransport::RemoveService(GattHandle service) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = services_.find(service);
+        if (it == services_.end()) return;
+        // A publication still in flight sees the entry gone and gives up.
+        if (it->second.provider) it->second.provider.StopAdvertising();
+        services_.erase(it);
+        for (auto c = characteristics_.begin(); c != characteristics_.end();) {
+            if (c->second.service != service) {
+                ++c;
+                continue;
+            }
+            RevokeCharacteristic(c->second);
+            c = characteristics_.erase(c);
+        }
+    }
+
+    bool WinRtGattTransport::SendValue(GattClientId client, GattHandle characteristic,
+                                       const SharedBuffer& value, bool indicate) {
+        // The stack sends a notification or an indication depending on what
+        // the client wrote to the descriptor, so |indicate| needs no handling.
+        GattLocalCharacteristic local{ nullptr };
+        GattSession session{ nullptr };
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto c = characteristics_.find(characteristic);
+            auto s = clients_.find(client);
+            if (c == characteristics_.end() || s == clients_.end()) return false;
+            if (s->second.pending >= kMaxPendingPerClient) return false;
+            local = c->second.characteristic;
+            session = s->second.session;
+        }
+
+        for (const auto& subscribed : local.SubscribedClients()) {
+            if (subscribed.Session() != session) continue;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto s = clients_.find(client);
+                if (s == clients_.end()) return false;
+                ++s->second.pending;
+            }
+            // Called outside mutex_: an operation that is already complete
+            // runs its handler on this thread.
+            auto operation = local.NotifyValueAsync(make<SharedBufferView>(value), subscribed);
+            operation.Completed([this, guard = callback_guard_, client, characteristic,
+                                 value](auto const& sender, AsyncStatus status) {
+                auto scope = guard->Enter();
+                if (!scope) return;
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    auto s = clients_.find(client);
+                    if (s != clients_.end() && s->second.pending > 0) --s->second.pending;
+                }
+                const bool delivered = status == AsyncStatus::Completed &&
+                    sender.GetResults().Status() == GattCommunicationStatus::Success;
+                if (callbacks_.sent) callbacks_.sent(client, characteristic, value, delivered);
+            });
+            return true;
+        }
+        return false;
+    }
+
+    fire_and_forget WinRtGattTransport::PublishAsync(GattService service) {
+        // Copied into the frame: |this| may be gone by the time a co_await
+        // resumes.
+        auto guard = callback_guard_;
+        auto providerResult = co_await GattServiceProvider::CreateAsync(ToGuid(service.uuid));
+        {
+            auto scope = guard->Enter();
+            if (!scope) co_return;
+            if (providerResult.Error() != BluetoothError::Success) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                services_.erase(service.handle);
+                co_return;
+            }
+        }
+        auto provider = providerResult.ServiceProvider();
+
+        for (const auto& definition : service.characteristics) {
+            GattLocalCharacteristicParameters parameters;
+            parameters.CharacteristicProperties(static_cast<GattCharacteristicProperties>(definition.properties));
+            parameters.ReadProtectionLevel(GattProtectionLevel::Plain);
+            parameters.WriteProtectionLevel(GattProtectionLevel::Plain);
+            auto result = co_await provider.Service().CreateCharacteristicAsync(ToGuid(definition.uuid), parameters);
+            auto scope = guard->Enter();
+            if (!scope) co_return;
+            // A characteristic the stack refused simply never sees requests.
+            if (result.Error() != BluetoothError::Success) continue;
+
+            const GattHandle handle = definition.handle;
+            LocalCharacteristic local;
+            local.handle = handle;
+            local.service = service.handle;
+            local.properties = definition.properties;
+            local.characteristic = result.Characteristic();
+            // The request coroutines enter the guard again once they have
+            // their request.
+            local.readRequestedToken = local.characteristic.ReadRequested(
+                [this, guard, handle](GattLocalCharacteristic const&, GattReadRequestedEventArgs const& args) {
+                    auto scope = guard->Enter();
+                    if (!scope) return;
+                    Characteristic_ReadRequested(handle, args);
+                });
+            local.writeRequestedToken = local.characteristic.WriteRequested(
+                [this, guard, handle](GattLocalCharacteristic const&, GattWriteRequestedEventArgs const& args) {
+                    auto scope = guard->Enter();
+                    if (!scope) return;
+                    Characteristic_WriteRequested(handle, args);
+                });
+            local.subscribedClientsChangedToken = local.characteristic.SubscribedClientsChanged(
+                [this, guard, handle](GattLocalCharacteristic const&, IInspectable const&) {
+                    auto scope = guard->Enter();
+                    if (!scope) return;
+                    Characteristic_SubscribedClientsChanged(handle);
+                });
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (services_.find(service.handle) == services_.end()) {
+                RevokeCharacteristic(local);
+                co_return;
+            }
+            characteristics_.emplace(handle, std::move(local));
+        }
+
+        auto scope = guard->Enter();
+        if (!scope) co_return;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = services_.find(service.handle);
+            if (it == services_.end()) co_return;
+            it->second.provider = provider;
+        }
+        GattServiceProviderAdvertisingParameters advertising;
+        advertising.IsConnectable(true);
+        advertising.IsDiscoverable(true);
+        provider.StartAdvertising(advertising);
+    }
+
+    fire_and_forget WinRtGattTransport::Characteristic_ReadRequested(
+        GattHandle handle, GattReadRequestedEventArgs args) {
+        // Copied before the co_await; |this| may be gone once it resumes.
+        auto guard = callback_guard_;
+        auto deferral = args.GetDeferral();
+        // Null when the client may not access the characteristic.
+        auto request = co_await args.GetRequestAsync();
+        auto scope = guard->Enter();
+        if (request && scope) {
+            auto result = callbacks_.read(ClientFor(args.Session()), handle, request.Offset());
+            if (result.status == GattStatus::kSuccess) {
+                // Whole-value reads, the common case, go out without a copy.
+                auto value = result.offset == 0 ? result.value : SharedBuffer::CopyFrom(result.bytes());
+                request.RespondWithValue(make<SharedBufferView>(std::move(value)));
+            }
+            else {
+                request.RespondWithProtocolError(static_cast<uint8_t>(result.status));
+            }
+        }
+        deferral.Complete();
+    }
+
+    fire_and_forget WinRtGattTransport::Characteristic_WriteRequested(
+        GattHandle handle, GattWriteRequestedEventArgs args) {
+        auto guard = callback_guard_;
+        auto deferral = args.GetDeferral();
+        auto request = co_await args.GetRequestAsync();
+        auto scope = guard->Enter();
+        if (request && scope) {
+            const bool with_response = request.Option() == GattWriteOption::WriteWithResponse;
+            auto buffer = request.Value();
+            auto status = callbacks_.write(ClientFor(args.Session()), handle, GattWriteKind::kWrite, request.Offset(),
+                                           ByteView(buffer.data(), buffer.Length()), with_response);
+            if (with_response) {
+                if (status == GattStatus::kSuccess) {
+                    request.Respond();
+                }
+                else {
+                    request.RespondWithProtocolError(static_cast<uint8_t>(status));
+                }
+            }
+        }
+        deferral.Complete();
+    }
+
+    void WinRtGattTransport::Characteristic_SubscribedClientsChanged(GattHandle handle) {
+        GattLocalCharacteristic local{ nullptr };
+        uint8_t properties = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = characteristics_.find(handle);
+            if (it == characteristics_.end()) return;
+            local = it->second.characteristic;
+            properties = it->second.properties;
+        }
+
+        std::vector<GattClientId> current;
+        for (const auto& subscribed : local.SubscribedClients()) {
+            current.push_back(ClientFor(subscribed.Session()));
+        }
+
+        // WinRT only says that the list changed; work out how.
+        std::vector<GattClientId> added;
+        std::vector<GattClientId> removed;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = characteristics_.find(handle);
+            if (it == characteristics_.end()) return;
+            auto& previous = it->second.subscribers;
+            for (auto client : current) {
+                if (std::find(previous.begin(), previous.end(), client) == previous.end()) added.push_back(client);
+            }
+            for (auto client : previous) {
+                if (std::find(current.begin(), current.end(), client) == current.end()) removed.push_back(client);
+            }
+            previous = current;
+        }
+
+        // The client's descriptor value is not exposed; assume it asked for
+        // what the characteristic offers, notifications first.
+        const auto subscription = (properties & kGattNotify) ? GattSubscription::kNotify : GattSubscription::kIndicate;
+        for (auto client : added) callbacks_.subscriptionChanged(client, handle, subscription);
+        for (auto client : removed) callbacks_.subscriptionChanged(client, handle, GattSubscription::kNone);
+    }
+
+    void WinRtGattTransport::Session_StatusChanged(GattSession const& sender,
+                                                   GattSessionStatusChangedEventArgs const& args) {
+        if (args.Status() != GattSessionStatus::Closed) return;
+
+        GattClientId id = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto key = client_ids_.find(sender.DeviceId().Id());
+            if (key == client_ids_.end()) return;
+            id = key->second;
+            client_ids_.erase(key);
+            auto client = clients_.find(id);
+            if (client != clients_.end()) {
+                RevokeSession(client->second);
+                clients_.erase(client);
+            }
+            for (auto& [handle, characteristic] : characteristics_) {
+                auto& subscribers = characteristic.subscribers;
+                subscribers.erase(std::remove(subscribers.begin(), subscribers.end(), id), subscribers.end());
+            }
+        }
+        callbacks_.disconnected(id);
+    }
+
+    void WinRtGattTransport::Session_MaxPduSizeChanged(GattSession const& sender, IInspectable const&) {
+        GattClientId id = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto key = client_ids_.find(sender.DeviceId().Id());
+            if (key == client_ids_.end()) return;
+            id = key->second;
+        }
+        callbacks_.mtuChanged(id, sender.MaxPduSize());
+    }
+
+    GattClientId WinRtGattTransport::ClientFor(GattSession const& session) {
+        GattClientId id = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto [key, inserted] = client_ids_.emplace(session.DeviceId().Id(), next_client_);
+            id = key->second;
+            if (!inserted) return id;
+            ++next_client_;
+            Client client;
+            client.session = session;
+            client.sessionStatusChangedToken = session.SessionStatusChanged(
+                [this, guard = callback_guard_](GattSession const& sender,
+                                                GattSessionStatusChangedEventArgs const& args) {
+                    auto scope = guard->Enter();
+                    if (!scope) return;
+                    Session_StatusChanged(sender, args);
+                });
+            client.maxPduSizeChangedToken = session.MaxPduSizeChanged(
+                [this, guard = callback_guard_](GattSession const& sender, IInspectable const& args) {
+                    auto scope = guard->Enter();
+                    if (!scope) return;
+                    Session_MaxPduSizeChanged(sender, args);
+                });
+            clients_.emplace(id, std::move(client));
+        }
+        callbacks_.connected(id);
+        // The exchange may have finished before the handler was attached.
+        callbacks_.mtuChanged(id, session.MaxPduSize());
+        return id;
+    }
+
+    void WinRtGattTransport::RevokeCharacteristic(LocalCharacteristic& characteristic) {
+        characteristic.characteristic.ReadRequested(characteristic.readRequestedToken);
+        characteristic.characteristic.WriteRequested(characteristic.writeRequestedToken);
+        characteristic.characteristic.SubscribedClientsChanged(characteristic.subscribedClientsChangedToken);
+    }
+
+    // static
+    void WinRtGattTransport::RevokeSession(Client& client) {
+        client.session.SessionStatusChanged(client.sessionStatusChangedToken);
+        client.session.MaxPduSizeChanged(client.maxPduSizeChangedToken);
+    }
+
+}  // namespace flutter_ble_peripheral
+
+#pragma warning( pop )
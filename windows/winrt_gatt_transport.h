@@ -0,0 +1,143 @@
+#ifndef FLUTTER_PLUGIN_WINRT_GATT_TRANSPORT_H_
+#define FLUTTER_PLUGIN_WINRT_GATT_TRANSPORT_H_
+
+// This must be included before many other Windows headers.
+#include <windows.h>
+#include <winrt/Windows.Foundation.h>
+#include <winrt/Windows.Foundation.Collections.h>
+#include <winrt/Windows.Storage.Streams.h>
+#include <winrt/Windows.Devices.Bluetooth.h>
+#include <winrt/Windows.Devices.Bluetooth.GenericAttributeProfile.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "core/callback_guard.h"
+#include "core/gatt_server.h"
+#include "core/gatt_transport.h"
+
+namespace flutter_ble_peripheral {
+
+    // GattTransport on top of GattServiceProvider. Everything winrt:: stays
+    // in this class; the plugin only sees core types.
+    //
+    // WinRT has no connection event for a GATT server, so a client counts as
+    // connected from its first request or subscription until its GattSession
+    // closes. All callbacks run on WinRT thread-pool threads; reads and writes
+    // are answered with what their callback returns. None runs once Shutdown
+    // has returned.
+    class WinRtGattTransport : public GattTransport {
+    public:
+        struct Callbacks {
+            std::function<void(GattClientId)> connected;
+            std::function<void(GattClientId)> disconnected;
+            std::function<void(GattClientId, GattHandle, GattSubscription)> subscriptionChanged;
+            // The session's MaxPduSize, which is its ATT_MTU. Raised once
+            // after connected and again on every renegotiation.
+            std::function<void(GattClientId, size_t mtu)> mtuChanged;
+            std::function<GattReadResult(GattClientId, GattHandle, size_t offset)> read;
+            // A GattWriteRequest carries only the value, the offset and
+            // whether a response is wanted; nothing tells a Write Request
+            // from a queued Prepare Write Request or raises the Execute
+            // Write Request (see learn.microsoft.com/uwp/api/
+            // windows.devices.bluetooth.genericattributeprofile.gattwriterequest).
+            // Every write is therefore reported as GattWriteKind::kWrite at
+            // its offset, and the core answers a nonzero offset with
+            // Invalid Offset rather than guess where a long write starts.
+            std::function<GattStatus(GattClientId, GattHandle, GattWriteKind, size_t offset, ByteView value,
+                                     bool withResponse)> write;
+            // A SendValue finished. May run inside SendValue when the stack
+            // completes the notification at once.
+            std::function<void(GattClientId, GattHandle, const SharedBuffer& value, bool delivered)> sent;
+        };
+
+        // Notifications queued to one client and not yet completed before
+        // SendValue pushes back.
+        static constexpr size_t kMaxPendingPerClient = 32;
+
+        explicit WinRtGattTransport(Callbacks callbacks);
+        ~WinRtGattTransport() override;
+
+        // Disallow copy and assign.
+        WinRtGattTransport(const WinRtGattTransport&) = delete;
+        WinRtGattTransport& operator=(const WinRtGattTransport&) = delete;
+
+        // Stops the services, revokes every WinRT handler and waits for the
+        // ones already running, so that the owner can tear down what the
+        // callbacks touch. The destructor calls it too. Must not be called
+        // from a callback.
+        void Shutdown();
+
+        // Starts creating the service provider and returns; creation finishes
+        // on a thread-pool thread.
+        bool PublishService(const GattService& service) override;
+        void RemoveService(GattHandle service) override;
+        bool SendValue(GattClientId client, GattHandle characteristic,
+                       const SharedBuffer& value, bool indicate) override;
+
+    private:
+        struct LocalCharacteristic {
+            GattHandle handle = 0;
+            GattHandle service = 0;
+            uint8_t properties = 0;
+            winrt::Windows::Devices::Bluetooth::GenericAttributeProfile::GattLocalCharacteristic characteristic{ nullptr };
+            winrt::event_token readRequestedToken;
+            winrt::event_token writeRequestedToken;
+            winrt::event_token subscribedClientsChangedToken;
+            std::vector<GattClientId> subscribers;
+        };
+
+        struct LocalService {
+            winrt::Windows::Devices::Bluetooth::GenericAttributeProfile::GattServiceProvider provider{ nullptr };
+        };
+
+        struct Client {
+            winrt::Windows::Devices::Bluetooth::GenericAttributeProfile::GattSession session{ nullptr };
+            winrt::event_token sessionStatusChangedToken;
+            winrt::event_token maxPduSizeChangedToken;
+            size_t pending = 0;
+        };
+
+        winrt::fire_and_forget PublishAsync(GattService service);
+        winrt::fire_and_forget Characteristic_ReadRequested(
+            GattHandle handle,
+            winrt::Windows::Devices::Bluetooth::GenericAttributeProfile::GattReadRequestedEventArgs args);
+        winrt::fire_and_forget Characteristic_WriteRequested(
+            GattHandle handle,
+            winrt::Windows::Devices::Bluetooth::GenericAttributeProfile::GattWriteRequestedEventArgs args);
+        void Characteristic_SubscribedClientsChanged(GattHandle handle);
+        void Session_StatusChanged(
+            winrt::Windows::Devices::Bluetooth::GenericAttributeProfile::GattSession const& sender,
+            winrt::Windows::Devices::Bluetooth::GenericAttributeProfile::GattSessionStatusChangedEventArgs const& args);
+        void Session_MaxPduSizeChanged(
+            winrt::Windows::Devices::Bluetooth::GenericAttributeProfile::GattSession const& sender,
+            winrt::Windows::Foundation::IInspectable const& args);
+
+        // The id of |session|'s client, raising connected for a new one.
+        GattClientId ClientFor(winrt::Windows::Devices::Bluetooth::GenericAttributeProfile::GattSession const& session);
+        void RevokeCharacteristic(LocalCharacteristic& characteristic);
+        static void RevokeSession(Client& client);
+
+        Callbacks callbacks_;
+        // Entered by every WinRT handler and coroutine before it touches the
+        // transport. PublishAsync resumes on the thread that published, so it
+        // never holds a scope across a co_await.
+        std::shared_ptr<CallbackGuard> callback_guard_ = std::make_shared<CallbackGuard>();
+
+        // Guards everything below; WinRT raises events on several threads at
+        // once.
+        std::mutex mutex_;
+        std::map<GattHandle, LocalService> services_;
+        std::map<GattHandle, LocalCharacteristic> characteristics_;
+        std::map<GattClientId, Client> clients_;
+        // Keyed by the client device id.
+        std::map<winrt::hstring, GattClientId> client_ids_;
+        GattClientId next_client_ = 1;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_PLUGIN_WINRT_GATT_TRANSPORT_H_
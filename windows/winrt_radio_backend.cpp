@@ -0,0 +1,268 @@
+#include "winrt_radio_backend.h"
+
+#include "winrt_bluetooth_uuid.h"
+#include "winrt_shared_buffer.h"
+
+#pragma warning( push )
+#pragma warning( disable : 4101)
+#pragma warning( disable : 4244)
+
+namespace flutter_ble_peripheral {
+
+    using namespace winrt;
+    using namespace winrt::Windows::Foundation;
+    using namespace winrt::Windows::Storage::Streams;
+    using namespace winrt::Windows::Devices::Bluetooth;
+    using namespace winrt::Windows::Devices::Bluetooth::Advertisement;
+
+    WinRtRadioBackend::WinRtRadioBackend(Metrics& metrics, StatusCallback on_status, ScanResultCallback on_scan_result)
+        : metrics_(metrics), on_status_(std::move(on_status)), on_scan_result_(std::move(on_scan_result)) {}
+
+    WinRtRadioBackend::~WinRtRadioBackend() {
+        if (bluetoothLEPublisher) {
+            bluetoothLEPublisher.StatusChanged(bluetoothLEPublisherStatusChangedToken);
+        }
+        if (bluetoothLEWatcher) {
+            bluetoothLEWatcher.Received(bluetoothLEWatcherReceivedToken);
+        }
+        // Revoking does not wait for a handler that already started.
+        callback_guard_->Shutdown();
+    }
+
+    void WinRtRadioBackend::ReleasePublisher() {
+        if (!bluetoothLEPublisher) return;
+        // Revoked first, so the old publisher stopping is not taken for the
+        // new one.
+        bluetoothLEPublisher.StatusChanged(bluetoothLEPublisherStatusChangedToken);
+        const auto status = bluetoothLEPublisher.Status();
+        if (status == BluetoothLEAdvertisementPublisherStatus::Started ||
+            status == BluetoothLEAdvertisementPublisherStatus::Waiting) {
+            bluetoothLEPublisher.Stop();
+        }
+        bluetoothLEPublisher = nullptr;
+    }
+
+    bool WinRtRadioBackend::StartAdvertising(const AdvertiseData& data) {
+        // A started publisher keeps the advertisement it started with, so
+        // every start builds a new one.
+        ReleasePublisher();
+        uint64_t publisher;
+        {
+            std::lock_guard<std::mutex> lock(publisher_mutex_);
+            publisher = ++publisher_;
+        }
+        bluetoothLEPublisher = BluetoothLEAdvertisementPublisher();
+        bluetoothLEPublisherStatusChangedToken = bluetoothLEPublisher.StatusChanged(
+            [this, publisher, guard = callback_guard_](const BluetoothLEAdvertisementPublisher&,
+                                                       const BluetoothLEAdvertisementPublisherStatusChangedEventArgs& args) {
+                auto scope = guard->Enter();
+                if (!scope) return;
+                Publisher_StatusChanged(publisher, args);
+            });
+
+        // No company id, no manufacturer data record.
+        if (data.manufacturerId) {
+            auto manufacturerData = BluetoothLEManufacturerData();
+            manufacturerData.CompanyId(*data.manufacturerId);
+            if (!data.manufacturerData.empty()) {
+                manufacturerData.Data(make<SharedBufferView>(data.manufacturerData));
+            }
+            bluetoothLEPublisher.Advertisement().ManufacturerData().Append(manufacturerData);
+        }
+        metrics_.OnPublisherStartRequested();
+        bluetoothLEPublisher.Start();
+        return bluetoothLEPublisher.Status() != BluetoothLEAdvertisementPublisherStatus::Aborted;
+    }
+
+    void WinRtRadioBackend::StopAdvertising() {
+        if (bluetoothLEPublisher) {
+            bluetoothLEPublisher.Advertisement().ManufacturerData().Clear();
+            bluetoothLEPublisher.Stop();
+        }
+    }
+
+    bool WinRtRadioBackend::UpdateAdvertisement(const AdvertiseData&, uint32_t changed) {
+        // A publisher that stopped or aborted broadcasts nothing to update.
+        if (!bluetoothLEPublisher) return false;
+        const auto status = bluetoothLEPublisher.Status();
+        if (status != BluetoothLEAdvertisementPublisherStatus::Started &&
+            status != BluetoothLEAdvertisementPublisherStatus::Waiting) {
+            return false;
+        }
+        // The publisher only carries manufacturer data, so nothing else can
+        // have changed on air.
+        if ((changed & (kManufacturerId | kManufacturerData)) == 0) return true;
+        // A started publisher broadcasts the advertisement it started with;
+        // WinRT has no call that swaps it. Manufacturer data changes go
+        // through a stop/start onto a new publisher, and the core reports
+        // the update as restarted.
+        return false;
+    }
+
+    void WinRtRadioBackend::EnsureWatcher() {
+        if (bluetoothLEWatcher) return;
+        bluetoothLEWatcher = BluetoothLEAdvertisementWatcher();
+        bluetoothLEWatcherReceivedToken = bluetoothLEWatcher.Received(
+            [this, guard = callback_guard_](const BluetoothLEAdvertisementWatcher& sender,
+                                            const BluetoothLEAdvertisementReceivedEventArgs& args) {
+                auto scope = guard->Enter();
+                if (!scope) return;
+                BluetoothLEWatcher_Received(sender, args);
+            });
+    }
+
+    bool WinRtRadioBackend::StartScan(const ScanSettings& settings) {
+        EnsureWatcher();
+        // Mode and filters only take effect from a start.
+        if (bluetoothLEWatcher.Status() == BluetoothLEAdvertisementWatcherStatus::Started) {
+            bluetoothLEWatcher.Stop();
+        }
+        scan_settings_ = settings;
+        bluetoothLEWatcher.ScanningMode(settings.mode == ScanMode::kActive
+            ? BluetoothLEScanningMode::Active
+            : BluetoothLEScanningMode::Passive);
+        ApplyWatcherFilters();
+        bluetoothLEWatcher.Start();
+        return bluetoothLEWatcher.Status() != BluetoothLEAdvertisementWatcherStatus::Aborted;
+    }
+
+    void WinRtRadioBackend::StopScan() {
+        if (bluetoothLEWatcher && bluetoothLEWatcher.Status() == BluetoothLEAdvertisementWatcherStatus::Started) {
+            bluetoothLEWatcher.Stop();
+        }
+    }
+
+    void WinRtRadioBackend::Publisher_StatusChanged(
+        uint64_t publisher,
+        BluetoothLEAdvertisementPublisherStatusChangedEventArgs args) {
+        const auto status = static_cast<PublisherStatus>(args.Status());
+        std::lock_guard<std::mutex> lock(publisher_mutex_);
+        // A handler already running when ReleasePublisher revoked it.
+        if (publisher != publisher_) return;
+        metrics_.OnPublisherStatus(status);
+        if (on_status_) {
+            on_status_(status, publisher);
+        }
+    }
+
+    void WinRtRadioBackend::SetScanFilter(std::shared_ptr<const ScanFilter> filter, ScanFilterPushDown push_down) {
+        if (filter && filter->passes_all()) filter = nullptr;
+        std::atomic_store(&scan_filter_, std::move(filter));
+        scan_filter_push_down_ = std::move(push_down);
+    }
+
+    void WinRtRadioBackend::ApplyWatcherFilters() {
+        const auto& push_down = scan_filter_push_down_;
+        auto signalStrengthFilter = BluetoothSignalStrengthFilter();
+        if (push_down.minRssi) {
+            signalStrengthFilter.InRangeThresholdInDBm(*push_down.minRssi);
+        }
+        // The scan interval: each device is reported at most once per
+        // interval, however often it advertises.
+        signalStrengthFilter.SamplingInterval(std::chrono::duration_cast<TimeSpan>(scan_settings_.interval));
+        bluetoothLEWatcher.SignalStrengthFilter(signalStrengthFilter);
+
+        auto advertisementFilter = BluetoothLEAdvertisementFilter();
+        if (push_down.serviceUuid) {
+            advertisementFilter.Advertisement().ServiceUuids().Append(ToGuid(*push_down.serviceUuid));
+        }
+        if (!push_down.manufacturerPattern.empty()) {
+            advertisementFilter.BytePatterns().Append(BluetoothLEAdvertisementBytePattern(
+                kAdManufacturerSpecificData, 0, make<SharedBufferView>(SharedBuffer::CopyFrom(push_down.manufacturerPattern))));
+        }
+        bluetoothLEWatcher.AdvertisementFilter(advertisementFilter);
+    }
+
+    void WinRtRadioBackend::SetScanCapture(std::shared_ptr<ScanCaptureWriter> capture) {
+        std::atomic_store(&scan_capture_, std::move(capture));
+    }
+
+    void WinRtRadioBackend::Replay(const ScanResult& result) {
+        metrics_.Add(MetricCounter::kScanReceived);
+        if (!on_scan_result_) return;
+        if (auto filter = std::atomic_load(&scan_filter_)) {
+            if (!filter->Matches(result)) {
+                filtered_.fetch_add(1, std::memory_order_relaxed);
+                metrics_.Add(MetricCounter::kScanFiltered);
+                return;
+            }
+        }
+        on_scan_result_(result);
+    }
+
+    void WinRtRadioBackend::BluetoothLEWatcher_Received(
+        BluetoothLEAdvertisementWatcher sender,
+        BluetoothLEAdvertisementReceivedEventArgs args) {
+        metrics_.Add(MetricCounter::kScanReceived);
+        if (!on_scan_result_) return;
+        SerializeDataSections(args.Advertisement(), advertisementData_);
+        if (auto capture = std::atomic_load(&scan_capture_)) {
+            capture->Append(ToRawScanResult(args, advertisementData_));
+        }
+        // Runs on the raw structures, before names, manufacturer records or
+        // anything for Dart is built.
+        if (auto filter = std::atomic_load(&scan_filter_)) {
+            if (!filter->Matches(args.RawSignalStrengthInDBm(), advertisementData_)) {
+                filtered_.fetch_add(1, std::memory_order_relaxed);
+                metrics_.Add(MetricCounter::kScanFiltered);
+                return;
+            }
+        }
+        on_scan_result_(ToScanResult(args, advertisementData_, advertisementFields_));
+    }
+
+    void SerializeDataSections(const BluetoothLEAdvertisement& advertisement,
+                               std::vector<uint8_t>& advertisementData) {
+        advertisementData.clear();
+        for (const auto& section : advertisement.DataSections()) {
+            auto data = section.Data();
+            advertisementData.push_back(static_cast<uint8_t>(data.Length() + 1));
+            advertisementData.push_back(section.DataType());
+            advertisementData.insert(advertisementData.end(), data.data(), data.data() + data.Length());
+        }
+    }
+
+    ScanResult ToRawScanResult(const BluetoothLEAdvertisementReceivedEventArgs& args,
+                               const std::vector<uint8_t>& advertisementData) {
+        ScanResult result;
+        result.address = args.BluetoothAddress();
+        result.rssi = args.RawSignalStrengthInDBm();
+        result.timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+            winrt::clock::to_sys(args.Timestamp()).time_since_epoch());
+        switch (args.AdvertisementType()) {
+        case BluetoothLEAdvertisementType::ConnectableUndirected:
+            result.flags = kConnectable | kScannable;
+            break;
+        case BluetoothLEAdvertisementType::ConnectableDirected:
+            result.flags = kConnectable | kDirected;
+            break;
+        case BluetoothLEAdvertisementType::ScannableUndirected:
+            result.flags = kScannable;
+            break;
+        case BluetoothLEAdvertisementType::ScanResponse:
+            result.flags = kScanResponse;
+            break;
+        default:
+            break;
+        }
+
+        result.advertisementData = advertisementData;
+        return result;
+    }
+
+    ScanResult ToScanResult(const BluetoothLEAdvertisementReceivedEventArgs& args,
+                            const std::vector<uint8_t>& advertisementData, AdvertisementFields& fields) {
+        ScanResult result = ToRawScanResult(args, advertisementData);
+        // One pass over the serialized sections instead of the
+        // Advertisement's LocalName and ManufacturerData collections, which
+        // allocate a WinRT object per record.
+        ParseAdvertisement(advertisementData, fields);
+        result.localName.assign(fields.localName.begin(), fields.localName.end());
+        result.manufacturerData.assign(fields.manufacturerData.begin(), fields.manufacturerData.end());
+        result.fields = &fields;
+        return result;
+    }
+
+}  // namespace flutter_ble_peripheral
+
+#pragma warning( pop )
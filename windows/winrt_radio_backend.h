@@ -0,0 +1,144 @@
+#ifndef FLUTTER_PLUGIN_WINRT_RADIO_BACKEND_H_
+#define FLUTTER_PLUGIN_WINRT_RADIO_BACKEND_H_
+
+// This must be included before many other Windows headers.
+#include <windows.h>
+#include <winrt/Windows.Foundation.h>
+#include <winrt/Windows.Foundation.Collections.h>
+#include <winrt/Windows.Storage.Streams.h>
+#include <winrt/Windows.Devices.Bluetooth.h>
+#include <winrt/Windows.Devices.Bluetooth.Advertisement.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "core/ad_parser.h"
+#include "core/callback_guard.h"
+#include "core/metrics.h"
+#include "core/peripheral_state.h"
+#include "core/radio_backend.h"
+#include "core/scan_capture.h"
+#include "core/scan_filter.h"
+#include "core/scan_result.h"
+
+namespace flutter_ble_peripheral {
+
+    // RadioBackend on top of the WinRT advertisement publisher and watcher.
+    // Everything winrt:: stays in this class; the plugin only sees core types.
+    // Both callbacks run on WinRT thread-pool threads. Scan and publisher
+    // events are counted in |metrics|, which must outlive the backend. The
+    // destructor waits for WinRT handlers that are already running.
+    class WinRtRadioBackend : public RadioBackend {
+    public:
+        // Called with the status and the number of the publisher that raised
+        // it, as described in RadioBackend.
+        using StatusCallback = std::function<void(PublisherStatus, uint64_t)>;
+        using ScanResultCallback = std::function<void(const ScanResult&)>;
+
+        WinRtRadioBackend(Metrics& metrics, StatusCallback on_status, ScanResultCallback on_scan_result);
+        ~WinRtRadioBackend() override;
+
+        // Disallow copy and assign.
+        WinRtRadioBackend(const WinRtRadioBackend&) = delete;
+        WinRtRadioBackend& operator=(const WinRtRadioBackend&) = delete;
+
+        bool StartAdvertising(const AdvertiseData& data) override;
+        void StopAdvertising() override;
+        bool UpdateAdvertisement(const AdvertiseData& data, uint32_t changed) override;
+        bool StartScan(const ScanSettings& settings) override;
+        void StopScan() override;
+
+        // Replaces the filter every advertisement has to pass before it is
+        // turned into a ScanResult; null lets everything through. The watcher
+        // applies |push_down| itself from its next StartScan. Call from one
+        // thread at a time, the one that starts and stops the scan.
+        void SetScanFilter(std::shared_ptr<const ScanFilter> filter, ScanFilterPushDown push_down);
+
+        // Starts recording every received advertisement, before the filter,
+        // into |capture|; null stops recording. Safe to call from any thread.
+        void SetScanCapture(std::shared_ptr<ScanCaptureWriter> capture);
+
+        // Feeds a recorded advertisement through the filter and on to the
+        // scan result callback, as if the watcher had just received it.
+        // Replayed advertisements are not captured again. Safe to call from
+        // any thread.
+        void Replay(const ScanResult& result);
+
+        // Advertisements the filter turned away.
+        uint64_t filtered() const { return filtered_.load(std::memory_order_relaxed); }
+
+    private:
+        // Detaches and stops the current publisher, if any.
+        void ReleasePublisher();
+        void EnsureWatcher();
+        void Publisher_StatusChanged(
+            uint64_t publisher,
+            winrt::Windows::Devices::Bluetooth::Advertisement::BluetoothLEAdvertisementPublisherStatusChangedEventArgs args);
+        // Sets the watcher's AdvertisementFilter and SignalStrengthFilter
+        // from scan_filter_push_down_ and scan_settings_.
+        void ApplyWatcherFilters();
+        void BluetoothLEWatcher_Received(
+            winrt::Windows::Devices::Bluetooth::Advertisement::BluetoothLEAdvertisementWatcher sender,
+            winrt::Windows::Devices::Bluetooth::Advertisement::BluetoothLEAdvertisementReceivedEventArgs args);
+
+        Metrics& metrics_;
+        StatusCallback on_status_;
+        ScanResultCallback on_scan_result_;
+        // Entered by the publisher and watcher handlers, which WinRT may
+        // still be running when their tokens are revoked.
+        std::shared_ptr<CallbackGuard> callback_guard_ = std::make_shared<CallbackGuard>();
+
+        winrt::Windows::Devices::Bluetooth::Advertisement::BluetoothLEAdvertisementPublisher bluetoothLEPublisher{ nullptr };
+        winrt::event_token bluetoothLEPublisherStatusChangedToken;
+        // Number of the current publisher. A status handler checks it and
+        // reports under |publisher_mutex_|, so once StartAdvertising has
+        // moved it on no status of an older publisher is reported.
+        std::mutex publisher_mutex_;
+        uint64_t publisher_ = 0;
+
+        winrt::Windows::Devices::Bluetooth::Advertisement::BluetoothLEAdvertisementWatcher bluetoothLEWatcher{ nullptr };
+        winrt::event_token bluetoothLEWatcherReceivedToken;
+
+        // Raw AD bytes of the advertisement being delivered, and their
+        // parse. The watcher raises Received one event at a time, so one of
+        // each is enough.
+        std::vector<uint8_t> advertisementData_;
+        AdvertisementFields advertisementFields_;
+
+        // Swapped with std::atomic_store by SetScanFilter and read with
+        // std::atomic_load on the watcher thread.
+        std::shared_ptr<const ScanFilter> scan_filter_;
+        ScanFilterPushDown scan_filter_push_down_;
+        ScanSettings scan_settings_;
+        std::atomic<uint64_t> filtered_{ 0 };
+        // Swapped with std::atomic_store by SetScanCapture.
+        std::shared_ptr<ScanCaptureWriter> scan_capture_;
+    };
+
+    // Serializes |advertisement|'s data sections into |advertisementData| as
+    // raw AD structures (length, type, data).
+    void SerializeDataSections(
+        const winrt::Windows::Devices::Bluetooth::Advertisement::BluetoothLEAdvertisement& advertisement,
+        std::vector<uint8_t>& advertisementData);
+
+    // The fields of a ScanResult a capture records: address, RSSI, flags,
+    // timestamp and the raw AD structures, borrowed from |advertisementData|.
+    ScanResult ToRawScanResult(
+        const winrt::Windows::Devices::Bluetooth::Advertisement::BluetoothLEAdvertisementReceivedEventArgs& args,
+        const std::vector<uint8_t>& advertisementData);
+
+    // Maps a WinRT advertisement onto a ScanResult without copying payloads,
+    // parsing it once into |fields|, which the result carries. The result
+    // borrows from |advertisementData|, the advertisement's
+    // SerializeDataSections output, and from |fields|; both must outlive it.
+    ScanResult ToScanResult(
+        const winrt::Windows::Devices::Bluetooth::Advertisement::BluetoothLEAdvertisementReceivedEventArgs& args,
+        const std::vector<uint8_t>& advertisementData, AdvertisementFields& fields);
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_PLUGIN_WINRT_RADIO_BACKEND_H_
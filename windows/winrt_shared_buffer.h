@@ -0,0 +1,42 @@
+#ifndef FLUTTER_PLUGIN_WINRT_SHARED_BUFFER_H_
+#define FLUTTER_PLUGIN_WINRT_SHARED_BUFFER_H_
+
+// This must be included before many other Windows headers.
+#include <windows.h>
+#include <winrt/Windows.Foundation.h>
+#include <winrt/Windows.Storage.Streams.h>
+
+#include <robuffer.h>
+
+#include <utility>
+
+#include "core/byte_buffer.h"
+
+namespace flutter_ble_peripheral {
+
+    // Exposes a SharedBuffer to WinRT as a read-only IBuffer without
+    // copying. Whoever holds the IBuffer (the publisher, a pending
+    // notification) keeps the storage alive through the reference held here.
+    struct SharedBufferView : winrt::implements<SharedBufferView, winrt::Windows::Storage::Streams::IBuffer,
+                                                ::Windows::Storage::Streams::IBufferByteAccess> {
+        explicit SharedBufferView(SharedBuffer buffer) : buffer_(std::move(buffer)) {}
+
+        uint32_t Capacity() const { return static_cast<uint32_t>(buffer_.size()); }
+        uint32_t Length() const { return static_cast<uint32_t>(buffer_.size()); }
+        void Length(uint32_t value) {
+            if (value != buffer_.size()) throw winrt::hresult_not_implemented();
+        }
+
+        HRESULT __stdcall Buffer(uint8_t** value) final {
+            // IBufferByteAccess has no const flavour; nothing writes through it.
+            *value = const_cast<uint8_t*>(buffer_.data());
+            return S_OK;
+        }
+
+    private:
+        SharedBuffer buffer_;
+    };
+
+}  // namespace flutter_ble_peripheral
+
+#endif  // FLUTTER_PLUGIN_WINRT_SHARED_BUFFER_H_